@@ -0,0 +1,147 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include <cstdlib>
+#include <new>
+
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
+
+#include "allocationCounter.h"
+
+using namespace benchmarks;
+
+// Allocations made by each thread. Only ever touched by its own thread, so needs no synchronisation
+static thread_local uint64_t allocations = 0;
+
+// Allocate through malloc, counting the allocation. Returns null if the memory can't be had
+static void *countedAllocate(std::size_t size) noexcept {
+    allocations++;
+    // malloc may return null for a zero sized request, which new must not
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+// Allocate memory aligned beyond what malloc guarantees, counting the allocation. Returns null if the memory
+// can't be had. Must be freed with alignedFree
+static void *countedAlignedAllocate(std::size_t size, std::align_val_t alignment) noexcept {
+    allocations++;
+    std::size_t align = (std::size_t) alignment;
+#if defined(_WIN32)
+    return _aligned_malloc(size == 0 ? 1 : size, align);
+#else
+    // aligned_alloc takes a size which is a whole number of the alignment
+    std::size_t rounded = size == 0 ? align : (size + align - 1) / align * align;
+    return std::aligned_alloc(align, rounded);
+#endif
+}
+
+// Free memory from countedAlignedAllocate
+static void alignedFree(void *memory) noexcept {
+#if defined(_WIN32)
+    _aligned_free(memory);
+#else
+    std::free(memory);
+#endif
+}
+
+void *operator new(std::size_t size) {
+    if (void *memory = countedAllocate(size)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+    return countedAllocate(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+    return countedAllocate(size);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment) {
+    if (void *memory = countedAlignedAllocate(size, alignment)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+    return countedAlignedAllocate(size, alignment);
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+    return countedAlignedAllocate(size, alignment);
+}
+
+void operator delete(void *memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, const std::nothrow_t &) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory, const std::nothrow_t &) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::align_val_t) noexcept {
+    alignedFree(memory);
+}
+
+void operator delete[](void *memory, std::align_val_t) noexcept {
+    alignedFree(memory);
+}
+
+void operator delete(void *memory, std::size_t, std::align_val_t) noexcept {
+    alignedFree(memory);
+}
+
+void operator delete[](void *memory, std::size_t, std::align_val_t) noexcept {
+    alignedFree(memory);
+}
+
+void operator delete(void *memory, std::align_val_t, const std::nothrow_t &) noexcept {
+    alignedFree(memory);
+}
+
+void operator delete[](void *memory, std::align_val_t, const std::nothrow_t &) noexcept {
+    alignedFree(memory);
+}
+
+uint64_t benchmarks::threadAllocations() {
+    return allocations;
+}
+
+AllocationCounter::AllocationCounter(benchmark::State &state)
+        : state(state), start(threadAllocations()) {
+
+}
+
+AllocationCounter::~AllocationCounter() {
+    state.counters["allocs/op"] = benchmark::Counter((double) (threadAllocations() - start),
+                                                     benchmark::Counter::kAvgIterations);
+}
@@ -0,0 +1,44 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#ifndef CONTRACTS_INTERNAL_ALLOCATIONCOUNTER_H
+#define CONTRACTS_INTERNAL_ALLOCATIONCOUNTER_H
+
+#include <cstdint>
+
+#include <benchmark/benchmark.h>
+
+namespace benchmarks {
+
+    // Get the number of heap allocations made by the calling thread so far. Counted by the replacement global
+    // operator new, so covers every allocation made through new, including by the standard containers
+    uint64_t threadAllocations();
+
+    // AllocationCounter
+    // Counts the allocations made on the benchmark thread while it is alive, and reports them as allocations per
+    // iteration of the benchmark when it is destroyed. Create one just before the benchmark loop, e.g.
+    //   AllocationCounter allocations(state);
+    //   for (auto _ : state) { ... }
+    class AllocationCounter {
+    public:
+        // Constructor taking the benchmark to report to
+        explicit AllocationCounter(benchmark::State &state);
+
+        AllocationCounter(const AllocationCounter &other) = delete;
+
+        AllocationCounter &operator=(const AllocationCounter &other) = delete;
+
+        // Destructor. Reports the allocations per iteration
+        ~AllocationCounter();
+
+    private:
+        // The benchmark to report to
+        benchmark::State &state;
+        // The thread's allocation count when the counter was created
+        uint64_t start;
+    };
+
+}
+
+#endif //CONTRACTS_INTERNAL_ALLOCATIONCOUNTER_H
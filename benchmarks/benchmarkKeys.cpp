@@ -0,0 +1,39 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include <cstdlib>
+#include <fstream>
+
+#include "benchmarkKeys.h"
+
+using namespace benchmarks;
+
+// Read the key pair from the file named by the environment variable
+static std::optional<RSAKeyPair> readKeyPair() {
+    const char *path = std::getenv(BENCHMARK_RSA_KEYS_VARIABLE);
+    if (!path) {
+        return std::nullopt;
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    RSAKeyPair keys{};
+    if (!file.read((char *) &keys, sizeof(RSAKeyPair))) {
+        return std::nullopt;
+    }
+    return keys;
+}
+
+const std::optional<RSAKeyPair> &benchmarks::benchmarkKeyPair() {
+    static const std::optional<RSAKeyPair> keys = readKeyPair();
+    return keys;
+}
+
+AESKey benchmarks::benchmarkAESKey() {
+    AESKey key{};
+    unsigned char *bytes = (unsigned char *) &key;
+    for (size_t i = 0; i < sizeof(AESKey); i++) {
+        bytes[i] = (unsigned char) (i * 37 + 11);
+    }
+    return key;
+}
@@ -0,0 +1,28 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#ifndef CONTRACTS_INTERNAL_BENCHMARKKEYS_H
+#define CONTRACTS_INTERNAL_BENCHMARKKEYS_H
+
+#include <optional>
+
+#include <encrypt.h>
+
+// Environment variable naming the file the RSA key pair for the benchmarks is read from
+#define BENCHMARK_RSA_KEYS_VARIABLE "CONTRACTS_BENCHMARK_RSA_KEYS"
+
+namespace benchmarks {
+
+    // Get the RSA key pair to benchmark with, read from the file named by CONTRACTS_BENCHMARK_RSA_KEYS as the raw
+    // bytes of an RSAKeyPair, the way keys are written to sockets. Generating a pair is far slower than anything
+    // measured here, so a pair is made once and reused. Returns nothing if the variable isn't set or the file
+    // can't be read, in which case the RSA benchmarks are skipped
+    const std::optional<RSAKeyPair> &benchmarkKeyPair();
+
+    // Get an AES key to benchmark with. AES runs the same work whatever the key, so this is a fixed key
+    AESKey benchmarkAESKey();
+
+}
+
+#endif //CONTRACTS_INTERNAL_BENCHMARKKEYS_H
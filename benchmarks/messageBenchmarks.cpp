@@ -0,0 +1,190 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include <array>
+#include <algorithm>
+
+#include <benchmark/benchmark.h>
+
+#include "../include/networking/NetworkMessageV2.h"
+#include "allocationCounter.h"
+#include "benchmarkKeys.h"
+
+using namespace networking;
+using namespace benchmarks;
+
+// Smallest and largest payloads the framing benchmarks are run over
+#define MESSAGE_BENCHMARK_MIN_PAYLOAD 16
+#define MESSAGE_BENCHMARK_MAX_PAYLOAD (1 << 20)
+
+// Make a buffer of the given size filled with a repeating pattern
+static byte_buffer makePayload(size_t size) {
+    byte_buffer payload(size);
+    for (size_t i = 0; i < size; i++) {
+        payload.begin()[i] = (byte) i;
+    }
+    return payload;
+}
+
+// Decode a framed message the way TCPSocket::receive does, a header and then a chunk at a time
+static NetworkMessage decodeChunked(const NetworkMessage &message) {
+    NetworkMessageDecoder decoder;
+
+    std::array<byte, NetworkMessage::HeaderSize> header{};
+    std::copy(message.cbegin(), message.cbegin() + NetworkMessage::HeaderSize, header.begin());
+    if (!decoder.decodeHeader(header)) {
+        return decoder.create();
+    }
+
+    std::array<byte, NetworkMessage::BufferChunkSize> chunk{};
+    const byte *next = message.cbegin() + NetworkMessage::HeaderSize;
+    while (decoder.expectingData()) {
+        std::copy(next, next + NetworkMessage::BufferChunkSize, chunk.begin());
+        decoder.decodeChunk(chunk);
+        next += NetworkMessage::BufferChunkSize;
+    }
+
+    return decoder.create();
+}
+
+// Frame a payload into a network message
+static void BM_NetworkMessageBuilder(benchmark::State &state) {
+    byte_buffer payload = makePayload(state.range(0));
+
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        NetworkMessageBuilder builder(payload.size());
+        std::copy(payload.cbegin(), payload.cend(), builder.begin());
+        NetworkMessage message = builder.create();
+        benchmark::DoNotOptimize(message.cbegin());
+    }
+    state.SetBytesProcessed((int64_t) state.iterations() * state.range(0));
+}
+BENCHMARK(BM_NetworkMessageBuilder)->RangeMultiplier(8)->Range(MESSAGE_BENCHMARK_MIN_PAYLOAD,
+                                                                MESSAGE_BENCHMARK_MAX_PAYLOAD);
+
+// Decode a framed message a header and chunk at a time, as a blocking receive does
+static void BM_NetworkMessageDecoder(benchmark::State &state) {
+    NetworkMessage framed = RawMessage(makePayload(state.range(0))).message();
+
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        NetworkMessage message = decodeChunked(framed);
+        benchmark::DoNotOptimize(message.cbegin());
+    }
+    state.SetBytesProcessed((int64_t) state.iterations() * state.range(0));
+}
+BENCHMARK(BM_NetworkMessageDecoder)->RangeMultiplier(8)->Range(MESSAGE_BENCHMARK_MIN_PAYLOAD,
+                                                                MESSAGE_BENCHMARK_MAX_PAYLOAD);
+
+// Decode a framed message from one span of bytes, as the stream multiplexer does
+static void BM_NetworkMessageDecoderStream(benchmark::State &state) {
+    NetworkMessage framed = RawMessage(makePayload(state.range(0))).message();
+
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        NetworkMessageDecoder decoder;
+        decoder.decodeStream(framed.cbegin(), framed.bufferSize());
+        NetworkMessage message = decoder.create();
+        benchmark::DoNotOptimize(message.cbegin());
+    }
+    state.SetBytesProcessed((int64_t) state.iterations() * state.range(0));
+}
+BENCHMARK(BM_NetworkMessageDecoderStream)->RangeMultiplier(8)->Range(MESSAGE_BENCHMARK_MIN_PAYLOAD,
+                                                                      MESSAGE_BENCHMARK_MAX_PAYLOAD);
+
+// Frame a raw message for sending
+static void BM_RawMessageEncode(benchmark::State &state) {
+    byte_buffer payload = makePayload(state.range(0));
+
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        NetworkMessage message = RawMessage(payload).message();
+        benchmark::DoNotOptimize(message.cbegin());
+    }
+    state.SetBytesProcessed((int64_t) state.iterations() * state.range(0));
+}
+BENCHMARK(BM_RawMessageEncode)->RangeMultiplier(8)->Range(MESSAGE_BENCHMARK_MIN_PAYLOAD,
+                                                           MESSAGE_BENCHMARK_MAX_PAYLOAD);
+
+// Unpack a received raw message
+static void BM_RawMessageDecode(benchmark::State &state) {
+    NetworkMessage framed = RawMessage(makePayload(state.range(0))).message();
+
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        RawMessage message(framed);
+        benchmark::DoNotOptimize(message.cbegin());
+    }
+    state.SetBytesProcessed((int64_t) state.iterations() * state.range(0));
+}
+BENCHMARK(BM_RawMessageDecode)->RangeMultiplier(8)->Range(MESSAGE_BENCHMARK_MIN_PAYLOAD,
+                                                           MESSAGE_BENCHMARK_MAX_PAYLOAD);
+
+// Encrypt and frame an AES message for sending
+static void BM_AESMessageEncode(benchmark::State &state) {
+    byte_buffer payload = makePayload(state.range(0));
+    AESKey key = benchmarkAESKey();
+
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        NetworkMessage message = AESMessage(payload, key).message();
+        benchmark::DoNotOptimize(message.cbegin());
+    }
+    state.SetBytesProcessed((int64_t) state.iterations() * state.range(0));
+}
+BENCHMARK(BM_AESMessageEncode)->RangeMultiplier(8)->Range(MESSAGE_BENCHMARK_MIN_PAYLOAD,
+                                                           MESSAGE_BENCHMARK_MAX_PAYLOAD);
+
+// Decrypt a received AES message
+static void BM_AESMessageDecode(benchmark::State &state) {
+    AESKey key = benchmarkAESKey();
+    NetworkMessage framed = AESMessage(makePayload(state.range(0)), key).message();
+
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        AESMessage message(framed, key);
+        benchmark::DoNotOptimize(message.cbegin());
+    }
+    state.SetBytesProcessed((int64_t) state.iterations() * state.range(0));
+}
+BENCHMARK(BM_AESMessageDecode)->RangeMultiplier(8)->Range(MESSAGE_BENCHMARK_MIN_PAYLOAD,
+                                                           MESSAGE_BENCHMARK_MAX_PAYLOAD);
+
+// Encrypt and frame an RSA message, which always carries a single 2048 bit value
+static void BM_RSAMessageEncrypt(benchmark::State &state) {
+    const std::optional<RSAKeyPair> &keys = benchmarkKeyPair();
+    if (!keys.has_value()) {
+        state.SkipWithError("No RSA key pair; set " BENCHMARK_RSA_KEYS_VARIABLE);
+        return;
+    }
+    uint2048 value{};
+    std::fill((byte *) &value, (byte *) &value + sizeof(uint2048) / 2, (byte) 0x5a);
+
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        NetworkMessage message = RSAMessage(value, keys->publicKey).message();
+        benchmark::DoNotOptimize(message.cbegin());
+    }
+}
+BENCHMARK(BM_RSAMessageEncrypt);
+
+// Decrypt a received RSA message
+static void BM_RSAMessageDecrypt(benchmark::State &state) {
+    const std::optional<RSAKeyPair> &keys = benchmarkKeyPair();
+    if (!keys.has_value()) {
+        state.SkipWithError("No RSA key pair; set " BENCHMARK_RSA_KEYS_VARIABLE);
+        return;
+    }
+    uint2048 value{};
+    std::fill((byte *) &value, (byte *) &value + sizeof(uint2048) / 2, (byte) 0x5a);
+    NetworkMessage framed = RSAMessage(value, keys->publicKey).message();
+
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        RSAMessage message(framed, keys.value());
+        benchmark::DoNotOptimize(message.cbegin());
+    }
+}
+BENCHMARK(BM_RSAMessageDecrypt);
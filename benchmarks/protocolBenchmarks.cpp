@@ -0,0 +1,170 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include <cstring>
+#include <thread>
+#include <optional>
+
+#include <benchmark/benchmark.h>
+
+#include "../include/Network"
+#include "allocationCounter.h"
+#include "benchmarkKeys.h"
+
+using namespace networking;
+using namespace benchmarks;
+
+// Input slots for the handshake protocols. Inputs belong to no layer, so their layer type is a placeholder
+using SocketInput = internal::Connector<0, std::nullptr_t, TCPSocket>;
+using PublicKeyInput = internal::Connector<1, std::nullptr_t, RSAKeyPair::Public>;
+using PrivateKeyInput = internal::Connector<2, std::nullptr_t, RSAKeyPair::Private>;
+using SessionKeyInput = internal::Connector<3, std::nullptr_t, AESKey>;
+using ResponseInput = internal::Connector<4, std::nullptr_t, ConnectionResponse>;
+
+// Output slot for the response the server receives
+using ResponseOutput = internal::Connector<0, std::nullptr_t, ConnectionResponse>;
+
+static_assert(sizeof(AESKey) <= sizeof(uint2048), "A session key must fit in a single RSA message.");
+
+// Pack a session key into the value an RSA message carries
+static uint2048 packSessionKey(const AESKey &key) {
+    uint2048 packed{};
+    std::memcpy(&packed, &key, sizeof(AESKey));
+    return packed;
+}
+
+// Unpack a session key from the value an RSA message carries
+static AESKey unpackSessionKey(const uint2048 &packed) {
+    AESKey key{};
+    std::memcpy(&key, &packed, sizeof(AESKey));
+    return key;
+}
+
+// LoopbackPair
+// Both ends of a connection over the loopback interface
+struct LoopbackPair {
+    // The connecting end
+    TCPSocket client;
+    // The accepted end
+    TCPSocket server;
+};
+
+// Open a connection to a listener on a port picked by the system, so runs never clash over a port. If the
+// connection can't be made, the benchmark is skipped with the reason and std::nullopt returned
+static std::optional<LoopbackPair> connectLoopback(benchmark::State &state) {
+    try {
+        TCPSocket listener;
+        listener.create();
+        listener.bind(0, "127.0.0.1");
+        listener.listen();
+
+        // The connection completes in the listen backlog, so it can be accepted afterwards on the same thread
+        LoopbackPair pair;
+        pair.client.create();
+        pair.client.connect("127.0.0.1", listener.localPort());
+        pair.client.setNoDelay(true);
+        pair.server = listener.accept();
+        pair.server.setNoDelay(true);
+        return pair;
+    } catch (SocketException &e) {
+        state.SkipWithError(e.what());
+        return std::nullopt;
+    }
+}
+
+// Build the connecting side of the handshake: send our public key, receive the session key encrypted under it,
+// then send a response encrypted under the session key
+static Protocol clientHandshake() {
+    Protocol protocol;
+
+    LayerReference<KeyExchange> keyExchange = protocol.addLayer<KeyExchange>(Sender);
+    LayerReference<RSAMessageLayer> sessionKey = protocol.addLayer<RSAMessageLayer>(Receiver);
+    LayerReference<CodeTransferLayer<ConnectionResponse>> response =
+            protocol.addLayer<CodeTransferLayer<ConnectionResponse>>(Sender);
+
+    protocol.link<SocketInput, KeyExchange::Socket>(Protocol::Inputs, keyExchange);
+    protocol.link<SocketInput, RSAMessageLayer::Socket>(Protocol::Inputs, sessionKey);
+    protocol.link<SocketInput, CodeTransferLayer<ConnectionResponse>::Socket>(Protocol::Inputs, response);
+
+    protocol.link<PublicKeyInput, KeyExchange::RSAPublicKey>(Protocol::Inputs, keyExchange);
+    protocol.link<PublicKeyInput, RSAMessageLayer::RSAPublicKey>(Protocol::Inputs, sessionKey);
+    protocol.link<PrivateKeyInput, RSAMessageLayer::RSAPrivateKey>(Protocol::Inputs, sessionKey);
+
+    protocol.link<RSAMessageLayer::Message, CodeTransferLayer<ConnectionResponse>::AESSymKey>(
+            sessionKey, response, unpackSessionKey);
+    protocol.link<ResponseInput, CodeTransferLayer<ConnectionResponse>::Code>(Protocol::Inputs, response);
+
+    return protocol;
+}
+
+// Build the accepting side of the handshake: receive the client's public key, send the session key encrypted
+// under it, then receive the client's response
+static Protocol serverHandshake() {
+    Protocol protocol;
+
+    LayerReference<KeyExchange> keyExchange = protocol.addLayer<KeyExchange>(Receiver);
+    LayerReference<RSAMessageLayer> sessionKey = protocol.addLayer<RSAMessageLayer>(Sender);
+    LayerReference<CodeTransferLayer<ConnectionResponse>> response =
+            protocol.addLayer<CodeTransferLayer<ConnectionResponse>>(Receiver);
+
+    protocol.link<SocketInput, KeyExchange::Socket>(Protocol::Inputs, keyExchange);
+    protocol.link<SocketInput, RSAMessageLayer::Socket>(Protocol::Inputs, sessionKey);
+    protocol.link<SocketInput, CodeTransferLayer<ConnectionResponse>::Socket>(Protocol::Inputs, response);
+
+    protocol.link<KeyExchange::RSAPublicKey, RSAMessageLayer::RSAPublicKey>(keyExchange, sessionKey);
+    protocol.link<SessionKeyInput, RSAMessageLayer::Message>(Protocol::Inputs, sessionKey, packSessionKey);
+    protocol.link<SessionKeyInput, CodeTransferLayer<ConnectionResponse>::AESSymKey>(Protocol::Inputs, response);
+
+    protocol.link<CodeTransferLayer<ConnectionResponse>::Code, ResponseOutput>(response, Protocol::Outputs);
+
+    return protocol;
+}
+
+// Run the whole handshake over a loopback connection, with the server side on a thread of its own. Only the
+// client's thread is counted for allocations
+static void BM_ProtocolHandshake(benchmark::State &state) {
+    const std::optional<RSAKeyPair> &keys = benchmarkKeyPair();
+    if (!keys.has_value()) {
+        state.SkipWithError("No RSA key pair; set " BENCHMARK_RSA_KEYS_VARIABLE);
+        return;
+    }
+
+    std::optional<LoopbackPair> connection = connectLoopback(state);
+    if (!connection.has_value()) {
+        return;
+    }
+
+    // The server handshakes until the client closes the connection, which stops its protocol
+    std::thread server([&connection]() {
+        Protocol protocol = serverHandshake();
+        protocol.feed<SocketInput>(connection->server);
+        protocol.feed<SessionKeyInput>(benchmarkAESKey());
+        do {
+            protocol.clearData();
+            protocol.execute();
+        } while (protocol.completed());
+    });
+
+    Protocol protocol = clientHandshake();
+    protocol.feed<SocketInput>(connection->client);
+    protocol.feed<PublicKeyInput>(keys->publicKey);
+    protocol.feed<PrivateKeyInput>(keys->privateKey);
+    protocol.feed<ResponseInput>(ConnectionResponse::SUCCESS);
+
+    {
+        AllocationCounter allocations(state);
+        for (auto _ : state) {
+            protocol.clearData();
+            protocol.execute();
+            if (!protocol.completed()) {
+                state.SkipWithError("Handshake failed");
+                break;
+            }
+        }
+    }
+
+    connection->client.close();
+    server.join();
+}
+BENCHMARK(BM_ProtocolHandshake)->UseRealTime();
@@ -0,0 +1,63 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include <benchmark/benchmark.h>
+
+#include "../include/database/queryConstructions.h"
+#include "allocationCounter.h"
+
+using namespace sql;
+using namespace benchmarks;
+
+// Build a query typical of the application: a few joins, a filter, grouping, ordering and a page of rows
+static SelectQuery typicalQuery() {
+    SelectQuery query;
+    query.rootTable = "Contracts";
+    query.rootTableAlias = "c";
+    query.joins.emplace_back("Customers", "cu", "c.CustomerID", "cu.CustomerID", JoinType::INNER);
+    query.joins.emplace_back("Products", "p", "c.ProductID", "p.ProductID", JoinType::INNER);
+    query.joins.emplace_back("Inspections", "i", "c.ContractNumber", "i.ContractNumber", JoinType::LEFT);
+    query.selections = {"c.ContractNumber", "cu.Name", "p.Description", "SUM(c.Quantity)", "MAX(i.Date)"};
+    query.whereConditions = {"c.Status='OPEN'", "c.Date>='2020-01-01'"};
+    query.groupByConditions = {"c.ContractNumber", "cu.Name", "p.Description"};
+    query.orderByConditions.emplace_back("c.ContractNumber", OrderDirection::ASC);
+    query.limit = 50;
+    query.offset = 100;
+    return query;
+}
+
+// Assemble a query through the builder, as TableSelection does for each query before it is run
+static void BM_QueryBuilderBuild(benchmark::State &state) {
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        internal::QueryBuilder builder(nullptr);
+        builder.setRootTable("Contracts", "c");
+        builder.addJoinedTable("Customers", "cu", "c.CustomerID", "cu.CustomerID", JoinType::INNER);
+        builder.addJoinedTable("Products", "p", "c.ProductID", "p.ProductID", JoinType::INNER);
+        builder.addJoinedTable("Inspections", "i", "c.ContractNumber", "i.ContractNumber", JoinType::LEFT);
+        builder.addSelections("c.ContractNumber", "cu.Name", "p.Description", "SUM(c.Quantity)", "MAX(i.Date)");
+        builder.addWhereConditions("c.Status='OPEN'", "c.Date>='2020-01-01'");
+        builder.addGroupByConditions("c.ContractNumber", "cu.Name", "p.Description");
+        builder.addOrderByConditions(OrderDirection::ASC, "c.ContractNumber");
+        builder.setLimit(50);
+        builder.setOffset(100);
+        benchmark::DoNotOptimize(&builder);
+    }
+}
+BENCHMARK(BM_QueryBuilderBuild);
+
+// Render a built query as SQL in each dialect, which is all QueryBuilder::construct does
+static void BM_QueryBuilderConstruct(benchmark::State &state, const SQLDialect &dialect) {
+    SelectQuery query = typicalQuery();
+
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        std::string sql = dialect.render(query);
+        benchmark::DoNotOptimize(sql.data());
+    }
+}
+BENCHMARK_CAPTURE(BM_QueryBuilderConstruct, sqlServer, SQLDialect::sqlServer());
+BENCHMARK_CAPTURE(BM_QueryBuilderConstruct, oracle, SQLDialect::oracle());
+BENCHMARK_CAPTURE(BM_QueryBuilderConstruct, sqlite, SQLDialect::sqlite());
+BENCHMARK_CAPTURE(BM_QueryBuilderConstruct, postgreSQL, SQLDialect::postgreSQL());
@@ -0,0 +1,201 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#ifndef CONTRACTS_INTERNAL_BULKINSERT_H
+#define CONTRACTS_INTERNAL_BULKINSERT_H
+
+#include <string>
+#include <vector>
+#include <optional>
+#include <type_traits>
+#include <initializer_list>
+
+#include "SQLSafeHandle.h"
+#include "SQLDialect.h"
+#include "ColumnType.h"
+#include "Value.h"
+
+// Most bytes of bound parameter data sent in a single execute. Larger batches are split into chunks of this size
+#define BULK_INSERT_BYTE_BUDGET (1024u * 1024u)
+// The savepoint a bulk insert inside the caller's transaction can roll back to
+#define BULK_INSERT_SAVEPOINT "bulk_insert__"
+
+namespace sql {
+
+    // BulkRowStatus
+    // What happened to a single row of a bulk insert
+    enum class BulkRowStatus {
+        // The row was inserted
+        INSERTED,
+        // The database rejected the row
+        FAILED,
+        // The row was never tried, e.g. because an earlier chunk failed
+        NOT_RUN,
+        // The database accepted the row, but it was undone with the rest of the batch when another row failed
+        ROLLED_BACK
+    };
+
+    // BulkInsertResult
+    // The outcome of a bulk insert
+    struct BulkInsertResult {
+        // Whether the batch was kept. A batch is only kept if every row was inserted; otherwise nothing from it
+        // is. Inside the caller's transaction, a kept batch is still only committed along with that transaction
+        bool committed = false;
+        // The number of rows kept, which is zero unless the whole batch was
+        size_t rowsInserted = 0;
+        // The status of each row, in the order the rows were added
+        std::vector<BulkRowStatus> rowStatus;
+    };
+
+    // BulkInsert
+    // A batch of rows to insert into a single table in one go. The rows are held column by column, so they can
+    // be bound to the insert statement as arrays and sent to the database as one execute per chunk rather than
+    // one statement per row. Each column takes its type from the first row added; later rows must match it.
+    // Supported types are bool, signed char, short, int, long long, float, double, ColumnarDate and strings, each
+    // optionally wrapped in a Value to allow nulls.
+    class BulkInsert {
+        // Friend the session class so it can bind the columns
+        friend class SQLSession;
+
+    public:
+        // Constructor taking the table and the columns each row gives values for
+        BulkInsert(std::string tableName, std::initializer_list<std::string> columnNames);
+
+        // Constructor taking the table and the columns each row gives values for
+        BulkInsert(std::string tableName, std::vector<std::string> columnNames);
+
+        // Add a row, with a value for each column in order
+        template<typename ...Values>
+        void addRow(const Values &...values);
+
+        // Get the number of rows in the batch
+        [[nodiscard]] size_t rowCount() const;
+
+        // Remove every row from the batch
+        void clear();
+
+    private:
+        // BulkColumn
+        // The values of one column
+        struct BulkColumn {
+            // The name of the column
+            std::string name;
+            // The type of the column, once the first row has been added
+            std::optional<ColumnType> type;
+            // Fixed width values back to back
+            std::vector<byte> data;
+            // String values
+            std::vector<std::string> strings;
+            // Whether each value is null
+            std::vector<bool> nulls;
+        };
+
+        // ChunkBuffers
+        // Buffers bound to the statement for a chunk, which must live until the chunk has been executed
+        struct ChunkBuffers {
+            // The length or null indicator of each value, per column
+            std::vector<std::vector<SQLLEN>> indicators;
+            // The fixed width string arrays, per column. Unused for fixed width columns, which are bound in place
+            std::vector<std::vector<byte>> strings;
+        };
+
+        // Recursive case for adding each value of a row
+        template<typename T, typename ...Values>
+        void impl_addRow(size_t index, const T &value, const Values &...values);
+
+        // Base case for adding each value of a row
+        void impl_addRow(size_t);
+
+        // Add a fixed width value to a column
+        template<typename T>
+        void addValue(BulkColumn &column, const T &value);
+
+        // Add a string value to a column
+        void addValue(BulkColumn &column, const std::string &value);
+
+        // Add a string value to a column
+        void addValue(BulkColumn &column, const char *value);
+
+        // Add a possibly null value to a column
+        template<typename T>
+        void addValue(BulkColumn &column, const Value<T> &value);
+
+        // Check a column has the given type, setting it if this is the first row
+        static void checkType(BulkColumn &column, ColumnType type);
+
+        // Get the width of each value of a fixed width column as bound to the statement
+        static size_t boundWidth(ColumnType type);
+
+        // Drop any values beyond the given number of rows, undoing a partly added row
+        void truncate(size_t rowCount);
+
+        // Build the insert statement for the batch, with the table and column names quoted for the dialect
+        [[nodiscard]] std::string statement(const SQLDialect &dialect) const;
+
+        // Get the number of rows from the given row which fit in the byte budget. Always at least one
+        [[nodiscard]] size_t chunkRows(size_t first) const;
+
+        // Bind the given rows to the statement's parameters as column arrays
+        void bindChunk(const SQLStatementHandle &statement, size_t first, size_t count, ChunkBuffers &buffers) const;
+
+        // The table to insert into
+        std::string tableName;
+        // The columns
+        std::vector<BulkColumn> columns;
+        // The number of rows
+        size_t rows = 0;
+    };
+
+    template<typename... Values>
+    void BulkInsert::addRow(const Values &... values) {
+        if (sizeof...(Values) != columns.size()) {
+            throw SQLException("Bulk insert row has " + std::to_string(sizeof...(Values)) + " values for " +
+                               std::to_string(columns.size()) + " columns.");
+        }
+        try {
+            impl_addRow(0, values...);
+        } catch (...) {
+            // Leave the batch as it was before the row
+            truncate(rows);
+            throw;
+        }
+        rows++;
+    }
+
+    template<typename T, typename... Values>
+    void BulkInsert::impl_addRow(size_t index, const T &value, const Values &... values) {
+        addValue(columns[index], value);
+        impl_addRow(index + 1, values...);
+    }
+
+    template<typename T>
+    void BulkInsert::addValue(BulkColumn &column, const T &value) {
+        checkType(column, columnTypeOf<T>());
+        if constexpr (std::is_same_v<T, ColumnarDate>) {
+            // Dates are bound as the driver's own date structure
+            SQL_DATE_STRUCT date{value.year, value.month, value.day};
+            const byte *bytes = reinterpret_cast<const byte *>(&date);
+            column.data.insert(column.data.end(), bytes, bytes + sizeof(SQL_DATE_STRUCT));
+        } else {
+            const byte *bytes = reinterpret_cast<const byte *>(&value);
+            column.data.insert(column.data.end(), bytes, bytes + sizeof(T));
+        }
+        column.nulls.push_back(false);
+    }
+
+    template<typename T>
+    void BulkInsert::addValue(BulkColumn &column, const Value<T> &value) {
+        if (value.hasValue()) {
+            addValue(column, value.value());
+            return;
+        }
+
+        // A null still takes a slot in the column, holding the default value of the type
+        addValue(column, T());
+        column.nulls.back() = true;
+    }
+
+}
+
+#endif //CONTRACTS_INTERNAL_BULKINSERT_H
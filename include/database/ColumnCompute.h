@@ -0,0 +1,189 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#ifndef CONTRACTS_INTERNAL_COLUMNCOMPUTE_H
+#define CONTRACTS_INTERNAL_COLUMNCOMPUTE_H
+
+#include <limits>
+#include <vector>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+#include "MaterializedResult.h"
+
+namespace sql {
+
+    // RowMask
+    // A set of rows of a result, held as one bit per row in 64 bit words. Masks are built by comparing a column
+    // against a value, combined with &, | and ~, and then used to restrict an aggregate or a group by, or turned
+    // into the rows to keep with MaterializedResult::selectRows
+    class RowMask {
+    public:
+        // Constructor for a mask over the given number of rows, with every row set or clear
+        explicit RowMask(size_t rows, bool selected = false);
+
+        // Get a mask of the rows of a result where a column isn't null
+        static RowMask nonNull(const MaterializedResult &result, size_t column);
+
+        // Get the number of rows the mask covers
+        [[nodiscard]] size_t size() const;
+
+        // Get the number of rows which are set
+        [[nodiscard]] size_t count() const;
+
+        // Returns true if the given row is set
+        [[nodiscard]] bool test(size_t row) const;
+
+        // Set or clear the given row
+        void set(size_t row, bool selected = true);
+
+        // Keep only the rows set in both masks
+        RowMask &operator&=(const RowMask &other);
+
+        // Keep the rows set in either mask
+        RowMask &operator|=(const RowMask &other);
+
+        // Get the rows which are clear in this mask
+        RowMask operator~() const;
+
+        // Get the indices of the rows which are set, in order
+        [[nodiscard]] std::vector<uint32_t> selectedRows() const;
+
+        // Get the words of the mask. Row i is bit i % 64 of word i / 64, and bits past the last row are clear
+        [[nodiscard]] const std::vector<uint64_t> &words() const;
+
+    private:
+        // Check another mask covers the same rows
+        void checkSize(const RowMask &other) const;
+
+        // The bits of the mask
+        std::vector<uint64_t> bits;
+        // The number of rows covered
+        size_t rows;
+    };
+
+    RowMask operator&(RowMask left, const RowMask &right);
+
+    RowMask operator|(RowMask left, const RowMask &right);
+
+    // Enum for the comparisons a column can be filtered by
+    enum class Comparison {
+        EQUAL,
+        NOT_EQUAL,
+        LESS,
+        LESS_EQUAL,
+        GREATER,
+        GREATER_EQUAL
+    };
+
+    // ColumnSummary
+    // The aggregates of a numeric column over a set of rows, leaving out nulls. Integers are summed exactly as
+    // long longs, and floating point values as doubles. The minimum and maximum are only meaningful when the count
+    // isn't zero
+    template<typename T>
+    struct ColumnSummary {
+        // The type values are summed as
+        using SumType = std::conditional_t<std::is_floating_point_v<T>, double, long long>;
+
+        // The number of values
+        size_t count = 0;
+        // The sum of the values
+        SumType sum = 0;
+        // The smallest value
+        T min = std::numeric_limits<T>::max();
+        // The largest value
+        T max = std::numeric_limits<T>::lowest();
+
+        // Get the mean of the values
+        [[nodiscard]] inline double mean() const {
+            return count == 0 ? 0.0 : (double) sum / (double) count;
+        }
+
+        // Add a value to the aggregates
+        inline void add(T value) {
+            count++;
+            sum += (SumType) value;
+            min = value < min ? value : min;
+            max = value > max ? value : max;
+        }
+
+        // Add the aggregates of another set of rows to these
+        inline void merge(const ColumnSummary &other) {
+            count += other.count;
+            sum += other.sum;
+            min = other.min < min ? other.min : min;
+            max = other.max > max ? other.max : max;
+        }
+    };
+
+    // Get the aggregates of a numeric column, over the rows in the mask if one is given. T must match the column
+    // type. Runs of rows with no nulls or masked rows are aggregated by a vector kernel
+    template<typename T>
+    ColumnSummary<T> summarise(const MaterializedResult &result, size_t column, const RowMask *mask = nullptr);
+
+    // Get a mask of the rows where a numeric column compares to the value as given. Null values never match.
+    // T must match the column type
+    template<typename T>
+    RowMask compareColumn(const MaterializedResult &result, size_t column, Comparison comparison, T value);
+
+    // Get a mask of the rows where a string column compares to the value as given. Null values never match
+    RowMask compareColumn(const MaterializedResult &result, size_t column, Comparison comparison,
+                          std::string_view value);
+
+    // Get a mask of the rows where a string column compares to the string literal as given. Without this, a
+    // literal would pick the numeric template, which has no instance for it
+    inline RowMask compareColumn(const MaterializedResult &result, size_t column, Comparison comparison,
+                                 const char *value) {
+        return compareColumn(result, column, comparison, std::string_view(value));
+    }
+
+    // GroupIndex
+    // The rows of a result grouped by the values of some key columns, as with GROUP BY. Rows with the same value in
+    // every key column (with nulls equal to each other) are in the same group, and groups are numbered in the order
+    // their first row appears. The index refers back to the result, which must outlive it and not be sorted or
+    // filtered while it is in use
+    class GroupIndex {
+    public:
+        // Group number given to rows left out by the mask
+        static constexpr uint32_t NO_GROUP = std::numeric_limits<uint32_t>::max();
+
+        // Group the rows of a result by the given key columns, only taking the rows in the mask if one is given
+        GroupIndex(const MaterializedResult &result, std::vector<size_t> keyColumns, const RowMask *mask = nullptr);
+
+        // Get the number of groups
+        [[nodiscard]] size_t groupCount() const;
+
+        // Get the group of each row, or NO_GROUP for rows left out
+        [[nodiscard]] const std::vector<uint32_t> &rowGroups() const;
+
+        // Get the first row of a group, from which its key values can be read
+        [[nodiscard]] size_t firstRow(size_t group) const;
+
+        // Get the number of rows in each group
+        [[nodiscard]] const std::vector<size_t> &groupSizes() const;
+
+        // Get the aggregates of a numeric column for each group. T must match the column type
+        template<typename T>
+        std::vector<ColumnSummary<T>> summarise(size_t column) const;
+
+    private:
+        // Returns true if two rows have the same value in every key column
+        [[nodiscard]] bool sameKey(size_t a, size_t b) const;
+
+        // The result grouped
+        const MaterializedResult &result;
+        // The key columns
+        std::vector<size_t> keyColumns;
+        // The group of each row
+        std::vector<uint32_t> groups;
+        // The first row of each group
+        std::vector<uint32_t> firstRows;
+        // The number of rows in each group
+        std::vector<size_t> sizes;
+    };
+
+}
+
+#endif //CONTRACTS_INTERNAL_COLUMNCOMPUTE_H
@@ -0,0 +1,84 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#ifndef CONTRACTS_INTERNAL_COLUMNTYPE_H
+#define CONTRACTS_INTERNAL_COLUMNTYPE_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "SQLSafeHandle.h"
+#include "../networking/buffer.h"
+
+namespace sql {
+
+    // ColumnType
+    // The type a column is exchanged with the driver as, e.g. in a columnar block or a bulk insert. Each SQL type
+    // is mapped onto the nearest of these
+    enum class ColumnType : byte {
+        BOOL = 0,
+        INT8 = 1,
+        INT16 = 2,
+        INT32 = 3,
+        INT64 = 4,
+        FLOAT32 = 5,
+        FLOAT64 = 6,
+        DATE = 7,
+        STRING = 8
+    };
+
+    // ColumnarDate
+    // A date as stored in a DATE column
+    struct ColumnarDate {
+        int16_t year;
+        uint8_t month;
+        uint8_t day;
+    };
+
+    // Get the type a column of the given SQL type is stored as. Types without a closer match (e.g. timestamps
+    // or binary data) are stored as the driver's character representation. NUMERIC and DECIMAL are stored as
+    // FLOAT64, which rounds values with more than 15 significant digits; read such columns as strings
+    // (CAST(... AS VARCHAR)) where every digit matters
+    ColumnType columnTypeFor(SQLSMALLINT sqlType);
+
+    // Get the width in bytes of each value of a fixed width column type, or 0 for strings
+    size_t columnTypeWidth(ColumnType type);
+
+    // Get the C type used to exchange values of a column type with the driver
+    SQLSMALLINT driverTypeFor(ColumnType type);
+
+    // Get the SQL type values of a column type are bound to a statement's parameters as
+    SQLSMALLINT sqlTypeFor(ColumnType type);
+
+    // Get the column type of a C++ type
+    template<typename T>
+    constexpr ColumnType columnTypeOf();
+
+    template<>
+    constexpr ColumnType columnTypeOf<bool>() { return ColumnType::BOOL; }
+
+    template<>
+    constexpr ColumnType columnTypeOf<signed char>() { return ColumnType::INT8; }
+
+    template<>
+    constexpr ColumnType columnTypeOf<short>() { return ColumnType::INT16; }
+
+    template<>
+    constexpr ColumnType columnTypeOf<int>() { return ColumnType::INT32; }
+
+    template<>
+    constexpr ColumnType columnTypeOf<long long>() { return ColumnType::INT64; }
+
+    template<>
+    constexpr ColumnType columnTypeOf<float>() { return ColumnType::FLOAT32; }
+
+    template<>
+    constexpr ColumnType columnTypeOf<double>() { return ColumnType::FLOAT64; }
+
+    template<>
+    constexpr ColumnType columnTypeOf<ColumnarDate>() { return ColumnType::DATE; }
+
+}
+
+#endif //CONTRACTS_INTERNAL_COLUMNTYPE_H
@@ -0,0 +1,196 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#ifndef CONTRACTS_INTERNAL_COLUMNARBLOCK_H
+#define CONTRACTS_INTERNAL_COLUMNARBLOCK_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "QueryResult.h"
+#include "ResultStreamer.h"
+#include "ColumnType.h"
+#include "../networking/byteOrder.h"
+
+// Version written into the header of every columnar block
+#define COLUMNAR_BLOCK_VERSION 1
+// Every section of a columnar block starts on a multiple of this many bytes, so fixed width columns can be read
+// in place as arrays of their type
+#define COLUMNAR_BLOCK_ALIGNMENT 8
+// Most bytes of a string value read from the driver in one call. Longer values are read in several pieces
+#define COLUMNAR_STRING_CHUNK 4096
+
+namespace sql {
+
+    // ColumnBuffer
+    // The values of one column of a query result, read from the driver straight into typed storage: fixed width
+    // values back to back as an array of their type, and strings as one run of bytes with the end offset of each
+    struct ColumnBuffer {
+        // The column as described by the driver
+        ColumnDescription description;
+        // The type the column is stored as
+        ColumnType type;
+        // The null bitmap, one bit per row, set for nulls. Empty unless the column is nullable
+        std::vector<byte> nulls;
+        // The fixed width values, or the string bytes
+        std::vector<byte> data;
+        // The end offset of each string, after an initial 0. Only used for string columns
+        std::vector<uint32_t> offsets;
+
+        // Empty the buffer, ready to take the values of the given column
+        void reset(ColumnDescription columnDescription);
+
+        // Read the value of this column on the result's current row, which is the given row of the buffer
+        void read(const QueryResult &result, size_t index, size_t row);
+
+        // Returns true if the value at the given row is null
+        [[nodiscard]] bool isNull(size_t row) const;
+
+        // Get the string at the given row of a string column
+        [[nodiscard]] std::string_view string(size_t row) const;
+
+    private:
+        // Read a fixed width value from the current row onto the end of the buffer
+        void readFixed(const QueryResult &result, size_t index, size_t row);
+
+        // Read a string value from the current row onto the end of the buffer
+        void readString(const QueryResult &result, size_t index, size_t row);
+
+        // Mark the value at the given row as null
+        void setNull(size_t row);
+    };
+
+    // ColumnarBlockEncoder
+    // The built-in block encoder, storing a block of rows column by column. Each value is read from the driver
+    // straight into its column's buffer, and the buffers are kept from block to block, so encoding allocates
+    // nothing once the first few blocks have been sized. A block is laid out as:
+    //      header:     [version (1)][byte order (1)][reserved (2)][column count (4)][row count (4)][reserved (4)]
+    //      schema:     for each column [column type (1)][nullable (1)][SQL type (2)][name length (4)][name]
+    //      columns:    for each column
+    //                      [null bitmap, one bit per row, set for nulls]   (nullable columns only)
+    //                      [row count values]                              (fixed width columns)
+    //                      [row count + 1 offsets (4 each)][string bytes]  (string columns)
+    // Integers are in the byte order of the sender, as given in the header. Each section after the header is
+    // padded to COLUMNAR_BLOCK_ALIGNMENT bytes. Null values in fixed width columns are stored as zero, and null
+    // strings as empty.
+    class ColumnarBlockEncoder : public BlockEncoder {
+    public:
+        // Default constructor
+        ColumnarBlockEncoder();
+
+        void beginBlock(const QueryResult &result) override;
+
+        void addRow(const QueryResult &result) override;
+
+        [[nodiscard]] size_t blockSize() const override;
+
+        byte_buffer finishBlock() override;
+
+    private:
+        // Round a size up to the block alignment
+        static size_t align(size_t size);
+
+        // The columns of the block being built
+        std::vector<ColumnBuffer> columnBuffers;
+        // The number of rows in the block being built
+        size_t rows = 0;
+    };
+
+    // ColumnarBlockReader
+    // Reads a columnar block in place. Nothing is copied: fixed width columns are returned as pointers into the
+    // block and strings as views of it, so the block must outlive the reader and everything read from it. A block
+    // written by a machine of the other byte order is swapped in place when the reader is constructed. Throws an
+    // SQLException if the block is malformed.
+    class ColumnarBlockReader {
+    public:
+        // Constructor taking a received block. The block must start on a COLUMNAR_BLOCK_ALIGNMENT byte boundary,
+        // as any freshly allocated buffer does
+        ColumnarBlockReader(byte *data, size_t size);
+
+        // Constructor taking a received block
+        explicit ColumnarBlockReader(byte_buffer &block);
+
+        // Get the number of rows in the block
+        [[nodiscard]] size_t rowCount() const;
+
+        // Get the number of columns in the block
+        [[nodiscard]] size_t columnCount() const;
+
+        // Get the name of a column
+        [[nodiscard]] std::string_view columnName(size_t column) const;
+
+        // Get the type a column is stored as
+        [[nodiscard]] ColumnType columnType(size_t column) const;
+
+        // Get the SQL type of a column
+        [[nodiscard]] SQLSMALLINT sqlType(size_t column) const;
+
+        // Returns true if the value at the given row of a column is null
+        [[nodiscard]] bool isNull(size_t column, size_t row) const;
+
+        // Get the values of a fixed width column as an array of row count values. T must match the column type
+        template<typename T>
+        const T *values(size_t column) const;
+
+        // Get the value at the given row of a string column
+        [[nodiscard]] std::string_view string(size_t column, size_t row) const;
+
+        // Get the value at the given row of a column
+        template<typename T>
+        Value<T> get(size_t column, size_t row) const;
+
+    private:
+        // ColumnView
+        // Where each part of a column lies in the block
+        struct ColumnView {
+            ColumnType type;
+            SQLSMALLINT sqlType;
+            std::string_view name;
+            bool nullable;
+            // Null when the column is not nullable
+            const byte *nulls;
+            const byte *data;
+            // Null unless the column is a string column
+            const uint32_t *offsets;
+        };
+
+        // Get a column, checking it exists and has the given type
+        const ColumnView &checkedColumn(size_t column, ColumnType type) const;
+
+        // The columns in the block
+        std::vector<ColumnView> columns;
+        // The number of rows in the block
+        size_t rows = 0;
+    };
+
+    template<typename T>
+    const T *ColumnarBlockReader::values(size_t column) const {
+        return reinterpret_cast<const T *>(checkedColumn(column, columnTypeOf<T>()).data);
+    }
+
+    template<typename T>
+    Value<T> ColumnarBlockReader::get(size_t column, size_t row) const {
+        const T *columnValues = values<T>(column);
+        if (isNull(column, row)) {
+            return null_value;
+        }
+        return columnValues[row];
+    }
+
+    // Strings and dates are read into their own types rather than straight from the column
+
+    template<>
+    Value<std::string_view> ColumnarBlockReader::get<std::string_view>(size_t column, size_t row) const;
+
+    template<>
+    Value<std::string> ColumnarBlockReader::get<std::string>(size_t column, size_t row) const;
+
+    template<>
+    Value<Date> ColumnarBlockReader::get<Date>(size_t column, size_t row) const;
+
+}
+
+#endif //CONTRACTS_INTERNAL_COLUMNARBLOCK_H
@@ -0,0 +1,225 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#ifndef CONTRACTS_INTERNAL_MATERIALIZEDRESULT_H
+#define CONTRACTS_INTERNAL_MATERIALIZEDRESULT_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <iterator>
+
+#include "QueryResult.h"
+#include "ColumnarBlock.h"
+#include "SQLDialect.h"
+
+namespace sql {
+
+    class MaterializedResult;
+
+    // MaterializedRow
+    // A row of a materialized result. Rows are light handles onto the result, which must outlive them
+    class MaterializedRow {
+        // Friend the result and its iterator so they can call the private constructor
+        friend class MaterializedResult;
+
+        friend class MaterializedRowIterator;
+
+    public:
+        // Get the value in the given column
+        template<typename T>
+        Value<T> get(size_t column) const;
+
+        // Returns true if the value in the given column is null
+        [[nodiscard]] bool isNull(size_t column) const;
+
+        // Get the index of the row in the result
+        [[nodiscard]] size_t index() const;
+
+    private:
+        // Private constructor taking the result and the index of the row in it
+        MaterializedRow(const MaterializedResult &result, size_t rowIndex);
+
+        // The result the row belongs to
+        const MaterializedResult *result;
+        // The index of the row in the result
+        size_t rowIndex;
+    };
+
+    // MaterializedRowIterator
+    // Random access iterator over the rows of a materialized result
+    class MaterializedRowIterator {
+        // Friend the result so it can call the private constructor
+        friend class MaterializedResult;
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = MaterializedRow;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = MaterializedRow;
+
+        MaterializedRow operator*() const;
+
+        MaterializedRow operator[](difference_type n) const;
+
+        MaterializedRowIterator &operator++();
+
+        MaterializedRowIterator operator++(int);
+
+        MaterializedRowIterator &operator--();
+
+        MaterializedRowIterator operator--(int);
+
+        MaterializedRowIterator &operator+=(difference_type n);
+
+        MaterializedRowIterator &operator-=(difference_type n);
+
+        MaterializedRowIterator operator+(difference_type n) const;
+
+        MaterializedRowIterator operator-(difference_type n) const;
+
+        difference_type operator-(const MaterializedRowIterator &other) const;
+
+        bool operator==(const MaterializedRowIterator &other) const;
+
+        bool operator!=(const MaterializedRowIterator &other) const;
+
+        bool operator<(const MaterializedRowIterator &other) const;
+
+    private:
+        // Private constructor taking the result and the index of the row the iterator is at
+        MaterializedRowIterator(const MaterializedResult &result, size_t rowIndex);
+
+        // The result being iterated over
+        const MaterializedResult *result;
+        // The index of the row the iterator is at
+        size_t rowIndex;
+    };
+
+    // MaterializedResult
+    // A query result read to the end into memory, so its rows can be visited in any order and any number of times.
+    // The values are held column by column, each column in a single array of its type with a null bitmap beside
+    // it (strings as one run of bytes with the end offset of each), which is the layout ColumnBuffer reads them
+    // into. Sorting and filtering rearrange the columns in place, so the arrays stay contiguous. The statement is
+    // released as soon as the result has been read, rather than living as long as the rows are used.
+    class MaterializedResult {
+        // Friend the row class so it can read values
+        friend class MaterializedRow;
+
+    public:
+        // Read a query result to the end, taking it over so its statement is released once every row is read
+        explicit MaterializedResult(QueryResult &&result);
+
+        // Get the number of rows
+        [[nodiscard]] size_t rowCount() const;
+
+        // Get the number of columns
+        [[nodiscard]] size_t columnCount() const;
+
+        // Describe a column
+        [[nodiscard]] const ColumnDescription &describeColumn(size_t column) const;
+
+        // Get the type a column is stored as
+        [[nodiscard]] ColumnType columnType(size_t column) const;
+
+        // Get the index of the column with the given name. Throws an SQLException if there isn't one
+        [[nodiscard]] size_t columnIndex(std::string_view name) const;
+
+        // Get a row
+        MaterializedRow operator[](size_t row) const;
+
+        // Get the value at the given row of a column
+        template<typename T>
+        Value<T> get(size_t row, size_t column) const;
+
+        // Returns true if the value at the given row of a column is null
+        [[nodiscard]] bool isNull(size_t row, size_t column) const;
+
+        // Get the values of a fixed width column as an array of row count values. T must match the column type.
+        // Null values are stored as zero
+        template<typename T>
+        const T *values(size_t column) const;
+
+        // Get the null bitmap of a column, one bit per row, set for nulls. Returns null if the column isn't
+        // nullable
+        [[nodiscard]] const byte *nulls(size_t column) const;
+
+        // Sort the rows by a column. The sort is stable, so sorting by several columns in turn, from the least
+        // significant to the most, sorts by all of them. Nulls sort before every other value
+        void sort(size_t column, OrderDirection direction = OrderDirection::ASC);
+
+        // Keep only the rows for which the predicate, called with each row, returns true
+        template<typename Predicate>
+        void filter(Predicate keep);
+
+        // Keep only the given rows, in the given order. A row may be given more than once
+        void selectRows(const std::vector<uint32_t> &selected);
+
+        // Begin iterator for range based for loops
+        [[nodiscard]] MaterializedRowIterator begin() const;
+
+        // End iterator for range based for loops
+        [[nodiscard]] MaterializedRowIterator end() const;
+
+    private:
+        // Get a column, checking it exists and has the given type
+        const ColumnBuffer &checkedColumn(size_t column, ColumnType type) const;
+
+        // The columns
+        std::vector<ColumnBuffer> columns;
+        // The number of rows
+        size_t rows = 0;
+    };
+
+    template<typename T>
+    Value<T> MaterializedRow::get(size_t column) const {
+        return result->get<T>(rowIndex, column);
+    }
+
+    template<typename T>
+    Value<T> MaterializedResult::get(size_t row, size_t column) const {
+        const T *columnValues = values<T>(column);
+        if (isNull(row, column)) {
+            return null_value;
+        }
+        return columnValues[row];
+    }
+
+    template<typename T>
+    const T *MaterializedResult::values(size_t column) const {
+        return reinterpret_cast<const T *>(checkedColumn(column, columnTypeOf<T>()).data.data());
+    }
+
+    template<typename Predicate>
+    void MaterializedResult::filter(Predicate keep) {
+        std::vector<uint32_t> kept;
+        kept.reserve(rows);
+        for (size_t row = 0; row < rows; row++) {
+            if (keep((*this)[row])) {
+                kept.push_back(row);
+            }
+        }
+        selectRows(kept);
+    }
+
+    // Strings, dates and prices are read into their own types rather than straight from the column
+
+    template<>
+    Value<std::string_view> MaterializedResult::get<std::string_view>(size_t row, size_t column) const;
+
+    template<>
+    Value<std::string> MaterializedResult::get<std::string>(size_t row, size_t column) const;
+
+    template<>
+    Value<Date> MaterializedResult::get<Date>(size_t row, size_t column) const;
+
+    // Prices may be read from either width of floating point column
+    template<>
+    Value<Price> MaterializedResult::get<Price>(size_t row, size_t column) const;
+
+}
+
+#endif //CONTRACTS_INTERNAL_MATERIALIZEDRESULT_H
@@ -0,0 +1,143 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#ifndef CONTRACTS_INTERNAL_QUERYCACHE_H
+#define CONTRACTS_INTERNAL_QUERYCACHE_H
+
+#include <list>
+#include <mutex>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "QueryResult.h"
+#include "ColumnarBlock.h"
+
+// Default most bytes of results a query cache holds before evicting the least recently used
+#define QUERY_CACHE_DEFAULT_BUDGET (64u * 1024u * 1024u)
+
+namespace sql {
+
+    // CachedResult
+    // A query result read into memory as columnar blocks, which can be read any number of times from any thread
+    class CachedResult {
+    public:
+        // Read a query result to the end into memory
+        explicit CachedResult(QueryResult &result);
+
+        // Get the number of rows in the result
+        [[nodiscard]] size_t rowCount() const;
+
+        // Get the number of blocks the rows are split into
+        [[nodiscard]] size_t blockCount() const;
+
+        // Get a reader for one of the blocks
+        [[nodiscard]] ColumnarBlockReader block(size_t index) const;
+
+        // Get the number of bytes the blocks take up
+        [[nodiscard]] size_t byteSize() const;
+
+    private:
+        // The encoded blocks
+        std::vector<byte_buffer> blocks;
+        // The total number of rows
+        size_t rows = 0;
+        // The total size of the blocks
+        size_t bytes = 0;
+    };
+
+    // QueryCache
+    // Holds the results of recent queries so repeated reads can be answered from memory. Results are keyed by
+    // their SQL text and parameters, and each is kept until the first of: its time to live passing, it being
+    // evicted as the least recently used when the cache is over its memory budget, or a write to one of the tables
+    // it reads from. A cache can be shared by several sessions, so that a write through any of them invalidates
+    // the results all of them read. Writes made outside those sessions are only seen once a result expires, so
+    // the time to live is the most a result can lag behind the database. All methods are thread safe.
+    class QueryCache {
+    public:
+        // Alias for the clock expiry times are measured by
+        using Clock = std::chrono::steady_clock;
+
+        // Constructor taking the most bytes of results to hold
+        explicit QueryCache(size_t memoryBudget = QUERY_CACHE_DEFAULT_BUDGET);
+
+        // Look up the result of a query. Returns null if it isn't held or has expired
+        std::shared_ptr<const CachedResult> find(const std::string &sql, const std::vector<std::string> &parameters);
+
+        // Get a number which changes on every invalidation. Take it before running a query to be stored, and pass
+        // it to store, so that a result which may have been read before a write isn't kept after it
+        [[nodiscard]] uint64_t generation() const;
+
+        // Store the result of a query, which reads from the given tables, for the given time. Results larger than
+        // the whole budget, and results read before an invalidation since the given generation, aren't stored
+        void store(const std::string &sql, const std::vector<std::string> &parameters,
+                   const std::vector<std::string> &tables, std::shared_ptr<const CachedResult> result,
+                   Clock::duration timeToLive, uint64_t readGeneration);
+
+        // Drop every result which reads from the given table
+        void invalidate(std::string_view table);
+
+        // Drop every result
+        void clear();
+
+        // Get the number of results held
+        [[nodiscard]] size_t size() const;
+
+        // Get the number of bytes of results held
+        [[nodiscard]] size_t memoryUsed() const;
+
+        // Get the tables an SQL statement writes to. Returns an empty list for a SELECT which doesn't create a
+        // table with INTO, and std::nullopt if the statement isn't understood, in which case it should be taken to
+        // write to anything. An UPDATE or DELETE with a FROM clause is taken to write to anything
+        static std::optional<std::vector<std::string>> writtenTables(std::string_view statement);
+
+    private:
+        // Entry
+        // A result held in the cache
+        struct Entry {
+            // The result
+            std::shared_ptr<const CachedResult> result;
+            // The tables it reads from
+            std::vector<std::string> tables;
+            // When it expires
+            Clock::time_point expiry;
+            // The bytes it is counted as taking up
+            size_t bytes;
+            // Its place in the recently used list
+            std::list<std::string>::iterator recent;
+        };
+
+        // Make the key for a query and its parameters
+        static std::string makeKey(const std::string &sql, const std::vector<std::string> &parameters);
+
+        // Bring a table name to the form it is indexed by, without quotes, schema or case
+        static std::string normaliseTable(std::string_view table);
+
+        // Drop an entry. Requires the cache lock
+        void erase(std::unordered_map<std::string, Entry>::iterator entry);
+
+        // Lock guarding the cache
+        mutable std::mutex cacheLock;
+        // The entries by key
+        std::unordered_map<std::string, Entry> entries;
+        // The keys of the entries reading from each table
+        std::unordered_map<std::string, std::unordered_set<std::string>> tableEntries;
+        // The keys of the entries, most recently used first
+        std::list<std::string> recentlyUsed;
+        // The most bytes of results to hold
+        size_t memoryBudget;
+        // The bytes of results held
+        size_t memoryInUse = 0;
+        // Changed on every invalidation
+        uint64_t invalidations = 0;
+    };
+
+}
+
+#endif //CONTRACTS_INTERNAL_QUERYCACHE_H
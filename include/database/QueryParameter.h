@@ -0,0 +1,70 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#ifndef CONTRACTS_INTERNAL_QUERYPARAMETER_H
+#define CONTRACTS_INTERNAL_QUERYPARAMETER_H
+
+#include <string>
+#include <cstring>
+#include <type_traits>
+
+#include "SQLSafeHandle.h"
+#include "ColumnType.h"
+
+namespace sql {
+
+    // QueryParameter
+    // A value bound to a ? placeholder in a statement rather than written into its text, so it never needs quoting
+    // and the text stays the same whatever the value. The value keeps its type, so the database compares it with a
+    // column as it would a value of that type. Supported types are bool, signed char, short, int, long long,
+    // float, double, ColumnarDate and strings
+    class QueryParameter {
+    public:
+        // Constructor taking a fixed width value
+        template<typename T>
+        QueryParameter(const T &value);
+
+        // Constructor taking a string value
+        QueryParameter(std::string value);
+
+        // Constructor taking a string value
+        QueryParameter(const char *value);
+
+        // Get the type of the value
+        [[nodiscard]] ColumnType type() const;
+
+        // Get a string identifying the value and its type, e.g. to key cached results by
+        [[nodiscard]] std::string key() const;
+
+        // Bind the value to the statement's parameter with the given number, counting from 1. The parameter must
+        // not be moved or destroyed until the statement has executed
+        void bind(const SQLStatementHandle &statement, SQLUSMALLINT number) const;
+
+    private:
+        // The type of the value
+        ColumnType valueType;
+        // A fixed width value, as it is bound. Dates are held as the driver's date structure
+        alignas(long long) byte data[sizeof(long long)]{};
+        // A string value
+        std::string string;
+        // The length indicator given to the driver with the value
+        mutable SQLLEN indicator = 0;
+    };
+
+    template<typename T>
+    QueryParameter::QueryParameter(const T &value)
+            : valueType(columnTypeOf<T>()) {
+        if constexpr (std::is_same_v<T, ColumnarDate>) {
+            SQL_DATE_STRUCT date{value.year, value.month, value.day};
+            static_assert(sizeof(date) <= sizeof(data));
+            memcpy(data, &date, sizeof(date));
+        } else {
+            static_assert(sizeof(T) <= sizeof(data));
+            memcpy(data, &value, sizeof(T));
+        }
+    }
+
+}
+
+#endif //CONTRACTS_INTERNAL_QUERYPARAMETER_H
@@ -11,9 +11,12 @@
 //#include <sqltypes.h>
 
 #include <string>
+#include <vector>
 #include <memory>
 
 #include "SQLSafeHandle.h"
+#include "StatementPool.h"
+#include "StatementMetrics.h"
 #include "Value.h"
 #include "Date.h"
 #include "Price.h"
@@ -58,11 +61,18 @@ namespace sql {
 
     private:
         // Private hidden constructor callable from the QueryResult object when setting up the iterator range
-        QueryResultRowIterator(size_t iterPosition, QueryResult &resultObject);
+        QueryResultRowIterator(size_t iterPosition, QueryResult &resultObject, bool endIterator = false);
+
+        // Returns true if the iterator is past the last row
+        bool atEnd() const;
 
         // The current position of this iterator. Goes from 0 (first element) to the number of returned records
         size_t iterPosition;
 
+        // Whether this is the end iterator, which is reached once a fetch finds no more rows rather than at a
+        // known position, as drivers needn't report the row count of a query
+        bool endIterator;
+
         // The calling result object to return the row from
         QueryResult &resultObject;
     };
@@ -83,9 +93,7 @@ namespace sql {
         // Wrapper for the query result's internal get method to get the value for the current row at the
         // index of this column
         template<typename T>
-        inline Value<T> getItem() const {
-            return resultObject.get<T>(columnIndex);
-        }
+        inline Value<T> getItem() const;
 
     private:
         // Private constructor callable by the ColumnSet class
@@ -149,14 +157,10 @@ namespace sql {
 
         // Template cast method. Calls the private get method in the QueryResult object assigned
         template<typename T>
-        inline operator Value<T>() const {
-            return resultObject.get<T>(index);
-        }
+        inline operator Value<T>() const;
 
         template<typename T>
-        inline Value<T> get() const {
-            return resultObject.get<T>(index);
-        }
+        inline Value<T> get() const;
 
     private:
         // Constructor taking a QueryResult object and the index of the column of interest
@@ -192,6 +196,21 @@ namespace sql {
         const QueryResult &resultObject;
     };
 
+    // ColumnDescription
+    // Describes a single column of a query result, as reported by the driver
+    struct ColumnDescription {
+        // The name of the column
+        std::string name;
+        // The SQL data type of the column
+        SQLSMALLINT sqlType;
+        // The size of the column, e.g. the maximum length of a character column
+        SQLULEN size;
+        // The number of decimal digits in the column
+        SQLSMALLINT decimalDigits;
+        // Whether the column may hold nulls
+        bool nullable;
+    };
+
     // QueryResult class
     // Represents the results from a query made in the SQL.
     class QueryResult {
@@ -204,27 +223,53 @@ namespace sql {
         // Friend the column set item proxy so it can call the private get method
         friend struct ColumnSetItemProxy;
 
+        // Friend the column buffer so it can read each value straight into its storage
+        friend struct ColumnBuffer;
+
+        // Friend the iterator so it can tell when the rows have run out
+        friend struct QueryResultRowIterator;
+
+        // Friend the block cursor so it can fetch into bound arrays
+        friend class BlockCursor;
+
     public:
         /*// Copy constructor
-        QueryResult(const QueryResult &queryResult);
+        QueryResult(const QueryResult &queryResult);*/
+
+        // Destructor. Gives the statement handle back to the session's pool, which closes the cursor
+        ~QueryResult();
 
-        ~QueryResult();*/
+        QueryResult(const QueryResult &other) = delete;
+
+        // Move constructor. The row and column set are rebound to the new object, so results can be handed
+        // between threads, e.g. through a future
+        QueryResult(QueryResult &&other) noexcept;
+
+        QueryResult &operator=(const QueryResult &other) = delete;
 
         // Fetches the next row from the dataset. The getter methods for row items will retrieve
-        // items from the next row once called
-        void fetchNextRow();
+        // items from the next row once called. Returns false once there are no more rows, and throws if the fetch fails
+        bool fetchNextRow();
 
         // Gets the first N items from the current row, where N is the number of values specified. Each is written to
-        // the corresponding reference variable passed in.
+        // the corresponding reference variable passed in. Reading every row into structs is much faster with a
+        // RowMapping, which fetches blocks of rows into bound arrays
         template<typename ...Values>
         void getRow(Values &...values) const;
 
-        // Gets the number of rows returned by the query
+        // Gets the number of rows returned by the query, as reported by the driver. Many drivers only report this
+        // for statements which modify rows, so it shouldn't be relied upon for a query
         size_t rowCount() const;
 
         // Gets the current row index
         size_t currentRow() const;
 
+        // Gets the number of columns in the result
+        size_t columnCount() const;
+
+        // Describes each column in the result
+        std::vector<ColumnDescription> describeColumns() const;
+
         // Begin iterator for range based for loops
         QueryResultRowIterator begin();
 
@@ -239,15 +284,47 @@ namespace sql {
 
     protected:
         // Protected constructor. This is hidden so only the session can create a QueryResult
-        explicit QueryResult(SQLSafeHandle<STATEMENT_HANDLE> &&sqlStatementHandle);
+        explicit QueryResult(SQLSafeHandle<STATEMENT_HANDLE> &&sqlStatementHandle,
+                             std::shared_ptr<StatementPool> statementPool = nullptr);
 
     private:
         // A handle for the statement which contains the internal row results
         SQLSafeHandle<STATEMENT_HANDLE> sqlStatementHandle;
 
+        // The pool the statement handle is given back to, or null if it is freed instead
+        std::shared_ptr<StatementPool> statementPool;
+
         // Current row index in the query - incremented each time fetchNextRow is called
         size_t currentRowIndex = 0;
 
+        // Whether a fetch has found there are no more rows
+        bool exhausted = false;
+
+        // The measurements of the statement, or null if it isn't measured
+        std::shared_ptr<StatementStats> stats;
+        // When the statement started running, if it is measured
+        metrics::LatencyHistogram::Clock::time_point executeStart;
+        // The number of rows fetched, if the statement is measured
+        uint64_t rowsRead = 0;
+        // Whether the time to fetch every row has been recorded
+        bool drainRecorded = false;
+
+        // Start measuring the result of a statement, recording its run, which began at the given time. The
+        // statement allocated the given number of handles, and returned the given code
+        void instrument(std::shared_ptr<StatementStats> statementStats,
+                        metrics::LatencyHistogram::Clock::time_point start, size_t handleAllocations,
+                        SQLRETURN executeResult);
+
+        // Record a fetch of the given number of rows, where zero means the rows have run out
+        void recordFetch(size_t rows);
+
+        // Record bytes of values read
+        void recordBytes(uint64_t bytes) const;
+
+        // Read a value from the current row, counting the bytes read if the statement is measured
+        SQLRETURN getData(size_t index, SQLSMALLINT cType, SQLPOINTER buffer, SQLLEN bufferLength,
+                          SQLLEN *length) const;
+
         // Recursive case for the implementation of the getRow method
         template<typename T, typename ...Values>
         void impl_getRow(size_t index, T &t, Values &...values) const;
@@ -261,6 +338,21 @@ namespace sql {
         Value<T> get(size_t index) const;
     };
 
+    template<typename T>
+    Value<T> ColumnSetItemProxy::getItem() const {
+        return resultObject.get<T>(columnIndex);
+    }
+
+    template<typename T>
+    RowItemProxy::operator Value<T>() const {
+        return resultObject.get<T>(index);
+    }
+
+    template<typename T>
+    Value<T> RowItemProxy::get() const {
+        return resultObject.get<T>(index);
+    }
+
     template<typename... Values>
     void QueryResult::getRow(Values &... values) const {
         // Wraps the implementation method with the starting index of 0 and the expanded variadic
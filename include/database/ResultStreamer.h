@@ -0,0 +1,165 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#ifndef CONTRACTS_INTERNAL_RESULTSTREAMER_H
+#define CONTRACTS_INTERNAL_RESULTSTREAMER_H
+
+#include <deque>
+#include <memory>
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <exception>
+#include <condition_variable>
+
+#include "QueryResult.h"
+#include "../networking/buffer.h"
+#include "../networking/TCPSocket.h"
+#include "../networking/StreamMultiplexer.h"
+
+// Most rows put into a single streamed block
+#define RESULT_STREAM_BLOCK_ROWS 1024
+// Size at which a streamed block is finished early, even if it has fewer rows
+#define RESULT_STREAM_BLOCK_BYTES (64u * 1024u)
+// Most encoded blocks held waiting to be sent before fetching stops to let the client catch up
+#define RESULT_STREAM_QUEUE_DEPTH 4
+
+namespace sql {
+
+    // BlockEncoder
+    // Serialises the rows of a query result into blocks for sending. The streamer calls beginBlock, then addRow
+    // with the result on each row of the block, then finishBlock to collect the encoded bytes. Every call for a
+    // stream is made on the same thread, so an encoder needs no locking of its own
+    class BlockEncoder {
+    public:
+        virtual ~BlockEncoder() = default;
+
+        // Start a new, empty block. The result is given for encoders which lay the block out by its columns
+        virtual void beginBlock(const QueryResult &result) = 0;
+
+        // Add the result's current row to the block
+        virtual void addRow(const QueryResult &result) = 0;
+
+        // Get the number of bytes the block has grown to so far
+        [[nodiscard]] virtual size_t blockSize() const = 0;
+
+        // Finish the block and return its encoded bytes
+        virtual byte_buffer finishBlock() = 0;
+    };
+
+    // RowBlockEncoder
+    // Block encoder for callers which already pack each row by hand. The row function appends the current row to
+    // the block, and the finished block is simply every row's bytes back to back
+    class RowBlockEncoder : public BlockEncoder {
+    public:
+        // Alias for the function which appends the result's current row to a block
+        using RowFunction = std::function<void(const Row &row, std::vector<byte> &block)>;
+
+        // Constructor taking the row function
+        explicit RowBlockEncoder(RowFunction rowFunction);
+
+        void beginBlock(const QueryResult &result) override;
+
+        void addRow(const QueryResult &result) override;
+
+        [[nodiscard]] size_t blockSize() const override;
+
+        byte_buffer finishBlock() override;
+
+    private:
+        // The row function
+        RowFunction rowFunction;
+        // The block being built
+        std::vector<byte> block;
+    };
+
+    // ResultStreamer
+    // Sends a query result to a client as a series of encoded blocks while the query is still being read, rather
+    // than reading the whole result before sending any of it. A fetch thread reads rows from the result and encodes
+    // them into blocks, while the calling thread encrypts and sends each finished block, so block N+1 is fetched
+    // while block N is on its way to the client. At most RESULT_STREAM_QUEUE_DEPTH finished blocks are held
+    // between the two: once the client falls that far behind, fetching waits for it, so a large export never
+    // needs more than a few blocks of memory. The end of the result is marked by an empty block.
+    class ResultStreamer {
+    public:
+        // Alias for the function which sends a finished block. Returns false if the block could not be sent, which
+        // stops the stream
+        using BlockSink = std::function<bool(byte_buffer &&block)>;
+
+        // Constructor taking the result to stream, positioned before its first row, and the limits on the size of
+        // each block and on the number of blocks held waiting to be sent. Blocks are encoded in the columnar block
+        // format
+        explicit ResultStreamer(QueryResult &result,
+                                size_t blockRows = RESULT_STREAM_BLOCK_ROWS,
+                                size_t blockBytes = RESULT_STREAM_BLOCK_BYTES,
+                                size_t queueDepth = RESULT_STREAM_QUEUE_DEPTH);
+
+        // Constructor taking the result to stream, positioned before its first row, the encoder for its blocks,
+        // and the limits on the size of each block and on the number of blocks held waiting to be sent
+        ResultStreamer(QueryResult &result, BlockEncoder &encoder,
+                       size_t blockRows = RESULT_STREAM_BLOCK_ROWS,
+                       size_t blockBytes = RESULT_STREAM_BLOCK_BYTES,
+                       size_t queueDepth = RESULT_STREAM_QUEUE_DEPTH);
+
+        ResultStreamer(const ResultStreamer &other) = delete;
+
+        ResultStreamer &operator=(const ResultStreamer &other) = delete;
+
+        // Stream the whole result to the sink, blocking until every block has been sent. Returns true if the
+        // whole result was sent, or false if the sink refused a block. Errors reading the result or thrown by
+        // the sink are rethrown here once fetching has stopped
+        bool stream(const BlockSink &sink);
+
+        // Get the number of rows which have been fetched from the result
+        [[nodiscard]] size_t rowsFetched() const;
+
+        // Make a sink which sends each block as a message on a multiplexed stream. The stream's own credit
+        // window then holds back fetching when the client stops reading
+        static BlockSink streamSink(networking::Stream &stream);
+
+        // Make a sink which sends each block as an AES encrypted message on a connected socket. The sink refuses
+        // the block if the send fails, which ends the stream
+        static BlockSink socketSink(const networking::TCPSocket &socket, AESKey key);
+
+    private:
+        // Fetch thread loop, reading and encoding blocks until the result is exhausted or the stream stops
+        void fetchLoop();
+
+        // Hand a finished block to the sending thread, waiting for room. Returns false if the stream has stopped
+        bool pushBlock(byte_buffer &&block);
+
+        // The result being streamed
+        QueryResult &result;
+        // The default encoder, when the caller didn't supply one
+        std::unique_ptr<BlockEncoder> ownedEncoder;
+        // The encoder for the blocks
+        BlockEncoder &encoder;
+        // Limits
+        size_t blockRows;
+        size_t blockBytes;
+        size_t queueDepth;
+
+        // Lock guarding the following state
+        mutable std::mutex queueLock;
+        // Notified when a block is queued or fetching finishes
+        std::condition_variable blockReady;
+        // Notified when a block is taken or the stream stops
+        std::condition_variable spaceReady;
+        // Finished blocks waiting to be sent
+        std::deque<byte_buffer> blocks;
+        // Whether the fetch thread has queued its last block
+        bool fetchFinished = false;
+        // Whether the sending side has stopped, so fetching should stop too
+        bool stopped = false;
+        // Any error raised while fetching, to be rethrown on the sending thread
+        std::exception_ptr fetchError;
+        // Number of rows fetched so far
+        size_t fetchedRows = 0;
+    };
+
+}
+
+#endif //CONTRACTS_INTERNAL_RESULTSTREAMER_H
@@ -0,0 +1,331 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#ifndef CONTRACTS_INTERNAL_ROWMAPPING_H
+#define CONTRACTS_INTERNAL_ROWMAPPING_H
+
+#include <string>
+#include <algorithm>
+#include <vector>
+#include <tuple>
+#include <utility>
+#include <type_traits>
+
+#include "QueryResult.h"
+#include "ColumnType.h"
+
+// Most bytes of bound column buffers used for each block of a mapped fetch
+#define ROW_MAPPING_BYTE_BUDGET (1024u * 1024u)
+// Most rows fetched in each block of a mapped fetch
+#define ROW_MAPPING_MAX_BLOCK_ROWS 1024u
+
+namespace sql {
+
+    // BlockCursor
+    // Fetches the rows of a result a block at a time into arrays bound to its columns, rather than one value at a
+    // time. The columns are unbound and the statement put back to fetching single rows when the cursor is
+    // destroyed, so the result can still be read as normal afterwards
+    class BlockCursor {
+    public:
+        // Constructor taking the result to fetch from and the number of rows to fetch at a time
+        BlockCursor(QueryResult &result, size_t blockRows);
+
+        BlockCursor(const BlockCursor &other) = delete;
+
+        BlockCursor &operator=(const BlockCursor &other) = delete;
+
+        ~BlockCursor();
+
+        // Bind an array of block row count values to a column
+        void bind(size_t column, SQLSMALLINT cType, SQLPOINTER data, SQLLEN width, SQLLEN *indicators);
+
+        // Fetch the next block of rows into the bound arrays. Returns the number of rows fetched, which is zero
+        // once the rows have run out, and throws if any row fails
+        size_t fetch();
+
+    private:
+        // Unbind the columns and go back to fetching single rows
+        void reset();
+
+        // The result being fetched from
+        QueryResult &result;
+        // The number of rows fetched by the last block
+        SQLULEN rowsFetched = 0;
+        // The status of each row of the last block
+        std::vector<SQLUSMALLINT> rowStatus;
+        // The length indicators of each bound column, for counting the bytes fetched
+        std::vector<SQLLEN *> boundIndicators;
+    };
+
+    // FieldBuffer
+    // The array a field of type T is fetched into, one value per row of a block. Specialised for each supported
+    // field type
+    template<typename T>
+    struct FieldBuffer;
+
+    // Fixed width fields are fetched straight into an array of their own type
+    template<typename T, SQLSMALLINT CType>
+    struct FixedFieldBuffer {
+        // Whether nulls are kept rather than rejected
+        static constexpr bool nullable = false;
+
+        // Get the bytes needed per row
+        static size_t rowWidth(const ColumnDescription &description) {
+            return sizeof(T) + sizeof(SQLLEN);
+        }
+
+        // Allocate the arrays and bind them to a column
+        void bind(BlockCursor &cursor, size_t column, const ColumnDescription &description, size_t rows) {
+            values.resize(rows);
+            indicators.resize(rows);
+            cursor.bind(column, CType, values.data(), (SQLLEN) sizeof(T), indicators.data());
+        }
+
+        // Returns true if the value at a row is null
+        [[nodiscard]] bool isNull(size_t row) const {
+            return indicators[row] == SQL_NULL_DATA;
+        }
+
+        // Get the value at a row
+        [[nodiscard]] T take(size_t row) const {
+            return values[row];
+        }
+
+        // The values
+        std::vector<T> values;
+        // The null indicator of each value
+        std::vector<SQLLEN> indicators;
+    };
+
+    template<>
+    struct FieldBuffer<bool> : FixedFieldBuffer<unsigned char, SQL_C_BIT> {
+        [[nodiscard]] bool take(size_t row) const {
+            return values[row] != 0;
+        }
+    };
+
+    template<>
+    struct FieldBuffer<signed char> : FixedFieldBuffer<signed char, SQL_C_STINYINT> {
+    };
+
+    template<>
+    struct FieldBuffer<unsigned char> : FixedFieldBuffer<unsigned char, SQL_C_UTINYINT> {
+    };
+
+    template<>
+    struct FieldBuffer<short> : FixedFieldBuffer<short, SQL_C_SSHORT> {
+    };
+
+    template<>
+    struct FieldBuffer<unsigned short> : FixedFieldBuffer<unsigned short, SQL_C_USHORT> {
+    };
+
+    template<>
+    struct FieldBuffer<int> : FixedFieldBuffer<SQLINTEGER, SQL_C_SLONG> {
+    };
+
+    template<>
+    struct FieldBuffer<unsigned int> : FixedFieldBuffer<SQLUINTEGER, SQL_C_ULONG> {
+    };
+
+    template<>
+    struct FieldBuffer<long long> : FixedFieldBuffer<SQLBIGINT, SQL_C_SBIGINT> {
+    };
+
+    template<>
+    struct FieldBuffer<unsigned long long> : FixedFieldBuffer<SQLUBIGINT, SQL_C_UBIGINT> {
+    };
+
+    template<>
+    struct FieldBuffer<float> : FixedFieldBuffer<SQLREAL, SQL_C_FLOAT> {
+    };
+
+    template<>
+    struct FieldBuffer<double> : FixedFieldBuffer<SQLDOUBLE, SQL_C_DOUBLE> {
+    };
+
+    template<>
+    struct FieldBuffer<Date> : FixedFieldBuffer<SQL_DATE_STRUCT, SQL_C_TYPE_DATE> {
+        [[nodiscard]] Date take(size_t row) const {
+            return Date(values[row].year, values[row].month, values[row].day);
+        }
+    };
+
+    template<>
+    struct FieldBuffer<ColumnarDate> : FixedFieldBuffer<SQL_DATE_STRUCT, SQL_C_TYPE_DATE> {
+        [[nodiscard]] ColumnarDate take(size_t row) const {
+            return ColumnarDate{(int16_t) values[row].year, (uint8_t) values[row].month, (uint8_t) values[row].day};
+        }
+    };
+
+    // Prices are fetched as doubles, which is the type decimal columns are read as elsewhere
+    template<>
+    struct FieldBuffer<Price> : FixedFieldBuffer<SQLDOUBLE, SQL_C_DOUBLE> {
+        [[nodiscard]] Price take(size_t row) const {
+            return Price((float) values[row]);
+        }
+    };
+
+    // Strings are fetched into a fixed width array wide enough for the longest value the column can hold
+    template<>
+    struct FieldBuffer<std::string> {
+        static constexpr bool nullable = false;
+
+        // Get the width of each string in the array, including the null terminator. Character columns may take
+        // up to four bytes per character once converted, and other columns are read as text of no set length
+        static size_t stringWidth(const ColumnDescription &description) {
+            size_t width = description.size == 0 ? MAX_QUERY_STRING_LENGTH : description.size * 4;
+            return std::min<size_t>(std::max<size_t>(width, 64), MAX_QUERY_STRING_LENGTH) + 1;
+        }
+
+        static size_t rowWidth(const ColumnDescription &description) {
+            return stringWidth(description) + sizeof(SQLLEN);
+        }
+
+        void bind(BlockCursor &cursor, size_t column, const ColumnDescription &description, size_t rows) {
+            width = stringWidth(description);
+            name = description.name;
+            chars.resize(rows * width);
+            indicators.resize(rows);
+            cursor.bind(column, SQL_C_CHAR, chars.data(), (SQLLEN) width, indicators.data());
+        }
+
+        [[nodiscard]] bool isNull(size_t row) const {
+            return indicators[row] == SQL_NULL_DATA;
+        }
+
+        [[nodiscard]] std::string take(size_t row) const {
+            if (indicators[row] == SQL_NO_TOTAL || indicators[row] >= (SQLLEN) width) {
+                throw SQLException("Value of column " + name + " is too long to fetch as a mapped string.");
+            }
+            return std::string(chars.data() + row * width, indicators[row]);
+        }
+
+        // The name of the column, for errors
+        std::string name;
+        // The width of each string
+        size_t width = 0;
+        // The strings back to back, each null terminated
+        std::vector<char> chars;
+        // The length or null indicator of each string
+        std::vector<SQLLEN> indicators;
+    };
+
+    // Nullable fields are fetched as their underlying type, with nulls kept rather than rejected
+    template<typename T>
+    struct FieldBuffer<Value<T>> : FieldBuffer<T> {
+        static constexpr bool nullable = true;
+
+        [[nodiscard]] Value<T> take(size_t row) const {
+            if (FieldBuffer<T>::isNull(row)) {
+                return null_value;
+            }
+            return FieldBuffer<T>::take(row);
+        }
+    };
+
+    // Field
+    // Maps a column of a result, by index, onto a data member of a struct, e.g. Field<0, &Trade::id>. The member
+    // may be any of the fixed width types, Date, Price or std::string, or a Value of one of them to allow nulls
+    template<size_t Column, auto Member>
+    struct Field;
+
+    template<size_t Column, typename S, typename T, T S::*Member>
+    struct Field<Column, Member> {
+        // The struct the field belongs to
+        using Owner = S;
+        // The type of the field
+        using Type = T;
+        // The index of the column the field is read from
+        static constexpr size_t column = Column;
+
+        // Set the field of a row
+        static inline void assign(S &row, T &&value) {
+            row.*Member = std::move(value);
+        }
+    };
+
+    // RowMapping
+    // Reads the rows of a result into a vector of structs, given a Field for each member to fill. The mapping is
+    // fixed at compile time, so each row is built by one unrolled sequence of copies out of arrays bound to the
+    // columns, fetched a block at a time, with no per value driver call or type dispatch. For example:
+    //   using TradeMapping = RowMapping<Trade, Field<0, &Trade::id>, Field<1, &Trade::price>>;
+    //   std::vector<Trade> trades = TradeMapping::fetchAll(result);
+    template<typename S, typename ...Fields>
+    class RowMapping {
+        static_assert(sizeof...(Fields) > 0, "A row mapping needs at least one field.");
+        static_assert((std::is_same_v<typename Fields::Owner, S> && ...),
+                      "Every field of a row mapping must belong to the mapped struct.");
+        static_assert(std::is_default_constructible_v<S>, "Mapped structs must be default constructible.");
+
+    public:
+        // The struct each row is read into
+        using RowType = S;
+
+        // Read the rest of the rows of a result, i.e. those not already fetched. Throws an SQLException if a
+        // field's column doesn't exist, or holds a null for a field which isn't a Value
+        static std::vector<S> fetchAll(QueryResult &result);
+
+    private:
+        // Implementation of fetchAll, with an index for each field
+        template<size_t ...I>
+        static std::vector<S> impl_fetchAll(QueryResult &result, std::index_sequence<I...>);
+
+        // Get a field's value at a row, checking for nulls if the field can't hold them
+        template<typename Field, typename Buffer>
+        static inline typename Field::Type take(const Buffer &buffer, size_t row,
+                                                const ColumnDescription &description);
+    };
+
+    template<typename S, typename... Fields>
+    std::vector<S> RowMapping<S, Fields...>::fetchAll(QueryResult &result) {
+        return impl_fetchAll(result, std::index_sequence_for<Fields...>());
+    }
+
+    template<typename S, typename... Fields>
+    template<size_t... I>
+    std::vector<S> RowMapping<S, Fields...>::impl_fetchAll(QueryResult &result, std::index_sequence<I...>) {
+        std::vector<ColumnDescription> descriptions = result.describeColumns();
+        if (((Fields::column >= descriptions.size()) || ...)) {
+            throw SQLException("Row mapping reads a column past the " + std::to_string(descriptions.size()) +
+                               " in the result.");
+        }
+
+        // Fit as many rows in a block as the byte budget allows
+        size_t rowWidth = (FieldBuffer<typename Fields::Type>::rowWidth(descriptions[Fields::column]) + ...);
+        size_t blockRows = std::clamp<size_t>(ROW_MAPPING_BYTE_BUDGET / rowWidth, 1, ROW_MAPPING_MAX_BLOCK_ROWS);
+
+        BlockCursor cursor(result, blockRows);
+        std::tuple<FieldBuffer<typename Fields::Type>...> buffers;
+        (std::get<I>(buffers).bind(cursor, Fields::column, descriptions[Fields::column], blockRows), ...);
+
+        std::vector<S> rows;
+        size_t fetched;
+        while ((fetched = cursor.fetch()) != 0) {
+            rows.reserve(rows.size() + fetched);
+            for (size_t row = 0; row < fetched; row++) {
+                S &mapped = rows.emplace_back();
+                (Fields::assign(mapped, take<Fields>(std::get<I>(buffers), row, descriptions[Fields::column])), ...);
+            }
+        }
+
+        return rows;
+    }
+
+    template<typename S, typename... Fields>
+    template<typename Field, typename Buffer>
+    typename Field::Type RowMapping<S, Fields...>::take(const Buffer &buffer, size_t row,
+                                                        const ColumnDescription &description) {
+        if constexpr (!Buffer::nullable) {
+            if (buffer.isNull(row)) {
+                throw SQLException("Column " + description.name + " is null, but is mapped to a field which "
+                                                                  "can't hold nulls.");
+            }
+        }
+        return buffer.take(row);
+    }
+
+}
+
+#endif //CONTRACTS_INTERNAL_ROWMAPPING_H
@@ -0,0 +1,259 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#ifndef CONTRACTS_INTERNAL_SQLDIALECT_H
+#define CONTRACTS_INTERNAL_SQLDIALECT_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <optional>
+
+#include "QueryParameter.h"
+
+namespace sql {
+
+    // Enum for the different available types of joins
+    enum class JoinType {
+        INNER,
+        LEFT,
+        RIGHT
+    };
+
+    // Enum for the ordering direction of any order by sets
+    enum class OrderDirection {
+        ASC,
+        DESC
+    };
+
+    // JoinSpec
+    // Simple bundling specifier for the information needed for a join
+    struct JoinSpec {
+        // The table name and two join ON clauses (i.e. JOIN table ON joinFrom=joinOnto)
+        std::string table, joinFrom, joinOnto;
+        std::optional<std::string> tableAlias;
+        // The type of join to make
+        JoinType joinType;
+
+        // Constructor
+        inline JoinSpec(std::string table, std::optional<std::string> tableAlias, std::string joinFrom,
+                        std::string joinOnto, JoinType joinType)
+                : table(std::move(table)), joinFrom(std::move(joinFrom)), joinOnto(std::move(joinOnto)),
+                  tableAlias(std::move(tableAlias)), joinType(joinType) {
+
+        }
+    };
+
+    // OrderSpec
+    // Simple bundling specifier for the information needed for an order by clause
+    struct OrderSpec {
+        // The clause itself
+        std::string clause;
+        // The direction of the order (i.e. ascending or descending)
+        OrderDirection direction;
+
+        // Constructor
+        inline OrderSpec(std::string clause, OrderDirection direction)
+                : clause(std::move(clause)), direction(direction) {
+
+        }
+    };
+
+    // SelectQuery
+    // A select query as built up by the query builder, independent of how any database spells it
+    struct SelectQuery {
+        std::string rootTable;
+        std::optional<std::string> rootTableAlias;
+        std::vector<JoinSpec> joins;
+        std::vector<std::string> selections;
+        std::vector<std::string> whereConditions;
+        std::vector<std::string> groupByConditions;
+        std::vector<OrderSpec> orderByConditions;
+        std::optional<size_t> limit = std::nullopt;
+        std::optional<size_t> offset = std::nullopt;
+        // The order by values of the row to return the rows after, for keyset pagination. They are bound as
+        // parameters rather than written into the query
+        std::vector<QueryParameter> afterKey;
+    };
+
+    // SQLDialect
+    // Renders select queries in the SQL of a particular database. The base class writes standard SQL, with the
+    // clauses in the order SELECT, FROM, WHERE, GROUP BY, ORDER BY; each database overrides the parts it spells
+    // differently, which in practice is mostly paging. A query is rendered in a single pass into a string which is
+    // sized for it up front, so rendering makes one allocation. Dialects hold no state and are shared.
+    class SQLDialect {
+    public:
+        // Virtual destructor
+        virtual ~SQLDialect() = default;
+
+        // Get the name of the dialect
+        [[nodiscard]] virtual std::string_view name() const = 0;
+
+        // Render a select query as SQL. Throws an SQLException if the query can't be expressed
+        [[nodiscard]] std::string render(const SelectQuery &query) const;
+
+        // Get the values to bind to the placeholders of a rendered query, in the order the placeholders appear
+        [[nodiscard]] static std::vector<QueryParameter> parameters(const SelectQuery &query);
+
+        // Quote a table or column name so it is read as a name whatever characters it holds. A name qualified by
+        // a schema, as in schema.table, has each part quoted. Quoted names match case sensitively in Oracle and
+        // PostgreSQL, so must be given as the database stores them
+        [[nodiscard]] std::string quoteIdentifier(std::string_view identifier) const;
+
+        // Get the statement which sets a savepoint with the given name in the current transaction
+        [[nodiscard]] virtual std::string savepoint(std::string_view name) const;
+
+        // Get the statement which rolls the current transaction back to the savepoint with the given name
+        [[nodiscard]] virtual std::string rollbackToSavepoint(std::string_view name) const;
+
+        // Get the statement which releases the savepoint with the given name, or std::nullopt if the database
+        // keeps savepoints until the transaction ends
+        [[nodiscard]] virtual std::optional<std::string> releaseSavepoint(std::string_view name) const;
+
+        // The dialect for databases which page rows as standard SQL does
+        static const SQLDialect &standard();
+
+        // The dialect for Microsoft SQL Server
+        static const SQLDialect &sqlServer();
+
+        // The dialect for Oracle
+        static const SQLDialect &oracle();
+
+        // The dialect for SQLite
+        static const SQLDialect &sqlite();
+
+        // The dialect for PostgreSQL
+        static const SQLDialect &postgreSQL();
+
+        // Get the dialect for a database from the DBMS name its driver reports. Databases which aren't recognised
+        // get the standard dialect
+        static const SQLDialect &forDBMS(std::string_view dbmsName);
+
+    protected:
+        // Write the whole query. Dialects which wrap the query in another override this
+        virtual void writeQuery(std::string &out, const SelectQuery &query) const;
+
+        // Write anything which goes between SELECT and the selections
+        virtual void writeSelectModifiers(std::string &out, const SelectQuery &query) const;
+
+        // Write the FROM clause
+        virtual void writeFrom(std::string &out, const SelectQuery &query) const;
+
+        // Returns true if the dialect gives join conditions in the WHERE clause rather than the FROM clause
+        [[nodiscard]] virtual bool joinsInWhere() const;
+
+        // Write the join conditions into the WHERE clause, followed by an AND if more conditions follow. Only
+        // called for dialects which give join conditions there
+        virtual void writeJoinConditions(std::string &out, const SelectQuery &query, bool more) const;
+
+        // Write the paging clause, which follows the ORDER BY clause
+        virtual void writePaging(std::string &out, const SelectQuery &query) const = 0;
+
+        // Write one part of a quoted name. Standard SQL quotes names in double quotes, doubling any inside
+        virtual void writeQuotedPart(std::string &out, std::string_view part) const;
+
+        // Get the most characters the dialect adds to a query on top of the standard clauses
+        [[nodiscard]] virtual size_t extraLength(const SelectQuery &query) const;
+
+        // Write the body of the query: the select, from, where, group by and order by clauses
+        void writeBody(std::string &out, const SelectQuery &query) const;
+
+        // Write the condition selecting the rows after the keyset pagination key, with a placeholder for each
+        // use of a key value
+        static void writeKeysetCondition(std::string &out, const SelectQuery &query);
+
+        // Write a number
+        static void writeNumber(std::string &out, size_t number);
+
+        // Write a table name followed by its alias, if it has one
+        static void writeTable(std::string &out, const std::string &table, const std::optional<std::string> &alias);
+
+        // Write a list of strings with a separator between each
+        static void writeList(std::string &out, const std::vector<std::string> &items, std::string_view separator);
+
+    private:
+        // Get an upper bound on the length of the rendered query
+        [[nodiscard]] size_t renderedLength(const SelectQuery &query) const;
+    };
+
+    // StandardDialect
+    // Standard SQL, as of SQL:2008. Rows are paged by OFFSET ... ROWS and FETCH FIRST ... ROWS ONLY, each of which
+    // may be given alone
+    class StandardDialect : public SQLDialect {
+    public:
+        [[nodiscard]] std::string_view name() const override;
+
+    protected:
+        void writePaging(std::string &out, const SelectQuery &query) const override;
+    };
+
+    // SQLServerDialect
+    // Microsoft SQL Server. A plain limit is given by TOP, and an offset by OFFSET ... FETCH NEXT, which SQL Server
+    // only allows after an ORDER BY. Names are quoted in square brackets, and savepoints are saved transactions,
+    // which are never released
+    class SQLServerDialect : public SQLDialect {
+    public:
+        [[nodiscard]] std::string_view name() const override;
+
+        [[nodiscard]] std::string savepoint(std::string_view name) const override;
+
+        [[nodiscard]] std::string rollbackToSavepoint(std::string_view name) const override;
+
+        [[nodiscard]] std::optional<std::string> releaseSavepoint(std::string_view name) const override;
+
+    protected:
+        void writeSelectModifiers(std::string &out, const SelectQuery &query) const override;
+
+        void writeQuotedPart(std::string &out, std::string_view part) const override;
+
+        void writePaging(std::string &out, const SelectQuery &query) const override;
+    };
+
+    // OracleDialect
+    // Oracle. Outer joins use the (+) operator, and as there is no TOP, a plain limit is given by ROWNUM in a query
+    // wrapped around the original, which every version accepts. An offset is given by OFFSET ... FETCH NEXT, which
+    // needs Oracle 12c or later. Savepoints can't be released
+    class OracleDialect : public SQLDialect {
+    public:
+        [[nodiscard]] std::string_view name() const override;
+
+        [[nodiscard]] std::optional<std::string> releaseSavepoint(std::string_view name) const override;
+
+    protected:
+        void writeQuery(std::string &out, const SelectQuery &query) const override;
+
+        void writeFrom(std::string &out, const SelectQuery &query) const override;
+
+        [[nodiscard]] bool joinsInWhere() const override;
+
+        void writeJoinConditions(std::string &out, const SelectQuery &query, bool more) const override;
+
+        void writePaging(std::string &out, const SelectQuery &query) const override;
+
+        [[nodiscard]] size_t extraLength(const SelectQuery &query) const override;
+    };
+
+    // SQLiteDialect
+    // SQLite. Rows are paged by LIMIT and OFFSET, where an offset always needs a limit
+    class SQLiteDialect : public SQLDialect {
+    public:
+        [[nodiscard]] std::string_view name() const override;
+
+    protected:
+        void writePaging(std::string &out, const SelectQuery &query) const override;
+    };
+
+    // PostgreSQLDialect
+    // PostgreSQL. Rows are paged by LIMIT and OFFSET, each of which may be given alone
+    class PostgreSQLDialect : public SQLDialect {
+    public:
+        [[nodiscard]] std::string_view name() const override;
+
+    protected:
+        void writePaging(std::string &out, const SelectQuery &query) const override;
+    };
+
+}
+
+#endif //CONTRACTS_INTERNAL_SQLDIALECT_H
@@ -27,9 +27,15 @@ namespace sql {
         // Getter for the internal error message (independently)
         const std::string error() const;
 
+        // Getter for the full error message
+        const char *what() const noexcept override;
+
     private:
         // Internal state and error messages
         std::string sqlState, sqlError;
+
+        // The full error message
+        std::string message;
     };
 
     // UnknownSQLException
@@ -38,6 +44,9 @@ namespace sql {
     class UnknownSQLException : public std::exception {
     public:
         UnknownSQLException();
+
+        // Getter for the error message
+        const char *what() const noexcept override;
     };
 
 }
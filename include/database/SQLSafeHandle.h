@@ -5,7 +5,9 @@
 #ifndef CONTRACTS_INTERNAL_SQLSAFEHANDLE_H
 #define CONTRACTS_INTERNAL_SQLSAFEHANDLE_H
 
+#ifdef _WIN32
 #include <Windows.h>
+#endif
 #include <sqlext.h>
 #include <sql.h>
 #include <sqltypes.h>
@@ -66,13 +68,13 @@ namespace sql {
         SQLSafeHandle<handleType> &operator=(SQLSafeHandle<handleType> &&other) noexcept;
 
         // Bool operator. Returns true if the handle is valid otherwise false
-        constexpr operator bool() noexcept;
+        constexpr operator bool() const noexcept;
 
         // Equality operator between two safe handles
-        constexpr bool operator==(const SQLSafeHandle<handleType> &other) noexcept;
+        constexpr bool operator==(const SQLSafeHandle<handleType> &other) const noexcept;
 
         // Inequality operator between two safe handles
-        constexpr bool operator!=(const SQLSafeHandle<handleType> &other) noexcept;
+        constexpr bool operator!=(const SQLSafeHandle<handleType> &other) const noexcept;
 
         // Allocates a new handle with no input
         void allocate();
@@ -128,6 +130,24 @@ namespace sql {
         return false;
     }
 
+    // The constexpr operators are defined here rather than with the other methods, as every file using them
+    // needs their definitions
+
+    template<HandleType handleType>
+    constexpr SQLSafeHandle<handleType>::operator bool() const noexcept {
+        return __handle != nullptr;
+    }
+
+    template<HandleType handleType>
+    constexpr bool SQLSafeHandle<handleType>::operator==(const SQLSafeHandle<handleType> &other) const noexcept {
+        return __handle == other.__handle;
+    }
+
+    template<HandleType handleType>
+    constexpr bool SQLSafeHandle<handleType>::operator!=(const SQLSafeHandle<handleType> &other) const noexcept {
+        return __handle != other.__handle;
+    }
+
     template<HandleType handleType>
     template<HandleType inputHandleType>
     void SQLSafeHandle<handleType>::allocate(const SQLSafeHandle<inputHandleType> &inputHandle) {
@@ -6,52 +6,229 @@
 #define CONTRACTS_INTERNAL_SAGEDATABASEMANAGER_H
 
 #include <sstream>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <future>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
 
 #include "queryConstructions.h"
+#include "BulkInsert.h"
+#include "Transaction.h"
+#include "QueryCache.h"
+#include "MaterializedResult.h"
+#include "StatementMetrics.h"
 #include "SQLException.h"
 
 namespace sql {
 
     // SQLSession
     // SQL Session representing a queryable connection to the ODBC.
-    // Essentially wraps the low level C ODBC interface with a C++ style interface
+    // Essentially wraps the low level C ODBC interface with a C++ style interface.
+    // Queries may also be run asynchronously on the session's database worker thread, so a network thread can
+    // hand off a query and carry on serving sockets while it runs. Asynchronous queries are run one at a time, in
+    // the order they were submitted.
+    // A session may be used from several threads, but its statements are run one at a time on its single
+    // connection. Threads which should run statements in parallel take a session each from a SessionPool.
     class SQLSession {
     public:
+        // Alias for the function called on the worker thread when an asynchronous query completes. The future it
+        // is given is already ready, so get returns the result (or rethrows the query's error) without waiting.
+        // Anything the callback throws is given to the callback error handler, and the worker carries on
+        using QueryCallback = std::function<void(std::future<MaterializedResult> &&result)>;
+
+        // Alias for the function given the errors thrown by query callbacks, called on the worker thread
+        using CallbackErrorHandler = std::function<void(std::exception_ptr error)>;
+
         // Constructor
         SQLSession();
 
         // Destructor
         ~SQLSession();
 
-        // Connect to the ODBC database through a predefined DSN
+        // Connect to the ODBC database through a predefined DSN. The dialect is chosen from the DBMS the driver
+        // reports
         void connect(const std::string &dsn, const std::string &userID, const std::string &password);
 
-        // Execute an SQL statement which does not return any data
+        // Get the dialect queries built on the session are rendered in
+        [[nodiscard]] const SQLDialect &dialect() const;
+
+        // Set the dialect queries built on the session are rendered in, replacing the one chosen on connecting
+        void setDialect(const SQLDialect &newDialect);
+
+        // Execute an SQL statement which does not return any data. Any rows it does return are discarded
         void execute(const std::string &sql);
 
         // Execute an SQL query
         sql::QueryResult executeQuery(const std::string &sql);
 
+        // Execute an SQL query, binding the parameters to its placeholders in order
+        sql::QueryResult executeQuery(const std::string &sql, const std::vector<QueryParameter> &parameters);
+
+        // Execute an SQL query which reads from the given tables, reading the whole result into memory. If the
+        // session has a query cache, a result it holds is returned without touching the database, and otherwise
+        // the new result is stored in it for the given time
+        std::shared_ptr<const CachedResult> executeCachedQuery(const std::string &sql,
+                                                               const std::vector<std::string> &tables,
+                                                               QueryCache::Clock::duration timeToLive);
+
+        // Execute an SQL query through the query cache, binding the parameters to its placeholders in order.
+        // Results are cached by the parameters as well as the query
+        std::shared_ptr<const CachedResult> executeCachedQuery(const std::string &sql,
+                                                               const std::vector<QueryParameter> &parameters,
+                                                               const std::vector<std::string> &tables,
+                                                               QueryCache::Clock::duration timeToLive);
+
+        // Set the cache for cached queries, which may be shared with other sessions. Writes through the session
+        // invalidate the results in it which read from the tables written to. Set before the session is used from
+        // more than one thread
+        void setQueryCache(std::shared_ptr<QueryCache> newCache);
+
+        // Get the cache for cached queries, which is null unless one has been set
+        [[nodiscard]] const std::shared_ptr<QueryCache> &queryCache() const;
+
+        // Set where the session's statements are measured, which may be shared with other sessions, or null to
+        // stop measuring them. Set before the session is used from more than one thread
+        void setStatementMetrics(std::shared_ptr<StatementMetrics> newMetrics);
+
+        // Get where the session's statements are measured, which is null unless it has been set
+        [[nodiscard]] const std::shared_ptr<StatementMetrics> &statementMetrics() const;
+
+        // Insert a batch of rows, sending them in as few executes as the byte budget allows. Outside a
+        // transaction, the batch is inserted as its own transaction, which is only committed if every row is
+        // accepted. Inside one, the batch is set behind a savepoint, which it is rolled back to unless every row
+        // is accepted, and committing the rest is left to the caller
+        BulkInsertResult bulkInsert(const BulkInsert &batch);
+
+        // Begin a transaction. Statements on the connection, including asynchronous ones, are part of it until it
+        // is committed or rolled back. Transactions don't nest
+        void beginTransaction();
+
+        // Commit the current transaction and return to autocommit
+        void commit();
+
+        // Roll back the current transaction and return to autocommit
+        void rollback();
+
+        // Returns true if a transaction is in progress
+        [[nodiscard]] bool inTransaction();
+
+        // Begin a transaction, returning a guard which rolls it back unless it is committed
+        Transaction transaction();
+
+        // Execute an SQL statement which does not return any data on the worker thread
+        std::future<void> executeAsync(const std::string &sql);
+
+        // Execute an SQL query on the worker thread. The worker reads the whole result before it runs the next
+        // statement, as most drivers can't fetch from one statement while another runs on the same connection,
+        // so the result may be read from any thread once the future is ready, while further queries run
+        std::future<MaterializedResult> executeQueryAsync(const std::string &sql);
+
+        // Execute an SQL query on the worker thread, calling the callback with its result when it completes
+        void executeQueryAsync(const std::string &sql, QueryCallback callback);
+
+        // Set the handler for errors thrown by query callbacks, or null to drop them, as they are by default.
+        // The handler is called on the worker thread, and anything it throws is dropped
+        void setCallbackErrorHandler(CallbackErrorHandler handler);
+
         // Gets a queryable table object for the C++ style query builder interface
         sql::Table table(const std::string &tableName);
 
         // Gets a queryable table object with an alias for the C++ style query builder interface
         sql::Table table(const std::string &tableName, const std::string &tableAlias);
 
-        // Terminate the connection
+        // Returns false if the connection has been lost, e.g. because the server went away, as far as the driver
+        // can tell without a round trip. A driver which can't tell reports the connection alive
+        [[nodiscard]] bool connectionAlive();
+
+        // Terminate the connection. Any asynchronous queries already submitted are run first
         void closeConnection();
 
     private:
         // Handles for the internal connection and environment
         SQLConnectionHandle sqlConnHandle;
         SQLEnvironmentHandle sqlEnvHandle;
-        SQLStatementHandle sqlStatementHandle;
+
+        // Statement handles for the connection, shared with the results using them so they can be given back
+        std::shared_ptr<StatementPool> statements = std::make_shared<StatementPool>();
 
         // Flag indicating whether the manager is currently connected to the database
         bool connected = false;
 
-        // Method to setup statement handle creation
-        void setupStatementHandle();
+        // The dialect queries are rendered in. Defaults to SQL Server until the connection says otherwise
+        std::atomic<const SQLDialect *> sqlDialect = &SQLDialect::sqlServer();
+
+        // Lock serialising statements on the connection between the calling threads and the worker
+        std::mutex connectionLock;
+        // Whether a transaction is in progress. Guarded by the connection lock
+        bool transactionActive = false;
+        // The tables written to in the current transaction, or std::nullopt if a statement in it could have
+        // written to anything. Guarded by the connection lock
+        std::optional<std::vector<std::string>> transactionWrites;
+
+        // The cache for cached queries
+        std::shared_ptr<QueryCache> cache;
+        // Where statements are measured
+        std::shared_ptr<StatementMetrics> metricsSink;
+
+        // The database worker thread, started by the first asynchronous query
+        std::thread worker;
+        // Lock guarding the work queue
+        std::mutex workLock;
+        // Notified when work is queued or the worker should stop
+        std::condition_variable workReady;
+        // Work waiting for the worker
+        std::deque<std::function<void()>> work;
+        // Whether the worker should stop once the queue is empty
+        bool stopping = false;
+        // The handler for errors thrown by query callbacks. Guarded by the work lock
+        CallbackErrorHandler callbackErrorHandler;
+
+        // Turn autocommit on or off for the connection. Requires the connection lock
+        void setAutoCommit(bool autoCommit);
+
+        // Begin a transaction, with none in progress. Requires the connection lock
+        void startTransaction();
+
+        // Commit or roll back the current transaction and return to autocommit
+        void endTransaction(bool commit);
+
+        // Commit or roll back the transaction in progress and return to autocommit. Requires the connection lock
+        void finishTransaction(bool commit);
+
+        // Invalidate the cached results reading from tables which have been written to, or every result if the
+        // tables are std::nullopt. Within a transaction, they are invalidated again once it ends, as results
+        // read by other sessions in the meantime don't include its writes. Requires the connection lock
+        void invalidateWrites(const std::optional<std::vector<std::string>> &tables);
+
+        // Execute one chunk of a bulk insert, recording the status of each of its rows, and measuring it if stats
+        // are given. Returns true if every row was inserted
+        bool executeBulkChunk(const SQLStatementHandle &statement, const BulkInsert &batch, size_t first,
+                              size_t count, BulkInsertResult &result, StatementStats *stats);
+
+        // Execute an SQL statement which does not return any data, throwing if it fails. Requires the connection
+        // lock
+        void executeStatement(const std::string &sql);
+
+        // Execute an SQL query and read its whole result, holding the connection until the statement is released
+        MaterializedResult executeMaterialized(const std::string &sql);
+
+        // Run a statement directly on a pooled handle with the given parameters bound, measuring it if the session
+        // has metrics. The returned result holds the handle, and gives it back to the pool once it is finished
+        // with
+        QueryResult executeDirect(const std::string &sql, SQLRETURN &ret,
+                                  const std::vector<QueryParameter> &parameters = {});
+
+        // Queue a job for the worker thread, starting it if necessary
+        void submit(std::function<void()> job);
+
+        // Worker thread loop
+        void workerLoop();
+
+        // Run the remaining work then stop the worker thread
+        void stopWorker();
 
         // Handles an internal error by throwing an exception where necessary
         template<HandleType handleType>
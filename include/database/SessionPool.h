@@ -0,0 +1,167 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#ifndef CONTRACTS_INTERNAL_SESSIONPOOL_H
+#define CONTRACTS_INTERNAL_SESSIONPOOL_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+#include "SQLSession.h"
+#include "MaterializedResult.h"
+
+// Most sessions a pool opens if it isn't given a size
+#define SESSION_POOL_DEFAULT_SIZE 8
+
+namespace sql {
+
+    class SessionPool;
+
+    // SessionLease
+    // A session borrowed from a pool by the calling thread, which is given back when the lease is destroyed. The
+    // session is only used by the thread holding the lease, so it needs no locking beyond its own
+    class SessionLease {
+        // Friend the pool so it can call the private constructor
+        friend class SessionPool;
+
+    public:
+        SessionLease(const SessionLease &other) = delete;
+
+        // Move constructor
+        SessionLease(SessionLease &&other) noexcept;
+
+        // Destructor. Gives the session back to the pool
+        ~SessionLease();
+
+        SessionLease &operator=(const SessionLease &other) = delete;
+
+        // Get the session
+        SQLSession &operator*() const;
+
+        // Get the session
+        SQLSession *operator->() const;
+
+    private:
+        // Private constructor taking the pool, the session leased and its index in the pool
+        SessionLease(SessionPool &pool, SQLSession &session, size_t slot);
+
+        // The pool the session belongs to, or null once the lease has been moved from
+        SessionPool *pool;
+        // The session
+        SQLSession *session;
+        // The index of the session in the pool
+        size_t slot;
+    };
+
+    // SessionPool
+    // Sessions, each with its own connection to the same database, shared between threads. A thread takes a
+    // session for as long as it needs with acquire, or for a single statement through the methods below, and a
+    // session is only ever used by one thread at a time, so threads run their statements in parallel rather than
+    // queueing for one connection. Sessions are opened as they are first needed, up to the pool's size, after
+    // which threads wait for one to be given back. A thread is given the session it used last if it is free.
+    // A free session whose connection has been lost is replaced with a new one as it is taken. Every method may be
+    // called from any thread. The pool must outlive its leases.
+    //
+    // A transaction sticks to the thread which began it: a session given back mid transaction is kept for that
+    // thread, and handed to it by every acquire until the transaction is committed or rolled back, so e.g.
+    //   pool.beginTransaction(); pool.execute(...); pool.execute(...); pool.commit();
+    // runs as one transaction on one connection. A thread must end its transactions before it exits, as the
+    // session is otherwise never given back.
+    class SessionPool {
+        // Friend the lease class so it can give sessions back
+        friend class SessionLease;
+
+    public:
+        // Constructor taking the database to connect to, the most sessions to open, and optionally a cache and
+        // statement metrics for the sessions to share. No connection is made until a session is first needed
+        SessionPool(std::string dsn, std::string userID, std::string password,
+                    size_t maxSessions = SESSION_POOL_DEFAULT_SIZE, std::shared_ptr<QueryCache> cache = nullptr,
+                    std::shared_ptr<StatementMetrics> statementMetrics = nullptr);
+
+        SessionPool(const SessionPool &other) = delete;
+
+        SessionPool &operator=(const SessionPool &other) = delete;
+
+        // Take a session for the calling thread, waiting for one if every session is in use. A thread which
+        // already holds a lease, or has a transaction open, is given the same session again
+        SessionLease acquire();
+
+        // Execute an SQL statement which does not return any data
+        void execute(const std::string &sql);
+
+        // Execute an SQL query, reading the whole result before the session is given back
+        MaterializedResult executeQuery(const std::string &sql);
+
+        // Execute an SQL query which reads from the given tables through the pool's query cache
+        std::shared_ptr<const CachedResult> executeCachedQuery(const std::string &sql,
+                                                               const std::vector<std::string> &tables,
+                                                               QueryCache::Clock::duration timeToLive);
+
+        // Insert a batch of rows
+        BulkInsertResult bulkInsert(const BulkInsert &batch);
+
+        // Begin a transaction on the calling thread's session, which stays with the thread until it ends
+        void beginTransaction();
+
+        // Commit the calling thread's transaction
+        void commit();
+
+        // Roll back the calling thread's transaction
+        void rollback();
+
+        // Returns true if the calling thread has a transaction open
+        [[nodiscard]] bool inTransaction();
+
+        // Get the number of sessions opened
+        [[nodiscard]] size_t size() const;
+
+    private:
+        // Slot
+        // A session of the pool and who it belongs to
+        struct Slot {
+            // The session, which is null while it is being opened
+            std::unique_ptr<SQLSession> session;
+            // The thread holding or last holding the session
+            std::thread::id owner;
+            // The number of leases the owner holds
+            size_t leases = 0;
+            // Whether the session is kept for its owner as it has a transaction open
+            bool pinned = false;
+        };
+
+        // Give back one lease of a session
+        void release(SQLSession &session, size_t slot);
+
+        // Open a new session into a slot the calling thread has claimed, connecting without holding the lock,
+        // which is held again on returning. If connecting fails, the slot is given up
+        SessionLease openInto(std::unique_lock<std::mutex> &lock, size_t slot);
+
+        // Open a new session
+        [[nodiscard]] std::unique_ptr<SQLSession> open() const;
+
+        // The database to connect to
+        std::string dsn, userID, password;
+        // The most sessions to open
+        size_t maxSessions;
+        // The cache shared by the sessions
+        std::shared_ptr<QueryCache> cache;
+        // Where the sessions' statements are measured
+        std::shared_ptr<StatementMetrics> statementMetrics;
+
+        // Lock guarding the slots
+        mutable std::mutex poolLock;
+        // Notified when a session is given back, or a slot frees up
+        std::condition_variable sessionFree;
+        // A slot for each session the pool may open. These are made up front and never resized, so a slot can be
+        // read by its owner while other threads take other slots
+        std::vector<Slot> slots;
+    };
+
+}
+
+#endif //CONTRACTS_INTERNAL_SESSIONPOOL_H
@@ -0,0 +1,145 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#ifndef CONTRACTS_INTERNAL_STATEMENTMETRICS_H
+#define CONTRACTS_INTERNAL_STATEMENTMETRICS_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <ostream>
+#include <functional>
+#include <unordered_map>
+#include <condition_variable>
+
+#include "../metrics/LatencyHistogram.h"
+
+// Most distinct statements tracked. Statements seen after this many are counted together under one entry
+#define STATEMENT_METRICS_MAX_STATEMENTS 1024
+// The text the statements past the limit are counted under
+#define STATEMENT_METRICS_OVERFLOW "(other statements)"
+
+namespace sql {
+
+    // StatementStats
+    // The measurements of every run of one statement, as normalised by StatementMetrics. Durations are recorded
+    // in nanoseconds. Every member may be updated from any thread
+    struct StatementStats {
+        // Constructor taking the normalised statement
+        explicit StatementStats(std::string sql);
+
+        // The normalised statement
+        const std::string sql;
+
+        // The number of times the statement was run
+        std::atomic<uint64_t> executions{0};
+        // The number of runs which failed
+        std::atomic<uint64_t> errors{0};
+        // The number of rows fetched from the statement's results
+        std::atomic<uint64_t> rows{0};
+        // The number of bytes of values read from the statement's results
+        std::atomic<uint64_t> bytes{0};
+        // The number of statement handles the driver allocated to run the statement, rather than being reused
+        std::atomic<uint64_t> handleAllocations{0};
+
+        // Time to prepare the statement, for statements which are prepared
+        metrics::LatencyHistogram prepare;
+        // Time for the driver to run the statement, up to the point its result is ready to fetch
+        metrics::LatencyHistogram execute;
+        // Time from running the statement to its first row being fetched
+        metrics::LatencyHistogram firstRow;
+        // Time from running the statement to its last row being fetched
+        metrics::LatencyHistogram drain;
+    };
+
+    // StatementReport
+    // A copy of the measurements of one statement at a point in time
+    struct StatementReport {
+        std::string sql;
+        uint64_t executions;
+        uint64_t errors;
+        uint64_t rows;
+        uint64_t bytes;
+        uint64_t handleAllocations;
+        metrics::HistogramSummary prepare;
+        metrics::HistogramSummary execute;
+        metrics::HistogramSummary firstRow;
+        metrics::HistogramSummary drain;
+        // The total time spent running the statement, in nanoseconds
+        double totalExecuteTime;
+    };
+
+    // StatementMetrics
+    // Measurements of the statements run by the sessions it is given to, grouped by statement text with literal
+    // values taken out, so e.g. every lookup of a contract by its number is counted together whatever the number.
+    // Read with report, or have a report passed on at a fixed interval with dumpEvery. Sessions look up their
+    // statement once per run, and record against it without locking
+    class StatementMetrics {
+    public:
+        // Alias for the function reports are passed to at each interval
+        using ReportSink = std::function<void(const std::vector<StatementReport> &report)>;
+
+        StatementMetrics() = default;
+
+        StatementMetrics(const StatementMetrics &other) = delete;
+
+        StatementMetrics &operator=(const StatementMetrics &other) = delete;
+
+        // Destructor. Stops any periodic report
+        ~StatementMetrics();
+
+        // Get the measurements of a statement, creating them if it hasn't been seen before
+        std::shared_ptr<StatementStats> statement(std::string_view sql);
+
+        // Get the measurements of every statement, the slowest in total first
+        [[nodiscard]] std::vector<StatementReport> report() const;
+
+        // Write the measurements of every statement as a table, the slowest in total first
+        void dump(std::ostream &out) const;
+
+        // Pass a report to the sink at every interval from now on, on a thread of its own. Replaces any earlier
+        // periodic report, waiting for its thread to finish. Must not be called from the sink
+        void dumpEvery(std::chrono::milliseconds interval, ReportSink sink);
+
+        // Stop any periodic report, waiting for its thread to finish. Must not be called from the sink
+        void stopDumping();
+
+        // Forget every statement measured so far
+        void reset();
+
+        // Take the literal values out of a statement and collapse its whitespace, so runs of the same statement
+        // with different values look alike. Lists of values, e.g. IN (1, 2, 3), collapse to a single ?
+        static std::string normalise(std::string_view sql);
+
+    private:
+        // Periodic report thread loop
+        void dumpLoop(std::chrono::milliseconds interval, ReportSink sink);
+
+        // Stop the periodic report thread, if one is running, and wait for it to finish. Requires the dumper lock
+        void stopDumper();
+
+        // Lock guarding the statements
+        mutable std::mutex statementLock;
+        // The measurements of each statement by its normalised text
+        std::unordered_map<std::string, std::shared_ptr<StatementStats>> statements;
+
+        // Lock held while the periodic report thread is started or stopped
+        std::mutex dumperLock;
+        // The periodic report thread. Guarded by the dumper lock
+        std::thread dumper;
+        // Lock guarding the stop flag
+        std::mutex dumpLock;
+        // Notified when the periodic report should stop
+        std::condition_variable dumpStop;
+        // Whether the periodic report should stop
+        bool stopping = false;
+    };
+
+}
+
+#endif //CONTRACTS_INTERNAL_STATEMENTMETRICS_H
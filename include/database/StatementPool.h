@@ -0,0 +1,59 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#ifndef CONTRACTS_INTERNAL_STATEMENTPOOL_H
+#define CONTRACTS_INTERNAL_STATEMENTPOOL_H
+
+#include <vector>
+#include <mutex>
+
+#include "SQLSafeHandle.h"
+
+// Most idle statement handles kept by a pool. Handles given back beyond this are freed
+#define STATEMENT_POOL_CAPACITY 16
+
+namespace sql {
+
+    // StatementPool
+    // Statement handles for a single connection, kept once they are finished with so the next statement can reuse
+    // one rather than the driver allocating and freeing a handle for every query. A handle given back has its
+    // cursor closed, its columns unbound, its parameters reset and its attributes returned to their defaults, so
+    // it is handed out as good as new. Handles may be given back from any thread
+    class StatementPool {
+    public:
+        // Constructor taking the most idle handles to keep
+        explicit StatementPool(size_t capacity = STATEMENT_POOL_CAPACITY);
+
+        // Take an idle handle, or allocate a new one on the connection if there are none
+        SQLStatementHandle acquire(const SQLConnectionHandle &connection);
+
+        // Give a handle back to the pool. Handles which can't be reset, or don't fit, are freed instead
+        void release(SQLStatementHandle &&handle);
+
+        // Free every idle handle, and free handles given back from now on rather than keeping them. Called before
+        // the connection is closed
+        void close();
+
+        // Get the number of idle handles
+        [[nodiscard]] size_t idleCount() const;
+
+        // Get the number of handles the pool has allocated
+        [[nodiscard]] size_t allocations() const;
+
+    private:
+        // Lock guarding the pool
+        mutable std::mutex poolLock;
+        // The idle handles
+        std::vector<SQLStatementHandle> idle;
+        // The most idle handles to keep
+        size_t capacity;
+        // The number of handles allocated
+        size_t allocated = 0;
+        // Whether the connection has been closed
+        bool closed = false;
+    };
+
+}
+
+#endif //CONTRACTS_INTERNAL_STATEMENTPOOL_H
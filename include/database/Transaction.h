@@ -0,0 +1,52 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#ifndef CONTRACTS_INTERNAL_TRANSACTION_H
+#define CONTRACTS_INTERNAL_TRANSACTION_H
+
+namespace sql {
+
+    // Forward declarations
+    class SQLSession;
+
+    // Transaction
+    // RAII guard for a transaction on a session. The transaction begins when the guard is created, and is rolled
+    // back when the guard goes out of scope unless it has been committed first, so an exception part way through
+    // a batch of writes never leaves half of them behind.
+    class Transaction {
+    public:
+        // Constructor taking the session to begin the transaction on
+        explicit Transaction(SQLSession &session);
+
+        Transaction(const Transaction &other) = delete;
+
+        // Move constructor. The moved from guard no longer controls the transaction
+        Transaction(Transaction &&other) noexcept;
+
+        // Destructor. Rolls back the transaction if it is still active
+        ~Transaction();
+
+        Transaction &operator=(const Transaction &other) = delete;
+
+        Transaction &operator=(Transaction &&other) = delete;
+
+        // Commit the transaction
+        void commit();
+
+        // Roll back the transaction
+        void rollback();
+
+        // Returns true until the transaction has been committed or rolled back
+        [[nodiscard]] bool active() const;
+
+    private:
+        // The session the transaction is on
+        SQLSession *session;
+        // Whether the transaction is still active
+        bool __active;
+    };
+
+}
+
+#endif //CONTRACTS_INTERNAL_TRANSACTION_H
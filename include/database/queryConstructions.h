@@ -9,8 +9,11 @@
 #include <utility>
 #include <vector>
 #include <optional>
+#include <chrono>
 
 #include "QueryResult.h"
+#include "SQLDialect.h"
+#include "QueryCache.h"
 
 namespace sql {
 
@@ -22,19 +25,6 @@ namespace sql {
     namespace internal {
         class QueryBuilder;
     }
-    // Enum for the different available types of joins
-    enum class JoinType {
-        INNER,
-        LEFT,
-        RIGHT
-    };
-
-    // Enum for the ordering direction of any order by sets
-    enum class OrderDirection {
-        ASC,
-        DESC
-    };
-
     // Table
     // Represents a table in the query builder system
     class Table {
@@ -84,12 +74,29 @@ namespace sql {
         // Specify a row limit on the returned rows
         TableSelection &limit(size_t n);
 
-        // Executes the constructed query and returns the row results in the form of a QueryResult object
+        // Skip the first n rows. Rows are only in a defined order if an order by has been given. On Oracle, an
+        // offset needs version 12c or later
+        TableSelection &offset(size_t n);
+
+        // Return only the rows after the given row in the order by order. A value is given for each order by
+        // condition in turn, e.g. the values of the order by columns on the last row of the previous page, and is
+        // bound to the query as a parameter of its own type. Unlike an offset, the server can seek straight to the
+        // first row rather than reading and discarding every row before it
+        template<typename ...T>
+        TableSelection &after(T &&...lastKey);
+
+        // Executes the constructed query in the session's dialect and returns the row results in the form of a
+        // QueryResult object
         QueryResult execute();
 
-        // Executes the constructed query as an Oracle-Style query
+        // Executes the constructed query as an Oracle-Style query, whatever the session's dialect
         QueryResult executeOracle();
 
+        // Executes the constructed query through the session's query cache, returning the whole result in memory.
+        // A result read within the last time to live, since when nothing has been written to any of the tables
+        // the query reads through the session, is returned without running the query
+        std::shared_ptr<const CachedResult> executeCached(std::chrono::steady_clock::duration timeToLive);
+
     private:
         // Private hidden constructor
         explicit TableSelection(std::unique_ptr<internal::QueryBuilder> builder);
@@ -134,64 +141,31 @@ namespace sql {
             // Setter for the limit. The limit defaults to an std::nullopt, implying there is no limit
             void setLimit(size_t lim);
 
+            // Setter for the offset. The offset defaults to an std::nullopt, implying no rows are skipped
+            void setOffset(size_t off);
+
+            // Set the key of the row to return the rows after
+            template<typename ...T>
+            void setAfterKey(T &&...lastKey);
+
             // Executes the constructed query and returns the results
             QueryResult execute();
 
             // Executes the constructed query as an Oracle-Style query and returns the results
             QueryResult executeOracle();
 
+            // Executes the constructed query through the session's query cache and returns the results
+            std::shared_ptr<const CachedResult> executeCached(std::chrono::steady_clock::duration timeToLive);
+
         private:
-            // JoinSpec
-            // Simple bundling specifier for the information needed for a join
-            struct JoinSpec {
-                // The table name and two join ON clauses (i.e. JOIN table ON joinFrom=joinOnto)
-                std::string table, joinFrom, joinOnto;
-                std::optional<std::string> tableAlias;
-                // The type of join to make
-                JoinType joinType;
-
-                // Constructor
-                inline JoinSpec(std::string table, std::optional<std::string> tableAlias, std::string joinFrom, std::string joinOnto,
-                                JoinType joinType)
-                        : table(std::move(table)), tableAlias(std::move(tableAlias)), joinFrom(std::move(joinFrom)),
-                          joinOnto(std::move(joinOnto)), joinType(joinType) {
-
-                }
-            };
-
-            // OrderSpec
-            // Simple bundling specifier for the information needed for an order by clause
-            struct OrderSpec {
-                // The clause itself
-                std::string clause;
-                // The direction of the order (i.e. ascending or descending)
-                OrderDirection direction;
-
-                // Constructor
-                inline OrderSpec(std::string clause, OrderDirection direction)
-                        : clause(std::move(clause)), direction(direction) {
-
-                }
-            };
-
-            // The information needed to construct the SQL query
-            std::string rootTable;
-            std::optional<std::string> rootTableAlias;
-            std::vector<JoinSpec> joins;
-            std::vector<std::string> selections;
-            std::vector<std::string> whereConditions;
-            std::vector<std::string> groupByConditions;
-            std::vector<OrderSpec> orderByConditions;
-            std::optional<size_t> limit = std::nullopt;
+            // The query being built
+            SelectQuery query;
 
             // The session to call the query on
             SQLSession *sess;
 
-            // Construct the SQL query string from the builder data
-            std::string construct() const;
-
-            // Construct the SQL query string in Oracle style SQL
-            std::string constructOracle() const;
+            // Construct the SQL query string from the builder data in the given dialect
+            std::string construct(const SQLDialect &dialect) const;
 
             // Variadic template recursive case for adding a set of strings to a vector
             template<typename ...T>
@@ -243,22 +217,36 @@ namespace sql {
         return *this;
     }
 
+    template<typename... T>
+    TableSelection &TableSelection::after(T &&... lastKey) {
+        // Set the key on the builder
+        builder->setAfterKey(lastKey...);
+        // Return this object - this allows for calling multiple functions on the same line
+        return *this;
+    }
+
+    template<typename... T>
+    void internal::QueryBuilder::setAfterKey(T &&... lastKey) {
+        // A new key replaces any earlier one
+        query.afterKey = {QueryParameter(lastKey)...};
+    }
+
     template<typename... T>
     void internal::QueryBuilder::addSelections(T &&... selects) {
         // Call the internal adder to add the "selects" values to the selections vector
-        addAllStrings(selections, selects...);
+        addAllStrings(query.selections, selects...);
     }
 
     template<typename... T>
     void internal::QueryBuilder::addWhereConditions(T &&... conditions) {
         // Call the internal adder to add the "conditions" values to the where conditions vector
-        addAllStrings(whereConditions, conditions...);
+        addAllStrings(query.whereConditions, conditions...);
     }
 
     template<typename... T>
     void internal::QueryBuilder::addGroupByConditions(T &&... conditions) {
         // Call the internal adder to add the "conditions" values to the group by conditions vector
-        addAllStrings(groupByConditions, conditions...);
+        addAllStrings(query.groupByConditions, conditions...);
     }
 
     template<typename... T>
@@ -281,7 +269,7 @@ namespace sql {
     void internal::QueryBuilder::impl_addOrderByConditions(OrderDirection direction,
                                                            const std::string &condition, T &&... rest) {
         // Add the head string and direction to the order by conditions
-        orderByConditions.emplace_back(condition, direction);
+        query.orderByConditions.emplace_back(condition, direction);
         // Recurse on the tail
         impl_addOrderByConditions(direction, rest...);
     }
@@ -0,0 +1,104 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#ifndef CONTRACTS_INTERNAL_LATENCYHISTOGRAM_H
+#define CONTRACTS_INTERNAL_LATENCYHISTOGRAM_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+// Bits of precision kept for each recorded value. Values below 2^bits are counted exactly, and larger values to
+// within 1 part in 2^(bits - 1), i.e. about 3%
+#define LATENCY_HISTOGRAM_PRECISION_BITS 6
+// Bit length of the largest value tracked. Larger values are counted as this one, which in nanoseconds is
+// around 39 hours
+#define LATENCY_HISTOGRAM_MAX_BITS 47
+
+namespace metrics {
+
+    // HistogramSummary
+    // The headline figures of a histogram at one point in time. Values are in the histogram's units, which for
+    // durations are nanoseconds
+    struct HistogramSummary {
+        uint64_t count = 0;
+        uint64_t min = 0;
+        uint64_t max = 0;
+        double mean = 0;
+        uint64_t p50 = 0;
+        uint64_t p90 = 0;
+        uint64_t p99 = 0;
+        uint64_t p999 = 0;
+    };
+
+    // LatencyHistogram
+    // A histogram of values, e.g. durations, in the style of an HDR histogram: the buckets are linear up to
+    // 2^LATENCY_HISTOGRAM_PRECISION_BITS, then each doubling of value is split into a fixed number of buckets, so
+    // every value is kept to the same relative precision whatever its size, in a fixed amount of memory.
+    // Recording is a few relaxed atomic adds, so any number of threads may record into one histogram without
+    // locking. Reads see each count as of some point during the read, so a summary taken while values are
+    // recorded may be a few values out.
+    class LatencyHistogram {
+    public:
+        // Alias the clock durations are measured on
+        using Clock = std::chrono::steady_clock;
+
+        LatencyHistogram();
+
+        LatencyHistogram(const LatencyHistogram &other) = delete;
+
+        LatencyHistogram &operator=(const LatencyHistogram &other) = delete;
+
+        // Record a value
+        void record(uint64_t value);
+
+        // Record a duration, in nanoseconds
+        inline void record(Clock::duration duration) {
+            long long nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+            record(nanoseconds < 0 ? 0 : (uint64_t) nanoseconds);
+        }
+
+        // Get the number of values recorded
+        [[nodiscard]] uint64_t count() const;
+
+        // Get the value below or equal to which the given percentage of values fall, to the histogram's
+        // precision. Returns 0 if nothing has been recorded
+        [[nodiscard]] uint64_t percentile(double percent) const;
+
+        // Get the headline figures of the histogram
+        [[nodiscard]] HistogramSummary summary() const;
+
+        // Add the values recorded in another histogram to this one
+        void merge(const LatencyHistogram &other);
+
+        // Forget every value recorded
+        void reset();
+
+        // The number of buckets in a histogram
+        static constexpr size_t BUCKET_COUNT =
+                (1u << LATENCY_HISTOGRAM_PRECISION_BITS) +
+                (LATENCY_HISTOGRAM_MAX_BITS - LATENCY_HISTOGRAM_PRECISION_BITS) *
+                (1u << (LATENCY_HISTOGRAM_PRECISION_BITS - 1));
+
+    private:
+        // Get the bucket a value is counted in
+        static size_t bucketOf(uint64_t value);
+
+        // Get the largest value counted in a bucket
+        static uint64_t bucketTop(size_t bucket);
+
+        // The count of each bucket
+        std::atomic<uint64_t> buckets[BUCKET_COUNT];
+        // The number of values
+        std::atomic<uint64_t> total;
+        // The sum of the values
+        std::atomic<uint64_t> sum;
+        // The smallest and largest values
+        std::atomic<uint64_t> smallest, largest;
+    };
+
+}
+
+#endif //CONTRACTS_INTERNAL_LATENCYHISTOGRAM_H
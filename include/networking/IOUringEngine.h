@@ -0,0 +1,226 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#ifndef CONTRACTS_INTERNAL_IOURINGENGINE_H
+#define CONTRACTS_INTERNAL_IOURINGENGINE_H
+
+// The io_uring backend is only available on Linux builds configured with CONTRACTS_USE_IO_URING. Everything else
+// uses the readiness based TCPSocket interface
+#ifdef CONTRACTS_IO_URING
+
+#include <liburing.h>
+
+#include <deque>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "TCPSocket.h"
+#include "NetworkMessageV2.h"
+
+#define IO_URING_DEFAULT_ENTRIES 256
+#define IO_URING_DEFAULT_CONNECTIONS 1024
+#define IO_URING_DEFAULT_BUFFER_COUNT 512
+#define IO_URING_DEFAULT_BUFFER_SIZE 4096
+// Bits of submission user data given to the generation of the connection slot an operation was for
+#define IO_URING_GENERATION_BITS 24u
+
+namespace networking {
+
+    // IOUringEngine
+    // Completion based socket engine for servers with many connections, built on io_uring. Rather than waiting
+    // for readiness and then making a system call per socket, the engine keeps a multishot accept armed on the
+    // listening socket and a multishot receive armed on every connection, and submits all of them in batches.
+    // Accepted connections are installed straight into the ring's fixed file table, and received data lands in
+    // buffers picked by the kernel from a registered buffer ring, so neither accepts nor receives need a file
+    // descriptor lookup or a user supplied buffer per call. Completed frames are decoded as they arrive and
+    // handed to the message handler. Not thread safe: an engine belongs to the thread which calls poll.
+    // Connections the engine accepts never exist as file descriptors outside the ring, so they carry framed
+    // messages only. A server whose connections first run a connection Protocol (e.g. a key exchange) accepts
+    // and runs it on a TCPSocket as usual, then adopts the socket, after which the rest of the connection is
+    // served from completions like any other.
+    class IOUringEngine {
+    public:
+        // Alias for a connection, which is its slot in the fixed file table. A slot is reused once its connection
+        // has closed, so an ID is only meaningful until the close handler has been called for it
+        using ConnectionID = unsigned;
+
+        // Alias for the handler called when a connection is accepted
+        using AcceptHandler = std::function<void(ConnectionID)>;
+        // Alias for the handler called with each complete message received on a connection
+        using MessageHandler = std::function<void(ConnectionID, NetworkMessage &&)>;
+        // Alias for the handler called when a connection has closed
+        using CloseHandler = std::function<void(ConnectionID)>;
+        // Alias for the handler called once an adopted socket has been installed in the ring
+        using AdoptHandler = std::function<void(ConnectionID)>;
+
+        // Constructor taking the submission queue size, the maximum number of open connections and the number
+        // and size of the receive buffers
+        explicit IOUringEngine(unsigned entries = IO_URING_DEFAULT_ENTRIES,
+                               unsigned maxConnections = IO_URING_DEFAULT_CONNECTIONS,
+                               unsigned bufferCount = IO_URING_DEFAULT_BUFFER_COUNT,
+                               unsigned bufferSize = IO_URING_DEFAULT_BUFFER_SIZE);
+
+        IOUringEngine(const IOUringEngine &other) = delete;
+
+        // Destructor. Tears down the ring, which closes every connection still in the fixed file table
+        ~IOUringEngine();
+
+        IOUringEngine &operator=(const IOUringEngine &other) = delete;
+
+        // Returns true if the running kernel supports every io_uring feature the engine needs
+        static bool supported();
+
+        // Set the handler for accepted connections
+        void onAccept(AcceptHandler handler);
+
+        // Set the handler for received messages
+        void onMessage(MessageHandler handler);
+
+        // Set the handler for closed connections
+        void onClose(CloseHandler handler);
+
+        // Set the largest message a connection may send. A connection whose message header gives a larger size
+        // is closed before anything is allocated for the message. Applies to connections opened after the call
+        void setMaxMessageSize(size_t bytes);
+
+        // Start accepting connections from a bound, listening socket
+        void listen(const TCPSocket &listenSocket);
+
+        // Hand a connected socket over to the engine, e.g. one which has just run its connection Protocol. The
+        // socket is installed in a free slot of the fixed file table, then the handler is called with its ID and
+        // its messages arrive through the message handler. The socket's own descriptor is released once it is
+        // installed, so no copy of it may be used after this call. If the table is full the socket is closed
+        // and the handler is not called
+        void adopt(const TCPSocket &socket, AdoptHandler handler = nullptr);
+
+        // Queue a message to be sent on a connection. Messages on the same connection are sent in order
+        void send(ConnectionID connection, MessageBase &&message);
+
+        // Close a connection. The close handler is called once the close has completed
+        void close(ConnectionID connection);
+
+        // Submit all pending operations and wait for at least the given number of completions, then process
+        // every completion available. Returns the number of completions processed
+        size_t poll(unsigned minCompletions = 1);
+
+    private:
+        // Operation
+        // The kind of operation a submission was for, stored in its user data with the connection
+        enum class Operation : unsigned char {
+            ACCEPT,
+            RECEIVE,
+            SEND,
+            SHUTDOWN,
+            CLOSE,
+            INSTALL
+        };
+
+        // Connection
+        // Per connection state, indexed by fixed file slot
+        struct Connection {
+            // Incremented each time the slot is given a new connection, so completions for operations submitted
+            // on behalf of an earlier connection in the slot can be recognised and ignored
+            unsigned generation = 0;
+            // Whether the slot currently holds an open connection
+            bool open = false;
+            // Whether a close has been submitted for the connection
+            bool closing = false;
+            // Whether a send is currently in flight. Only one is submitted at a time to keep messages in order
+            bool sending = false;
+            // Decoder for the message currently being received
+            NetworkMessageDecoder decoder;
+            // Framed messages waiting to be sent. The front message is the one in flight
+            std::deque<NetworkMessage> outbound;
+            // Number of bytes of the front message which have been sent
+            size_t sendOffset = 0;
+        };
+
+        // Adoption
+        // A socket waiting to be installed in the fixed file table
+        struct Adoption {
+            // The socket being installed, held so it stays open until the ring has its own reference
+            TCPSocket socket;
+            // The descriptor to install, which the kernel overwrites with the slot it was installed in
+            int descriptor;
+            // The handler to call once the socket is installed
+            AdoptHandler handler;
+        };
+
+        // Pack an operation, connection and the connection's current generation into submission user data
+        [[nodiscard]] unsigned long long packUserData(Operation operation, ConnectionID connection) const;
+
+        // Submit the close of a connection, removing it from the fixed file table
+        void armClose(ConnectionID connection);
+
+        // Get a submission queue entry, submitting the queue to make room if it is full
+        io_uring_sqe *getSubmission();
+
+        // Submit a multishot accept on the listening socket
+        void armAccept();
+
+        // Submit a multishot receive on a connection
+        void armReceive(ConnectionID connection);
+
+        // Submit the next send for a connection, if it has data waiting and nothing in flight
+        void armSend(ConnectionID connection);
+
+        // Return a receive buffer to the buffer ring
+        void recycleBuffer(unsigned short bufferID);
+
+        // Handle a single completion
+        void complete(const io_uring_cqe *cqe);
+
+        // Handle an accept completion
+        void completeAccept(const io_uring_cqe *cqe);
+
+        // Handle a receive completion
+        void completeReceive(ConnectionID connection, const io_uring_cqe *cqe);
+
+        // Handle a send completion
+        void completeSend(ConnectionID connection, const io_uring_cqe *cqe);
+
+        // Handle the completion of installing an adopted socket
+        void completeInstall(unsigned adoption, const io_uring_cqe *cqe);
+
+        // The ring
+        io_uring ring{};
+
+        // The registered receive buffer ring
+        io_uring_buf_ring *bufferRing = nullptr;
+        // Memory backing the receive buffers
+        std::vector<byte> bufferMemory;
+        // Number of receive buffers
+        unsigned bufferCount;
+        // Size of each receive buffer
+        unsigned bufferSize;
+
+        // State for every slot in the fixed file table
+        std::vector<Connection> connections;
+
+        // The listening socket, held so it stays open while the engine is accepting from it
+        TCPSocket listener;
+
+        // Sockets being installed in the fixed file table, by the identifier their install was submitted with
+        std::unordered_map<unsigned, Adoption> adoptions;
+        // The identifier to give the next adoption
+        unsigned nextAdoption = 0;
+
+        // The largest message a connection may send
+        size_t maxMessageSize = NETWORK_MESSAGE_DEFAULT_MAX_SIZE;
+
+        // Event handlers
+        AcceptHandler acceptHandler;
+        MessageHandler messageHandler;
+        CloseHandler closeHandler;
+
+        // The buffer group the receive buffers are registered under
+        constexpr static unsigned short BufferGroup = 0;
+    };
+
+}
+
+#endif //CONTRACTS_IO_URING
+
+#endif //CONTRACTS_INTERNAL_IOURINGENGINE_H
@@ -10,6 +10,10 @@
 
 #include "buffer.h"
 
+// Largest message body a decoder accepts by default. The size comes from the peer, so without a limit a single
+// header could make the receiver allocate gigabytes
+#define NETWORK_MESSAGE_DEFAULT_MAX_SIZE (64u * 1024u * 1024u)
+
 namespace networking {
 
     class NetworkMessageDecoder;
@@ -112,23 +116,43 @@ namespace networking {
     // Helper class for decoding network messages
     class NetworkMessageDecoder {
     public:
-        NetworkMessageDecoder();
+        // Constructor taking the largest message body the decoder accepts
+        explicit NetworkMessageDecoder(size_t maxMessageSize = NETWORK_MESSAGE_DEFAULT_MAX_SIZE);
 
-        void decodeHeader(const std::array<byte, NetworkMessage::HeaderSize> &header);
+        // Decode the header and size the message buffer. Returns false, allocating nothing and invalidating the
+        // decoder, if the header gives a message larger than the decoder accepts
+        [[nodiscard]] bool decodeHeader(const std::array<byte, NetworkMessage::HeaderSize> &header);
 
         void decodeChunk(const std::array<byte, NetworkMessage::BufferChunkSize> &chunk);
 
+        // Decode from an arbitrary span of received bytes, for callers which do not read the header and chunks
+        // separately. Returns the number of bytes used, which is less than size only once the message is complete
+        // or the decoder has been invalidated by an oversized header, after which it uses nothing more
+        size_t decodeStream(const byte *data, size_t size);
+
+        // Returns true once decodeStream has received the whole message
+        bool streamComplete() const;
+
         bool expectingData() const;
 
         NetworkMessage create();
 
         void invalidate();
 
+        // Returns true if the decoder has been invalidated, e.g. by a header giving an oversized message
+        [[nodiscard]] bool invalid() const;
+
     private:
         byte_buffer buff;
         size_t decoderStep;
         size_t messageSize;
-        bool invalid;
+        size_t maxMessageSize;
+        bool __invalid;
+
+        // Header bytes received so far by decodeStream
+        std::array<byte, NetworkMessage::HeaderSize> streamHeader{};
+        // Total bytes of the message received so far by decodeStream
+        size_t streamOffset = 0;
     };
 
     // Base interface for different message types
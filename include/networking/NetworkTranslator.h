@@ -5,19 +5,249 @@
 #ifndef CONTRACTS_SITE_CLIENT_NETWORKTRANSLATOR_H
 #define CONTRACTS_SITE_CLIENT_NETWORKTRANSLATOR_H
 
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <chrono>
+
 #include "protocol/Protocol.h"
 #include "TCPSocket.h"
+#include "TimerWheel.h"
+
+// The longest a reactor sleeps in select before checking for new connections and shutdown
+#define REACTOR_POLL_INTERVAL std::chrono::milliseconds(10)
+// Size of the buffer each reactor reads connection data into
+#define REACTOR_RECEIVE_BUFFER_SIZE (64u * 1024u)
+// Most reads a reactor makes from one connection each time it is readable, so a fast sender can't starve the rest
+#define REACTOR_READS_PER_WAKE 16
+// Most accepted connections waiting for a handshake thread. Connections beyond this are closed straight away
+#define HANDSHAKE_QUEUE_LIMIT 1024
 
 namespace networking {
 
+    class NetworkTranslator;
+
+    // ServerConnection
+    // A single client connection being served by a NetworkTranslator. Each connection owns its own instance of
+    // the connection protocol, so once the handshake has run, any outputs it produced (e.g. a session key) can be
+    // read back from protocol(). Once its handshake is complete, a connection belongs to the reactor thread which
+    // serves it, and is only handed to the message handler on that thread.
+    class ServerConnection {
+        // Friend the translator so its reactors can manage the connection
+        friend class NetworkTranslator;
+
+    public:
+        ServerConnection(const ServerConnection &other) = delete;
+
+        ServerConnection &operator=(const ServerConnection &other) = delete;
+
+        // Get the socket for this connection. Copies of the socket may queue messages from any thread
+        [[nodiscard]] const TCPSocket &socket() const;
+
+        // Get the protocol instance which ran the handshake for this connection
+        Protocol &protocol();
+
+        // Queue a message to be sent on this connection. The reactor writes it as soon as the socket allows. If
+        // the client is so far behind that the send queue stays over its budget, the connection is closed
+        void send(MessageBase &&message);
+
+        // Close this connection once the current handler returns
+        void close();
+
+        // Returns true if the connection has been closed
+        [[nodiscard]] bool closed() const;
+
+    private:
+        // Private constructor taking the accepted socket
+        explicit ServerConnection(const TCPSocket &socket);
+
+        // Write as much of the send queue as the socket will take, closing the connection if the write fails
+        void flush();
+
+        // The connection socket
+        TCPSocket __socket;
+        // This connection's instance of the connection protocol
+        Protocol __protocol;
+        // Decoder for the message currently arriving on this connection
+        NetworkMessageDecoder decoder;
+        // The timer which closes this connection when it has been idle for too long
+        std::optional<TimerWheel::TimerID> idleTimer;
+        // The timer which closes this connection if the message currently arriving takes too long to complete
+        std::optional<TimerWheel::TimerID> messageTimer;
+        // Whether the connection has been closed
+        bool __closed = false;
+    };
+
+    // NetworkTranslator
+    // Multi reactor server runtime. A single acceptor thread passes new connections to a pool of handshake
+    // threads, which run the connection protocol (e.g. a key exchange) on each one and then hand it out round
+    // robin to a set of reactor threads, each pinned to its own core. The connection protocol blocks, so it is kept
+    // off the reactors, where a slow client would hold up every other connection. A reactor waits on all of its
+    // connections at once, decodes whatever each one has sent without ever waiting for the rest of a message, and
+    // passes every complete message to the message handler. Replies are queued and written by the reactor as the
+    // sockets become writable. Stopping the server stops accepting, then gives the reactors a grace period to
+    // finish writing queued replies before the remaining connections are closed.
     class NetworkTranslator {
     public:
-        void setConnectionProtocol(Protocol &&protocol);
+        // Alias for the function which sets up the connection protocol for a new connection. It is given a
+        // fresh protocol to add its layers to, and the connection socket to feed into them
+        using ProtocolBuilder = std::function<void(Protocol &protocol, const TCPSocket &socket)>;
+        // Alias for the function called with each message received after the connection protocol has completed
+        using MessageHandler = std::function<void(ServerConnection &connection, NetworkMessage &&message)>;
+
+        // Default constructor
+        NetworkTranslator();
+
+        NetworkTranslator(const NetworkTranslator &other) = delete;
+
+        // Destructor. Stops the server if it is still running
+        ~NetworkTranslator();
+
+        NetworkTranslator &operator=(const NetworkTranslator &other) = delete;
+
+        // Set the builder for the protocol run on each new connection
+        void setConnectionProtocol(ProtocolBuilder builder);
+
+        // Set the handler for messages received once the connection protocol has completed
+        void setMessageHandler(MessageHandler handler);
+
+        // Set how long a new connection has to complete the connection protocol
+        void setHandshakeTimeout(std::chrono::milliseconds timeout);
+
+        // Set the number of threads running connection protocols for new connections. Takes effect the next time
+        // the server is started. Zero, the default, uses one per reactor
+        void setHandshakeThreads(unsigned count);
+
+        // Set how long a message may take to arrive in full once its first bytes have been received
+        void setMessageTimeout(std::chrono::milliseconds timeout);
+
+        // Set how long a connection may go without sending a message before it is closed. Zero disables this
+        void setIdleTimeout(std::chrono::milliseconds timeout);
+
+        // Set the largest message a connection may send once its handshake has completed. A connection whose
+        // message header gives a larger size is closed before anything is allocated for the message
+        void setMaxMessageSize(size_t bytes);
+
+        // Start serving on the given port and optionally a specific address, with the given number of reactor
+        // threads. A reactor count of zero uses one reactor per hardware thread
+        void start(unsigned short port, const std::string &host = std::string(), unsigned reactorCount = 0);
+
+        // Stop the server. New connections are refused immediately, and existing connections are closed once
+        // their queued replies are written or the drain timeout passes, whichever is first. Blocks until every
+        // reactor has finished
+        void stop(std::chrono::milliseconds drainTimeout = std::chrono::seconds(5));
+
+        // Returns true if the server is running
+        [[nodiscard]] bool running() const;
+
+        // Get the port the server is listening on. Useful after starting on port 0, which picks a free port
+        [[nodiscard]] unsigned short port() const;
+
+        // Get the number of connections currently being served
+        [[nodiscard]] size_t connectionCount() const;
 
     private:
-        TCPSocket socket;
-        Protocol connectionProtocol;
+        // Reactor
+        // A single event loop thread and the connections it serves
+        struct Reactor {
+            // The event loop thread
+            std::thread thread;
+            // Lock for the inbox
+            std::mutex inboxLock;
+            // Connections which have completed their handshake, waiting to be picked up by the reactor
+            std::vector<std::unique_ptr<ServerConnection>> inbox;
+            // The connections served by this reactor. Reactor thread only
+            std::vector<std::unique_ptr<ServerConnection>> connections;
+            // Idle and message timers for the connections. Reactor thread only
+            TimerWheel timers;
+            // Buffer connection data is read into. Reactor thread only
+            std::vector<byte> receiveBuffer = std::vector<byte>(REACTOR_RECEIVE_BUFFER_SIZE);
+            // Number of connections served by this reactor, readable from any thread
+            std::atomic_size_t connectionCount{0};
+        };
+
+        // Acceptor thread loop, handing new connections to the handshake threads
+        void acceptLoop();
+
+        // Handshake thread loop, running the connection protocol on new connections and handing each one which
+        // completes it out to the reactors
+        void handshakeLoop();
+
+        // Reactor thread loop
+        void reactorLoop(Reactor &reactor);
+
+        // Run the connection protocol on a newly accepted socket. Returns the connection if it completed, or null
+        // if the client failed to complete it in time
+        std::unique_ptr<ServerConnection> handshake(const TCPSocket &socket);
+
+        // Start serving a connection which has completed its handshake on a reactor
+        void adopt(Reactor &reactor, std::unique_ptr<ServerConnection> connection);
+
+        // Decode whatever has arrived on a readable connection, handling each message it completes
+        void handleReadable(Reactor &reactor, ServerConnection &connection);
+
+        // Pass a complete message to the message handler
+        void dispatch(Reactor &reactor, ServerConnection &connection, NetworkMessage &&message);
+
+        // (Re)start the idle timer for a connection
+        void resetIdleTimer(Reactor &reactor, ServerConnection &connection);
+
+        // Remove every closed connection from a reactor
+        void sweepClosed(Reactor &reactor);
+
+        // Pin a thread to a single core. This is best effort - if the platform refuses, the thread is left to
+        // float between cores
+        static void pinThread(std::thread &thread, unsigned core);
+
+        // The listening socket
+        TCPSocket listener;
+        // The acceptor thread
+        std::thread acceptThread;
+        // The reactors
+        std::vector<std::unique_ptr<Reactor>> reactors;
+        // Lock guarding the reactor list while it is filled and cleared, so it can be read from any thread. The
+        // handshake threads only run while the list is fixed, so need not take it
+        mutable std::mutex reactorsLock;
+        // The reactor to give the next connection to, shared by the handshake threads
+        std::atomic_size_t nextReactor{0};
+
+        // The handshake threads
+        std::vector<std::thread> handshakeThreads;
+        // Lock guarding the handshake queue and flag
+        std::mutex handshakeLock;
+        // Notified when a connection is queued for a handshake or the handshake threads should stop
+        std::condition_variable handshakeReady;
+        // Accepted sockets waiting for a handshake thread
+        std::deque<TCPSocket> handshakeQueue;
+        // Whether the handshake threads are running
+        bool handshaking = false;
+        // The number of handshake threads to start, or zero for one per reactor
+        unsigned handshakeThreadCount = 0;
+
+        // The connection protocol builder
+        ProtocolBuilder protocolBuilder;
+        // The message handler
+        MessageHandler messageHandler;
+
+        // Timeouts
+        std::chrono::milliseconds handshakeTimeout = std::chrono::seconds(10);
+        std::chrono::milliseconds messageTimeout = std::chrono::seconds(10);
+        std::chrono::milliseconds idleTimeout = std::chrono::minutes(5);
+
+        // The largest message a connection may send
+        size_t maxMessageSize = NETWORK_MESSAGE_DEFAULT_MAX_SIZE;
 
+        // Whether the acceptor is running
+        std::atomic_bool accepting{false};
+        // Whether the reactors are draining for shutdown
+        std::atomic_bool draining{false};
+        // The point at which draining reactors close their remaining connections. Written before draining is set
+        Deadline drainDeadline;
     };
 
 }
@@ -0,0 +1,90 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#ifndef CONTRACTS_INTERNAL_SENDQUEUE_H
+#define CONTRACTS_INTERNAL_SENDQUEUE_H
+
+#include <atomic>
+
+#include "NetworkMessageV2.h"
+
+#define SEND_QUEUE_BYTE_BUDGET (1u << 20u)
+
+namespace networking {
+
+    // SendQueue
+    // Lock free multi producer, single consumer queue of framed network messages waiting to be written to a
+    // socket. Any number of threads may push messages concurrently, but only a single writer thread may call
+    // front, pop and the write progress methods. The queue tracks the number of bytes it holds and refuses new
+    // messages once this exceeds its byte budget, so producers are held back until the writer catches up.
+    class SendQueue {
+    public:
+        // Constructor taking the byte budget
+        explicit SendQueue(size_t byteBudget = SEND_QUEUE_BYTE_BUDGET);
+
+        SendQueue(const SendQueue &other) = delete;
+
+        // Destructor. Frees any messages which were never sent
+        ~SendQueue();
+
+        SendQueue &operator=(const SendQueue &other) = delete;
+
+        // Attempt to push a message onto the queue. Returns false, leaving the message untouched, if the queue
+        // is already over its byte budget. A message is always accepted by an empty queue, so a single message
+        // larger than the budget can still be sent.
+        bool tryPush(NetworkMessage &&message);
+
+        // Push a message onto the queue, yielding the calling thread until there is room in the budget
+        void push(NetworkMessage &&message);
+
+        // Get the message at the front of the queue, or a null pointer if the queue is empty. Writer only.
+        NetworkMessage *front();
+
+        // Remove the message at the front of the queue. Writer only.
+        void pop();
+
+        // Get the number of bytes of the front message which have already been written. Writer only.
+        size_t frontOffset() const;
+
+        // Record that some more bytes of the front message have been written. Writer only.
+        void advanceFront(size_t bytes);
+
+        // Get the number of bytes currently held in the queue
+        size_t queuedBytes() const;
+
+        // Get the byte budget
+        size_t byteBudget() const;
+
+        // Set the byte budget
+        void setByteBudget(size_t budget);
+
+        // Returns true if there are no messages in the queue
+        bool empty() const;
+
+    private:
+        // Node
+        // Singly linked queue node owning a single message
+        struct Node {
+            // Pointer to the next (newer) node in the queue
+            std::atomic<Node *> next{nullptr};
+            // The message this node holds
+            NetworkMessage message;
+        };
+
+        // The most recently pushed node, swapped by producers
+        alignas(64) std::atomic<Node *> head;
+        // The consumed sentinel node. The front of the queue is always the node after this. Writer only.
+        alignas(64) Node *tail;
+        // Write progress through the front message. Writer only.
+        size_t __frontOffset = 0;
+
+        // Running total of message bytes in the queue
+        alignas(64) std::atomic_size_t bytes{0};
+        // Maximum total number of bytes the queue accepts before producers are held back
+        std::atomic_size_t budget;
+    };
+
+}
+
+#endif //CONTRACTS_INTERNAL_SENDQUEUE_H
@@ -0,0 +1,119 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#ifndef CONTRACTS_INTERNAL_SOCKETMETRICS_H
+#define CONTRACTS_INTERNAL_SOCKETMETRICS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+// Number of shards the socket counters are split over. Each thread counts into one shard, so threads only share
+// a shard once there are more of them than this
+#define SOCKET_METRICS_SHARDS 64
+// Size of a cache line, which each shard is aligned to so threads counting into different shards never contend
+#define SOCKET_METRICS_CACHE_LINE 64
+
+namespace networking {
+
+    // SocketCounter
+    // The events counted by the socket layer
+    enum class SocketCounter {
+        // Bytes written to sockets
+        BytesSent,
+        // Calls to send
+        SendCalls,
+        // Calls to send which wrote less than they were given
+        PartialWrites,
+        // Calls to send which failed
+        SendErrors,
+        // Bytes read from sockets
+        BytesReceived,
+        // Calls to recv
+        ReceiveCalls,
+        // Sockets closed because a receive found the connection reset or errored (e.g. WSAECONNRESET)
+        ResetCloses,
+        // Sockets closed because a receive found the remote had closed the connection
+        EofCloses,
+        // Sockets closed because a message didn't arrive by its deadline
+        TimeoutCloses,
+        // Sockets closed because a message header gave a size larger than the receiver accepts
+        OversizedCloses,
+        // Connections accepted
+        Accepts,
+        // Sockets opened, whether created or accepted
+        SocketsOpened,
+        // Sockets closed
+        SocketsClosed,
+        // Number of counters
+        Count
+    };
+
+    // SocketMetricsSnapshot
+    // The socket counters summed over every thread at a point in time
+    struct SocketMetricsSnapshot {
+        // Get a counter
+        [[nodiscard]] uint64_t operator[](SocketCounter counter) const;
+
+        // Get the rate a counter has increased at per second since an earlier snapshot, e.g. the accept rate. A
+        // counter which has gone down since, because the counters were reset in between, gives a rate of zero
+        [[nodiscard]] double rate(SocketCounter counter, const SocketMetricsSnapshot &earlier) const;
+
+        // Get the number of sockets open, i.e. opened and not yet closed
+        [[nodiscard]] int64_t openSockets() const;
+
+        // Write the counters
+        void dump(std::ostream &out) const;
+
+        // The value of each counter
+        std::array<uint64_t, (size_t) SocketCounter::Count> counters;
+        // The number of TCPSocket objects in existence, including copies sharing a socket and sockets not yet
+        // created
+        int socketObjects;
+        // When the snapshot was taken
+        std::chrono::steady_clock::time_point taken;
+    };
+
+    // SocketMetrics
+    // Counters fed by the socket layer. Each thread counts into a cache line aligned shard of its own with
+    // relaxed atomic adds, so counting takes no locks and threads on different shards never touch the same
+    // cache line; a snapshot sums the shards. Reads see each counter as of some point during the snapshot
+    class SocketMetrics {
+    public:
+        // Add to a counter
+        static inline void add(SocketCounter counter, uint64_t amount = 1) {
+            shard().counters[(size_t) counter].fetch_add(amount, std::memory_order_relaxed);
+        }
+
+        // Sum the counters over every thread
+        [[nodiscard]] static SocketMetricsSnapshot snapshot();
+
+        // Reset every counter to zero, other than the sockets opened and closed
+        static void reset();
+
+    private:
+        // Shard
+        // The counters of the threads assigned to one shard
+        struct alignas(SOCKET_METRICS_CACHE_LINE) Shard {
+            std::array<std::atomic<uint64_t>, (size_t) SocketCounter::Count> counters{};
+        };
+
+        // Get the calling thread's shard
+        static inline Shard &shard() {
+            thread_local Shard &threadShard = shards[nextShard.fetch_add(1, std::memory_order_relaxed) %
+                                                     SOCKET_METRICS_SHARDS];
+            return threadShard;
+        }
+
+        // The shards
+        static std::array<Shard, SOCKET_METRICS_SHARDS> shards;
+        // The shard the next thread to count is given, so threads are spread over the shards in turn
+        static std::atomic<size_t> nextShard;
+    };
+
+}
+
+#endif //CONTRACTS_INTERNAL_SOCKETMETRICS_H
@@ -0,0 +1,302 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#ifndef CONTRACTS_INTERNAL_STREAMMULTIPLEXER_H
+#define CONTRACTS_INTERNAL_STREAMMULTIPLEXER_H
+
+#include <map>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <memory>
+#include <optional>
+#include <condition_variable>
+
+#include "TCPSocket.h"
+#include "NetworkMessageV2.h"
+#include "byteOrder.h"
+
+// Number of bytes each side may send on a stream before the other side grants it more credit
+#define STREAM_INITIAL_WINDOW (256u * 1024u)
+// Largest send window credit may build up to. An honest receiver only ever returns credit for what it has been
+// sent, so credit past this is a broken peer and resets the stream, rather than overflowing the window
+#define STREAM_MAX_WINDOW (1024u * 1024u * 1024u)
+// Largest payload carried by a single frame. Longer messages are split so streams interleave fairly
+#define STREAM_MAX_FRAME_PAYLOAD (16u * 1024u)
+// Largest message which may be sent on a stream. A receiver resets a stream whose message grows past this
+#define STREAM_MAX_MESSAGE_SIZE (64u * 1024u * 1024u)
+// Longest closing the multiplexer waits for frames already queued to be written before closing the connection
+#define STREAM_CLOSE_DRAIN_TIMEOUT std::chrono::seconds(5)
+
+namespace networking {
+
+    class StreamMultiplexer;
+
+    struct StreamLink;
+
+    // Alias for a stream identifier
+    using StreamID = unsigned;
+
+    // Stream
+    // A single logical, bidirectional message stream carried by a StreamMultiplexer. Messages sent on a stream
+    // arrive whole and in order on the matching stream at the other end, independently of every other stream.
+    // Any thread may send on a stream, and any single thread may receive from it. A stream may outlive its
+    // multiplexer, in which case it behaves as if the connection had been lost.
+    class Stream {
+        // Friend the multiplexer and the link so they can deliver frames to the stream
+        friend class StreamMultiplexer;
+        friend struct StreamLink;
+
+    public:
+        Stream(const Stream &other) = delete;
+
+        Stream &operator=(const Stream &other) = delete;
+
+        // Get the identifier of this stream
+        [[nodiscard]] StreamID id() const;
+
+        // Send a message on this stream, blocking while the stream is out of credit. Returns false if the
+        // stream was closed or reset, or the connection lost, before the whole message was sent, or if the message
+        // is larger than STREAM_MAX_MESSAGE_SIZE
+        bool send(const byte *data, size_t size);
+
+        // Send a message on this stream
+        bool send(const byte_buffer &buffer);
+
+        // Receive the next message on this stream. Returns a null optional once the other side has closed the
+        // stream and every message has been received, if the stream is reset or the connection lost, or if the
+        // deadline passes first
+        std::optional<byte_buffer> receive(const std::optional<Deadline> &deadline = std::nullopt);
+
+        // Close this side of the stream, telling the other side no more messages will be sent
+        void close();
+
+        // Abandon the stream in both directions. Messages not yet received are discarded
+        void reset();
+
+    private:
+        // Message
+        // A whole message waiting to be received, with the credit still owed to the sender for it
+        struct Message {
+            byte_buffer data;
+            size_t uncredited;
+        };
+
+        // Alias for the connection state shared with the multiplexer
+        using Link = std::shared_ptr<StreamLink>;
+
+        // Private constructor taking the link to the carrying multiplexer and the stream's identifier
+        Stream(Link link, StreamID id);
+
+        // Abandon the stream, discarding anything received. Requires the stream lock
+        void abandon();
+
+        // The connection this stream is carried on
+        Link link;
+        // The identifier of this stream
+        StreamID __id;
+
+        // Each of the following is guarded by the link's stream lock
+
+        // Number of bytes we may still send before the other side grants more credit
+        size_t sendWindow = STREAM_INITIAL_WINDOW;
+        // Number of bytes the other side may still send before we grant it more credit. A frame beyond this
+        // breaks the flow control agreement, and resets the stream
+        size_t receiveWindow = STREAM_INITIAL_WINDOW;
+        // Whole messages received but not yet taken by receive
+        std::deque<Message> ready;
+        // The message currently being reassembled from frames
+        std::vector<byte> partial;
+        // The credit owed to the sender for the partial message
+        size_t partialUncredited = 0;
+        // Whether we have closed our side of the stream
+        bool localClosed = false;
+        // Whether the other side has closed its side of the stream
+        bool remoteClosed = false;
+        // Whether the stream has been reset by either side
+        bool __reset = false;
+
+        // Notified when a message arrives or the stream ends
+        std::condition_variable readable;
+        // Notified when the stream gains credit or ends
+        std::condition_variable writable;
+    };
+
+    // StreamLink
+    // The connection state shared between a StreamMultiplexer and its streams. Streams hold the link rather than
+    // the multiplexer, so one which outlives its multiplexer finds the connection gone instead of a destroyed object
+    struct StreamLink {
+        // Constructor taking the connection and the key agreed for it
+        StreamLink(const TCPSocket &socket, AESKey key);
+
+        // Build a single frame and queue it for the writer
+        void sendFrame(StreamID id, byte type, byte flags, const byte *payload, size_t size);
+
+        // Grant the other side more credit on a stream. The caller must already have added the credit to the
+        // stream's receive window
+        void grantCredit(StreamID id, size_t credit);
+
+        // Forget a stream once both sides are done with it. Requires the stream lock
+        void retireIfFinished(const Stream &stream);
+
+        // The connection, used to queue frames for the writer. Never modified once constructed, so any thread
+        // may queue through it
+        const TCPSocket socket;
+        // The key for the connection
+        AESKey key;
+
+        // Lock guarding the writer state
+        std::mutex writeLock;
+        // Notified when frames are queued or the writer should stop
+        std::condition_variable writeReady;
+        // Notified when the writer has stopped
+        std::condition_variable writerStopped;
+        // Whether frames have been queued since the writer last flushed
+        bool framesPending = false;
+        // Whether the writer should stop
+        bool stopping = false;
+        // Whether the writer should write everything already queued before it stops
+        bool draining = false;
+        // Whether the writer has stopped
+        bool writerFinished = false;
+
+        // Lock guarding the stream table and every stream's state
+        mutable std::mutex streamLock;
+        // The open streams
+        std::map<StreamID, std::shared_ptr<Stream>> streams;
+        // Whether the connection is open
+        bool connected = true;
+        // Notified when the reader finds the connection has gone
+        std::condition_variable disconnected;
+    };
+
+    // StreamMultiplexer
+    // Carries many concurrent logical streams over a single connection which has already completed a key
+    // exchange, so a client can have several requests in flight without a new connection and handshake for
+    // each. Every frame is sent as its own AESMessage, with a small header giving the stream it belongs to:
+    //      [stream id (4 bytes)][type (1 byte)][flags (1 byte)][reserved (2 bytes)][payload...]
+    // Messages are split into frames of at most STREAM_MAX_FRAME_PAYLOAD bytes, so a large message on one stream
+    // does not hold up the others. Each stream has its own credit window: a sender may only have
+    // STREAM_INITIAL_WINDOW bytes outstanding on a stream until the receiver takes the messages and grants the
+    // credit back, so one slow stream cannot fill the receiver's memory or starve the rest. A reader thread
+    // receives every frame and hands it to its stream, and a writer thread writes out the frames queued by the
+    // streams. The reader only ever queues frames (e.g. credit grants), so it never waits on a write, and two
+    // multiplexers can't deadlock each writing to the other while neither reads.
+    class StreamMultiplexer {
+        // Friend the stream class so it can send frames
+        friend class Stream;
+
+    public:
+        // Role
+        // Which end of the connection this is. Clients open odd numbered streams and servers even numbered
+        // ones, so both sides can open streams without agreeing identifiers first
+        enum class Role {
+            CLIENT,
+            SERVER
+        };
+
+        // Constructor taking the connection, the key agreed for it, and which end of the connection this is.
+        // Starts the reader and writer threads
+        StreamMultiplexer(const TCPSocket &socket, AESKey key, Role role);
+
+        StreamMultiplexer(const StreamMultiplexer &other) = delete;
+
+        // Destructor. Closes the connection and waits for the reader and writer threads. Streams still held
+        // elsewhere end as if the connection had been lost
+        ~StreamMultiplexer();
+
+        StreamMultiplexer &operator=(const StreamMultiplexer &other) = delete;
+
+        // Open a new stream
+        std::shared_ptr<Stream> open();
+
+        // Wait for the other side to open a stream. Returns a null pointer if the connection is lost or the
+        // deadline passes first
+        std::shared_ptr<Stream> accept(const std::optional<Deadline> &deadline = std::nullopt);
+
+        // Close the connection once the frames already queued have been written and the other side has seen them
+        // all, or STREAM_CLOSE_DRAIN_TIMEOUT has passed. Every stream ends, and blocked calls on them return. Waits
+        // for the reader and writer threads to finish, so must not be called from either of them
+        void close();
+
+        // Returns true while the connection is open
+        [[nodiscard]] bool connected() const;
+
+    private:
+        // Friend the link so it can use the frame format
+        friend struct StreamLink;
+
+        // FrameType
+        // The kind of frame
+        enum class FrameType : byte {
+            // A new stream has been opened. Sent in order of stream identifier, before any other frame for it
+            OPEN = 0,
+            // Part of a message
+            DATA = 1,
+            // A grant of credit to send more on the stream
+            WINDOW_UPDATE = 2,
+            // The stream has been abandoned
+            RESET = 3
+        };
+
+        // Flags which may be set on a data frame
+        constexpr static byte EndOfMessage = 0x1;
+        constexpr static byte EndOfStream = 0x2;
+
+        // Size of the frame header
+        constexpr static size_t FrameHeaderSize = sizeof(StreamID) + 4;
+
+        // Reader thread loop, receiving frames until the connection fails or is shut down. Never closes the
+        // socket, as the writer may still be using it
+        void readLoop(TCPSocket connection);
+
+        // Writer thread loop, writing queued frames until told to stop or the connection fails. Never closes the
+        // socket, as the reader may still be using it
+        void writeLoop(TCPSocket connection);
+
+        // Tell the writer thread to stop, optionally once it has written everything already queued
+        void stopWriter(bool drain);
+
+        // Handle an open frame
+        void receiveOpen(StreamID id);
+
+        // Handle a data frame
+        void receiveData(StreamID id, byte flags, const byte *payload, size_t size);
+
+        // Handle a frame which breaks the flow control agreement by resetting its stream. Requires the stream lock,
+        // which is released before the reset is sent
+        void resetViolating(std::unique_lock<std::mutex> &lock, Stream &stream);
+
+        // The connection state shared with the streams
+        std::shared_ptr<StreamLink> link;
+        // Copy of the connection used to shut it down and close it. Copies of a socket share its descriptor, so
+        // this is the only copy ever closed, and only once the reader and writer have finished with it
+        TCPSocket closer;
+        // Lock guarding the closer and the joining of the reader and writer, so only one caller closes
+        std::mutex closeLock;
+        // Which end of the connection this is
+        Role role;
+
+        // Each of the following is guarded by the link's stream lock
+
+        // Streams opened by the other side which have not yet been accepted
+        std::deque<std::shared_ptr<Stream>> acceptQueue;
+        // Notified when a stream is opened by the other side or the connection is lost
+        std::condition_variable acceptable;
+        // The identifier to give the next stream we open
+        StreamID nextID;
+        // The highest identifier of a stream the other side has opened
+        StreamID lastRemoteID = 0;
+        // Why the reader's last receive failed, counted once the connection is closed
+        std::optional<SocketCounter> closeReason;
+
+        // The reader thread
+        std::thread reader;
+        // The writer thread
+        std::thread writer;
+    };
+
+}
+
+#endif //CONTRACTS_INTERNAL_STREAMMULTIPLEXER_H
@@ -5,22 +5,24 @@
 #ifndef CONTRACTS_SITE_CLIENT_TCPSOCKET_H
 #define CONTRACTS_SITE_CLIENT_TCPSOCKET_H
 
-#include <WinSock2.h>
-#include <Windows.h>
-#include <ws2tcpip.h>
-#include <strsafe.h>
-
 #include <string>
 #include <unordered_set>
+#include <unordered_map>
 #include <exception>
 #include <memory>
 #include <atomic>
 #include <optional>
+#include <vector>
+#include <chrono>
 
+#include "platform/socketPlatform.h"
 #include "NetworkMessageV2.h"
+#include "SendQueue.h"
+#include "SocketMetrics.h"
 
 #define BACKLOG_QUEUE_SIZE 8
 #define INVALID_SOCK (SOCKET)(~0ULL)
+#define CORK_FLUSH_THRESHOLD (16u * 1024u)
 
 // Forward declare TCP socket
 namespace networking {
@@ -42,6 +44,11 @@ namespace networking {
 
     struct TCPSocketSet;
 
+    class IOUringEngine;
+
+    // Alias for a point in time by which a socket operation must complete
+    using Deadline = std::chrono::steady_clock::time_point;
+
     // TCPSocket
     // Wraps a low level C socket in a C++ style object
     class TCPSocket {
@@ -49,7 +56,18 @@ namespace networking {
         friend struct TCPSocketSet;
         // Friend the hash struct so it can access the private socket file descriptor
         friend struct std::hash<TCPSocket>;
+        // Friend the io_uring engine so it can submit accepts on the listening file descriptor
+        friend class IOUringEngine;
     public:
+        // ThreadTraffic
+        // Message bytes moved through sockets by a single thread
+        struct ThreadTraffic {
+            // Bytes of framed messages sent or queued
+            unsigned long long sent = 0;
+            // Bytes received
+            unsigned long long received = 0;
+        };
+
         // Default constructor
         TCPSocket();
 
@@ -80,6 +98,9 @@ namespace networking {
         // Bind the socket to a specific port and optionally a specific address
         void bind(unsigned short port, const std::string &host = std::string()) const;
 
+        // Get the port this socket is bound to. After binding to port 0, this is the port the system picked
+        [[nodiscard]] unsigned short localPort() const;
+
         // Connect to a remote socket with an IP address and port. If the IP address string is a hostname,
         // an attempt to resolve the hostname will be made before excepting
         void connect(const std::string &host, unsigned short port) const;
@@ -87,28 +108,122 @@ namespace networking {
         // Set this socket to non blocking mode
         void setNonBlocking();
 
+        // Enable or disable Nagle's algorithm on this socket (TCP_NODELAY). With no delay set, small messages are
+        // written immediately rather than held back waiting for an acknowledgement
+        void setNoDelay(bool noDelay) const;
+
+        // Enable or disable TCP keepalive probes on this socket
+        void setKeepAlive(bool keepAlive) const;
+
+        // Set the size of the kernel send buffer for this socket
+        void setSendBufferSize(int bytes) const;
+
+        // Set the size of the kernel receive buffer for this socket
+        void setReceiveBufferSize(int bytes) const;
+
+        // Cork the socket. While corked, sent messages are coalesced into a single buffer rather than written
+        // individually. The buffer is written when the socket is uncorked, when it grows past
+        // CORK_FLUSH_THRESHOLD, or when this socket is about to block receiving (i.e. the current exchange step
+        // has finished sending). Corks nest, so the socket is only uncorked when every cork has been released.
+        // The cork is shared between copies of this socket but is not synchronised: corking, sending on and
+        // uncorking a socket must all happen on the one thread running the protocol over it.
+        void cork() const;
+
+        // Release a cork on the socket, writing any coalesced messages once the last cork is released
+        void uncork() const;
+
+        // Write any coalesced messages immediately, without releasing the cork. Returns false if the write failed
+        bool flush() const;
+
         // Close the socket
         void close();
 
+        // Stop sending on the socket, leaving it able to receive. The remote reads the end of the connection once
+        // it has read everything already sent. Does nothing if the socket is closed
+        void shutdownSend() const;
+
+        // Shut the connection down in both directions without closing the socket, waking any thread blocked
+        // receiving or sending on it. Does nothing if the socket is closed
+        void shutdown() const;
+
         // Set the socket to listen for incoming connections
         void listen() const;
 
         // Accept an incoming socket connection
         [[nodiscard]] TCPSocket accept() const;
 
-        // Send a message to this remote socket
-        void send(MessageBase &&message) const;
+        // Send a message to this remote socket. Note this writes directly to the socket, so messages sent
+        // concurrently from copies of this socket on different threads may interleave - use queue instead.
+        // Returns false if the message could not be written because the connection has failed. A message held
+        // back by a cork only reports a failure if it is written here because the cork buffer filled up
+        bool send(MessageBase &&message) const;
+
+        // Queue a message to be sent on this socket by the writer thread. May be called from any number of
+        // threads holding copies of this socket. Blocks while the connection's send queue is over its byte budget.
+        // Throws a SocketException if the socket has not been created.
+        void queue(MessageBase &&message) const;
+
+        // Attempt to queue a message to be sent on this socket. Returns false if the connection's send queue
+        // is over its byte budget. Throws a SocketException if the socket has not been created.
+        [[nodiscard]] bool tryQueue(MessageBase &&message) const;
+
+        // Write as much of the send queue to the socket as possible. Must only be called from a single writer
+        // thread, usually once select reports the socket as writable. Returns true if the queue was emptied,
+        // or false if the socket would block with data still waiting. Throws a SocketException if the socket has not
+        // been created.
+        bool flushQueue() const;
+
+        // Wait until this socket has room to write, e.g. after flushQueue returns false. Returns false if the
+        // socket errors while waiting
+        [[nodiscard]] bool waitWritable() const;
+
+        // Returns true if there are messages in the send queue waiting to be written
+        [[nodiscard]] bool hasQueuedData() const;
+
+        // Set the number of bytes the send queue may hold before producers are held back. Throws a SocketException
+        // if the socket has not been created
+        void setSendQueueBudget(size_t bytes) const;
 
         // Receive a message from this remote socket
         [[nodiscard]] NetworkMessage receive();
 
+        // Receive a message from this remote socket, giving up if the whole message has not arrived by the
+        // deadline. A timed out receive is treated like a reset connection: the socket is closed and an invalid
+        // message is returned. A null deadline waits indefinitely.
+        [[nodiscard]] NetworkMessage receive(const std::optional<Deadline> &deadline);
+
+        // Receive a message as above, but leave the socket open if the receive fails, setting closeReason to the
+        // counter for why it failed. For a socket shared between threads, whose owner closes it once no other
+        // thread can be using it
+        [[nodiscard]] NetworkMessage receive(const std::optional<Deadline> &deadline, SocketCounter &closeReason);
+
+        // Read whatever has already arrived on a non blocking socket into the buffer, without waiting, for callers
+        // which decode messages incrementally. Returns the number of bytes read, zero if nothing has arrived yet,
+        // or SOCKET_ERROR if the remote closed the connection or it failed, in which case closeReason is set to
+        // EofCloses or ResetCloses for the caller to count when it closes the socket. The socket is left open
+        // either way
+        long receiveAvailable(byte *data, size_t size, SocketCounter &closeReason) const;
+
 //        RSAMessage receiveRSA() const;
 //
 //        AESMessage receiveAES() const;
 
-        // Select method to check a socket set for sockets ready to read, write and check for exceptions
+        // Select method to check a socket set for sockets ready to read, write and check for exceptions. Waits
+        // with poll, so there is no limit on the number of sockets or on their descriptor values
         static void select(TCPSocketSet &socketSet);
 
+        // Select method which gives up waiting once the timeout has elapsed. Returns false if no socket became
+        // ready in time, including when the wait was interrupted by a signal
+        static bool select(TCPSocketSet &socketSet, std::chrono::microseconds timeout);
+
+        // Get the message bytes the calling thread has sent and received so far, across every socket. Reading
+        // this either side of a piece of work gives the traffic of that work alone
+        static ThreadTraffic threadTraffic();
+
+        // Get the number of socket objects in existence, including copies sharing a socket and sockets not
+        // yet created. See SocketMetrics for the number of sockets actually open
+        static int globalUsage();
+
     private:
         // Invalidate this socket object. Note that as these sockets are copyable, this only invalidates
         // the C++ object, not necessarily the socket itself
@@ -117,17 +232,74 @@ namespace networking {
         // Destroy the actual internal socket
         void destroy();
 
+        // Get the send queue shared by this socket's copies. Throws a SocketException if the socket has none, as
+        // for a default constructed socket or one which has been closed
+        SendQueue &requireSendQueue() const;
+
+        // Receive exactly size bytes into the buffer, looping over partial reads. Returns false if the
+        // connection was reset or closed, or the deadline passed, before the buffer was filled, setting
+        // closeReason to the counter for which of these it was
+        bool receiveExact(byte *data, size_t size, const std::optional<Deadline> &deadline,
+                          SocketCounter &closeReason);
+
+        // Wait until this socket has data to read or the deadline passes. Returns true if the socket is readable
+        [[nodiscard]] bool waitReadable(const std::optional<Deadline> &deadline) const;
+
+        // Write a whole buffer to the socket, looping until all of it has been written. Interrupted writes are
+        // retried, and a non blocking socket with a full send buffer waits until it has room. Returns false if the
+        // socket errors before the whole buffer is written
+        bool sendAll(const byte *data, size_t size) const;
+
+        // CorkState
+        // Coalescing state shared between copies of this socket
+        struct CorkState {
+            // Coalesced message bytes waiting to be written
+            std::vector<byte> buffer;
+            // Number of corks currently held on the socket. Only touched by the thread running the protocol, so
+            // needs no synchronisation
+            int depth = 0;
+        };
+
         // Internal file descriptor for the socket
         std::shared_ptr<SOCKET> sock;
 
         // Shared usage counter for copied sockets. The internal socket will be destroyed when it has no
-        // remaining references
-        std::shared_ptr<int> __useCount;
+        // remaining references. Atomic, as copies may be made and dropped on different threads
+        std::shared_ptr<std::atomic_int> __useCount;
+
+        // Outbound message queue shared between copies of this socket, so any of them may queue messages for
+        // the single writer to send
+        std::shared_ptr<SendQueue> sendQueue;
 
-        // Static management system for global socket reference counting. This allows for the WSA system
-        // to be started up when the first socket is created and cleaned up when all sockets go out of scope.
+        // Coalescing state shared between copies of this socket
+        std::shared_ptr<CorkState> corkState;
+
+        // Static management system for global socket reference counting. This allows for the platform socket
+        // library to be started up when the first socket is created and cleaned up when all sockets go out of scope.
         static std::atomic_int __globalSockUsage;
-        static WSADATA __wsaData;
+
+        // Traffic of each thread. Only ever touched by its own thread, so needs no synchronisation
+        static thread_local ThreadTraffic __threadTraffic;
+    };
+
+    // CorkGuard
+    // Scoped cork for a socket. Corks the socket for the lifetime of the guard, so that every message sent in a
+    // protocol step (e.g. a call to Protocol::execute) leaves in as few segments as possible.
+    class CorkGuard {
+    public:
+        // Constructor corking the given socket
+        explicit CorkGuard(const TCPSocket &socket);
+
+        CorkGuard(const CorkGuard &other) = delete;
+
+        // Destructor uncorking the socket, writing anything still coalesced
+        ~CorkGuard();
+
+        CorkGuard &operator=(const CorkGuard &other) = delete;
+
+    private:
+        // The corked socket
+        TCPSocket socket;
     };
 
     // SocketException
@@ -138,16 +310,22 @@ namespace networking {
         // Constructor taking a string message
         explicit SocketException(const std::string &message);
 
+        // Get the full error message
+        [[nodiscard]] const char *what() const noexcept override;
+
     private:
         // Format the message string into a full error message with the formatted string
         // from the internal socket interface
         [[nodiscard]] static std::string formatMessage(const std::string &userMessage) ;
+
+        // The full error message
+        std::string message;
     };
 
     // TCPSocketSet
-    // Represents a set of sockets which may be used in select calls. Wraps low level C select interface
+    // Represents a set of sockets which may be used in select calls. Wraps the low level C poll interface
     struct TCPSocketSet {
-        // Friend the TCPSocket class so it may access the internal file descriptor sets
+        // Friend the TCPSocket class so it may access the internal poll descriptors
         friend class TCPSocket;
     public:
         // Constructor
@@ -167,7 +345,8 @@ namespace networking {
         // Get the subset of read sockets which are ready to read
         [[nodiscard]] std::unordered_set<TCPSocket> reads() const;
 
-        // Get the subset of write sockets which are ready to write
+        // Get the subset of sockets with queued messages which are ready to write. Sockets with nothing queued
+        // are not watched for writability, as an idle socket is almost always writable
         [[nodiscard]] std::unordered_set<TCPSocket> writes() const;
 
         // Get the subset of exception sockets which are ready to be checked
@@ -175,14 +354,30 @@ namespace networking {
 
         [[nodiscard]] bool acceptReady() const;
 
+        // Returns true if select reported the given socket as ready to read. A socket the remote has hung up is
+        // reported as readable, so the following receive finds the end of the connection
+        [[nodiscard]] bool readReady(const TCPSocket &sock) const;
+
+        // Returns true if select reported the given socket as ready to write
+        [[nodiscard]] bool writeReady(const TCPSocket &sock) const;
+
+        // Returns true if select reported an error on the given socket
+        [[nodiscard]] bool exceptReady(const TCPSocket &sock) const;
+
     private:
-        void buildFDSets();
+        // Build the poll descriptors for the accept socket and every socket in the set
+        void buildDescriptors();
+
+        // Get the events poll reported for a socket, or none if it isn't in the set
+        [[nodiscard]] short readyEvents(SOCKET sock) const;
 
         std::optional<TCPSocket> acceptSocket;
         // Internal sets of socket objects
         std::unordered_set<TCPSocket> sockets;//, writeSockets, exceptSockets;
-        // Internal C interface sets of file descriptors
-        FD_SET readFds{}, writeFds{}, exceptFds{};
+        // Internal C interface poll descriptors, one for each socket
+        std::vector<platform::PollDescriptor> descriptors;
+        // Map from each socket's descriptor to its poll descriptor
+        std::unordered_map<SOCKET, size_t> descriptorIndex;
     };
 
 }
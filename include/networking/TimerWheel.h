@@ -0,0 +1,94 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#ifndef CONTRACTS_INTERNAL_TIMERWHEEL_H
+#define CONTRACTS_INTERNAL_TIMERWHEEL_H
+
+#include <chrono>
+#include <functional>
+#include <list>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#define TIMER_WHEEL_DEFAULT_SLOTS 512
+
+namespace networking {
+
+    // TimerWheel
+    // Hashed timing wheel for tracking large numbers of connection deadlines in an event loop. Scheduling and
+    // cancelling are constant time, and each call to advance only visits the slots for the ticks which have
+    // passed. Timers fire at tick granularity, never early. Not thread safe: a wheel belongs to the event loop
+    // which advances it.
+    class TimerWheel {
+    public:
+        // Alias the clock the wheel runs on
+        using Clock = std::chrono::steady_clock;
+        // Alias the identifier returned for each scheduled timer
+        using TimerID = unsigned long long;
+
+        // Constructor taking the tick length and the number of slots in the wheel
+        explicit TimerWheel(std::chrono::milliseconds tick = std::chrono::milliseconds(10),
+                            size_t slotCount = TIMER_WHEEL_DEFAULT_SLOTS);
+
+        // Schedule a callback to be called once the deadline has passed
+        TimerID schedule(Clock::time_point deadline, std::function<void()> callback);
+
+        // Schedule a callback to be called once the delay has elapsed
+        TimerID schedule(Clock::duration delay, std::function<void()> callback);
+
+        // Cancel a scheduled timer. Returns false if the timer has already fired or been cancelled
+        bool cancel(TimerID id);
+
+        // Advance the wheel to the given time, calling the callback of every timer which has expired.
+        // Callbacks may schedule and cancel timers. Returns the number of timers fired
+        size_t advance(Clock::time_point now = Clock::now());
+
+        // Get the time until the wheel next needs advancing, for use as an event loop's poll timeout.
+        // Returns a null optional if there are no timers scheduled
+        [[nodiscard]] std::optional<Clock::duration> timeUntilNextTick(Clock::time_point now = Clock::now()) const;
+
+        // Get the number of timers currently scheduled
+        [[nodiscard]] size_t size() const;
+
+    private:
+        // Timer
+        // Single scheduled timer in a wheel slot
+        struct Timer {
+            // The identifier of this timer
+            TimerID id;
+            // The number of full turns of the wheel left before this timer fires
+            size_t rounds;
+            // The function to call on expiry
+            std::function<void()> callback;
+        };
+
+        // Alias for a slot of the wheel
+        using Slot = std::list<Timer>;
+
+        // Location of a scheduled timer, for constant time cancellation
+        struct TimerLocation {
+            size_t slot;
+            Slot::iterator timer;
+        };
+
+        // The length of a single tick
+        Clock::duration tick;
+        // The slots of the wheel
+        std::vector<Slot> slots;
+        // Map from each scheduled timer to its location in the wheel
+        std::unordered_map<TimerID, TimerLocation> locations;
+
+        // The time the wheel has been advanced to
+        Clock::time_point currentTime;
+        // The slot for the current time
+        size_t currentSlot = 0;
+
+        // The identifier to give the next timer
+        TimerID nextID = 0;
+    };
+
+}
+
+#endif //CONTRACTS_INTERNAL_TIMERWHEEL_H
@@ -0,0 +1,46 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#ifndef CONTRACTS_INTERNAL_BYTEORDER_H
+#define CONTRACTS_INTERNAL_BYTEORDER_H
+
+#include <cstddef>
+
+#include "buffer.h"
+
+namespace networking {
+
+    // ByteOrder
+    // Byte order tag written into bulk exchange frames so the receiver knows whether it must swap the
+    // elements it has been sent
+    enum class ByteOrder : unsigned char {
+        LITTLE = 0,
+        BIG = 1
+    };
+
+    // Get the byte order of the machine this was compiled for
+    constexpr ByteOrder hostByteOrder() {
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        return ByteOrder::BIG;
+#else
+        // Windows targets (and anything not reporting a byte order) are little endian
+        return ByteOrder::LITTLE;
+#endif
+    }
+
+    // Reverse the bytes of each of the count elements of the given size starting at data, in place.
+    // Element sizes of 2, 4 and 8 use a vectorised shuffle when compiled with SSSE3 or AVX support; any other
+    // size is swapped byte by byte. Elements of size 1 are left untouched.
+    void byteSwapElements(byte *data, size_t count, size_t elementSize);
+
+    // Write the low width bytes of an integer into the buffer in little endian order, whatever the host's order,
+    // for header fields with a fixed wire format
+    void writeLittleEndian(byte *dst, unsigned long long value, size_t width);
+
+    // Read an integer of the given width in bytes, stored in little endian order, from the buffer
+    unsigned long long readLittleEndian(const byte *src, size_t width);
+
+}
+
+#endif //CONTRACTS_INTERNAL_BYTEORDER_H
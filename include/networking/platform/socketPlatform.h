@@ -0,0 +1,87 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#ifndef CONTRACTS_INTERNAL_SOCKETPLATFORM_H
+#define CONTRACTS_INTERNAL_SOCKETPLATFORM_H
+
+#ifdef _WIN32
+#include <WinSock2.h>
+#include <Windows.h>
+#include <ws2tcpip.h>
+#else
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <poll.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+
+// Alias the POSIX file descriptor to the WinSock socket type so the socket code is shared between platforms
+using SOCKET = int;
+
+#define SOCKET_ERROR (-1)
+#endif
+
+#include <cstddef>
+
+#include <string>
+
+namespace networking::platform {
+
+    // Alias the descriptor poll waits on, which holds a socket, the events to wait for and the events which occurred
+#ifdef _WIN32
+    using PollDescriptor = WSAPOLLFD;
+#else
+    using PollDescriptor = pollfd;
+#endif
+
+    // Flags passed to every send call. On POSIX systems this stops a write to a closed connection from raising
+    // SIGPIPE, so the error is reported through the return value as it is on Windows
+#if !defined(_WIN32) && defined(MSG_NOSIGNAL)
+    constexpr int SendFlags = MSG_NOSIGNAL;
+#else
+    constexpr int SendFlags = 0;
+#endif
+
+    // Start up the platform socket library. Called when the first socket object is created
+    void startup();
+
+    // Clean up the platform socket library. Called when the last socket object is destroyed
+    void cleanup();
+
+    // Shut down both directions of a socket
+    int shutdownSocket(SOCKET sock);
+
+    // Shut down the sending direction of a socket, leaving it able to receive
+    int shutdownSend(SOCKET sock);
+
+    // Close a socket, releasing its descriptor
+    int closeSocket(SOCKET sock);
+
+    // Put a socket into non blocking mode. Returns false on failure
+    bool setNonBlocking(SOCKET sock);
+
+    // Get the error code from the last failed socket call on this thread
+    int lastError();
+
+    // Returns true if the error code means the call would have blocked on a non blocking socket
+    bool wouldBlock(int error);
+
+    // Returns true if the error code means the call was interrupted by a signal before it did anything, so it
+    // should simply be made again
+    bool interrupted(int error);
+
+    // Wait for events on a number of sockets, for at most the timeout in milliseconds (or indefinitely if the
+    // timeout is negative). Unlike select, there is no limit on the number of sockets or on their descriptor
+    // values. Returns the number of sockets with events, zero on timeout, or SOCKET_ERROR on failure
+    int poll(PollDescriptor *descriptors, size_t count, int timeoutMillis);
+
+    // Format an error code into a human readable message
+    std::string errorString(int error);
+
+}
+
+#endif //CONTRACTS_INTERNAL_SOCKETPLATFORM_H
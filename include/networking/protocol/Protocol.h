@@ -11,6 +11,8 @@
 #include <memory>
 #include <functional>
 #include <algorithm>
+#include <chrono>
+#include <optional>
 
 #include "CodeProtocols.h"
 #include "layers/KeyExchange.h"
@@ -18,6 +20,7 @@
 #include "layers/AESMessageLayer.h"
 #include "layers/CodeTransferLayer.h"
 #include "layers/PrimitiveExchange.h"
+#include "layers/ArrayExchange.h"
 
 namespace networking {
 
@@ -42,6 +45,25 @@ namespace networking {
         size_t __index;
     };
 
+    // NullProtocolInstrumentation
+    // Instrumentation policy for executing a protocol which measures nothing. The protocol checks enabled at
+    // compile time, so executing with this policy reads no clocks or counters and costs exactly what an
+    // uninstrumented execution does. Any other policy (e.g. ProtocolMetrics) provides the same members:
+    //   layerActivated(layer, duration, bytesSent, bytesReceived) - after each layer is activated, with the time
+    //                                                               taken and the message bytes it moved
+    //   layerTerminated(layer, reason) - when a layer stops the protocol
+    //   executionFinished(completed, duration) - once an execution ends, whether or not it completed
+    struct NullProtocolInstrumentation {
+        static constexpr bool enabled = false;
+
+        void layerActivated(const internal::ProtocolLayer &, std::chrono::steady_clock::duration,
+                            unsigned long long, unsigned long long) {}
+
+        void layerTerminated(const internal::ProtocolLayer &, TerminationReason) {}
+
+        void executionFinished(bool, std::chrono::steady_clock::duration) {}
+    };
+
     // Protocol
     // A layered protocol into which data can be fed, which processes data, and then returns some set of
     // outputs. Works through templated linking of internal mechanisms
@@ -152,6 +174,20 @@ namespace networking {
         // Execute the model. This will call all the linker and activation functions on each layer
         void execute();
 
+        // Execute the model, requiring it to complete within the given timeout. Every layer receives with the
+        // resulting deadline, so a remote which stops sending terminates the protocol (and closes the socket)
+        // instead of blocking forever. Check completed() to see whether the protocol finished in time.
+        void execute(std::chrono::milliseconds timeout);
+
+        // Execute the model, passing the time taken and bytes moved by each layer, and the reason for any
+        // termination, to the instrumentation. The instrumentation is only called from the executing thread
+        template<typename _Instrumentation>
+        void execute(_Instrumentation &instrumentation);
+
+        // Execute the model within the given timeout, passing measurements to the instrumentation
+        template<typename _Instrumentation>
+        void execute(std::chrono::milliseconds timeout, _Instrumentation &instrumentation);
+
         // Clear the current data in the protocol
         void clearData();
 
@@ -170,6 +206,63 @@ namespace networking {
                             const LinkElement &rhs) const;
         };
 
+        // DeadlineGuard
+        // Gives every layer of a protocol a receive deadline for as long as it lives, clearing them again when it
+        // goes out of scope, so a layer which throws doesn't leave its deadline on a later untimed execution
+        class DeadlineGuard {
+        public:
+            // Constructor taking the protocol and the deadline to give its layers
+            DeadlineGuard(Protocol &protocol, std::chrono::steady_clock::time_point deadline);
+
+            DeadlineGuard(const DeadlineGuard &other) = delete;
+
+            DeadlineGuard &operator=(const DeadlineGuard &other) = delete;
+
+            // Destructor. Clears the deadlines
+            ~DeadlineGuard();
+
+        private:
+            // The protocol whose layers have the deadline
+            Protocol &protocol;
+        };
+
+        // ExecutionRecord<_Instrumentation>
+        // Passes the end of an execution to the instrumentation when it goes out of scope, however the execution
+        // ended, so a layer which throws is still counted as a terminated execution. Does nothing for
+        // instrumentation which is not enabled
+        template<typename _Instrumentation>
+        class ExecutionRecord {
+        public:
+            // Constructor taking the protocol being executed and the instrumentation to report to
+            ExecutionRecord(const Protocol &protocol, _Instrumentation &instrumentation);
+
+            ExecutionRecord(const ExecutionRecord &other) = delete;
+
+            ExecutionRecord &operator=(const ExecutionRecord &other) = delete;
+
+            // Destructor. Reports the execution, as completed if the protocol completed
+            ~ExecutionRecord();
+
+        private:
+            // The protocol being executed
+            const Protocol &protocol;
+            // The instrumentation to report to
+            _Instrumentation &instrumentation;
+            // When the execution started
+            std::chrono::steady_clock::time_point start;
+        };
+
+        // Run the activation and linker functions over every layer
+        template<typename _Instrumentation>
+        void executeLayers(_Instrumentation &instrumentation);
+
+        // Activate a single layer. Returns false if the layer terminated the protocol
+        template<typename _Instrumentation>
+        bool activateLayer(size_t layer, _Instrumentation &instrumentation);
+
+        // Set the receive deadline on every layer
+        void setLayerDeadlines(const std::optional<std::chrono::steady_clock::time_point> &deadline);
+
         // Recursive function to add each required link slot to the protocol. This version of the function call
         // is enabled if the head _From slot is from an intermediary layer, not the input layer.
         template<typename _To, typename _From, typename ..._Rest>
@@ -483,6 +576,111 @@ namespace networking {
         addMultiLinks<_To, _Rest...>(index + 1, parameterGroupIndex, restFrom..., layerTo, transform);
     }
 
+    template<typename _Instrumentation>
+    void Protocol::execute(_Instrumentation &instrumentation) {
+        executeLayers(instrumentation);
+    }
+
+    template<typename _Instrumentation>
+    void Protocol::execute(std::chrono::milliseconds timeout, _Instrumentation &instrumentation) {
+        // Give every layer the same absolute deadline, so the timeout covers the whole execution rather than
+        // each receive individually. The deadlines are cleared however the execution ends, so a later untimed
+        // execution isn't affected
+        DeadlineGuard deadlines(*this, std::chrono::steady_clock::now() + timeout);
+
+        executeLayers(instrumentation);
+    }
+
+    template<typename _Instrumentation>
+    Protocol::ExecutionRecord<_Instrumentation>::ExecutionRecord(const Protocol &protocol,
+                                                                 _Instrumentation &instrumentation)
+            : protocol(protocol), instrumentation(instrumentation) {
+        if constexpr (_Instrumentation::enabled) {
+            start = std::chrono::steady_clock::now();
+        }
+    }
+
+    template<typename _Instrumentation>
+    Protocol::ExecutionRecord<_Instrumentation>::~ExecutionRecord() {
+        if constexpr (_Instrumentation::enabled) {
+            instrumentation.executionFinished(protocol.__completed, std::chrono::steady_clock::now() - start);
+        }
+    }
+
+    template<typename _Instrumentation>
+    void Protocol::executeLayers(_Instrumentation &instrumentation) {
+        __completed = false;
+
+        // Reports the execution when this returns or a layer throws
+        ExecutionRecord<_Instrumentation> record(*this, instrumentation);
+
+        // Initialise the current layer to 0
+        size_t currentLayer = 0;
+
+        // Loop over every linker function
+        for (const LinkElement &link : links) {
+            // Get the layer of the current linker function - this is the index of the "from" side of the feed
+            size_t layerID = link.first;
+
+            // If the layer of this link is greater than the current layer, this means that we have executed all of
+            // the linker functions up to layerID. Therefore, we need to activate each layer up to
+            // layerID. The goal is to activate each layer once and only once, in order, and only after it has been
+            // fed all of its inputs. As there is no cyclic feeding, we know that if we have no more links which come
+            // from a layer earlier than layerID, then each layer is ready for activation.
+            if (layerID >= currentLayer) {
+                // Activate each layer from the current layer up to layerID (exclusive)
+                for (size_t l = currentLayer; l <= layerID; l++) {
+                    if (!activateLayer(l, instrumentation)) {
+                        return;
+                    }
+                }
+                // Update the current layer to layer ID + 1
+                currentLayer = layerID + 1;
+            }
+
+            // Call the linker function
+            link.second();
+        }
+
+        // We can see that every layer up to (but not including) currentLayer has been activated from above.
+        // Therefore, we still need to activate the rest of the layers, so for each layer from currentLayer to the
+        // end of the layers list, we activate it.
+        for (size_t l = currentLayer; l < layers.size(); l++) {
+            if (!activateLayer(l, instrumentation)) {
+                return;
+            }
+        }
+
+        __completed = true;
+    }
+
+    template<typename _Instrumentation>
+    bool Protocol::activateLayer(size_t layer, _Instrumentation &instrumentation) {
+        internal::ProtocolLayer &protocolLayer = *layers[layer];
+
+        if constexpr (_Instrumentation::enabled) {
+            // Layers send and receive on the executing thread, so the thread's traffic either side of the
+            // activation is the layer's own
+            TCPSocket::ThreadTraffic before = TCPSocket::threadTraffic();
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+            protocolLayer.activate();
+
+            std::chrono::steady_clock::duration duration = std::chrono::steady_clock::now() - start;
+            TCPSocket::ThreadTraffic after = TCPSocket::threadTraffic();
+            instrumentation.layerActivated(protocolLayer, duration, after.sent - before.sent,
+                                           after.received - before.received);
+        } else {
+            protocolLayer.activate();
+        }
+
+        if (protocolLayer.protocolTerminated()) {
+            instrumentation.layerTerminated(protocolLayer, protocolLayer.terminationReason());
+            return false;
+        }
+        return true;
+    }
+
 }
 
 #endif //CONTRACTS_SITE_CLIENT_PROTOCOL_H
@@ -0,0 +1,127 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#ifndef CONTRACTS_INTERNAL_PROTOCOLMETRICS_H
+#define CONTRACTS_INTERNAL_PROTOCOLMETRICS_H
+
+#include <array>
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <ostream>
+#include <typeindex>
+#include <unordered_map>
+
+#include "protocolInternal.h"
+#include "../../metrics/LatencyHistogram.h"
+
+namespace networking {
+
+    // LayerStats
+    // The measurements of every activation of one type of layer, across every protocol it is used in. Durations
+    // are recorded in nanoseconds. Every member may be updated from any thread
+    struct LayerStats {
+        // Constructor taking the name of the layer type
+        explicit LayerStats(std::string layer);
+
+        // The name of the layer type
+        const std::string layer;
+
+        // The number of times a layer of the type was activated
+        std::atomic<uint64_t> activations{0};
+        // The message bytes sent by its activations
+        std::atomic<uint64_t> bytesSent{0};
+        // The message bytes received by its activations
+        std::atomic<uint64_t> bytesReceived{0};
+        // The number of times it stopped a protocol, for each reason
+        std::array<std::atomic<uint64_t>, TerminationReasonCount> terminations{};
+
+        // Time taken by each activation
+        metrics::LatencyHistogram activate;
+    };
+
+    // LayerReport
+    // A copy of the measurements of one type of layer at a point in time
+    struct LayerReport {
+        std::string layer;
+        uint64_t activations;
+        uint64_t bytesSent;
+        uint64_t bytesReceived;
+        std::array<uint64_t, TerminationReasonCount> terminations;
+        metrics::HistogramSummary activate;
+    };
+
+    // ProtocolReport
+    // A copy of the measurements of every execution and layer at a point in time
+    struct ProtocolReport {
+        // The number of executions which completed
+        uint64_t completed;
+        // The number of executions a layer stopped
+        uint64_t terminated;
+        // Time taken by each execution, whether or not it completed
+        metrics::HistogramSummary executions;
+        // Each type of layer, the slowest in total first
+        std::vector<LayerReport> layers;
+    };
+
+    // ProtocolMetrics
+    // Instrumentation policy for Protocol::execute which measures each type of layer: how long its activations
+    // take, the bytes they move and why they stop protocols. One instance may be shared by any number of
+    // protocols executing on any number of threads, e.g.
+    //   protocol.execute(std::chrono::seconds(5), metrics);
+    // so a connection stuck in a handshake shows up as the layer whose activations are slow or terminating
+    class ProtocolMetrics {
+    public:
+        static constexpr bool enabled = true;
+
+        ProtocolMetrics() = default;
+
+        ProtocolMetrics(const ProtocolMetrics &other) = delete;
+
+        ProtocolMetrics &operator=(const ProtocolMetrics &other) = delete;
+
+        // Record an activation of a layer
+        void layerActivated(const internal::ProtocolLayer &layer, std::chrono::steady_clock::duration duration,
+                            unsigned long long bytesSent, unsigned long long bytesReceived);
+
+        // Record a layer stopping its protocol
+        void layerTerminated(const internal::ProtocolLayer &layer, TerminationReason reason);
+
+        // Record the end of an execution
+        void executionFinished(bool completed, std::chrono::steady_clock::duration duration);
+
+        // Get the measurements of every execution and layer
+        [[nodiscard]] ProtocolReport report() const;
+
+        // Write the measurements of every layer as a table, the slowest in total first
+        void dump(std::ostream &out) const;
+
+        // Forget everything measured so far
+        void reset();
+
+        // Get the name of a termination reason
+        static const char *reasonName(TerminationReason reason);
+
+    private:
+        // Get the measurements of a layer's type, creating them if it hasn't been seen before
+        LayerStats &layerStats(const internal::ProtocolLayer &layer);
+
+        // Lock guarding the layers
+        mutable std::mutex layerLock;
+        // The measurements of each type of layer. These are never removed, so references to them stay valid
+        std::unordered_map<std::type_index, std::unique_ptr<LayerStats>> layers;
+
+        // The number of executions which completed
+        std::atomic<uint64_t> completed{0};
+        // The number of executions a layer stopped
+        std::atomic<uint64_t> terminated{0};
+        // Time taken by each execution
+        metrics::LatencyHistogram executions;
+    };
+
+}
+
+#endif //CONTRACTS_INTERNAL_PROTOCOLMETRICS_H
@@ -0,0 +1,171 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#ifndef CONTRACTS_INTERNAL_ARRAYEXCHANGE_H
+#define CONTRACTS_INTERNAL_ARRAYEXCHANGE_H
+
+#include <vector>
+#include <type_traits>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include "../../TCPSocket.h"
+#include "../../byteOrder.h"
+#include "../protocolInternal.h"
+
+namespace networking {
+
+    // ArrayExchange
+    // Layer for exchanging a contiguous array of trivially copyable values of type _Ty in a single message.
+    // The message is framed as:
+    //      [element count (4 bytes)][element size (2 bytes)][byte order (1 byte)][reserved (1 byte)][elements...]
+    // where the header fields are little endian and the elements are in the byte order given in the header.
+    // The sender always writes its native order, and the receiver swaps the elements only if the orders differ.
+    // Arithmetic elements are swapped as a whole; any other type can only be received from a peer with the
+    // same byte order, as the layout of its fields is unknown. Sending more elements than the count field holds
+    // throws std::length_error.
+    template<typename _Ty>
+    struct ArrayExchange : internal::ProtocolLayer {
+        // Friend the protocol class so it can access internal param method
+        friend class Protocol;
+
+        static_assert(std::is_trivially_copyable_v<_Ty>, "Array exchange elements must be trivially copyable.");
+
+    public:
+        // Create the slot for the values
+        using Values = internal::Connector<0, ArrayExchange<_Ty>, std::vector<_Ty>>;
+        // Create the slot for the socket
+        using Socket = internal::Connector<1, ArrayExchange<_Ty>, TCPSocket>;
+
+        // Size of the frame header preceding the elements
+        constexpr static size_t HeaderSize { sizeof(unsigned) + sizeof(unsigned short) + 2 };
+
+        // Activate the layer
+        void activate() override;
+
+    private:
+        // Anonymous enum for translating the sender and receiver tags
+        enum {
+            SENDER,
+            RECEIVER
+        } role;
+
+        // Constructor for the sender tag
+        explicit ArrayExchange(internal::role_sender_t);
+
+        // Constructor for the receiver tag
+        explicit ArrayExchange(internal::role_receiver_t);
+
+        // Get the specified parameter value at the given slot
+        template<typename _Param>
+        constexpr _Param &param();
+
+        // Values parameter data
+        Values values;
+        // Socket parameter data
+        Socket socket;
+    };
+
+    template<typename _Ty>
+    ArrayExchange<_Ty>::ArrayExchange(internal::role_sender_t)
+            : ProtocolLayer(Sender), role(SENDER) {
+        // Sender constructor - note we set the role enum value to SENDER
+    }
+
+    template<typename _Ty>
+    ArrayExchange<_Ty>::ArrayExchange(internal::role_receiver_t)
+            : ProtocolLayer(Receiver), role(RECEIVER) {
+        // Receiver constructor - note we set the role enum value to RECEIVER
+    }
+
+    template<typename _Ty>
+    void ArrayExchange<_Ty>::activate() {
+        // Switch the activation depending on the role
+        switch (role) {
+            case SENDER: {
+                const std::vector<_Ty> &data = values.get();
+                // The count must fit in its header field, or the receiver would be told of fewer elements than sent
+                if (data.size() > std::numeric_limits<unsigned>::max()) {
+                    throw std::length_error("Too many elements for a single array exchange.");
+                }
+                // Create the send buffer for the header and every element
+                byte_buffer buff(HeaderSize + data.size() * sizeof(_Ty));
+                // Write the header, then copy the elements straight in behind it in native byte order
+                writeLittleEndian(buff.begin(), data.size(), sizeof(unsigned));
+                writeLittleEndian(buff.begin() + sizeof(unsigned), sizeof(_Ty), sizeof(unsigned short));
+                buff.begin()[sizeof(unsigned) + sizeof(unsigned short)] = (byte) hostByteOrder();
+                buff.begin()[sizeof(unsigned) + sizeof(unsigned short) + 1] = 0;
+                if (!data.empty()) {
+                    std::memcpy(buff.begin() + HeaderSize, data.data(), data.size() * sizeof(_Ty));
+                }
+                // Construct a message from the buffer and send it on the socket
+                socket.get().send(std::move(RawMessage(std::move(buff))));
+                break;
+            }
+            case RECEIVER: {
+                // Receive a message from the socket
+                RawMessage valuesMessage(socket.get().receive(receiveDeadline()));
+                if (valuesMessage.invalid()) {
+                    markReceiveFailure();
+                    return;
+                }
+                if (valuesMessage.size() < HeaderSize) {
+                    markProtocolTermination(TerminationReason::MalformedMessage);
+                    return;
+                }
+
+                // Decode the header
+                size_t count = readLittleEndian(valuesMessage.begin(), sizeof(unsigned));
+                size_t elementSize = readLittleEndian(valuesMessage.begin() + sizeof(unsigned),
+                                                      sizeof(unsigned short));
+                ByteOrder order = (ByteOrder) valuesMessage.begin()[sizeof(unsigned) + sizeof(unsigned short)];
+
+                // The frame must describe exactly the elements it carries, and they must be of the type we expect
+                if (elementSize != sizeof(_Ty) || valuesMessage.size() - HeaderSize != count * sizeof(_Ty)) {
+                    markProtocolTermination(TerminationReason::MalformedMessage);
+                    return;
+                }
+                // We only know how to swap the order of whole arithmetic values
+                if (order != hostByteOrder() && !std::is_arithmetic_v<_Ty>) {
+                    markProtocolTermination(TerminationReason::MalformedMessage);
+                    return;
+                }
+
+                // Copy from the message data into the internal values, then fix the byte order if necessary
+                std::vector<_Ty> &data = values.get();
+                data.resize(count);
+                if (count != 0) {
+                    std::memcpy(data.data(), valuesMessage.begin() + HeaderSize, count * sizeof(_Ty));
+                    if (order != hostByteOrder()) {
+                        byteSwapElements((byte *) data.data(), count, sizeof(_Ty));
+                    }
+                }
+                break;
+            }
+        }
+    }
+
+    template<typename _Ty>
+    template<typename _Param>
+    constexpr _Param &ArrayExchange<_Ty>::param() {
+        if constexpr (std::is_same_v<_Param, Values>) {
+            return values;
+        } else {
+            static_assert(std::is_same_v<_Param, Socket>, "Invalid parameter requested from array exchange.");
+            return socket;
+        }
+    }
+
+    // Create aliases for arrays of each of the primitives
+    using Int32ArrayExchange = ArrayExchange<int>;
+    using UInt32ArrayExchange = ArrayExchange<unsigned int>;
+    using Int64ArrayExchange = ArrayExchange<long long>;
+    using UInt64ArrayExchange = ArrayExchange<unsigned long long>;
+    using FloatArrayExchange = ArrayExchange<float>;
+    using DoubleArrayExchange = ArrayExchange<double>;
+
+}
+
+#endif //CONTRACTS_INTERNAL_ARRAYEXCHANGE_H
@@ -5,6 +5,8 @@
 #ifndef CONTRACTS_SITE_CLIENT_CODETRANSFERLAYER_H
 #define CONTRACTS_SITE_CLIENT_CODETRANSFERLAYER_H
 
+#include <type_traits>
+
 #include "../../TCPSocket.h"
 #include "../protocolInternal.h"
 
@@ -32,34 +34,6 @@ namespace networking {
 
         explicit CodeTransferLayer(internal::role_receiver_t);
 
-        template<typename _Param>
-        struct ParameterDelegateSwitch {
-            constexpr static _Param &get(AESSymKey &key, Code &code, Socket &socket) {
-                static_assert(false, "Invalid parameter requested from delegate.");
-            }
-        };
-
-        template<>
-        struct ParameterDelegateSwitch<AESSymKey> {
-            constexpr static AESSymKey &get(AESSymKey &key, Code &code, Socket &socket) {
-                return key;
-            }
-        };
-
-        template<>
-        struct ParameterDelegateSwitch<Code> {
-            constexpr static Code &get(AESSymKey &key, Code &code, Socket &socket) {
-                return code;
-            }
-        };
-
-        template<>
-        struct ParameterDelegateSwitch<Socket> {
-            constexpr static Socket &get(AESSymKey &key, Code &code, Socket &socket) {
-                return socket;
-            }
-        };
-
         template<typename _Param>
         constexpr _Param &param();
 
@@ -90,9 +64,14 @@ namespace networking {
                 break;
             }
             case RECEIVER: {
-                AESMessage aesMessage(socket.get().receive(), key.get());
+                NetworkMessage received = socket.get().receive(receiveDeadline());
+                if (received.invalid()) {
+                    markReceiveFailure();
+                    return;
+                }
+                AESMessage aesMessage(received, key.get());
                 if (aesMessage.invalid()) {
-                    markProtocolTermination();
+                    markProtocolTermination(TerminationReason::MalformedMessage);
                     return;
                 }
                 std::copy(aesMessage.begin(), aesMessage.end(), (byte *) &code.get());
@@ -104,7 +83,16 @@ namespace networking {
     template<typename _EnumType>
     template<typename _Param>
     inline constexpr _Param &CodeTransferLayer<_EnumType>::param() {
-        return ParameterDelegateSwitch<_Param>::get(key, code, socket);
+        // Select the parameter at compile time. Explicitly specialising a member template inside the class
+        // is only accepted by MSVC, so this is resolved with a constexpr branch instead
+        if constexpr (std::is_same_v<_Param, AESSymKey>) {
+            return key;
+        } else if constexpr (std::is_same_v<_Param, Code>) {
+            return code;
+        } else {
+            static_assert(std::is_same_v<_Param, Socket>, "Invalid parameter requested from delegate.");
+            return socket;
+        }
     }
 
 }
@@ -96,9 +96,9 @@ namespace networking {
             }
             case RECEIVER: {
                 // Receive a message from the socket
-                RawMessage valMessage(socket.get().receive());
+                RawMessage valMessage(socket.get().receive(receiveDeadline()));
                 if (valMessage.invalid()) {
-                    markProtocolTermination();
+                    markReceiveFailure();
                     return;
                 }
                 // Copy from the message data into the internal value
@@ -6,6 +6,8 @@
 #define CONTRACTS_SITE_CLIENT_PROTOCOLINTERNAL_H
 
 #include <functional>
+#include <optional>
+#include <chrono>
 
 namespace networking {
 
@@ -15,6 +17,24 @@ namespace networking {
     template<typename _Layer>
     struct LayerReference;
 
+    // TerminationReason
+    // Why a layer stopped its protocol
+    enum class TerminationReason {
+        // The protocol has not been stopped
+        None,
+        // The layer gave no reason
+        Unspecified,
+        // The connection was closed or reset while receiving
+        ConnectionLost,
+        // The deadline passed before a message arrived
+        DeadlineExpired,
+        // A message arrived, but could not be understood
+        MalformedMessage
+    };
+
+    // Number of termination reasons, for tables indexed by reason
+    constexpr size_t TerminationReasonCount = (size_t) TerminationReason::MalformedMessage + 1;
+
     namespace internal {
 
         // role_sender_t
@@ -53,17 +73,39 @@ namespace networking {
             // Default constructor for tagging as Receiver
             ProtocolLayer(role_receiver_t) {};
 
+            // Virtual destructor, as the protocol owns its layers through pointers to this base
+            virtual ~ProtocolLayer() = default;
+
             // Pure virtual activation function. This is called for each layer when the protocol is executed.
             virtual void activate() = 0;
 
-            void markProtocolTermination();
+            // Stop the protocol once this layer's activation returns, giving the reason why
+            void markProtocolTermination(TerminationReason reason = TerminationReason::Unspecified);
 
             bool protocolTerminated() const;
 
+            // Get the reason this layer stopped the protocol, or None if it didn't
+            TerminationReason terminationReason() const;
+
             void reset();
 
+            // Set the point in time by which any receive in this layer must complete. Set by the protocol when
+            // it is executed with a timeout; a null deadline means the layer may wait indefinitely.
+            void setDeadline(const std::optional<std::chrono::steady_clock::time_point> &deadline);
+
+        protected:
+            // Getter for the deadline receiving layers should pass to the socket. If the receive times out, the
+            // socket returns an invalid message and the layer should mark the protocol for termination.
+            const std::optional<std::chrono::steady_clock::time_point> &receiveDeadline() const;
+
+            // Stop the protocol after a receive returned an invalid message, telling apart a receive which ran
+            // out of time from a connection which was lost
+            void markReceiveFailure();
+
         private:
-            bool terminateProtocol = false;
+            TerminationReason termination = TerminationReason::None;
+
+            std::optional<std::chrono::steady_clock::time_point> deadline;
         };
 
         // ParameterValue
@@ -219,16 +261,36 @@ namespace networking {
             using Type = typename InputOrLayerSwitchType<std::is_base_of_v<ProtocolLayer, _Layer>, _Layer>::Type;
         };
 
-        inline void ProtocolLayer::markProtocolTermination() {
-            terminateProtocol = true;
+        inline void ProtocolLayer::markProtocolTermination(TerminationReason reason) {
+            termination = reason == TerminationReason::None ? TerminationReason::Unspecified : reason;
         }
 
         inline bool ProtocolLayer::protocolTerminated() const {
-            return terminateProtocol;
+            return termination != TerminationReason::None;
+        }
+
+        inline TerminationReason ProtocolLayer::terminationReason() const {
+            return termination;
         }
 
         inline void ProtocolLayer::reset() {
-            terminateProtocol = false;
+            termination = TerminationReason::None;
+        }
+
+        inline void ProtocolLayer::setDeadline(const std::optional<std::chrono::steady_clock::time_point> &layerDeadline) {
+            deadline = layerDeadline;
+        }
+
+        inline const std::optional<std::chrono::steady_clock::time_point> &ProtocolLayer::receiveDeadline() const {
+            return deadline;
+        }
+
+        inline void ProtocolLayer::markReceiveFailure() {
+            if (deadline.has_value() && std::chrono::steady_clock::now() >= deadline.value()) {
+                markProtocolTermination(TerminationReason::DeadlineExpired);
+            } else {
+                markProtocolTermination(TerminationReason::ConnectionLost);
+            }
         }
 
         template<typename _Ty>
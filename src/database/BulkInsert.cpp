@@ -0,0 +1,175 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+#include "../../include/database/BulkInsert.h"
+
+using namespace sql;
+
+BulkInsert::BulkInsert(std::string tableName, std::initializer_list<std::string> columnNames)
+        : BulkInsert(std::move(tableName), std::vector<std::string>(columnNames)) {
+
+}
+
+BulkInsert::BulkInsert(std::string tableName, std::vector<std::string> columnNames)
+        : tableName(std::move(tableName)) {
+    for (std::string &name : columnNames) {
+        BulkColumn column;
+        column.name = std::move(name);
+        columns.push_back(std::move(column));
+    }
+}
+
+size_t BulkInsert::rowCount() const {
+    return rows;
+}
+
+void BulkInsert::clear() {
+    truncate(0);
+    rows = 0;
+}
+
+void BulkInsert::impl_addRow(size_t) {
+    // Every value has been added
+}
+
+void BulkInsert::addValue(BulkColumn &column, const std::string &value) {
+    checkType(column, ColumnType::STRING);
+    column.strings.push_back(value);
+    column.nulls.push_back(false);
+}
+
+void BulkInsert::addValue(BulkColumn &column, const char *value) {
+    addValue(column, std::string(value));
+}
+
+void BulkInsert::checkType(BulkColumn &column, ColumnType type) {
+    if (!column.type.has_value()) {
+        column.type = type;
+    } else if (column.type.value() != type) {
+        throw SQLException("Bulk insert value for column " + column.name + " does not match its earlier rows.");
+    }
+}
+
+size_t BulkInsert::boundWidth(ColumnType type) {
+    // Dates are bound as the driver's date structure, which is wider than a columnar date
+    return type == ColumnType::DATE ? sizeof(SQL_DATE_STRUCT) : columnTypeWidth(type);
+}
+
+void BulkInsert::truncate(size_t rowCount) {
+    for (BulkColumn &column : columns) {
+        column.nulls.resize(std::min(column.nulls.size(), rowCount));
+        column.strings.resize(std::min(column.strings.size(), rowCount));
+        if (column.type.has_value()) {
+            column.data.resize(std::min(column.data.size(), rowCount * boundWidth(column.type.value())));
+        }
+        if (rowCount == 0) {
+            // An empty batch may take new types
+            column.type.reset();
+        }
+    }
+}
+
+std::string BulkInsert::statement(const SQLDialect &dialect) const {
+    std::stringstream ss;
+
+    ss << "INSERT INTO " << dialect.quoteIdentifier(tableName) << " (";
+    for (size_t i = 0; i < columns.size(); i++) {
+        ss << (i == 0 ? "" : ", ") << dialect.quoteIdentifier(columns[i].name);
+    }
+    ss << ") VALUES (";
+    for (size_t i = 0; i < columns.size(); i++) {
+        ss << (i == 0 ? "?" : ", ?");
+    }
+    ss << ")";
+
+    return ss.str();
+}
+
+size_t BulkInsert::chunkRows(size_t first) const {
+    // Strings are bound in a fixed width array as wide as the longest in the chunk, so track the longest of
+    // each column as the chunk grows
+    size_t fixedWidth = 0;
+    for (const BulkColumn &column : columns) {
+        fixedWidth += sizeof(SQLLEN);
+        if (column.type.value() != ColumnType::STRING) {
+            fixedWidth += boundWidth(column.type.value());
+        }
+    }
+
+    std::vector<size_t> longest(columns.size(), 0);
+    size_t count = 0;
+    while (first + count < rows) {
+        size_t rowWidth = fixedWidth;
+        for (size_t i = 0; i < columns.size(); i++) {
+            if (columns[i].type.value() == ColumnType::STRING) {
+                rowWidth += std::max(longest[i], columns[i].strings[first + count].size()) + 1;
+            }
+        }
+        // Every chunk takes at least one row, however large
+        if (count != 0 && (count + 1) * rowWidth > BULK_INSERT_BYTE_BUDGET) {
+            break;
+        }
+        for (size_t i = 0; i < columns.size(); i++) {
+            if (columns[i].type.value() == ColumnType::STRING) {
+                longest[i] = std::max(longest[i], columns[i].strings[first + count].size());
+            }
+        }
+        count++;
+    }
+
+    return count;
+}
+
+void BulkInsert::bindChunk(const SQLStatementHandle &statement, size_t first, size_t count,
+                           ChunkBuffers &buffers) const {
+    buffers.indicators.resize(columns.size());
+    buffers.strings.resize(columns.size());
+
+    for (size_t i = 0; i < columns.size(); i++) {
+        const BulkColumn &column = columns[i];
+        ColumnType type = column.type.value();
+        std::vector<SQLLEN> &indicators = buffers.indicators[i];
+        indicators.resize(count);
+
+        SQLPOINTER data;
+        SQLLEN width;
+        SQLULEN columnSize;
+        if (type == ColumnType::STRING) {
+            // Lay the strings out in a fixed width array, each null terminated
+            size_t longest = 0;
+            for (size_t row = 0; row < count; row++) {
+                longest = std::max(longest, column.strings[first + row].size());
+            }
+            width = longest + 1;
+            std::vector<byte> &strings = buffers.strings[i];
+            strings.assign(count * width, 0);
+            for (size_t row = 0; row < count; row++) {
+                const std::string &value = column.strings[first + row];
+                memcpy(strings.data() + row * width, value.data(), value.size());
+                indicators[row] = column.nulls[first + row] ? SQL_NULL_DATA : (SQLLEN) value.size();
+            }
+            data = strings.data();
+            columnSize = std::max<size_t>(longest, 1);
+        } else {
+            // Fixed width values are already laid out as an array, so are bound where they are
+            width = boundWidth(type);
+            data = (SQLPOINTER) (column.data.data() + first * width);
+            for (size_t row = 0; row < count; row++) {
+                indicators[row] = column.nulls[first + row] ? SQL_NULL_DATA : 0;
+            }
+            // Only dates need a column size, which is the length of their yyyy-mm-dd form
+            columnSize = type == ColumnType::DATE ? 10 : 0;
+        }
+
+        SQLRETURN ret = SQLBindParameter(statement.get(), i + 1, SQL_PARAM_INPUT, driverTypeFor(type),
+                                         sqlTypeFor(type), columnSize, 0, data, width, indicators.data());
+        if (ret == SQL_ERROR) {
+            throw statement.getError();
+        }
+    }
+}
@@ -0,0 +1,528 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include <cstring>
+#include <functional>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define COLUMN_COMPUTE_SIMD
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include "../../include/database/ColumnCompute.h"
+
+// Hash given to null key values, which are stored as zero, so they don't group with real zeroes by chance
+#define GROUP_NULL_HASH 0x5bd1e995u
+
+using namespace sql;
+
+// Get the index of the lowest set bit of a non-zero word
+static inline size_t lowestBit(uint64_t word) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return index;
+#else
+    return __builtin_ctzll(word);
+#endif
+}
+
+// Get the number of set bits in a word
+static inline size_t bitCount(uint64_t word) {
+#if defined(_MSC_VER)
+    return __popcnt64(word);
+#else
+    return __builtin_popcountll(word);
+#endif
+}
+
+// Get the word with a bit set for each of the first n rows of a word
+static inline uint64_t firstBits(size_t n) {
+    return n >= 64 ? ~(uint64_t) 0 : ((uint64_t) 1 << n) - 1;
+}
+
+// Get the 64 rows of a null bitmap starting at the given word, with bits past the last row clear
+static inline uint64_t nullWord(const byte *nulls, size_t word, size_t rows) {
+    size_t bytes = std::min<size_t>(8, (rows - word * 64 + 7) / 8);
+    uint64_t bits = 0;
+    for (size_t i = 0; i < bytes; i++) {
+        bits |= (uint64_t) nulls[word * 8 + i] << (8 * i);
+    }
+    return bits & firstBits(rows - word * 64);
+}
+
+// Get the word of rows which should be visited for the given word of a column: those which exist, aren't null
+// and are in the mask
+static inline uint64_t liveWord(const byte *nulls, const RowMask *mask, size_t word, size_t rows) {
+    uint64_t live = firstBits(rows - word * 64);
+    if (nulls != nullptr) {
+        live &= ~nullWord(nulls, word, rows);
+    }
+    if (mask != nullptr) {
+        live &= mask->words()[word];
+    }
+    return live;
+}
+
+// Aggregate a run of values with no gaps. The sum, minimum and maximum are each spread over several
+// accumulators, so each step doesn't wait on the last and the compiler is free to vectorise
+template<typename T>
+static void summariseDense(const T *values, size_t n, ColumnSummary<T> &summary) {
+    using SumType = typename ColumnSummary<T>::SumType;
+    SumType sums[4] = {0, 0, 0, 0};
+    T mins[4] = {summary.min, summary.min, summary.min, summary.min};
+    T maxes[4] = {summary.max, summary.max, summary.max, summary.max};
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        for (size_t lane = 0; lane < 4; lane++) {
+            T value = values[i + lane];
+            sums[lane] += (SumType) value;
+            mins[lane] = value < mins[lane] ? value : mins[lane];
+            maxes[lane] = value > maxes[lane] ? value : maxes[lane];
+        }
+    }
+    for (; i < n; i++) {
+        sums[0] += (SumType) values[i];
+        mins[0] = values[i] < mins[0] ? values[i] : mins[0];
+        maxes[0] = values[i] > maxes[0] ? values[i] : maxes[0];
+    }
+
+    summary.count += n;
+    for (size_t lane = 0; lane < 4; lane++) {
+        summary.sum += sums[lane];
+        summary.min = mins[lane] < summary.min ? mins[lane] : summary.min;
+        summary.max = maxes[lane] > summary.max ? maxes[lane] : summary.max;
+    }
+}
+
+#ifdef COLUMN_COMPUTE_SIMD
+// Compilers won't reorder floating point additions to vectorise a sum, so doubles, which prices are read as, are
+// aggregated two lanes to a register by hand
+template<>
+void summariseDense<double>(const double *values, size_t n, ColumnSummary<double> &summary) {
+    __m128d sum0 = _mm_setzero_pd(), sum1 = _mm_setzero_pd();
+    __m128d min0 = _mm_set1_pd(summary.min), min1 = min0;
+    __m128d max0 = _mm_set1_pd(summary.max), max1 = max0;
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128d a = _mm_loadu_pd(values + i);
+        __m128d b = _mm_loadu_pd(values + i + 2);
+        sum0 = _mm_add_pd(sum0, a);
+        sum1 = _mm_add_pd(sum1, b);
+        min0 = _mm_min_pd(min0, a);
+        min1 = _mm_min_pd(min1, b);
+        max0 = _mm_max_pd(max0, a);
+        max1 = _mm_max_pd(max1, b);
+    }
+
+    alignas(16) double lanes[2];
+    _mm_store_pd(lanes, _mm_add_pd(sum0, sum1));
+    double sum = lanes[0] + lanes[1];
+    _mm_store_pd(lanes, _mm_min_pd(min0, min1));
+    double low = std::min(lanes[0], lanes[1]);
+    _mm_store_pd(lanes, _mm_max_pd(max0, max1));
+    double high = std::max(lanes[0], lanes[1]);
+
+    for (; i < n; i++) {
+        sum += values[i];
+        low = std::min(low, values[i]);
+        high = std::max(high, values[i]);
+    }
+
+    summary.count += n;
+    summary.sum += sum;
+    summary.min = std::min(summary.min, low);
+    summary.max = std::max(summary.max, high);
+}
+#endif
+
+// Build a mask word by word from a test of each row
+template<typename Test>
+static RowMask buildMask(const MaterializedResult &result, size_t column, Test test) {
+    size_t rows = result.rowCount();
+    const byte *nulls = result.nulls(column);
+    RowMask mask(rows);
+
+    for (size_t word = 0; word * 64 < rows; word++) {
+        size_t first = word * 64;
+        size_t n = std::min<size_t>(64, rows - first);
+        // Every row in the word is tested without branching, so the loop can be vectorised
+        uint64_t bits = 0;
+        for (size_t j = 0; j < n; j++) {
+            bits |= (uint64_t) test(first + j) << j;
+        }
+        bits &= liveWord(nulls, nullptr, word, rows);
+        for (; bits != 0; bits &= bits - 1) {
+            mask.set(first + lowestBit(bits));
+        }
+    }
+    return mask;
+}
+
+// Compare two values as given
+template<typename T>
+static inline bool compare(const T &left, Comparison comparison, const T &right) {
+    switch (comparison) {
+        case Comparison::EQUAL:
+            return left == right;
+        case Comparison::NOT_EQUAL:
+            return left != right;
+        case Comparison::LESS:
+            return left < right;
+        case Comparison::LESS_EQUAL:
+            return left <= right;
+        case Comparison::GREATER:
+            return left > right;
+        case Comparison::GREATER_EQUAL:
+            return left >= right;
+    }
+    return false;
+}
+
+// Call a function with a value of the C++ type a column type is stored as, or a string view for strings
+template<typename Function>
+static void visitColumnType(ColumnType type, Function function) {
+    switch (type) {
+        case ColumnType::BOOL:
+            function(bool());
+            break;
+        case ColumnType::INT8:
+            function((signed char) 0);
+            break;
+        case ColumnType::INT16:
+            function((short) 0);
+            break;
+        case ColumnType::INT32:
+            function(0);
+            break;
+        case ColumnType::INT64:
+            function(0ll);
+            break;
+        case ColumnType::FLOAT32:
+            function(0.0f);
+            break;
+        case ColumnType::FLOAT64:
+            function(0.0);
+            break;
+        case ColumnType::DATE:
+            function(ColumnarDate());
+            break;
+        case ColumnType::STRING:
+            function(std::string_view());
+            break;
+    }
+}
+
+// Mix a value into a running hash
+static inline uint64_t mixHash(uint64_t hash, uint64_t value) {
+    hash ^= value + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+    return hash;
+}
+
+RowMask::RowMask(size_t rows, bool selected)
+        : bits((rows + 63) / 64, selected ? ~(uint64_t) 0 : 0), rows(rows) {
+    if (selected && !bits.empty()) {
+        bits.back() &= firstBits(rows - (bits.size() - 1) * 64);
+    }
+}
+
+RowMask RowMask::nonNull(const MaterializedResult &result, size_t column) {
+    size_t rows = result.rowCount();
+    const byte *nulls = result.nulls(column);
+    RowMask mask(rows, true);
+    if (nulls != nullptr) {
+        for (size_t word = 0; word < mask.bits.size(); word++) {
+            mask.bits[word] &= ~nullWord(nulls, word, rows);
+        }
+    }
+    return mask;
+}
+
+size_t RowMask::size() const {
+    return rows;
+}
+
+size_t RowMask::count() const {
+    size_t total = 0;
+    for (uint64_t word : bits) {
+        total += bitCount(word);
+    }
+    return total;
+}
+
+bool RowMask::test(size_t row) const {
+    return (bits.at(row / 64) >> (row % 64)) & 1u;
+}
+
+void RowMask::set(size_t row, bool selected) {
+    uint64_t bit = (uint64_t) 1 << (row % 64);
+    if (selected) {
+        bits.at(row / 64) |= bit;
+    } else {
+        bits.at(row / 64) &= ~bit;
+    }
+}
+
+RowMask &RowMask::operator&=(const RowMask &other) {
+    checkSize(other);
+    for (size_t i = 0; i < bits.size(); i++) {
+        bits[i] &= other.bits[i];
+    }
+    return *this;
+}
+
+RowMask &RowMask::operator|=(const RowMask &other) {
+    checkSize(other);
+    for (size_t i = 0; i < bits.size(); i++) {
+        bits[i] |= other.bits[i];
+    }
+    return *this;
+}
+
+RowMask RowMask::operator~() const {
+    RowMask inverse(rows, true);
+    for (size_t i = 0; i < bits.size(); i++) {
+        inverse.bits[i] &= ~bits[i];
+    }
+    return inverse;
+}
+
+std::vector<uint32_t> RowMask::selectedRows() const {
+    std::vector<uint32_t> selected;
+    selected.reserve(count());
+    for (size_t word = 0; word < bits.size(); word++) {
+        for (uint64_t live = bits[word]; live != 0; live &= live - 1) {
+            selected.push_back(word * 64 + lowestBit(live));
+        }
+    }
+    return selected;
+}
+
+const std::vector<uint64_t> &RowMask::words() const {
+    return bits;
+}
+
+void RowMask::checkSize(const RowMask &other) const {
+    if (other.rows != rows) {
+        throw SQLException("Row masks over different numbers of rows can't be combined.");
+    }
+}
+
+RowMask sql::operator&(RowMask left, const RowMask &right) {
+    left &= right;
+    return left;
+}
+
+RowMask sql::operator|(RowMask left, const RowMask &right) {
+    left |= right;
+    return left;
+}
+
+template<typename T>
+ColumnSummary<T> sql::summarise(const MaterializedResult &result, size_t column, const RowMask *mask) {
+    const T *values = result.values<T>(column);
+    const byte *nulls = result.nulls(column);
+    size_t rows = result.rowCount();
+    if (mask != nullptr && mask->size() != rows) {
+        throw SQLException("Row mask doesn't cover the rows of the result.");
+    }
+
+    ColumnSummary<T> summary;
+    for (size_t word = 0; word * 64 < rows; word++) {
+        size_t first = word * 64;
+        size_t n = std::min<size_t>(64, rows - first);
+        uint64_t live = liveWord(nulls, mask, word, rows);
+
+        if (live == firstBits(n)) {
+            // Every row in the word is wanted, so the vector kernel takes them all at once
+            summariseDense(values + first, n, summary);
+        } else {
+            for (; live != 0; live &= live - 1) {
+                summary.add(values[first + lowestBit(live)]);
+            }
+        }
+    }
+    return summary;
+}
+
+template<typename T>
+RowMask sql::compareColumn(const MaterializedResult &result, size_t column, Comparison comparison, T value) {
+    const T *values = result.values<T>(column);
+    // Switch on the comparison once, outside the loop over the rows
+    switch (comparison) {
+        case Comparison::EQUAL:
+            return buildMask(result, column, [values, value](size_t row) { return values[row] == value; });
+        case Comparison::NOT_EQUAL:
+            return buildMask(result, column, [values, value](size_t row) { return values[row] != value; });
+        case Comparison::LESS:
+            return buildMask(result, column, [values, value](size_t row) { return values[row] < value; });
+        case Comparison::LESS_EQUAL:
+            return buildMask(result, column, [values, value](size_t row) { return values[row] <= value; });
+        case Comparison::GREATER:
+            return buildMask(result, column, [values, value](size_t row) { return values[row] > value; });
+        case Comparison::GREATER_EQUAL:
+            return buildMask(result, column, [values, value](size_t row) { return values[row] >= value; });
+    }
+    return RowMask(result.rowCount());
+}
+
+RowMask sql::compareColumn(const MaterializedResult &result, size_t column, Comparison comparison,
+                           std::string_view value) {
+    return buildMask(result, column, [&result, column, comparison, value](size_t row) {
+        Value<std::string_view> cell = result.get<std::string_view>(row, column);
+        return cell.hasValue() && compare(cell.value(), comparison, value);
+    });
+}
+
+GroupIndex::GroupIndex(const MaterializedResult &result, std::vector<size_t> keyColumns, const RowMask *mask)
+        : result(result), keyColumns(std::move(keyColumns)) {
+    size_t rows = result.rowCount();
+    if (mask != nullptr && mask->size() != rows) {
+        throw SQLException("Row mask doesn't cover the rows of the result.");
+    }
+
+    // Hash every row's key a column at a time, so each pass runs down a single array
+    std::vector<uint64_t> hashes(rows, 0);
+    for (size_t column : this->keyColumns) {
+        visitColumnType(result.columnType(column), [&](auto type) {
+            using T = decltype(type);
+            if constexpr (std::is_same_v<T, std::string_view>) {
+                std::hash<std::string_view> hashString;
+                for (size_t row = 0; row < rows; row++) {
+                    Value<std::string_view> value = result.get<std::string_view>(row, column);
+                    hashes[row] = mixHash(hashes[row], value.hasValue() ? hashString(value.value()) : 0);
+                }
+            } else {
+                // Fixed width values are hashed by their bytes. Nulls are stored as zero, so are marked apart
+                const T *values = result.values<T>(column);
+                for (size_t row = 0; row < rows; row++) {
+                    uint64_t bits = 0;
+                    memcpy(&bits, values + row, sizeof(T));
+                    hashes[row] = mixHash(hashes[row], result.isNull(row, column) ? GROUP_NULL_HASH : bits);
+                }
+            }
+        });
+    }
+
+    // Open addressing table of group numbers, kept at most half full
+    size_t capacity = 16;
+    while (capacity < rows * 2) {
+        capacity *= 2;
+    }
+    std::vector<uint32_t> slots(capacity, NO_GROUP);
+    std::vector<uint64_t> groupHashes;
+
+    groups.assign(rows, NO_GROUP);
+    for (size_t row = 0; row < rows; row++) {
+        if (mask != nullptr && !mask->test(row)) {
+            continue;
+        }
+
+        size_t slot = hashes[row] & (capacity - 1);
+        while (true) {
+            uint32_t group = slots[slot];
+            if (group == NO_GROUP) {
+                // The first row with this key starts a new group
+                group = firstRows.size();
+                slots[slot] = group;
+                firstRows.push_back(row);
+                groupHashes.push_back(hashes[row]);
+                sizes.push_back(0);
+            } else if (groupHashes[group] != hashes[row] || !sameKey(firstRows[group], row)) {
+                slot = (slot + 1) & (capacity - 1);
+                continue;
+            }
+            groups[row] = group;
+            sizes[group]++;
+            break;
+        }
+    }
+}
+
+size_t GroupIndex::groupCount() const {
+    return firstRows.size();
+}
+
+const std::vector<uint32_t> &GroupIndex::rowGroups() const {
+    return groups;
+}
+
+size_t GroupIndex::firstRow(size_t group) const {
+    return firstRows.at(group);
+}
+
+const std::vector<size_t> &GroupIndex::groupSizes() const {
+    return sizes;
+}
+
+template<typename T>
+std::vector<ColumnSummary<T>> GroupIndex::summarise(size_t column) const {
+    const T *values = result.values<T>(column);
+    const byte *nulls = result.nulls(column);
+    size_t rows = result.rowCount();
+    if (groups.size() != rows) {
+        throw SQLException("Result has changed since it was grouped.");
+    }
+
+    std::vector<ColumnSummary<T>> summaries(groupCount());
+    for (size_t word = 0; word * 64 < rows; word++) {
+        size_t first = word * 64;
+        for (uint64_t live = liveWord(nulls, nullptr, word, rows); live != 0; live &= live - 1) {
+            size_t row = first + lowestBit(live);
+            if (groups[row] != NO_GROUP) {
+                summaries[groups[row]].add(values[row]);
+            }
+        }
+    }
+    return summaries;
+}
+
+bool GroupIndex::sameKey(size_t a, size_t b) const {
+    for (size_t column : keyColumns) {
+        bool aNull = result.isNull(a, column), bNull = result.isNull(b, column);
+        if (aNull || bNull) {
+            if (aNull != bNull) {
+                return false;
+            }
+            continue;
+        }
+
+        bool same = true;
+        visitColumnType(result.columnType(column), [&](auto type) {
+            using T = decltype(type);
+            if constexpr (std::is_same_v<T, std::string_view>) {
+                same = result.get<std::string_view>(a, column).value() ==
+                       result.get<std::string_view>(b, column).value();
+            } else {
+                const T *values = result.values<T>(column);
+                same = memcmp(values + a, values + b, sizeof(T)) == 0;
+            }
+        });
+        if (!same) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Instantiate the kernels for every numeric column type
+#define COLUMN_COMPUTE_INSTANTIATE(T) \
+    template ColumnSummary<T> sql::summarise<T>(const MaterializedResult &, size_t, const RowMask *); \
+    template RowMask sql::compareColumn<T>(const MaterializedResult &, size_t, Comparison, T); \
+    template std::vector<ColumnSummary<T>> GroupIndex::summarise<T>(size_t) const;
+
+COLUMN_COMPUTE_INSTANTIATE(bool)
+COLUMN_COMPUTE_INSTANTIATE(signed char)
+COLUMN_COMPUTE_INSTANTIATE(short)
+COLUMN_COMPUTE_INSTANTIATE(int)
+COLUMN_COMPUTE_INSTANTIATE(long long)
+COLUMN_COMPUTE_INSTANTIATE(float)
+COLUMN_COMPUTE_INSTANTIATE(double)
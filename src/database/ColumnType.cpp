@@ -0,0 +1,102 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include "../../include/database/ColumnType.h"
+
+using namespace sql;
+
+ColumnType sql::columnTypeFor(SQLSMALLINT sqlType) {
+    switch (sqlType) {
+        case SQL_BIT:
+            return ColumnType::BOOL;
+        case SQL_TINYINT:
+            // TINYINT is unsigned on some databases (e.g. SQL Server's 0 to 255) and signed on others, so it is
+            // widened to hold either
+        case SQL_SMALLINT:
+            return ColumnType::INT16;
+        case SQL_INTEGER:
+            return ColumnType::INT32;
+        case SQL_BIGINT:
+            return ColumnType::INT64;
+        case SQL_REAL:
+            return ColumnType::FLOAT32;
+        case SQL_FLOAT:
+        case SQL_DOUBLE:
+        case SQL_NUMERIC:
+        case SQL_DECIMAL:
+            // Decimals are read as doubles, so prices can be summed, sorted and compared as numbers. A double
+            // holds 15 significant digits exactly, which covers every price column, but wider decimals are rounded
+            return ColumnType::FLOAT64;
+        case SQL_TYPE_DATE:
+        case SQL_DATE:
+            return ColumnType::DATE;
+        default:
+            return ColumnType::STRING;
+    }
+}
+
+size_t sql::columnTypeWidth(ColumnType type) {
+    switch (type) {
+        case ColumnType::BOOL:
+        case ColumnType::INT8:
+            return 1;
+        case ColumnType::INT16:
+            return 2;
+        case ColumnType::INT32:
+        case ColumnType::FLOAT32:
+        case ColumnType::DATE:
+            return 4;
+        case ColumnType::INT64:
+        case ColumnType::FLOAT64:
+            return 8;
+        default:
+            return 0;
+    }
+}
+
+SQLSMALLINT sql::driverTypeFor(ColumnType type) {
+    switch (type) {
+        case ColumnType::BOOL:
+            return SQL_C_BIT;
+        case ColumnType::INT8:
+            return SQL_C_STINYINT;
+        case ColumnType::INT16:
+            return SQL_C_SSHORT;
+        case ColumnType::INT32:
+            return SQL_C_SLONG;
+        case ColumnType::INT64:
+            return SQL_C_SBIGINT;
+        case ColumnType::FLOAT32:
+            return SQL_C_FLOAT;
+        case ColumnType::FLOAT64:
+            return SQL_C_DOUBLE;
+        case ColumnType::DATE:
+            return SQL_C_TYPE_DATE;
+        default:
+            return SQL_C_CHAR;
+    }
+}
+
+SQLSMALLINT sql::sqlTypeFor(ColumnType type) {
+    switch (type) {
+        case ColumnType::BOOL:
+            return SQL_BIT;
+        case ColumnType::INT8:
+            return SQL_TINYINT;
+        case ColumnType::INT16:
+            return SQL_SMALLINT;
+        case ColumnType::INT32:
+            return SQL_INTEGER;
+        case ColumnType::INT64:
+            return SQL_BIGINT;
+        case ColumnType::FLOAT32:
+            return SQL_REAL;
+        case ColumnType::FLOAT64:
+            return SQL_DOUBLE;
+        case ColumnType::DATE:
+            return SQL_TYPE_DATE;
+        default:
+            return SQL_VARCHAR;
+    }
+}
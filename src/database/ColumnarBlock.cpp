@@ -0,0 +1,395 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include <cstring>
+#include <limits>
+#include <algorithm>
+
+#include "../../include/database/ColumnarBlock.h"
+
+using namespace sql;
+
+// Size of the fixed header at the start of every block
+#define COLUMNAR_HEADER_SIZE 16
+// Size of the fixed part of each column's schema entry, before its name
+#define COLUMNAR_SCHEMA_ENTRY_SIZE 8
+
+// Read an unsigned integer of the given width written in the given byte order
+static unsigned long long readInteger(const byte *src, size_t width, networking::ByteOrder order) {
+    unsigned long long value = 0;
+    for (size_t i = 0; i < width; i++) {
+        size_t shift = order == networking::ByteOrder::LITTLE ? i : width - 1 - i;
+        value |= (unsigned long long) src[i] << (8 * shift);
+    }
+    return value;
+}
+
+void ColumnBuffer::reset(ColumnDescription columnDescription) {
+    type = columnTypeFor(columnDescription.sqlType);
+    description = std::move(columnDescription);
+    nulls.clear();
+    data.clear();
+    offsets.clear();
+    offsets.push_back(0);
+}
+
+void ColumnBuffer::read(const QueryResult &result, size_t index, size_t row) {
+    // Grow the null bitmap a byte at a time
+    if (description.nullable && row % 8 == 0) {
+        nulls.push_back(0);
+    }
+
+    if (type == ColumnType::STRING) {
+        readString(result, index, row);
+    } else {
+        readFixed(result, index, row);
+    }
+}
+
+bool ColumnBuffer::isNull(size_t row) const {
+    return !nulls.empty() && (nulls[row / 8] & (1u << (row % 8))) != 0;
+}
+
+std::string_view ColumnBuffer::string(size_t row) const {
+    return std::string_view((const char *) data.data() + offsets[row], offsets[row + 1] - offsets[row]);
+}
+
+void ColumnBuffer::readFixed(const QueryResult &result, size_t index, size_t row) {
+    size_t width = columnTypeWidth(type);
+    size_t offset = data.size();
+    data.resize(offset + width);
+
+    SQLRETURN ret;
+    SQLLEN length;
+    if (type == ColumnType::DATE) {
+        // The driver's date structure is wider than ours, so read it aside and narrow it
+        SQL_DATE_STRUCT date;
+        ret = result.getData(index, SQL_C_TYPE_DATE, &date, (SQLLEN) sizeof(SQL_DATE_STRUCT), &length);
+        ColumnarDate narrow{(int16_t) date.year, (uint8_t) date.month, (uint8_t) date.day};
+        memcpy(data.data() + offset, &narrow, sizeof(ColumnarDate));
+    } else {
+        ret = result.getData(index, driverTypeFor(type), data.data() + offset, (SQLLEN) width, &length);
+    }
+
+    if (ret == SQL_ERROR) {
+        throw result.sqlStatementHandle.getError();
+    }
+    if (length == SQL_NULL_DATA) {
+        memset(data.data() + offset, 0, width);
+        setNull(row);
+    }
+}
+
+void ColumnBuffer::readString(const QueryResult &result, size_t index, size_t row) {
+    size_t start = data.size();
+
+    // Read the value in pieces, sizing each piece by what the driver says is left where it can tell us. Every
+    // piece is null terminated by the driver, and the terminator is overwritten by the next piece
+    size_t chunk = std::clamp<size_t>(description.size + 1, 16, COLUMNAR_STRING_CHUNK);
+    while (true) {
+        size_t offset = data.size();
+        data.resize(offset + chunk);
+
+        SQLLEN length;
+        SQLRETURN ret = result.getData(index, SQL_C_CHAR, data.data() + offset, (SQLLEN) chunk, &length);
+
+        if (ret == SQL_ERROR) {
+            throw result.sqlStatementHandle.getError();
+        }
+        if (ret == SQL_NO_DATA) {
+            // The previous piece was the last
+            data.resize(offset);
+            break;
+        }
+        if (length == SQL_NULL_DATA) {
+            data.resize(start);
+            setNull(row);
+            break;
+        }
+        if (ret == SQL_SUCCESS) {
+            data.resize(offset + std::min<size_t>(length, chunk - 1));
+            break;
+        }
+
+        // The piece was truncated, so keep all but its terminator and go back for the rest
+        data.resize(offset + chunk - 1);
+        if (length != SQL_NO_TOTAL) {
+            chunk = std::max<size_t>(length - (chunk - 1) + 1, 2);
+        }
+    }
+
+    if (data.size() > std::numeric_limits<uint32_t>::max()) {
+        throw SQLException("Column string data is too large.");
+    }
+    offsets.push_back(data.size());
+}
+
+void ColumnBuffer::setNull(size_t row) {
+    if (!description.nullable) {
+        // The driver told us the column could never be null, so there is nowhere to record it
+        throw SQLException("Null value in a column described as not nullable: " + description.name);
+    }
+    nulls[row / 8] |= (byte) (1u << (row % 8));
+}
+
+ColumnarBlockEncoder::ColumnarBlockEncoder() = default;
+
+void ColumnarBlockEncoder::beginBlock(const QueryResult &result) {
+    std::vector<ColumnDescription> descriptions = result.describeColumns();
+
+    // Keep the buffers from the last block, so their memory is reused
+    columnBuffers.resize(descriptions.size());
+    for (size_t i = 0; i < descriptions.size(); i++) {
+        columnBuffers[i].reset(std::move(descriptions[i]));
+    }
+    rows = 0;
+}
+
+void ColumnarBlockEncoder::addRow(const QueryResult &result) {
+    for (size_t i = 0; i < columnBuffers.size(); i++) {
+        columnBuffers[i].read(result, i, rows);
+    }
+    rows++;
+}
+
+size_t ColumnarBlockEncoder::blockSize() const {
+    size_t size = COLUMNAR_HEADER_SIZE;
+    for (const ColumnBuffer &column : columnBuffers) {
+        size += COLUMNAR_SCHEMA_ENTRY_SIZE + column.description.name.size();
+        size += column.nulls.size() + column.data.size();
+        if (column.type == ColumnType::STRING) {
+            size += column.offsets.size() * sizeof(uint32_t);
+        }
+    }
+    return size;
+}
+
+byte_buffer ColumnarBlockEncoder::finishBlock() {
+    // Work out the size of the block first, so it can be written into a single buffer
+    size_t schemaSize = 0;
+    size_t columnsSize = 0;
+    for (const ColumnBuffer &column : columnBuffers) {
+        schemaSize += COLUMNAR_SCHEMA_ENTRY_SIZE + column.description.name.size();
+        columnsSize += align(column.nulls.size()) + align(column.data.size());
+        if (column.type == ColumnType::STRING) {
+            columnsSize += align(column.offsets.size() * sizeof(uint32_t));
+        }
+    }
+
+    // The buffer starts zeroed, so padding and reserved bytes need not be written
+    byte_buffer block(COLUMNAR_HEADER_SIZE + align(schemaSize) + columnsSize);
+    byte *out = block.begin();
+
+    uint32_t columnCount = columnBuffers.size();
+    uint32_t rowCount = rows;
+    out[0] = COLUMNAR_BLOCK_VERSION;
+    out[1] = (byte) networking::hostByteOrder();
+    memcpy(out + 4, &columnCount, sizeof(uint32_t));
+    memcpy(out + 8, &rowCount, sizeof(uint32_t));
+    out += COLUMNAR_HEADER_SIZE;
+
+    byte *schemaStart = out;
+    for (const ColumnBuffer &column : columnBuffers) {
+        int16_t sqlType = column.description.sqlType;
+        uint32_t nameLength = column.description.name.size();
+        out[0] = (byte) column.type;
+        out[1] = column.description.nullable ? 1 : 0;
+        memcpy(out + 2, &sqlType, sizeof(int16_t));
+        memcpy(out + 4, &nameLength, sizeof(uint32_t));
+        memcpy(out + COLUMNAR_SCHEMA_ENTRY_SIZE, column.description.name.data(), nameLength);
+        out += COLUMNAR_SCHEMA_ENTRY_SIZE + nameLength;
+    }
+    out = schemaStart + align(schemaSize);
+
+    // Copy a column's buffer into its section
+    auto writeSection = [&out](const void *src, size_t size) {
+        if (size != 0) {
+            memcpy(out, src, size);
+        }
+        out += align(size);
+    };
+
+    for (const ColumnBuffer &column : columnBuffers) {
+        writeSection(column.nulls.data(), column.nulls.size());
+        if (column.type == ColumnType::STRING) {
+            writeSection(column.offsets.data(), column.offsets.size() * sizeof(uint32_t));
+        }
+        writeSection(column.data.data(), column.data.size());
+    }
+
+    return block;
+}
+
+size_t ColumnarBlockEncoder::align(size_t size) {
+    return (size + COLUMNAR_BLOCK_ALIGNMENT - 1) / COLUMNAR_BLOCK_ALIGNMENT * COLUMNAR_BLOCK_ALIGNMENT;
+}
+
+ColumnarBlockReader::ColumnarBlockReader(byte *data, size_t size) {
+    auto malformed = []() {
+        return SQLException("Malformed columnar block.");
+    };
+
+    if ((uintptr_t) data % COLUMNAR_BLOCK_ALIGNMENT != 0) {
+        throw SQLException("Columnar block is not aligned.");
+    }
+    if (size < COLUMNAR_HEADER_SIZE || data[0] != COLUMNAR_BLOCK_VERSION ||
+        data[1] > (byte) networking::ByteOrder::BIG) {
+        throw malformed();
+    }
+
+    networking::ByteOrder order = (networking::ByteOrder) data[1];
+    bool swap = order != networking::hostByteOrder();
+    size_t columnCount = readInteger(data + 4, 4, order);
+    rows = readInteger(data + 8, 4, order);
+
+    // Every column takes at least a schema entry, so a count the block can't hold is rejected before anything is
+    // allocated for it
+    if (columnCount > (size - COLUMNAR_HEADER_SIZE) / COLUMNAR_SCHEMA_ENTRY_SIZE) {
+        throw malformed();
+    }
+
+    // Read the schema, checking every section lies inside the block as we go
+    byte *end = data + size;
+    byte *in = data + COLUMNAR_HEADER_SIZE;
+    byte *schemaStart = in;
+    columns.resize(columnCount);
+    for (ColumnView &column : columns) {
+        if ((size_t) (end - in) < COLUMNAR_SCHEMA_ENTRY_SIZE) {
+            throw malformed();
+        }
+        column.type = (ColumnType) in[0];
+        if (column.type > ColumnType::STRING) {
+            throw malformed();
+        }
+        column.nullable = in[1] != 0;
+        column.sqlType = (SQLSMALLINT) (int16_t) readInteger(in + 2, 2, order);
+        size_t nameLength = readInteger(in + 4, 4, order);
+        in += COLUMNAR_SCHEMA_ENTRY_SIZE;
+        if ((size_t) (end - in) < nameLength) {
+            throw malformed();
+        }
+        column.name = std::string_view((const char *) in, nameLength);
+        in += nameLength;
+    }
+    size_t schemaSize = in - schemaStart;
+    in = schemaStart + (schemaSize + COLUMNAR_BLOCK_ALIGNMENT - 1) / COLUMNAR_BLOCK_ALIGNMENT *
+                       COLUMNAR_BLOCK_ALIGNMENT;
+
+    // Take a section of the given size, returning a pointer to its start
+    auto section = [&](size_t sectionSize) {
+        size_t padded = (sectionSize + COLUMNAR_BLOCK_ALIGNMENT - 1) / COLUMNAR_BLOCK_ALIGNMENT *
+                        COLUMNAR_BLOCK_ALIGNMENT;
+        if ((size_t) (end - in) < padded) {
+            throw malformed();
+        }
+        byte *start = in;
+        in += padded;
+        return start;
+    };
+
+    for (ColumnView &column : columns) {
+        column.nulls = column.nullable ? section((rows + 7) / 8) : nullptr;
+
+        if (column.type == ColumnType::STRING) {
+            byte *offsets = section((rows + 1) * sizeof(uint32_t));
+            if (swap) {
+                networking::byteSwapElements(offsets, rows + 1, sizeof(uint32_t));
+            }
+            column.offsets = reinterpret_cast<const uint32_t *>(offsets);
+            // Offsets must never decrease, or a string view could reach outside the block
+            for (size_t row = 0; row < rows; row++) {
+                if (column.offsets[row] > column.offsets[row + 1]) {
+                    throw malformed();
+                }
+            }
+            column.data = section(column.offsets[rows]);
+        } else {
+            size_t width = columnTypeWidth(column.type);
+            byte *values = section(rows * width);
+            if (swap && column.type == ColumnType::DATE) {
+                // Only the year of a date is wider than a byte
+                for (size_t row = 0; row < rows; row++) {
+                    networking::byteSwapElements(values + row * sizeof(ColumnarDate), 1, sizeof(int16_t));
+                }
+            } else if (swap) {
+                networking::byteSwapElements(values, rows, width);
+            }
+            column.data = values;
+            column.offsets = nullptr;
+        }
+    }
+
+    // Mark the block as now being in our byte order, so reading it again doesn't swap it back
+    data[1] = (byte) networking::hostByteOrder();
+}
+
+ColumnarBlockReader::ColumnarBlockReader(byte_buffer &block)
+        : ColumnarBlockReader(block.begin(), block.size()) {
+
+}
+
+size_t ColumnarBlockReader::rowCount() const {
+    return rows;
+}
+
+size_t ColumnarBlockReader::columnCount() const {
+    return columns.size();
+}
+
+std::string_view ColumnarBlockReader::columnName(size_t column) const {
+    return columns.at(column).name;
+}
+
+ColumnType ColumnarBlockReader::columnType(size_t column) const {
+    return columns.at(column).type;
+}
+
+SQLSMALLINT ColumnarBlockReader::sqlType(size_t column) const {
+    return columns.at(column).sqlType;
+}
+
+bool ColumnarBlockReader::isNull(size_t column, size_t row) const {
+    const byte *nulls = columns.at(column).nulls;
+    return nulls != nullptr && (nulls[row / 8] & (1u << (row % 8))) != 0;
+}
+
+std::string_view ColumnarBlockReader::string(size_t column, size_t row) const {
+    const ColumnView &view = checkedColumn(column, ColumnType::STRING);
+    return std::string_view((const char *) view.data + view.offsets[row], view.offsets[row + 1] - view.offsets[row]);
+}
+
+const ColumnarBlockReader::ColumnView &ColumnarBlockReader::checkedColumn(size_t column, ColumnType type) const {
+    const ColumnView &view = columns.at(column);
+    if (view.type != type) {
+        throw SQLException("Columnar block column " + std::string(view.name) + " read as the wrong type.");
+    }
+    return view;
+}
+
+template<>
+Value<std::string_view> ColumnarBlockReader::get<std::string_view>(size_t column, size_t row) const {
+    std::string_view value = string(column, row);
+    if (isNull(column, row)) {
+        return null_value;
+    }
+    return value;
+}
+
+template<>
+Value<std::string> ColumnarBlockReader::get<std::string>(size_t column, size_t row) const {
+    std::string_view value = string(column, row);
+    if (isNull(column, row)) {
+        return null_value;
+    }
+    return std::string(value);
+}
+
+template<>
+Value<Date> ColumnarBlockReader::get<Date>(size_t column, size_t row) const {
+    const ColumnarDate *dates = values<ColumnarDate>(column);
+    if (isNull(column, row)) {
+        return null_value;
+    }
+    return Date(dates[row].year, dates[row].month, dates[row].day);
+}
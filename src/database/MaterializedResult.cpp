@@ -0,0 +1,326 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <tuple>
+#include <algorithm>
+
+#include "../../include/database/MaterializedResult.h"
+
+using namespace sql;
+
+// Stable sort row indices by a column, given a comparison of the values at two rows. Nulls sort lowest
+template<typename Less>
+static void sortRows(std::vector<uint32_t> &order, const ColumnBuffer &column, OrderDirection direction,
+                     Less less) {
+    bool ascending = direction == OrderDirection::ASC;
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        bool aNull = column.isNull(a), bNull = column.isNull(b);
+        if (aNull || bNull) {
+            return ascending ? aNull && !bNull : bNull && !aNull;
+        }
+        return ascending ? less(a, b) : less(b, a);
+    });
+}
+
+// Stable sort row indices by a fixed width column of type T
+template<typename T>
+static void sortFixed(std::vector<uint32_t> &order, const ColumnBuffer &column, OrderDirection direction) {
+    const T *values = reinterpret_cast<const T *>(column.data.data());
+    sortRows(order, column, direction, [values](uint32_t a, uint32_t b) {
+        return values[a] < values[b];
+    });
+}
+
+MaterializedRow::MaterializedRow(const MaterializedResult &result, size_t rowIndex)
+        : result(&result), rowIndex(rowIndex) {
+
+}
+
+bool MaterializedRow::isNull(size_t column) const {
+    return result->isNull(rowIndex, column);
+}
+
+size_t MaterializedRow::index() const {
+    return rowIndex;
+}
+
+MaterializedRowIterator::MaterializedRowIterator(const MaterializedResult &result, size_t rowIndex)
+        : result(&result), rowIndex(rowIndex) {
+
+}
+
+MaterializedRow MaterializedRowIterator::operator*() const {
+    return (*result)[rowIndex];
+}
+
+MaterializedRow MaterializedRowIterator::operator[](difference_type n) const {
+    return (*result)[rowIndex + n];
+}
+
+MaterializedRowIterator &MaterializedRowIterator::operator++() {
+    rowIndex++;
+    return *this;
+}
+
+MaterializedRowIterator MaterializedRowIterator::operator++(int) {
+    MaterializedRowIterator ret = *this;
+    rowIndex++;
+    return ret;
+}
+
+MaterializedRowIterator &MaterializedRowIterator::operator--() {
+    rowIndex--;
+    return *this;
+}
+
+MaterializedRowIterator MaterializedRowIterator::operator--(int) {
+    MaterializedRowIterator ret = *this;
+    rowIndex--;
+    return ret;
+}
+
+MaterializedRowIterator &MaterializedRowIterator::operator+=(difference_type n) {
+    rowIndex += n;
+    return *this;
+}
+
+MaterializedRowIterator &MaterializedRowIterator::operator-=(difference_type n) {
+    rowIndex -= n;
+    return *this;
+}
+
+MaterializedRowIterator MaterializedRowIterator::operator+(difference_type n) const {
+    return MaterializedRowIterator(*result, rowIndex + n);
+}
+
+MaterializedRowIterator MaterializedRowIterator::operator-(difference_type n) const {
+    return MaterializedRowIterator(*result, rowIndex - n);
+}
+
+MaterializedRowIterator::difference_type MaterializedRowIterator::operator-(const MaterializedRowIterator &other) const {
+    return (difference_type) rowIndex - (difference_type) other.rowIndex;
+}
+
+bool MaterializedRowIterator::operator==(const MaterializedRowIterator &other) const {
+    return result == other.result && rowIndex == other.rowIndex;
+}
+
+bool MaterializedRowIterator::operator!=(const MaterializedRowIterator &other) const {
+    return !(*this == other);
+}
+
+bool MaterializedRowIterator::operator<(const MaterializedRowIterator &other) const {
+    return rowIndex < other.rowIndex;
+}
+
+MaterializedResult::MaterializedResult(QueryResult &&result) {
+    // Take the result over, so its statement is freed when this constructor returns
+    QueryResult source = std::move(result);
+
+    std::vector<ColumnDescription> descriptions = source.describeColumns();
+    columns.resize(descriptions.size());
+    for (size_t i = 0; i < descriptions.size(); i++) {
+        columns[i].reset(std::move(descriptions[i]));
+    }
+
+    while (source.fetchNextRow()) {
+        for (size_t i = 0; i < columns.size(); i++) {
+            columns[i].read(source, i, rows);
+        }
+        rows++;
+    }
+
+    if (rows > std::numeric_limits<uint32_t>::max()) {
+        throw SQLException("Materialized result has too many rows.");
+    }
+}
+
+size_t MaterializedResult::rowCount() const {
+    return rows;
+}
+
+size_t MaterializedResult::columnCount() const {
+    return columns.size();
+}
+
+const ColumnDescription &MaterializedResult::describeColumn(size_t column) const {
+    return columns.at(column).description;
+}
+
+ColumnType MaterializedResult::columnType(size_t column) const {
+    return columns.at(column).type;
+}
+
+size_t MaterializedResult::columnIndex(std::string_view name) const {
+    for (size_t i = 0; i < columns.size(); i++) {
+        if (columns[i].description.name == name) {
+            return i;
+        }
+    }
+    throw SQLException("No column named " + std::string(name) + " in the result.");
+}
+
+MaterializedRow MaterializedResult::operator[](size_t row) const {
+    return MaterializedRow(*this, row);
+}
+
+bool MaterializedResult::isNull(size_t row, size_t column) const {
+    return columns.at(column).isNull(row);
+}
+
+const byte *MaterializedResult::nulls(size_t column) const {
+    const ColumnBuffer &buffer = columns.at(column);
+    return buffer.description.nullable ? buffer.nulls.data() : nullptr;
+}
+
+void MaterializedResult::sort(size_t column, OrderDirection direction) {
+    const ColumnBuffer &buffer = columns.at(column);
+
+    std::vector<uint32_t> order(rows);
+    std::iota(order.begin(), order.end(), 0);
+
+    switch (buffer.type) {
+        case ColumnType::BOOL:
+            sortFixed<bool>(order, buffer, direction);
+            break;
+        case ColumnType::INT8:
+            sortFixed<signed char>(order, buffer, direction);
+            break;
+        case ColumnType::INT16:
+            sortFixed<short>(order, buffer, direction);
+            break;
+        case ColumnType::INT32:
+            sortFixed<int>(order, buffer, direction);
+            break;
+        case ColumnType::INT64:
+            sortFixed<long long>(order, buffer, direction);
+            break;
+        case ColumnType::FLOAT32:
+            sortFixed<float>(order, buffer, direction);
+            break;
+        case ColumnType::FLOAT64:
+            sortFixed<double>(order, buffer, direction);
+            break;
+        case ColumnType::DATE: {
+            const ColumnarDate *dates = reinterpret_cast<const ColumnarDate *>(buffer.data.data());
+            sortRows(order, buffer, direction, [dates](uint32_t a, uint32_t b) {
+                return std::tie(dates[a].year, dates[a].month, dates[a].day) <
+                       std::tie(dates[b].year, dates[b].month, dates[b].day);
+            });
+            break;
+        }
+        case ColumnType::STRING:
+            sortRows(order, buffer, direction, [&buffer](uint32_t a, uint32_t b) {
+                return buffer.string(a) < buffer.string(b);
+            });
+            break;
+    }
+
+    selectRows(order);
+}
+
+void MaterializedResult::selectRows(const std::vector<uint32_t> &selected) {
+    for (uint32_t row : selected) {
+        if (row >= rows) {
+            throw SQLException("Selected row " + std::to_string(row) + " is past the end of the result.");
+        }
+    }
+
+    // Gather each column into new buffers in the selected order, then swap them in
+    for (ColumnBuffer &column : columns) {
+        std::vector<byte> nulls;
+        if (column.description.nullable) {
+            nulls.assign((selected.size() + 7) / 8, 0);
+            for (size_t i = 0; i < selected.size(); i++) {
+                if (column.isNull(selected[i])) {
+                    nulls[i / 8] |= (byte) (1u << (i % 8));
+                }
+            }
+        }
+
+        std::vector<byte> data;
+        if (column.type == ColumnType::STRING) {
+            std::vector<uint32_t> offsets;
+            offsets.reserve(selected.size() + 1);
+            offsets.push_back(0);
+            for (uint32_t row : selected) {
+                std::string_view value = column.string(row);
+                data.insert(data.end(), value.begin(), value.end());
+                if (data.size() > std::numeric_limits<uint32_t>::max()) {
+                    throw SQLException("Column string data is too large.");
+                }
+                offsets.push_back(data.size());
+            }
+            column.offsets.swap(offsets);
+        } else {
+            size_t width = columnTypeWidth(column.type);
+            data.resize(selected.size() * width);
+            for (size_t i = 0; i < selected.size(); i++) {
+                memcpy(data.data() + i * width, column.data.data() + selected[i] * width, width);
+            }
+        }
+
+        column.nulls.swap(nulls);
+        column.data.swap(data);
+    }
+
+    rows = selected.size();
+}
+
+MaterializedRowIterator MaterializedResult::begin() const {
+    return MaterializedRowIterator(*this, 0);
+}
+
+MaterializedRowIterator MaterializedResult::end() const {
+    return MaterializedRowIterator(*this, rows);
+}
+
+const ColumnBuffer &MaterializedResult::checkedColumn(size_t column, ColumnType type) const {
+    const ColumnBuffer &buffer = columns.at(column);
+    if (buffer.type != type) {
+        throw SQLException("Column " + buffer.description.name + " read as the wrong type.");
+    }
+    return buffer;
+}
+
+template<>
+Value<std::string_view> MaterializedResult::get<std::string_view>(size_t row, size_t column) const {
+    const ColumnBuffer &buffer = checkedColumn(column, ColumnType::STRING);
+    if (buffer.isNull(row)) {
+        return null_value;
+    }
+    return buffer.string(row);
+}
+
+template<>
+Value<std::string> MaterializedResult::get<std::string>(size_t row, size_t column) const {
+    const ColumnBuffer &buffer = checkedColumn(column, ColumnType::STRING);
+    if (buffer.isNull(row)) {
+        return null_value;
+    }
+    return std::string(buffer.string(row));
+}
+
+template<>
+Value<Date> MaterializedResult::get<Date>(size_t row, size_t column) const {
+    const ColumnarDate *dates = values<ColumnarDate>(column);
+    if (isNull(row, column)) {
+        return null_value;
+    }
+    return Date(dates[row].year, dates[row].month, dates[row].day);
+}
+
+template<>
+Value<Price> MaterializedResult::get<Price>(size_t row, size_t column) const {
+    if (isNull(row, column)) {
+        return null_value;
+    }
+    if (columnType(column) == ColumnType::FLOAT32) {
+        return Price(values<float>(column)[row]);
+    }
+    return Price((float) values<double>(column)[row]);
+}
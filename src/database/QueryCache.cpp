@@ -0,0 +1,289 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include <cctype>
+
+#include "../../include/database/QueryCache.h"
+
+using namespace sql;
+
+CachedResult::CachedResult(QueryResult &result) {
+    // Encode the rows in blocks of the same size as a streamed result
+    ColumnarBlockEncoder encoder;
+    bool more = result.fetchNextRow();
+    while (more) {
+        size_t blockRows = 0;
+        encoder.beginBlock(result);
+        do {
+            encoder.addRow(result);
+            blockRows++;
+            more = result.fetchNextRow();
+        } while (more && blockRows < RESULT_STREAM_BLOCK_ROWS && encoder.blockSize() < RESULT_STREAM_BLOCK_BYTES);
+
+        blocks.push_back(encoder.finishBlock());
+        rows += blockRows;
+        bytes += blocks.back().size();
+    }
+}
+
+size_t CachedResult::rowCount() const {
+    return rows;
+}
+
+size_t CachedResult::blockCount() const {
+    return blocks.size();
+}
+
+ColumnarBlockReader CachedResult::block(size_t index) const {
+    // The reader only writes to a block to swap its byte order, and these were encoded on this machine, so the
+    // block is never written to
+    byte_buffer &block = const_cast<byte_buffer &>(blocks.at(index));
+    return ColumnarBlockReader(block);
+}
+
+size_t CachedResult::byteSize() const {
+    return bytes;
+}
+
+QueryCache::QueryCache(size_t memoryBudget)
+        : memoryBudget(memoryBudget) {
+
+}
+
+std::shared_ptr<const CachedResult> QueryCache::find(const std::string &sql,
+                                                     const std::vector<std::string> &parameters) {
+    std::lock_guard<std::mutex> guard(cacheLock);
+
+    std::unordered_map<std::string, Entry>::iterator entry = entries.find(makeKey(sql, parameters));
+    if (entry == entries.end()) {
+        return nullptr;
+    }
+    if (Clock::now() >= entry->second.expiry) {
+        erase(entry);
+        return nullptr;
+    }
+
+    // Move the entry to the front of the recently used list
+    recentlyUsed.splice(recentlyUsed.begin(), recentlyUsed, entry->second.recent);
+    return entry->second.result;
+}
+
+uint64_t QueryCache::generation() const {
+    std::lock_guard<std::mutex> guard(cacheLock);
+    return invalidations;
+}
+
+void QueryCache::store(const std::string &sql, const std::vector<std::string> &parameters,
+                       const std::vector<std::string> &tables, std::shared_ptr<const CachedResult> result,
+                       Clock::duration timeToLive, uint64_t readGeneration) {
+    std::string key = makeKey(sql, parameters);
+    size_t bytes = result->byteSize() + key.size();
+
+    std::lock_guard<std::mutex> guard(cacheLock);
+
+    // A write may have landed after the result was read, in which case it could already be out of date
+    if (readGeneration != invalidations || bytes > memoryBudget) {
+        return;
+    }
+
+    std::unordered_map<std::string, Entry>::iterator existing = entries.find(key);
+    if (existing != entries.end()) {
+        erase(existing);
+    }
+
+    // Make room by dropping the least recently used results
+    while (memoryInUse + bytes > memoryBudget) {
+        erase(entries.find(recentlyUsed.back()));
+    }
+
+    recentlyUsed.push_front(key);
+    Entry &entry = entries[key];
+    entry.result = std::move(result);
+    entry.expiry = Clock::now() + timeToLive;
+    entry.bytes = bytes;
+    entry.recent = recentlyUsed.begin();
+    for (const std::string &table : tables) {
+        entry.tables.push_back(normaliseTable(table));
+        tableEntries[entry.tables.back()].insert(key);
+    }
+    memoryInUse += bytes;
+}
+
+void QueryCache::invalidate(std::string_view table) {
+    std::lock_guard<std::mutex> guard(cacheLock);
+    invalidations++;
+
+    std::unordered_map<std::string, std::unordered_set<std::string>>::iterator keys =
+            tableEntries.find(normaliseTable(table));
+    if (keys == tableEntries.end()) {
+        return;
+    }
+
+    // Erasing an entry removes it from this set, so take the keys first
+    std::vector<std::string> stale(keys->second.begin(), keys->second.end());
+    for (const std::string &key : stale) {
+        erase(entries.find(key));
+    }
+}
+
+void QueryCache::clear() {
+    std::lock_guard<std::mutex> guard(cacheLock);
+    invalidations++;
+
+    entries.clear();
+    tableEntries.clear();
+    recentlyUsed.clear();
+    memoryInUse = 0;
+}
+
+size_t QueryCache::size() const {
+    std::lock_guard<std::mutex> guard(cacheLock);
+    return entries.size();
+}
+
+size_t QueryCache::memoryUsed() const {
+    std::lock_guard<std::mutex> guard(cacheLock);
+    return memoryInUse;
+}
+
+std::optional<std::vector<std::string>> QueryCache::writtenTables(std::string_view statement) {
+    // Split the start of the statement into words, treating brackets as the end of a word
+    size_t position = 0;
+    auto nextWord = [&]() {
+        while (position < statement.size() && std::isspace((unsigned char) statement[position])) {
+            position++;
+        }
+        size_t start = position;
+        while (position < statement.size() && !std::isspace((unsigned char) statement[position]) &&
+               statement[position] != '(' && statement[position] != ';') {
+            position++;
+        }
+        std::string word(statement.substr(start, position - start));
+        return word;
+    };
+    auto upper = [](std::string word) {
+        for (char &c : word) {
+            c = (char) std::toupper((unsigned char) c);
+        }
+        return word;
+    };
+    // Skip ahead past the next occurrence of a keyword as a word of its own, anywhere in the rest of the
+    // statement. Returns false if there is none
+    auto skipPast = [&](std::string_view keyword) {
+        while (position < statement.size()) {
+            size_t start = position;
+            while (position < statement.size() &&
+                   (std::isalnum((unsigned char) statement[position]) || statement[position] == '_')) {
+                position++;
+            }
+            if (position - start == keyword.size() &&
+                upper(std::string(statement.substr(start, position - start))) == keyword) {
+                return true;
+            }
+            if (position == start) {
+                position++;
+            }
+        }
+        return false;
+    };
+
+    // Several statements in one go could write anywhere
+    size_t semicolon = statement.find(';');
+    if (semicolon != std::string_view::npos &&
+        statement.find_first_not_of(" \t\r\n;", semicolon) != std::string_view::npos) {
+        return std::nullopt;
+    }
+
+    std::string verb = upper(nextWord());
+    if (verb == "SELECT") {
+        // SELECT ... INTO creates the table it names
+        if (!skipPast("INTO")) {
+            return std::vector<std::string>();
+        }
+        std::string table = nextWord();
+        if (table.empty()) {
+            return std::nullopt;
+        }
+        return std::vector<std::string>{table};
+    }
+
+    // Find the table, skipping the words which may come between it and the verb
+    std::string table;
+    if (verb == "INSERT" || verb == "REPLACE" || verb == "MERGE") {
+        table = nextWord();
+        if (upper(table) == "INTO") {
+            table = nextWord();
+        }
+    } else if (verb == "DELETE" || verb == "UPDATE") {
+        table = nextWord();
+        if (verb == "DELETE" && upper(table) == "FROM") {
+            table = nextWord();
+        }
+        // With a FROM clause of its own, as in UPDATE a ... FROM Orders a or DELETE t FROM Orders t, the word
+        // found may only be an alias for the table written to, and the clause may join in further tables. Working
+        // out which is which isn't worth the risk of getting it wrong, so the statement could write anything
+        if (skipPast("FROM")) {
+            return std::nullopt;
+        }
+    } else if (verb == "TRUNCATE" || verb == "DROP" || verb == "ALTER") {
+        if (upper(nextWord()) != "TABLE") {
+            return std::nullopt;
+        }
+        table = nextWord();
+        if (upper(table) == "IF" && upper(nextWord()) == "EXISTS") {
+            table = nextWord();
+        }
+    } else {
+        return std::nullopt;
+    }
+
+    if (table.empty()) {
+        return std::nullopt;
+    }
+    return std::vector<std::string>{table};
+}
+
+std::string QueryCache::makeKey(const std::string &sql, const std::vector<std::string> &parameters) {
+    // Each parameter is prefixed by its length, so no two different parameter lists make the same key
+    std::string key = sql;
+    for (const std::string &parameter : parameters) {
+        key.push_back('\0');
+        key.append(std::to_string(parameter.size())).push_back(':');
+        key.append(parameter);
+    }
+    return key;
+}
+
+std::string QueryCache::normaliseTable(std::string_view table) {
+    // Only the last part of a qualified name is kept. Tables of the same name in different schemas share an index
+    // entry, which only means a write to one also drops results from the other
+    size_t dot = table.find_last_of('.');
+    if (dot != std::string_view::npos) {
+        table = table.substr(dot + 1);
+    }
+
+    std::string name;
+    name.reserve(table.size());
+    for (char c : table) {
+        if (c != '[' && c != ']' && c != '"' && c != '`') {
+            name.push_back((char) std::tolower((unsigned char) c));
+        }
+    }
+    return name;
+}
+
+void QueryCache::erase(std::unordered_map<std::string, Entry>::iterator entry) {
+    for (const std::string &table : entry->second.tables) {
+        std::unordered_map<std::string, std::unordered_set<std::string>>::iterator keys = tableEntries.find(table);
+        if (keys != tableEntries.end()) {
+            keys->second.erase(entry->first);
+            if (keys->second.empty()) {
+                tableEntries.erase(keys);
+            }
+        }
+    }
+    recentlyUsed.erase(entry->second.recent);
+    memoryInUse -= entry->second.bytes;
+    entries.erase(entry);
+}
@@ -0,0 +1,53 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include <algorithm>
+
+#include "../../include/database/QueryParameter.h"
+
+using namespace sql;
+
+QueryParameter::QueryParameter(std::string value)
+        : valueType(ColumnType::STRING), string(std::move(value)) {
+
+}
+
+QueryParameter::QueryParameter(const char *value)
+        : QueryParameter(std::string(value)) {
+
+}
+
+ColumnType QueryParameter::type() const {
+    return valueType;
+}
+
+std::string QueryParameter::key() const {
+    // The type, then the value's bytes, which are zeroed past the end of a fixed width value
+    std::string key(1, (char) valueType);
+    if (valueType == ColumnType::STRING) {
+        key.append(string);
+    } else {
+        key.append((const char *) data, sizeof(data));
+    }
+    return key;
+}
+
+void QueryParameter::bind(const SQLStatementHandle &statement, SQLUSMALLINT number) const {
+    SQLRETURN ret;
+    if (valueType == ColumnType::STRING) {
+        indicator = (SQLLEN) string.size();
+        ret = SQLBindParameter(statement.get(), number, SQL_PARAM_INPUT, SQL_C_CHAR, SQL_VARCHAR,
+                               std::max<size_t>(string.size(), 1), 0, (SQLPOINTER) string.c_str(),
+                               (SQLLEN) string.size() + 1, &indicator);
+    } else {
+        // Only dates need a column size, which is the length of their yyyy-mm-dd form
+        indicator = 0;
+        ret = SQLBindParameter(statement.get(), number, SQL_PARAM_INPUT, driverTypeFor(valueType),
+                               sqlTypeFor(valueType), valueType == ColumnType::DATE ? 10 : 0, 0, (SQLPOINTER) data,
+                               0, &indicator);
+    }
+    if (ret == SQL_ERROR) {
+        throw statement.getError();
+    }
+}
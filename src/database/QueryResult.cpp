@@ -2,12 +2,14 @@
 // Created by Matthew.Sirman on 20/08/2020.
 //
 
+#include <algorithm>
+
 #include "../../include/database/QueryResult.h"
 
 using namespace sql;
 
-QueryResultRowIterator::QueryResultRowIterator(size_t iterPosition, QueryResult &resultObject)
-        : iterPosition(iterPosition), resultObject(resultObject) {
+QueryResultRowIterator::QueryResultRowIterator(size_t iterPosition, QueryResult &resultObject, bool endIterator)
+        : iterPosition(iterPosition), endIterator(endIterator), resultObject(resultObject) {
 
 }
 
@@ -28,7 +30,7 @@ QueryResultRowIterator &QueryResultRowIterator::operator++() {
 
 QueryResultRowIterator QueryResultRowIterator::operator++(int) {
     // Cache the old value of the iterator before incrementing
-    QueryResultRowIterator ret(iterPosition, resultObject);
+    QueryResultRowIterator ret(iterPosition, resultObject, endIterator);
 
     // Increment the internal iterator
     iterPosition++;
@@ -40,26 +42,111 @@ QueryResultRowIterator QueryResultRowIterator::operator++(int) {
 }
 
 bool QueryResultRowIterator::operator==(const QueryResultRowIterator &other) const {
-    // Return equal if and only if the iterators are in the same position and pertain to the same query
-    return iterPosition == other.iterPosition && &resultObject == &other.resultObject;
+    // Iterators pertaining to different queries are never equal
+    if (&resultObject != &other.resultObject) {
+        return false;
+    }
+    // Any iterator past the last row is equal to the end iterator
+    if (atEnd() || other.atEnd()) {
+        return atEnd() == other.atEnd();
+    }
+    // Otherwise they are equal if and only if they are in the same position
+    return iterPosition == other.iterPosition;
 }
 
 bool QueryResultRowIterator::operator!=(const QueryResultRowIterator &other) const {
-    // Return not equal if and only if the iterators are in different positions or pertain to different queries
-    return iterPosition != other.iterPosition || &resultObject != &other.resultObject;
+    return !(*this == other);
+}
+
+bool QueryResultRowIterator::atEnd() const {
+    return endIterator || resultObject.exhausted;
 }
 
-QueryResult::QueryResult(SQLSafeHandle<STATEMENT_HANDLE> &&sqlStatementHandle)
-        : sqlStatementHandle(std::move(sqlStatementHandle)), columns(*this), row(*this) {
+QueryResult::QueryResult(SQLSafeHandle<STATEMENT_HANDLE> &&sqlStatementHandle,
+                         std::shared_ptr<StatementPool> statementPool)
+        : sqlStatementHandle(std::move(sqlStatementHandle)), statementPool(std::move(statementPool)), columns(*this),
+          row(*this) {
+
+}
+
+QueryResult::QueryResult(QueryResult &&other) noexcept
+        : row(*this), columns(*this), sqlStatementHandle(std::move(other.sqlStatementHandle)),
+          statementPool(std::move(other.statementPool)), currentRowIndex(other.currentRowIndex),
+          exhausted(other.exhausted), stats(std::move(other.stats)), executeStart(other.executeStart),
+          rowsRead(other.rowsRead), drainRecorded(other.drainRecorded) {
+
+}
 
+QueryResult::~QueryResult() {
+    // A moved from result has no handle, which the pool ignores
+    if (statementPool) {
+        statementPool->release(std::move(sqlStatementHandle));
+    }
 }
 
-void QueryResult::fetchNextRow() {
+bool QueryResult::fetchNextRow() {
     // Fetch the next row from the internal SQL statement
-    SQLFetch(sqlStatementHandle.get());
+    SQLRETURN ret = SQLFetch(sqlStatementHandle.get());
 
     // Increment the current row index
     currentRowIndex++;
+
+    // SQL_NO_DATA marks the end of the result set, but a failed fetch must not look like the end of the data
+    if (ret == SQL_ERROR) {
+        if (stats) {
+            stats->errors.fetch_add(1, std::memory_order_relaxed);
+        }
+        throw sqlStatementHandle.getError();
+    }
+    exhausted = !SQL_SUCCEEDED(ret);
+    if (stats) {
+        recordFetch(exhausted ? 0 : 1);
+    }
+    return !exhausted;
+}
+
+void QueryResult::instrument(std::shared_ptr<StatementStats> statementStats,
+                             metrics::LatencyHistogram::Clock::time_point start, size_t handleAllocations,
+                             SQLRETURN executeResult) {
+    stats = std::move(statementStats);
+    executeStart = start;
+
+    stats->execute.record(metrics::LatencyHistogram::Clock::now() - start);
+    stats->executions.fetch_add(1, std::memory_order_relaxed);
+    stats->handleAllocations.fetch_add(handleAllocations, std::memory_order_relaxed);
+    if (executeResult == SQL_ERROR) {
+        stats->errors.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void QueryResult::recordFetch(size_t rows) {
+    // Rows are added to the statement's total as they are fetched, so a report taken while a long result is
+    // being read, or of a result which is never finished with, still counts them
+    if (rows != 0) {
+        if (rowsRead == 0) {
+            stats->firstRow.record(metrics::LatencyHistogram::Clock::now() - executeStart);
+        }
+        rowsRead += rows;
+        stats->rows.fetch_add(rows, std::memory_order_relaxed);
+    } else if (!drainRecorded) {
+        stats->drain.record(metrics::LatencyHistogram::Clock::now() - executeStart);
+        drainRecorded = true;
+    }
+}
+
+SQLRETURN QueryResult::getData(size_t index, SQLSMALLINT cType, SQLPOINTER buffer, SQLLEN bufferLength,
+                               SQLLEN *length) const {
+    SQLRETURN ret = SQLGetData(sqlStatementHandle.get(), index + 1, cType, buffer, bufferLength, length);
+
+    // A truncated value reports its whole length, but only the buffer's worth has been read so far
+    if (stats && SQL_SUCCEEDED(ret) && *length > 0) {
+        recordBytes(ret == SQL_SUCCESS_WITH_INFO ? std::min<SQLLEN>(*length, bufferLength) : *length);
+    }
+    return ret;
+}
+
+void QueryResult::recordBytes(uint64_t bytes) const {
+    stats->bytes.fetch_add(bytes, std::memory_order_relaxed);
 }
 
 // Each get method is essentially identical. They all specialise "getting" for a particular type
@@ -72,7 +159,7 @@ Value<char> QueryResult::get<char>(size_t index) const {
     SQLSCHAR result;
     SQLLEN length;
 
-    SQLGetData(sqlStatementHandle.get(), index + 1, SQL_CHAR, &result, (SQLLEN) sizeof(SQLSCHAR), &length);
+    getData(index, SQL_CHAR, &result, (SQLLEN) sizeof(SQLSCHAR), &length);
 
     if (length == SQL_NULL_DATA) {
         return null_value;
@@ -86,7 +173,7 @@ Value<unsigned char> QueryResult::get<unsigned char>(size_t index) const {
     SQLCHAR result;
     SQLLEN length;
 
-    SQLGetData(sqlStatementHandle.get(), index + 1, SQL_CHAR, &result, (SQLLEN) sizeof(SQLCHAR), &length);
+    getData(index, SQL_CHAR, &result, (SQLLEN) sizeof(SQLCHAR), &length);
 
     if (length == SQL_NULL_DATA) {
         return null_value;
@@ -100,7 +187,7 @@ Value<short> QueryResult::get<short>(size_t index) const {
     SQLSMALLINT result;
     SQLLEN length;
 
-    SQLGetData(sqlStatementHandle.get(), index + 1, SQL_SMALLINT, &result, (SQLLEN) sizeof(SQLSMALLINT), &length);
+    getData(index, SQL_SMALLINT, &result, (SQLLEN) sizeof(SQLSMALLINT), &length);
 
     if (length == SQL_NULL_DATA) {
         return null_value;
@@ -114,7 +201,7 @@ Value<unsigned short> QueryResult::get<unsigned short>(size_t index) const {
     SQLUSMALLINT result;
     SQLLEN length;
 
-    SQLGetData(sqlStatementHandle.get(), index + 1, SQL_SMALLINT, &result, (SQLLEN) sizeof(SQLUSMALLINT), &length);
+    getData(index, SQL_SMALLINT, &result, (SQLLEN) sizeof(SQLUSMALLINT), &length);
 
     if (length == SQL_NULL_DATA) {
         return null_value;
@@ -128,7 +215,7 @@ Value<int> QueryResult::get<int>(size_t index) const {
     SQLINTEGER result;
     SQLLEN length;
 
-    SQLGetData(sqlStatementHandle.get(), index + 1, SQL_INTEGER, &result, (SQLLEN) sizeof(SQLINTEGER), &length);
+    getData(index, SQL_INTEGER, &result, (SQLLEN) sizeof(SQLINTEGER), &length);
 
     if (length == SQL_NULL_DATA) {
         return null_value;
@@ -142,7 +229,7 @@ Value<unsigned int> QueryResult::get<unsigned int>(size_t index) const {
     SQLUINTEGER result;
     SQLLEN length;
 
-    SQLGetData(sqlStatementHandle.get(), index + 1, SQL_INTEGER, &result, (SQLLEN) sizeof(SQLUINTEGER), &length);
+    getData(index, SQL_INTEGER, &result, (SQLLEN) sizeof(SQLUINTEGER), &length);
 
     if (length == SQL_NULL_DATA) {
         return null_value;
@@ -156,7 +243,7 @@ Value<long long> QueryResult::get<long long>(size_t index) const {
     SQLBIGINT result;
     SQLLEN length;
 
-    SQLGetData(sqlStatementHandle.get(), index + 1, SQL_INTEGER, &result, (SQLLEN) sizeof(SQLINTEGER), &length);
+    getData(index, SQL_INTEGER, &result, (SQLLEN) sizeof(SQLINTEGER), &length);
 
     if (length == SQL_NULL_DATA) {
         return null_value;
@@ -170,7 +257,7 @@ Value<unsigned long long> QueryResult::get<unsigned long long>(size_t index) con
     SQLUBIGINT result;
     SQLLEN length;
 
-    SQLGetData(sqlStatementHandle.get(), index + 1, SQL_INTEGER, &result, (SQLLEN) sizeof(SQLUBIGINT), &length);
+    getData(index, SQL_INTEGER, &result, (SQLLEN) sizeof(SQLUBIGINT), &length);
 
     if (length == SQL_NULL_DATA) {
         return null_value;
@@ -184,7 +271,7 @@ Value<float> QueryResult::get<float>(size_t index) const {
     SQLREAL result;
     SQLLEN length;
 
-    SQLGetData(sqlStatementHandle.get(), index + 1, SQL_REAL, &result, (SQLLEN) sizeof(SQLREAL), &length);
+    getData(index, SQL_REAL, &result, (SQLLEN) sizeof(SQLREAL), &length);
 
     if (length == SQL_NULL_DATA) {
         return null_value;
@@ -198,7 +285,7 @@ Value<double> QueryResult::get<double>(size_t index) const {
     SQLDOUBLE result;
     SQLLEN length;
 
-    SQLGetData(sqlStatementHandle.get(), index + 1, SQL_DOUBLE, &result, (SQLLEN) sizeof(SQLDOUBLE), &length);
+    getData(index, SQL_DOUBLE, &result, (SQLLEN) sizeof(SQLDOUBLE), &length);
 
     if (length == SQL_NULL_DATA) {
         return null_value;
@@ -211,23 +298,40 @@ template<>
 Value<std::string> QueryResult::get<std::string>(size_t index) const {
     // This is a differing get method.
 
-    // First we declare an array for the result. This is declared in static storage
-    static SQLCHAR result[MAX_QUERY_STRING_LENGTH];
+    // First we declare a buffer for the result. This is on the stack rather than in static storage, so results
+    // on different threads can be read at once
+    SQLCHAR buffer[MAX_QUERY_STRING_LENGTH];
     // Declare a value to hold the length of the returned string (usually this is omitted as we already know the
     // size for other types)
     SQLLEN resultLength = 0;
 
-    // Then, we call the SQLGetData function as usual, which writes the string to the result buffer and the length
-    // to the resultLength value
-    SQLGetData(sqlStatementHandle.get(), index + 1, SQL_CHAR, result, (SQLLEN) sizeof(result), &resultLength);
-
-    if (resultLength == SQL_NULL_DATA) {
-        return null_value;
+    // Then, we call the SQLGetData function as usual, which writes the string to the buffer and the length to the
+    // resultLength value. A string longer than the buffer is truncated, with the rest returned by calling again,
+    // so keep going until the driver says the last piece has been read
+    std::string result;
+    while (true) {
+        SQLRETURN ret = getData(index, SQL_CHAR, buffer, (SQLLEN) sizeof(buffer), &resultLength);
+
+        if (ret == SQL_ERROR) {
+            throw sqlStatementHandle.getError();
+        }
+        if (ret == SQL_NO_DATA) {
+            break;
+        }
+        if (resultLength == SQL_NULL_DATA) {
+            return null_value;
+        }
+        if (ret == SQL_SUCCESS) {
+            result.append((const char *) buffer, std::min<size_t>(resultLength, sizeof(buffer) - 1));
+            break;
+        }
+
+        // Every piece is null terminated, so a truncated piece fills all but the last byte of the buffer
+        result.append((const char *) buffer, sizeof(buffer) - 1);
     }
 
-    // Finally, we construct a string from the result buffer and length. This implicitly copies from the buffer,
-    // so it does not matter that the buffer itself is in static space
-    return std::string((const char *) result, resultLength);
+    // Finally, we return the string, which was copied out of the buffer piece by piece
+    return result;
 }
 
 template<>
@@ -235,7 +339,7 @@ Value<bool> QueryResult::get<bool>(size_t index) const {
     SQLCHAR result;
     SQLLEN length;
 
-    SQLGetData(sqlStatementHandle.get(), index + 1, SQL_CHAR, &result, (SQLLEN) sizeof(SQLCHAR), &length);
+    getData(index, SQL_CHAR, &result, (SQLLEN) sizeof(SQLCHAR), &length);
 
     if (length == SQL_NULL_DATA) {
         return null_value;
@@ -249,7 +353,7 @@ Value<Date> QueryResult::get<Date>(size_t index) const {
     SQL_DATE_STRUCT result;
     SQLLEN length;
 
-    SQLGetData(sqlStatementHandle.get(), index + 1, 91, &result, (SQLLEN) sizeof(SQL_DATE_STRUCT), &length);
+    getData(index, 91, &result, (SQLLEN) sizeof(SQL_DATE_STRUCT), &length);
 
     if (length == SQL_NULL_DATA) {
         return null_value;
@@ -287,6 +391,40 @@ size_t QueryResult::currentRow() const {
     return currentRowIndex;
 }
 
+size_t QueryResult::columnCount() const {
+    SQLSMALLINT count;
+
+    if (SQLNumResultCols(sqlStatementHandle.get(), &count) == SQL_ERROR) {
+        throw sqlStatementHandle.getError();
+    }
+
+    return count;
+}
+
+std::vector<ColumnDescription> QueryResult::describeColumns() const {
+    std::vector<ColumnDescription> descriptions(columnCount());
+
+    for (size_t i = 0; i < descriptions.size(); i++) {
+        SQLCHAR name[MAX_QUERY_STRING_LENGTH];
+        SQLSMALLINT nameLength, nullable;
+        ColumnDescription &description = descriptions[i];
+
+        if (SQLDescribeCol(sqlStatementHandle.get(), i + 1, name, (SQLSMALLINT) sizeof(name), &nameLength,
+                           &description.sqlType, &description.size, &description.decimalDigits,
+                           &nullable) == SQL_ERROR) {
+            throw sqlStatementHandle.getError();
+        }
+
+        // A name too long for the buffer is truncated to it
+        description.name = std::string((const char *) name,
+                                       std::min<size_t>(nameLength, sizeof(name) - 1));
+        // Treat unknown nullability as nullable, so nulls are never lost
+        description.nullable = nullable != SQL_NO_NULLS;
+    }
+
+    return descriptions;
+}
+
 QueryResultRowIterator QueryResult::begin() {
     // Fetch the first row - the rows are incremented whenever the increment operator is called on the iterator,
     // but it will not be called for the first row, hence we manually increment it here as begin is called.
@@ -296,6 +434,6 @@ QueryResultRowIterator QueryResult::begin() {
 }
 
 QueryResultRowIterator QueryResult::end() {
-    // Return an iterator with the position of rowCount, meaning it will be the "final" row
-    return QueryResultRowIterator(rowCount(), *this);
+    // Return the end iterator, which every iterator becomes equal to once the rows run out
+    return QueryResultRowIterator(0, *this, true);
 }
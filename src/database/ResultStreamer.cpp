@@ -0,0 +1,164 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include "../../include/database/ResultStreamer.h"
+#include "../../include/database/ColumnarBlock.h"
+
+using namespace sql;
+
+RowBlockEncoder::RowBlockEncoder(RowFunction rowFunction)
+        : rowFunction(std::move(rowFunction)) {
+
+}
+
+void RowBlockEncoder::beginBlock(const QueryResult &) {
+    block.clear();
+}
+
+void RowBlockEncoder::addRow(const QueryResult &result) {
+    rowFunction(result.row, block);
+}
+
+size_t RowBlockEncoder::blockSize() const {
+    return block.size();
+}
+
+byte_buffer RowBlockEncoder::finishBlock() {
+    byte_buffer buffer(block.size());
+    std::copy(block.begin(), block.end(), buffer.begin());
+    return buffer;
+}
+
+ResultStreamer::ResultStreamer(QueryResult &result, size_t blockRows, size_t blockBytes, size_t queueDepth)
+        : result(result), ownedEncoder(std::make_unique<ColumnarBlockEncoder>()), encoder(*ownedEncoder),
+          blockRows(std::max<size_t>(blockRows, 1)), blockBytes(blockBytes),
+          queueDepth(std::max<size_t>(queueDepth, 1)) {
+
+}
+
+ResultStreamer::ResultStreamer(QueryResult &result, BlockEncoder &encoder, size_t blockRows, size_t blockBytes,
+                               size_t queueDepth)
+        : result(result), encoder(encoder), blockRows(std::max<size_t>(blockRows, 1)), blockBytes(blockBytes),
+          queueDepth(std::max<size_t>(queueDepth, 1)) {
+
+}
+
+bool ResultStreamer::stream(const BlockSink &sink) {
+    fetchFinished = false;
+    stopped = false;
+    fetchError = nullptr;
+
+    // Fetching runs on its own thread so the next block is read from the database while this one is sent
+    std::thread fetcher(&ResultStreamer::fetchLoop, this);
+
+    bool sent = true;
+    std::exception_ptr sinkError;
+    while (true) {
+        byte_buffer block;
+        {
+            std::unique_lock<std::mutex> lock(queueLock);
+            blockReady.wait(lock, [this]() { return !blocks.empty() || fetchFinished; });
+            if (blocks.empty()) {
+                break;
+            }
+            block = std::move(blocks.front());
+            blocks.pop_front();
+        }
+        spaceReady.notify_one();
+
+        try {
+            sent = sink(std::move(block));
+        } catch (...) {
+            sent = false;
+            sinkError = std::current_exception();
+        }
+        if (!sent) {
+            break;
+        }
+    }
+
+    // Make sure the fetch thread isn't left waiting for room which will never come
+    {
+        std::lock_guard<std::mutex> guard(queueLock);
+        stopped = true;
+        blocks.clear();
+    }
+    spaceReady.notify_one();
+    fetcher.join();
+
+    if (sinkError) {
+        std::rethrow_exception(sinkError);
+    }
+    if (fetchError) {
+        std::rethrow_exception(fetchError);
+    }
+    return sent;
+}
+
+size_t ResultStreamer::rowsFetched() const {
+    std::lock_guard<std::mutex> guard(queueLock);
+    return fetchedRows;
+}
+
+ResultStreamer::BlockSink ResultStreamer::streamSink(networking::Stream &stream) {
+    return [&stream](byte_buffer &&block) {
+        return stream.send(block);
+    };
+}
+
+ResultStreamer::BlockSink ResultStreamer::socketSink(const networking::TCPSocket &socket, AESKey key) {
+    return [socket, key](byte_buffer &&block) {
+        return socket.send(networking::AESMessage(std::move(block), key));
+    };
+}
+
+void ResultStreamer::fetchLoop() {
+    try {
+        bool more = result.fetchNextRow();
+        while (more) {
+            // Fill a block until it reaches either limit or the rows run out
+            size_t rows = 0;
+            encoder.beginBlock(result);
+            do {
+                encoder.addRow(result);
+                rows++;
+                more = result.fetchNextRow();
+            } while (more && rows < blockRows && encoder.blockSize() < blockBytes);
+
+            {
+                std::lock_guard<std::mutex> guard(queueLock);
+                fetchedRows += rows;
+            }
+            if (!pushBlock(encoder.finishBlock())) {
+                return;
+            }
+        }
+
+        // An empty block tells the client the result is complete
+        pushBlock(byte_buffer((size_t) 0));
+    } catch (...) {
+        std::lock_guard<std::mutex> guard(queueLock);
+        fetchError = std::current_exception();
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(queueLock);
+        fetchFinished = true;
+    }
+    blockReady.notify_one();
+}
+
+bool ResultStreamer::pushBlock(byte_buffer &&block) {
+    {
+        // This is the back-pressure: while the sending side is behind, stop reading from the database
+        std::unique_lock<std::mutex> lock(queueLock);
+        spaceReady.wait(lock, [this]() { return blocks.size() < queueDepth || stopped; });
+        if (stopped) {
+            return false;
+        }
+        blocks.push_back(std::move(block));
+    }
+    blockReady.notify_one();
+    return true;
+}
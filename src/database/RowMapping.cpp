@@ -0,0 +1,85 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include "../../include/database/RowMapping.h"
+
+using namespace sql;
+
+BlockCursor::BlockCursor(QueryResult &result, size_t blockRows)
+        : result(result), rowStatus(blockRows) {
+    const SQLStatementHandle &statement = result.sqlStatementHandle;
+
+    if (SQLSetStmtAttr(statement.get(), SQL_ATTR_ROW_BIND_TYPE, (SQLPOINTER) SQL_BIND_BY_COLUMN, 0) == SQL_ERROR ||
+        SQLSetStmtAttr(statement.get(), SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER) blockRows, 0) == SQL_ERROR ||
+        SQLSetStmtAttr(statement.get(), SQL_ATTR_ROW_STATUS_PTR, rowStatus.data(), 0) == SQL_ERROR ||
+        SQLSetStmtAttr(statement.get(), SQL_ATTR_ROWS_FETCHED_PTR, &rowsFetched, 0) == SQL_ERROR) {
+        SQLException error = statement.getError();
+        // Put back whichever attributes were set
+        reset();
+        throw error;
+    }
+}
+
+BlockCursor::~BlockCursor() {
+    reset();
+}
+
+void BlockCursor::reset() {
+    // Put the statement back to fetching single rows with nothing bound, so the result reads as normal again
+    const SQLStatementHandle &statement = result.sqlStatementHandle;
+    SQLFreeStmt(statement.get(), SQL_UNBIND);
+    SQLSetStmtAttr(statement.get(), SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER) 1, 0);
+    SQLSetStmtAttr(statement.get(), SQL_ATTR_ROW_STATUS_PTR, nullptr, 0);
+    SQLSetStmtAttr(statement.get(), SQL_ATTR_ROWS_FETCHED_PTR, nullptr, 0);
+}
+
+void BlockCursor::bind(size_t column, SQLSMALLINT cType, SQLPOINTER data, SQLLEN width, SQLLEN *indicators) {
+    const SQLStatementHandle &statement = result.sqlStatementHandle;
+    if (SQLBindCol(statement.get(), column + 1, cType, data, width, indicators) == SQL_ERROR) {
+        throw statement.getError();
+    }
+    boundIndicators.push_back(indicators);
+}
+
+size_t BlockCursor::fetch() {
+    if (result.exhausted) {
+        return 0;
+    }
+
+    rowsFetched = 0;
+    SQLRETURN ret = SQLFetch(result.sqlStatementHandle.get());
+    if (ret == SQL_ERROR) {
+        if (result.stats) {
+            result.stats->errors.fetch_add(1, std::memory_order_relaxed);
+        }
+        throw result.sqlStatementHandle.getError();
+    }
+    if (ret == SQL_NO_DATA) {
+        result.exhausted = true;
+        if (result.stats) {
+            result.recordFetch(0);
+        }
+        return 0;
+    }
+
+    // A block may partly succeed, so check each row. Truncated strings are caught as their values are taken
+    for (size_t row = 0; row < rowsFetched; row++) {
+        if (rowStatus[row] == SQL_ROW_ERROR) {
+            throw result.sqlStatementHandle.getError();
+        }
+    }
+
+    result.currentRowIndex += rowsFetched;
+    if (result.stats) {
+        uint64_t bytes = 0;
+        for (SQLLEN *indicators : boundIndicators) {
+            for (size_t row = 0; row < rowsFetched; row++) {
+                bytes += indicators[row] > 0 ? indicators[row] : 0;
+            }
+        }
+        result.recordBytes(bytes);
+        result.recordFetch(rowsFetched);
+    }
+    return rowsFetched;
+}
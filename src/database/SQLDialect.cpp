@@ -0,0 +1,483 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include <charconv>
+
+#include "../../include/database/SQLDialect.h"
+#include "../../include/database/SQLException.h"
+
+// Characters allowed for the keywords, separators and line breaks of a query, on top of its own strings
+#define QUERY_FIXED_LENGTH 128
+// Characters allowed for each number in a query
+#define QUERY_NUMBER_LENGTH 20
+
+using namespace sql;
+
+std::string SQLDialect::render(const SelectQuery &query) const {
+    std::string out;
+    out.reserve(renderedLength(query));
+    writeQuery(out, query);
+    return out;
+}
+
+std::vector<QueryParameter> SQLDialect::parameters(const SelectQuery &query) {
+    // Only the keyset condition has placeholders, where each term repeats the values of the terms before it
+    std::vector<QueryParameter> values;
+    for (size_t i = 0; i < query.afterKey.size(); i++) {
+        values.insert(values.end(), query.afterKey.begin(), query.afterKey.begin() + (long) i + 1);
+    }
+    return values;
+}
+
+std::string SQLDialect::quoteIdentifier(std::string_view identifier) const {
+    std::string out;
+    out.reserve(identifier.size() + 8);
+
+    // Quote each part of a qualified name separately, so the dots between them still qualify it
+    size_t start = 0;
+    while (true) {
+        size_t end = identifier.find('.', start);
+        writeQuotedPart(out, identifier.substr(start, end - start));
+        if (end == std::string_view::npos) {
+            return out;
+        }
+        out.append(".");
+        start = end + 1;
+    }
+}
+
+std::string SQLDialect::savepoint(std::string_view name) const {
+    return "SAVEPOINT " + quoteIdentifier(name);
+}
+
+std::string SQLDialect::rollbackToSavepoint(std::string_view name) const {
+    return "ROLLBACK TO SAVEPOINT " + quoteIdentifier(name);
+}
+
+std::optional<std::string> SQLDialect::releaseSavepoint(std::string_view name) const {
+    return "RELEASE SAVEPOINT " + quoteIdentifier(name);
+}
+
+const SQLDialect &SQLDialect::standard() {
+    static const StandardDialect dialect;
+    return dialect;
+}
+
+const SQLDialect &SQLDialect::sqlServer() {
+    static const SQLServerDialect dialect;
+    return dialect;
+}
+
+const SQLDialect &SQLDialect::oracle() {
+    static const OracleDialect dialect;
+    return dialect;
+}
+
+const SQLDialect &SQLDialect::sqlite() {
+    static const SQLiteDialect dialect;
+    return dialect;
+}
+
+const SQLDialect &SQLDialect::postgreSQL() {
+    static const PostgreSQLDialect dialect;
+    return dialect;
+}
+
+const SQLDialect &SQLDialect::forDBMS(std::string_view dbmsName) {
+    // Drivers report names such as "Microsoft SQL Server", "Oracle", "SQLite" and "PostgreSQL"
+    if (dbmsName.find("SQL Server") != std::string_view::npos) {
+        return sqlServer();
+    }
+    if (dbmsName.find("Oracle") != std::string_view::npos) {
+        return oracle();
+    }
+    if (dbmsName.find("SQLite") != std::string_view::npos) {
+        return sqlite();
+    }
+    if (dbmsName.find("PostgreSQL") != std::string_view::npos) {
+        return postgreSQL();
+    }
+    return standard();
+}
+
+void SQLDialect::writeQuery(std::string &out, const SelectQuery &query) const {
+    writeBody(out, query);
+    writePaging(out, query);
+}
+
+void SQLDialect::writeSelectModifiers(std::string &, const SelectQuery &) const {
+    // Standard SQL has nothing to add
+}
+
+void SQLDialect::writeFrom(std::string &out, const SelectQuery &query) const {
+    // Add a FROM clause for the root table
+    out.append("FROM ");
+    writeTable(out, query.rootTable, query.rootTableAlias);
+    out.append("\n");
+
+    // Add a join clause for every joined table (which may be none)
+    for (const JoinSpec &join : query.joins) {
+        switch (join.joinType) {
+            case JoinType::INNER:
+                out.append("INNER JOIN ");
+                break;
+            case JoinType::LEFT:
+                out.append("LEFT JOIN ");
+                break;
+            case JoinType::RIGHT:
+                out.append("RIGHT JOIN ");
+                break;
+        }
+        writeTable(out, join.table, join.tableAlias);
+        out.append(" ON ").append(join.joinFrom).append("=").append(join.joinOnto).append("\n");
+    }
+}
+
+bool SQLDialect::joinsInWhere() const {
+    return false;
+}
+
+void SQLDialect::writeJoinConditions(std::string &, const SelectQuery &, bool) const {
+    // Standard SQL gives join conditions in the FROM clause
+}
+
+size_t SQLDialect::extraLength(const SelectQuery &) const {
+    return 0;
+}
+
+void SQLDialect::writeBody(std::string &out, const SelectQuery &query) const {
+    // Always begins with a SELECT statement, followed by every column we wish to select separated by commas
+    out.append("SELECT ");
+    writeSelectModifiers(out, query);
+    writeList(out, query.selections, ", ");
+    out.append("\n");
+
+    writeFrom(out, query);
+
+    // If there are any where conditions, add the WHERE clause with each condition joined by an AND
+    bool filtered = !query.whereConditions.empty() || !query.afterKey.empty();
+    bool joinConditions = joinsInWhere() && !query.joins.empty();
+    if (filtered || joinConditions) {
+        out.append("WHERE ");
+        if (joinConditions) {
+            writeJoinConditions(out, query, filtered);
+        }
+        writeList(out, query.whereConditions, " AND ");
+        if (!query.afterKey.empty()) {
+            if (!query.whereConditions.empty()) {
+                out.append(" AND ");
+            }
+            writeKeysetCondition(out, query);
+        }
+        out.append("\n");
+    }
+
+    // If there are any group by conditions, add the GROUP BY clause. This has to come before the ORDER BY
+    if (!query.groupByConditions.empty()) {
+        out.append("GROUP BY ");
+        writeList(out, query.groupByConditions, ", ");
+        out.append("\n");
+    }
+
+    // If there are any order by conditions, add the ORDER BY clause with each condition's direction
+    if (!query.orderByConditions.empty()) {
+        out.append("ORDER BY ");
+        for (size_t i = 0; i < query.orderByConditions.size(); i++) {
+            const OrderSpec &order = query.orderByConditions[i];
+            if (i != 0) {
+                out.append(", ");
+            }
+            out.append(order.clause).append(order.direction == OrderDirection::ASC ? " ASC" : " DESC");
+        }
+        out.append("\n");
+    }
+}
+
+void SQLDialect::writeKeysetCondition(std::string &out, const SelectQuery &query) {
+    // The key has to give a value for each column the rows are ordered by
+    if (query.afterKey.size() != query.orderByConditions.size()) {
+        throw SQLException("Keyset pagination needs a key value for each of the " +
+                           std::to_string(query.orderByConditions.size()) + " order by conditions, but " +
+                           std::to_string(query.afterKey.size()) + " were given.");
+    }
+
+    // A row comes after the key if it is equal on the first few order by columns and then past the key on the
+    // next, e.g. (a > x) OR (a = x AND b > y). Past means greater for ascending and less for descending columns
+    out.append("(");
+    for (size_t i = 0; i < query.afterKey.size(); i++) {
+        if (i != 0) {
+            out.append(" OR ");
+        }
+        out.append("(");
+        for (size_t j = 0; j < i; j++) {
+            out.append(query.orderByConditions[j].clause).append(" = ? AND ");
+        }
+        out.append(query.orderByConditions[i].clause)
+                .append(query.orderByConditions[i].direction == OrderDirection::ASC ? " > ?)" : " < ?)");
+    }
+    out.append(")");
+}
+
+void SQLDialect::writeQuotedPart(std::string &out, std::string_view part) const {
+    out.append("\"");
+    for (char c : part) {
+        if (c == '"') {
+            out.push_back('"');
+        }
+        out.push_back(c);
+    }
+    out.append("\"");
+}
+
+void SQLDialect::writeNumber(std::string &out, size_t number) {
+    char digits[QUERY_NUMBER_LENGTH];
+    std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), number);
+    out.append(digits, result.ptr);
+}
+
+void SQLDialect::writeTable(std::string &out, const std::string &table, const std::optional<std::string> &alias) {
+    out.append(table);
+    if (alias.has_value()) {
+        out.append(" ").append(alias.value());
+    }
+}
+
+void SQLDialect::writeList(std::string &out, const std::vector<std::string> &items, std::string_view separator) {
+    for (size_t i = 0; i < items.size(); i++) {
+        if (i != 0) {
+            out.append(separator);
+        }
+        out.append(items[i]);
+    }
+}
+
+size_t SQLDialect::renderedLength(const SelectQuery &query) const {
+    // Every string in the query appears once, with a separator of at most a few characters after it, except the
+    // order by columns in the keyset condition, where the earlier ones are repeated in each of its terms
+    size_t length = QUERY_FIXED_LENGTH + 2 * QUERY_NUMBER_LENGTH + extraLength(query);
+
+    length += query.rootTable.size() + (query.rootTableAlias.has_value() ? query.rootTableAlias->size() + 1 : 0);
+    for (const JoinSpec &join : query.joins) {
+        length += join.table.size() + (join.tableAlias.has_value() ? join.tableAlias->size() + 1 : 0) +
+                  join.joinFrom.size() + join.joinOnto.size() + 24;
+    }
+    for (const std::vector<std::string> *list : {&query.selections, &query.whereConditions,
+                                                 &query.groupByConditions}) {
+        for (const std::string &item : *list) {
+            length += item.size() + 5;
+        }
+    }
+    for (const OrderSpec &order : query.orderByConditions) {
+        length += order.clause.size() + 7;
+    }
+
+    size_t keyTerm = 0;
+    for (size_t i = 0; i < query.afterKey.size() && i < query.orderByConditions.size(); i++) {
+        length += keyTerm + query.orderByConditions[i].clause.size() + 10;
+        keyTerm += query.orderByConditions[i].clause.size() + 9;
+    }
+
+    return length;
+}
+
+std::string_view StandardDialect::name() const {
+    return "Standard SQL";
+}
+
+void StandardDialect::writePaging(std::string &out, const SelectQuery &query) const {
+    if (!query.offset.has_value() && !query.limit.has_value()) {
+        return;
+    }
+
+    // Either clause may be given alone, but an offset comes first
+    if (query.offset.has_value()) {
+        out.append("OFFSET ");
+        writeNumber(out, query.offset.value());
+        out.append(query.limit.has_value() ? " ROWS " : " ROWS");
+    }
+    if (query.limit.has_value()) {
+        out.append("FETCH FIRST ");
+        writeNumber(out, query.limit.value());
+        out.append(" ROWS ONLY");
+    }
+    out.append("\n");
+}
+
+std::string_view SQLServerDialect::name() const {
+    return "SQL Server";
+}
+
+std::string SQLServerDialect::savepoint(std::string_view name) const {
+    return "SAVE TRANSACTION " + quoteIdentifier(name);
+}
+
+std::string SQLServerDialect::rollbackToSavepoint(std::string_view name) const {
+    return "ROLLBACK TRANSACTION " + quoteIdentifier(name);
+}
+
+std::optional<std::string> SQLServerDialect::releaseSavepoint(std::string_view) const {
+    // A saved transaction lasts until the transaction around it ends
+    return std::nullopt;
+}
+
+void SQLServerDialect::writeSelectModifiers(std::string &out, const SelectQuery &query) const {
+    // If there is a limit but no offset, add a TOP statement to the query. With an offset, the limit is given by
+    // the FETCH clause at the end instead
+    if (query.limit.has_value() && !query.offset.has_value()) {
+        out.append("TOP ");
+        writeNumber(out, query.limit.value());
+        out.append(" ");
+    }
+}
+
+void SQLServerDialect::writeQuotedPart(std::string &out, std::string_view part) const {
+    out.append("[");
+    for (char c : part) {
+        if (c == ']') {
+            out.push_back(']');
+        }
+        out.push_back(c);
+    }
+    out.append("]");
+}
+
+void SQLServerDialect::writePaging(std::string &out, const SelectQuery &query) const {
+    if (!query.offset.has_value()) {
+        return;
+    }
+
+    // Without an order by, order by a constant, which leaves the rows in whatever order the server finds them
+    if (query.orderByConditions.empty()) {
+        out.append("ORDER BY (SELECT NULL)\n");
+    }
+    out.append("OFFSET ");
+    writeNumber(out, query.offset.value());
+    out.append(" ROWS");
+    if (query.limit.has_value()) {
+        out.append(" FETCH NEXT ");
+        writeNumber(out, query.limit.value());
+        out.append(" ROWS ONLY");
+    }
+    out.append("\n");
+}
+
+std::string_view OracleDialect::name() const {
+    return "Oracle";
+}
+
+std::optional<std::string> OracleDialect::releaseSavepoint(std::string_view) const {
+    // Oracle keeps savepoints until the transaction ends
+    return std::nullopt;
+}
+
+void OracleDialect::writeQuery(std::string &out, const SelectQuery &query) const {
+    // ROWNUM is only given out as rows pass the WHERE clause of the query it belongs to, and before its ORDER BY.
+    // So a plain limit is given in a further query wrapped around the ordered rows. With an offset, the paging
+    // goes at the end of the query itself
+    if (query.limit.has_value() && !query.offset.has_value()) {
+        out.append("SELECT * FROM (\n");
+    }
+
+    writeBody(out, query);
+    writePaging(out, query);
+}
+
+void OracleDialect::writeFrom(std::string &out, const SelectQuery &query) const {
+    // Every table goes in the FROM clause, and is joined by the conditions in the WHERE clause
+    out.append("FROM ");
+    writeTable(out, query.rootTable, query.rootTableAlias);
+    for (const JoinSpec &join : query.joins) {
+        out.append(", ");
+        writeTable(out, join.table, join.tableAlias);
+    }
+    out.append("\n");
+}
+
+bool OracleDialect::joinsInWhere() const {
+    return true;
+}
+
+void OracleDialect::writeJoinConditions(std::string &out, const SelectQuery &query, bool more) const {
+    // Outer joins mark the side which may be missing with (+)
+    for (size_t i = 0; i < query.joins.size(); i++) {
+        const JoinSpec &join = query.joins[i];
+        switch (join.joinType) {
+            case JoinType::INNER:
+                out.append(join.joinFrom).append("=").append(join.joinOnto);
+                break;
+            case JoinType::LEFT:
+                out.append(join.joinFrom).append("=").append(join.joinOnto).append("(+)");
+                break;
+            case JoinType::RIGHT:
+                out.append(join.joinFrom).append("(+)=").append(join.joinOnto);
+                break;
+        }
+
+        if (i != query.joins.size() - 1 || more) {
+            out.append(" AND\n");
+        }
+    }
+}
+
+void OracleDialect::writePaging(std::string &out, const SelectQuery &query) const {
+    if (query.offset.has_value()) {
+        out.append("OFFSET ");
+        writeNumber(out, query.offset.value());
+        out.append(" ROWS");
+        if (query.limit.has_value()) {
+            out.append(" FETCH NEXT ");
+            writeNumber(out, query.limit.value());
+            out.append(" ROWS ONLY");
+        }
+        out.append("\n");
+    } else if (query.limit.has_value()) {
+        // Close the query opened around the body
+        out.append(")\nWHERE ROWNUM <= ");
+        writeNumber(out, query.limit.value());
+        out.append("\n");
+    }
+}
+
+size_t OracleDialect::extraLength(const SelectQuery &) const {
+    // The wrapping query, and the tables which move from joins to the FROM clause
+    return QUERY_FIXED_LENGTH;
+}
+
+std::string_view SQLiteDialect::name() const {
+    return "SQLite";
+}
+
+void SQLiteDialect::writePaging(std::string &out, const SelectQuery &query) const {
+    // SQLite only takes an offset after a limit, where a negative limit means no limit
+    if (query.limit.has_value()) {
+        out.append("LIMIT ");
+        writeNumber(out, query.limit.value());
+    } else if (query.offset.has_value()) {
+        out.append("LIMIT -1");
+    } else {
+        return;
+    }
+    if (query.offset.has_value()) {
+        out.append(" OFFSET ");
+        writeNumber(out, query.offset.value());
+    }
+    out.append("\n");
+}
+
+std::string_view PostgreSQLDialect::name() const {
+    return "PostgreSQL";
+}
+
+void PostgreSQLDialect::writePaging(std::string &out, const SelectQuery &query) const {
+    if (query.limit.has_value()) {
+        out.append("LIMIT ");
+        writeNumber(out, query.limit.value());
+        out.append("\n");
+    }
+    if (query.offset.has_value()) {
+        out.append("OFFSET ");
+        writeNumber(out, query.offset.value());
+        out.append("\n");
+    }
+}
@@ -7,14 +7,13 @@
 using namespace sql;
 
 SQLException::SQLException(const std::string &message)
-        : std::exception(message.c_str()) {
+        : message(message) {
 
 }
 
 // Passes the state and error messages in a formatted string to the base exception
 SQLException::SQLException(const std::string &sqlState, const std::string &sqlError)
-        : std::exception(("SQL Error (" + sqlState + "): " + sqlError).c_str()),
-          sqlState(sqlState), sqlError(sqlError) {
+        : sqlState(sqlState), sqlError(sqlError), message("SQL Error (" + sqlState + "): " + sqlError) {
 
 }
 
@@ -26,7 +25,12 @@ const std::string SQLException::error() const {
     return sqlError;
 }
 
-UnknownSQLException::UnknownSQLException()
-        : std::exception("Unknown SQL Exception") {
+const char *SQLException::what() const noexcept {
+    return message.c_str();
+}
+
+UnknownSQLException::UnknownSQLException() = default;
 
+const char *UnknownSQLException::what() const noexcept {
+    return "Unknown SQL Exception";
 }
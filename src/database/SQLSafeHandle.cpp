@@ -55,21 +55,6 @@ SQLSafeHandle<handleType> &SQLSafeHandle<handleType>::operator=(SQLSafeHandle<ha
     return *this;
 }
 
-template<HandleType handleType>
-constexpr SQLSafeHandle<handleType>::operator bool() noexcept {
-    return __handle;
-}
-
-template<HandleType handleType>
-constexpr bool SQLSafeHandle<handleType>::operator==(const SQLSafeHandle<handleType> &other) noexcept {
-    return __handle == other.__handle;
-}
-
-template<HandleType handleType>
-constexpr bool SQLSafeHandle<handleType>::operator!=(const SQLSafeHandle<handleType> &other) noexcept {
-    return __handle != other.__handle;
-}
-
 template<HandleType handleType>
 void SQLSafeHandle<handleType>::allocate() {
     // Allocate the handle and switch the return value
@@ -2,6 +2,8 @@
 // Created by Matthew.Sirman on 20/08/2020.
 //
 
+#include <algorithm>
+
 #include "../../include/database/SQLSession.h"
 
 using namespace sql;
@@ -20,8 +22,10 @@ SQLSession::~SQLSession() {
 }
 
 void SQLSession::connect(const std::string &dsn, const std::string &userID, const std::string &password) {
-    // Create the connection handle
+    // Create the connection handle, with a fresh pool of statements for it, as any earlier connection's pool
+    // was closed with it
     sqlConnHandle.allocate(sqlEnvHandle);
+    statements = std::make_shared<StatementPool>();
 
     // Declare the connection string
     std::stringstream connectionString;
@@ -48,27 +52,225 @@ void SQLSession::connect(const std::string &dsn, const std::string &userID, cons
             // Throw an unknown exception - this code wasn't picked up from the return value
             throw UnknownSQLException();
     }
+
+    // Pick the dialect for the database the driver is connected to. If the driver won't say, keep the current one
+    SQLCHAR dbmsName[256];
+    SQLSMALLINT nameLength = 0;
+    if (SQL_SUCCEEDED(SQLGetInfo(sqlConnHandle.get(), SQL_DBMS_NAME, dbmsName, sizeof(dbmsName), &nameLength))) {
+        nameLength = std::min<SQLSMALLINT>(nameLength, sizeof(dbmsName) - 1);
+        sqlDialect = &SQLDialect::forDBMS(std::string_view((const char *) dbmsName, nameLength));
+    }
+}
+
+const SQLDialect &SQLSession::dialect() const {
+    return *sqlDialect;
+}
+
+void SQLSession::setDialect(const SQLDialect &newDialect) {
+    sqlDialect = &newDialect;
 }
 
 void SQLSession::execute(const std::string &sql) {
-    // Set up the internal statement handle ready for use if necessary
-    setupStatementHandle();
+    std::lock_guard<std::mutex> guard(connectionLock);
 
-    // Execute the SQL query passed in
-    handleInternalError(SQLExecDirect(sqlStatementHandle.get(), (SQLCHAR *) sql.c_str(), SQL_NTS), sqlStatementHandle);
+    // Execute the SQL query passed in on a pooled statement. Holding it in a result gives it back, closing any
+    // cursor the statement opened, even if it fails. A failed statement may still have written something, so
+    // cached results are invalidated either way
+    SQLRETURN ret;
+    QueryResult result = executeDirect(sql, ret);
+    invalidateWrites(QueryCache::writtenTables(sql));
+    handleInternalError(ret, result.sqlStatementHandle);
 }
 
 sql::QueryResult SQLSession::executeQuery(const std::string &sql) {
-    // Create a handle for this query - this allows for "query parallelism" i.e. having multiple queries which do
-    // not necessarily require to be executed in order.
-    SQLStatementHandle queryStatementHandle;
-    queryStatementHandle.allocate(sqlConnHandle);
+    return executeQuery(sql, {});
+}
 
-    // Execute the query with
-    handleInternalError(SQLExecDirect(queryStatementHandle.get(), (SQLCHAR *) sql.c_str(), SQL_NTS), queryStatementHandle);
+sql::QueryResult SQLSession::executeQuery(const std::string &sql, const std::vector<QueryParameter> &parameters) {
+    std::lock_guard<std::mutex> guard(connectionLock);
+
+    // Execute the query on its own handle - this allows for "query parallelism" i.e. having multiple queries which
+    // do not necessarily require to be executed in order. The result gives it back to the pool once it is
+    // finished with, including if the query fails
+    SQLRETURN ret;
+    QueryResult result = executeDirect(sql, ret, parameters);
+    handleInternalError(ret, result.sqlStatementHandle);
 
     // Return a a query result
-    return QueryResult(std::move(queryStatementHandle));
+    return result;
+}
+
+std::shared_ptr<const CachedResult> SQLSession::executeCachedQuery(const std::string &sql,
+                                                                   const std::vector<std::string> &tables,
+                                                                   QueryCache::Clock::duration timeToLive) {
+    return executeCachedQuery(sql, {}, tables, timeToLive);
+}
+
+std::shared_ptr<const CachedResult> SQLSession::executeCachedQuery(const std::string &sql,
+                                                                   const std::vector<QueryParameter> &parameters,
+                                                                   const std::vector<std::string> &tables,
+                                                                   QueryCache::Clock::duration timeToLive) {
+    std::vector<std::string> keys;
+    keys.reserve(parameters.size());
+    for (const QueryParameter &parameter : parameters) {
+        keys.push_back(parameter.key());
+    }
+
+    uint64_t readGeneration = 0;
+    if (cache) {
+        std::shared_ptr<const CachedResult> cached = cache->find(sql, keys);
+        if (cached) {
+            return cached;
+        }
+        readGeneration = cache->generation();
+    }
+
+    QueryResult result = executeQuery(sql, parameters);
+    std::shared_ptr<const CachedResult> cached = std::make_shared<const CachedResult>(result);
+
+    // A result read inside a transaction may include its uncommitted writes, so isn't kept
+    if (cache && !inTransaction()) {
+        cache->store(sql, keys, tables, cached, timeToLive, readGeneration);
+    }
+    return cached;
+}
+
+void SQLSession::setQueryCache(std::shared_ptr<QueryCache> newCache) {
+    cache = std::move(newCache);
+}
+
+const std::shared_ptr<QueryCache> &SQLSession::queryCache() const {
+    return cache;
+}
+
+void SQLSession::setStatementMetrics(std::shared_ptr<StatementMetrics> newMetrics) {
+    metricsSink = std::move(newMetrics);
+}
+
+const std::shared_ptr<StatementMetrics> &SQLSession::statementMetrics() const {
+    return metricsSink;
+}
+
+BulkInsertResult SQLSession::bulkInsert(const BulkInsert &batch) {
+    BulkInsertResult result;
+    result.rowStatus.assign(batch.rowCount(), BulkRowStatus::NOT_RUN);
+    if (batch.rowCount() == 0) {
+        result.committed = true;
+        return result;
+    }
+
+    // Run every chunk in one transaction, so either the whole batch is kept or none of it is. If the caller
+    // already has a transaction open, the batch joins it behind a savepoint instead, so a failed batch can be
+    // undone without losing what the caller wrote before it. Which of the two is decided under the connection
+    // lock, held until the batch is finished, so no other thread can begin or end a transaction in between
+    const SQLDialect &sessionDialect = dialect();
+    std::lock_guard<std::mutex> guard(connectionLock);
+    bool ownTransaction = !transactionActive;
+
+    if (ownTransaction) {
+        startTransaction();
+    } else {
+        executeStatement(sessionDialect.savepoint(BULK_INSERT_SAVEPOINT));
+    }
+
+    bool succeeded = true;
+    try {
+        // Prepare the insert once, to be executed for every chunk
+        SQLStatementHandle statement;
+        statement.allocate(sqlConnHandle);
+        std::string text = batch.statement(sessionDialect);
+        std::shared_ptr<StatementStats> stats = metricsSink ? metricsSink->statement(text) : nullptr;
+        metrics::LatencyHistogram::Clock::time_point start;
+        if (stats) {
+            stats->handleAllocations.fetch_add(1, std::memory_order_relaxed);
+            start = metrics::LatencyHistogram::Clock::now();
+        }
+        SQLRETURN prepared = SQLPrepare(statement.get(), (SQLCHAR *) text.c_str(), SQL_NTS);
+        if (stats) {
+            stats->prepare.record(metrics::LatencyHistogram::Clock::now() - start);
+        }
+        handleInternalError(prepared, statement);
+        handleInternalError(SQLSetStmtAttr(statement.get(), SQL_ATTR_PARAM_BIND_TYPE,
+                                           (SQLPOINTER) SQL_PARAM_BIND_BY_COLUMN, 0), statement);
+
+        for (size_t first = 0; first < batch.rowCount() && succeeded;) {
+            size_t count = batch.chunkRows(first);
+            succeeded = executeBulkChunk(statement, batch, first, count, result, stats.get());
+            first += count;
+        }
+    } catch (...) {
+        // Undo the rows so far, either with the session's own transaction or back to the savepoint in the
+        // caller's. If even that fails, the transaction is in no state to commit anyway
+        try {
+            if (ownTransaction) {
+                finishTransaction(false);
+            } else {
+                executeStatement(sessionDialect.rollbackToSavepoint(BULK_INSERT_SAVEPOINT));
+            }
+        } catch (...) {
+        }
+        throw;
+    }
+
+    invalidateWrites(std::vector<std::string>{batch.tableName});
+
+    if (ownTransaction) {
+        finishTransaction(succeeded);
+    } else if (succeeded) {
+        std::optional<std::string> release = sessionDialect.releaseSavepoint(BULK_INSERT_SAVEPOINT);
+        if (release.has_value()) {
+            executeStatement(release.value());
+        }
+    } else {
+        executeStatement(sessionDialect.rollbackToSavepoint(BULK_INSERT_SAVEPOINT));
+    }
+    result.committed = succeeded;
+
+    // Rows the database accepted before another failed were undone with the rest of the batch
+    if (!succeeded) {
+        for (BulkRowStatus &status : result.rowStatus) {
+            if (status == BulkRowStatus::INSERTED) {
+                status = BulkRowStatus::ROLLED_BACK;
+            }
+        }
+        result.rowsInserted = 0;
+    }
+
+    return result;
+}
+
+std::future<void> SQLSession::executeAsync(const std::string &sql) {
+    // Packaged tasks can't be copied into the work queue, so share them instead
+    auto task = std::make_shared<std::packaged_task<void()>>([this, sql]() {
+        execute(sql);
+    });
+    std::future<void> result = task->get_future();
+    submit([task]() {
+        (*task)();
+    });
+    return result;
+}
+
+std::future<MaterializedResult> SQLSession::executeQueryAsync(const std::string &sql) {
+    auto task = std::make_shared<std::packaged_task<MaterializedResult()>>([this, sql]() {
+        return executeMaterialized(sql);
+    });
+    std::future<MaterializedResult> result = task->get_future();
+    submit([task]() {
+        (*task)();
+    });
+    return result;
+}
+
+void SQLSession::executeQueryAsync(const std::string &sql, QueryCallback callback) {
+    auto task = std::make_shared<std::packaged_task<MaterializedResult()>>([this, sql]() {
+        return executeMaterialized(sql);
+    });
+    auto result = std::make_shared<std::future<MaterializedResult>>(task->get_future());
+    submit([task, result, callback = std::move(callback)]() {
+        (*task)();
+        callback(std::move(*result));
+    });
 }
 
 sql::Table SQLSession::table(const std::string &tableName) {
@@ -82,9 +284,27 @@ sql::Table SQLSession::table(const std::string &tableName, const std::string &ta
     return Table(tableName, tableAlias, std::move(builder));
 }
 
+bool SQLSession::connectionAlive() {
+    std::lock_guard<std::mutex> guard(connectionLock);
+    if (!connected) {
+        return false;
+    }
+
+    SQLUINTEGER dead = SQL_CD_FALSE;
+    if (!SQL_SUCCEEDED(SQLGetConnectAttr(sqlConnHandle.get(), SQL_ATTR_CONNECTION_DEAD, &dead, 0, nullptr))) {
+        return true;
+    }
+    return dead != SQL_CD_TRUE;
+}
+
 void SQLSession::closeConnection() {
+    // Let any queued queries finish before the connection goes away
+    stopWorker();
+
     // If the object is connected to the database
     if (connected) {
+        // Free the idle statements while the connection is still open
+        statements->close();
         // Disconnect
         SQLDisconnect(sqlConnHandle.get());
         // Flag that we are now disconnected
@@ -92,13 +312,257 @@ void SQLSession::closeConnection() {
     }
 }
 
-void SQLSession::setupStatementHandle() {
-    // If we already have a statement handle, there is nothing to do
-    if (sqlStatementHandle) {
+void SQLSession::beginTransaction() {
+    std::lock_guard<std::mutex> guard(connectionLock);
+
+    if (transactionActive) {
+        throw SQLException("A transaction is already in progress.");
+    }
+    startTransaction();
+}
+
+void SQLSession::commit() {
+    endTransaction(true);
+}
+
+void SQLSession::rollback() {
+    endTransaction(false);
+}
+
+bool SQLSession::inTransaction() {
+    std::lock_guard<std::mutex> guard(connectionLock);
+    return transactionActive;
+}
+
+Transaction SQLSession::transaction() {
+    return Transaction(*this);
+}
+
+void SQLSession::setAutoCommit(bool autoCommit) {
+    handleInternalError(SQLSetConnectAttr(sqlConnHandle.get(), SQL_ATTR_AUTOCOMMIT,
+                                          (SQLPOINTER) (autoCommit ? SQL_AUTOCOMMIT_ON : SQL_AUTOCOMMIT_OFF), 0),
+                        sqlConnHandle);
+}
+
+void SQLSession::startTransaction() {
+    // With autocommit off, every statement from here on is held in one transaction until it is ended
+    setAutoCommit(false);
+    transactionActive = true;
+    transactionWrites.emplace();
+}
+
+void SQLSession::endTransaction(bool commit) {
+    std::lock_guard<std::mutex> guard(connectionLock);
+
+    if (!transactionActive) {
+        throw SQLException("No transaction is in progress.");
+    }
+    finishTransaction(commit);
+}
+
+void SQLSession::finishTransaction(bool commit) {
+    // Whatever happens, the session is no longer in the transaction, as a failed commit leaves nothing to roll
+    // back to
+    transactionActive = false;
+    SQLRETURN ret = SQLEndTran(SQL_HANDLE_DBC, sqlConnHandle.get(), commit ? SQL_COMMIT : SQL_ROLLBACK);
+    invalidateWrites(transactionWrites);
+
+    // A failed end is the error the caller needs, so it is reported ahead of any failure returning to autocommit,
+    // which would otherwise replace it and its diagnostic on the connection
+    try {
+        handleInternalError(ret, sqlConnHandle);
+    } catch (...) {
+        try {
+            setAutoCommit(true);
+        } catch (...) {
+        }
+        throw;
+    }
+    setAutoCommit(true);
+}
+
+void SQLSession::invalidateWrites(const std::optional<std::vector<std::string>> &tables) {
+    if (!cache) {
         return;
     }
-    // Otherwise, we create a new handle
-    sqlStatementHandle.allocate(sqlConnHandle);
+
+    if (tables.has_value()) {
+        for (const std::string &table : tables.value()) {
+            cache->invalidate(table);
+        }
+    } else {
+        cache->clear();
+    }
+
+    // Remember the writes of a transaction until it ends
+    if (transactionActive && transactionWrites.has_value()) {
+        if (tables.has_value()) {
+            transactionWrites->insert(transactionWrites->end(), tables->begin(), tables->end());
+        } else {
+            transactionWrites.reset();
+        }
+    }
+}
+
+bool SQLSession::executeBulkChunk(const SQLStatementHandle &statement, const BulkInsert &batch, size_t first,
+                                  size_t count, BulkInsertResult &result, StatementStats *stats) {
+    // The driver writes the status of each row, and how many rows it got through, into these
+    std::vector<SQLUSMALLINT> status(count, SQL_PARAM_UNUSED);
+    SQLULEN processed = 0;
+    handleInternalError(SQLSetStmtAttr(statement.get(), SQL_ATTR_PARAMSET_SIZE, (SQLPOINTER) count, 0), statement);
+    handleInternalError(SQLSetStmtAttr(statement.get(), SQL_ATTR_PARAM_STATUS_PTR, status.data(), 0), statement);
+    handleInternalError(SQLSetStmtAttr(statement.get(), SQL_ATTR_PARAMS_PROCESSED_PTR, &processed, 0), statement);
+
+    BulkInsert::ChunkBuffers buffers;
+    batch.bindChunk(statement, first, count, buffers);
+
+    metrics::LatencyHistogram::Clock::time_point start;
+    if (stats) {
+        start = metrics::LatencyHistogram::Clock::now();
+    }
+    SQLRETURN ret = SQLExecute(statement.get());
+    if (stats) {
+        stats->execute.record(metrics::LatencyHistogram::Clock::now() - start);
+        stats->executions.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    bool rowFailed = false;
+    for (size_t row = 0; row < count; row++) {
+        BulkRowStatus &rowStatus = result.rowStatus[first + row];
+        if (row >= processed) {
+            rowStatus = BulkRowStatus::NOT_RUN;
+            continue;
+        }
+        switch (status[row]) {
+            case SQL_PARAM_SUCCESS:
+            case SQL_PARAM_SUCCESS_WITH_INFO:
+                rowStatus = BulkRowStatus::INSERTED;
+                result.rowsInserted++;
+                break;
+            case SQL_PARAM_UNUSED:
+                rowStatus = BulkRowStatus::NOT_RUN;
+                break;
+            default:
+                // Either the row failed, or the driver failed the chunk as a whole without saying which row
+                rowStatus = BulkRowStatus::FAILED;
+                rowFailed = true;
+                break;
+        }
+    }
+
+    if (stats && (ret == SQL_ERROR || rowFailed)) {
+        stats->errors.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // An error which wasn't pinned on any row is a problem with the statement itself
+    if (ret == SQL_ERROR && !rowFailed) {
+        throw statement.getError();
+    }
+    handleInternalError(SQLFreeStmt(statement.get(), SQL_RESET_PARAMS), statement);
+
+    return ret != SQL_ERROR && !rowFailed;
+}
+
+void SQLSession::executeStatement(const std::string &sql) {
+    SQLRETURN ret;
+    QueryResult result = executeDirect(sql, ret);
+    handleInternalError(ret, result.sqlStatementHandle);
+}
+
+MaterializedResult SQLSession::executeMaterialized(const std::string &sql) {
+    std::lock_guard<std::mutex> guard(connectionLock);
+
+    // Read the result to the end under the lock, so no other statement runs on the connection while its cursor
+    // is open. Materializing releases the statement before the lock is
+    SQLRETURN ret;
+    QueryResult result = executeDirect(sql, ret);
+    handleInternalError(ret, result.sqlStatementHandle);
+    return MaterializedResult(std::move(result));
+}
+
+QueryResult SQLSession::executeDirect(const std::string &sql, SQLRETURN &ret,
+                                      const std::vector<QueryParameter> &parameters) {
+    std::shared_ptr<StatementStats> stats = metricsSink ? metricsSink->statement(sql) : nullptr;
+
+    // Statements only take handles under the connection lock, so any allocated in between are this statement's
+    size_t allocations = statements->allocations();
+    QueryResult result(statements->acquire(sqlConnHandle), statements);
+
+    // The parameters stay bound until the pool resets the handle, but are only read while the statement runs
+    for (size_t i = 0; i < parameters.size(); i++) {
+        parameters[i].bind(result.sqlStatementHandle, (SQLUSMALLINT) (i + 1));
+    }
+
+    if (!stats) {
+        ret = SQLExecDirect(result.sqlStatementHandle.get(), (SQLCHAR *) sql.c_str(), SQL_NTS);
+        return result;
+    }
+
+    metrics::LatencyHistogram::Clock::time_point start = metrics::LatencyHistogram::Clock::now();
+    ret = SQLExecDirect(result.sqlStatementHandle.get(), (SQLCHAR *) sql.c_str(), SQL_NTS);
+    result.instrument(std::move(stats), start, statements->allocations() - allocations, ret);
+    return result;
+}
+
+void SQLSession::setCallbackErrorHandler(CallbackErrorHandler handler) {
+    std::lock_guard<std::mutex> guard(workLock);
+    callbackErrorHandler = std::move(handler);
+}
+
+void SQLSession::submit(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> guard(workLock);
+        work.push_back(std::move(job));
+        if (!worker.joinable()) {
+            stopping = false;
+            worker = std::thread(&SQLSession::workerLoop, this);
+        }
+    }
+    workReady.notify_one();
+}
+
+void SQLSession::workerLoop() {
+    while (true) {
+        std::function<void()> job;
+        CallbackErrorHandler errorHandler;
+        {
+            std::unique_lock<std::mutex> lock(workLock);
+            workReady.wait(lock, [this]() { return !work.empty() || stopping; });
+            if (work.empty()) {
+                return;
+            }
+            job = std::move(work.front());
+            work.pop_front();
+            errorHandler = callbackErrorHandler;
+        }
+
+        // Errors from the query itself are carried by its future, so anything escaping here came from a
+        // completion callback, which must not take the worker down with it. There is no caller left to rethrow
+        // it to, so it goes to the error handler if there is one, and is dropped otherwise
+        try {
+            job();
+        } catch (...) {
+            if (errorHandler) {
+                try {
+                    errorHandler(std::current_exception());
+                } catch (...) {
+                    // The handler failing leaves nowhere else to report to
+                }
+            }
+        }
+    }
+}
+
+void SQLSession::stopWorker() {
+    {
+        std::lock_guard<std::mutex> guard(workLock);
+        if (!worker.joinable()) {
+            return;
+        }
+        stopping = true;
+    }
+    workReady.notify_one();
+    worker.join();
 }
 
 template<HandleType handleType>
@@ -0,0 +1,217 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include "../../include/database/SessionPool.h"
+
+using namespace sql;
+
+SessionLease::SessionLease(SessionPool &pool, SQLSession &session, size_t slot)
+        : pool(&pool), session(&session), slot(slot) {
+
+}
+
+SessionLease::SessionLease(SessionLease &&other) noexcept
+        : pool(other.pool), session(other.session), slot(other.slot) {
+    other.pool = nullptr;
+}
+
+SessionLease::~SessionLease() {
+    if (pool) {
+        pool->release(*session, slot);
+    }
+}
+
+SQLSession &SessionLease::operator*() const {
+    return *session;
+}
+
+SQLSession *SessionLease::operator->() const {
+    return session;
+}
+
+SessionPool::SessionPool(std::string dsn, std::string userID, std::string password, size_t maxSessions,
+                         std::shared_ptr<QueryCache> cache, std::shared_ptr<StatementMetrics> statementMetrics)
+        : dsn(std::move(dsn)), userID(std::move(userID)), password(std::move(password)),
+          maxSessions(std::max<size_t>(maxSessions, 1)), cache(std::move(cache)),
+          statementMetrics(std::move(statementMetrics)), slots(this->maxSessions) {
+
+}
+
+SessionLease SessionPool::acquire() {
+    std::thread::id self = std::this_thread::get_id();
+    std::unique_lock<std::mutex> lock(poolLock);
+
+    // A thread already holding a session, or with a transaction open on one, keeps using it
+    for (size_t i = 0; i < slots.size(); i++) {
+        if (slots[i].session && slots[i].owner == self && (slots[i].leases != 0 || slots[i].pinned)) {
+            slots[i].leases++;
+            return SessionLease(*this, *slots[i].session, i);
+        }
+    }
+
+    while (true) {
+        // Take a free session, preferring the one this thread used last
+        size_t chosen = slots.size(), empty = slots.size();
+        for (size_t i = 0; i < slots.size(); i++) {
+            const Slot &slot = slots[i];
+            if (!slot.session) {
+                // Slots are filled in order, but one whose session failed to open may be left behind
+                if (slot.leases == 0 && empty == slots.size()) {
+                    empty = i;
+                }
+            } else if (slot.leases == 0 && !slot.pinned && (chosen == slots.size() || slot.owner == self)) {
+                chosen = i;
+            }
+        }
+
+        if (chosen != slots.size()) {
+            slots[chosen].owner = self;
+            slots[chosen].leases = 1;
+
+            // Check the connection hasn't been lost while the session sat idle, without holding the lock as the
+            // driver may take a moment to answer. The slot is claimed, so nothing else touches it meanwhile
+            SQLSession *session = slots[chosen].session.get();
+            lock.unlock();
+            bool alive = session->connectionAlive();
+            lock.lock();
+            if (alive) {
+                return SessionLease(*this, *session, chosen);
+            }
+
+            // Replace a lost session, closing it outside the lock
+            std::unique_ptr<SQLSession> lost = std::move(slots[chosen].session);
+            lock.unlock();
+            lost.reset();
+            lock.lock();
+            return openInto(lock, chosen);
+        }
+
+        if (empty != slots.size()) {
+            // Claim the slot, then connect
+            slots[empty].owner = self;
+            slots[empty].leases = 1;
+            slots[empty].pinned = false;
+            return openInto(lock, empty);
+        }
+
+        // Every session is in use, so wait for one to be given back
+        sessionFree.wait(lock);
+    }
+}
+
+void SessionPool::execute(const std::string &sql) {
+    acquire()->execute(sql);
+}
+
+MaterializedResult SessionPool::executeQuery(const std::string &sql) {
+    // The result is read in full while the session is held, so no statement is left open on it afterwards
+    SessionLease lease = acquire();
+    return MaterializedResult(lease->executeQuery(sql));
+}
+
+std::shared_ptr<const CachedResult> SessionPool::executeCachedQuery(const std::string &sql,
+                                                                    const std::vector<std::string> &tables,
+                                                                    QueryCache::Clock::duration timeToLive) {
+    return acquire()->executeCachedQuery(sql, tables, timeToLive);
+}
+
+BulkInsertResult SessionPool::bulkInsert(const BulkInsert &batch) {
+    return acquire()->bulkInsert(batch);
+}
+
+void SessionPool::beginTransaction() {
+    // The session is kept for this thread when the lease is given back, as the transaction is then open
+    acquire()->beginTransaction();
+}
+
+void SessionPool::commit() {
+    acquire()->commit();
+}
+
+void SessionPool::rollback() {
+    acquire()->rollback();
+}
+
+bool SessionPool::inTransaction() {
+    // Only the calling thread's own session can have its transaction open, so check for one without taking a
+    // session which might otherwise be opened just to ask
+    std::thread::id self = std::this_thread::get_id();
+    SQLSession *held = nullptr;
+    {
+        std::lock_guard<std::mutex> guard(poolLock);
+        for (const Slot &slot : slots) {
+            if (slot.session && slot.owner == self) {
+                if (slot.pinned) {
+                    return true;
+                }
+                if (slot.leases != 0) {
+                    held = slot.session.get();
+                }
+            }
+        }
+    }
+
+    // A session the thread holds may have begun a transaction since it was taken. Only this thread uses it, so
+    // it can be asked without the pool lock
+    return held != nullptr && held->inTransaction();
+}
+
+size_t SessionPool::size() const {
+    std::lock_guard<std::mutex> guard(poolLock);
+    size_t opened = 0;
+    for (const Slot &slot : slots) {
+        if (slot.session) {
+            opened++;
+        }
+    }
+    return opened;
+}
+
+void SessionPool::release(SQLSession &session, size_t slot) {
+    // Check for an open transaction before taking the pool lock, as it takes the session's own lock
+    bool pinned = session.inTransaction();
+
+    {
+        std::lock_guard<std::mutex> guard(poolLock);
+        Slot &released = slots[slot];
+        if (--released.leases != 0) {
+            return;
+        }
+        released.pinned = pinned;
+        if (pinned) {
+            return;
+        }
+    }
+    sessionFree.notify_one();
+}
+
+SessionLease SessionPool::openInto(std::unique_lock<std::mutex> &lock, size_t slot) {
+    // Connecting can take a while, so is done without the lock
+    lock.unlock();
+    std::unique_ptr<SQLSession> session;
+    try {
+        session = open();
+    } catch (...) {
+        lock.lock();
+        slots[slot].leases = 0;
+        sessionFree.notify_one();
+        throw;
+    }
+
+    lock.lock();
+    slots[slot].session = std::move(session);
+    return SessionLease(*this, *slots[slot].session, slot);
+}
+
+std::unique_ptr<SQLSession> SessionPool::open() const {
+    std::unique_ptr<SQLSession> session = std::make_unique<SQLSession>();
+    session->connect(dsn, userID, password);
+    if (cache) {
+        session->setQueryCache(cache);
+    }
+    if (statementMetrics) {
+        session->setStatementMetrics(statementMetrics);
+    }
+    return session;
+}
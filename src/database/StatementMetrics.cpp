@@ -0,0 +1,222 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include <algorithm>
+#include <cctype>
+#include <iomanip>
+
+#include "../../include/database/StatementMetrics.h"
+
+using namespace sql;
+
+// Write a duration in nanoseconds as milliseconds
+static void writeMilliseconds(std::ostream &out, double nanoseconds) {
+    out << std::setw(10) << std::fixed << std::setprecision(3) << nanoseconds / 1e6;
+}
+
+StatementStats::StatementStats(std::string sql)
+        : sql(std::move(sql)) {
+
+}
+
+StatementMetrics::~StatementMetrics() {
+    stopDumping();
+}
+
+std::shared_ptr<StatementStats> StatementMetrics::statement(std::string_view sql) {
+    std::string normalised = normalise(sql);
+
+    std::lock_guard<std::mutex> guard(statementLock);
+    std::unordered_map<std::string, std::shared_ptr<StatementStats>>::iterator found = statements.find(normalised);
+    if (found != statements.end()) {
+        return found->second;
+    }
+
+    // Statements built with their values written in can be endless, so stop tracking them separately at the limit
+    if (statements.size() >= STATEMENT_METRICS_MAX_STATEMENTS) {
+        normalised = STATEMENT_METRICS_OVERFLOW;
+        found = statements.find(normalised);
+        if (found != statements.end()) {
+            return found->second;
+        }
+    }
+
+    std::shared_ptr<StatementStats> stats = std::make_shared<StatementStats>(normalised);
+    statements.emplace(std::move(normalised), stats);
+    return stats;
+}
+
+std::vector<StatementReport> StatementMetrics::report() const {
+    std::vector<std::shared_ptr<StatementStats>> tracked;
+    {
+        std::lock_guard<std::mutex> guard(statementLock);
+        tracked.reserve(statements.size());
+        for (const std::pair<const std::string, std::shared_ptr<StatementStats>> &entry : statements) {
+            tracked.push_back(entry.second);
+        }
+    }
+
+    // Summarising the histograms takes a while, so is done without holding the lock
+    std::vector<StatementReport> report;
+    report.reserve(tracked.size());
+    for (const std::shared_ptr<StatementStats> &stats : tracked) {
+        StatementReport &entry = report.emplace_back();
+        entry.sql = stats->sql;
+        entry.executions = stats->executions.load(std::memory_order_relaxed);
+        entry.errors = stats->errors.load(std::memory_order_relaxed);
+        entry.rows = stats->rows.load(std::memory_order_relaxed);
+        entry.bytes = stats->bytes.load(std::memory_order_relaxed);
+        entry.handleAllocations = stats->handleAllocations.load(std::memory_order_relaxed);
+        entry.prepare = stats->prepare.summary();
+        entry.execute = stats->execute.summary();
+        entry.firstRow = stats->firstRow.summary();
+        entry.drain = stats->drain.summary();
+        entry.totalExecuteTime = entry.execute.mean * (double) entry.execute.count;
+    }
+
+    std::sort(report.begin(), report.end(), [](const StatementReport &a, const StatementReport &b) {
+        return a.totalExecuteTime > b.totalExecuteTime;
+    });
+    return report;
+}
+
+void StatementMetrics::dump(std::ostream &out) const {
+    out << "      runs     errors       rows      bytes    handles   total ms    p50 ms    p99 ms  first ms  drain ms"
+           "  statement\n";
+    for (const StatementReport &entry : report()) {
+        out << std::setw(10) << entry.executions << ' ' << std::setw(10) << entry.errors << ' '
+            << std::setw(10) << entry.rows << ' ' << std::setw(10) << entry.bytes << ' '
+            << std::setw(10) << entry.handleAllocations << ' ';
+        writeMilliseconds(out, entry.totalExecuteTime);
+        writeMilliseconds(out, (double) entry.execute.p50);
+        writeMilliseconds(out, (double) entry.execute.p99);
+        writeMilliseconds(out, (double) entry.firstRow.p50);
+        writeMilliseconds(out, (double) entry.drain.p50);
+        out << "  " << entry.sql << '\n';
+    }
+}
+
+void StatementMetrics::dumpEvery(std::chrono::milliseconds interval, ReportSink sink) {
+    // Held until the new thread has started, so two calls at once can't both find no thread running and each
+    // start one
+    std::lock_guard<std::mutex> guard(dumperLock);
+    stopDumper();
+
+    {
+        std::lock_guard<std::mutex> stopGuard(dumpLock);
+        stopping = false;
+    }
+    dumper = std::thread(&StatementMetrics::dumpLoop, this, interval, std::move(sink));
+}
+
+void StatementMetrics::stopDumping() {
+    std::lock_guard<std::mutex> guard(dumperLock);
+    stopDumper();
+}
+
+void StatementMetrics::stopDumper() {
+    if (!dumper.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> guard(dumpLock);
+        stopping = true;
+    }
+    dumpStop.notify_one();
+    dumper.join();
+}
+
+void StatementMetrics::reset() {
+    // Sessions still holding the old measurements finish recording into them, but they are no longer reported
+    std::lock_guard<std::mutex> guard(statementLock);
+    statements.clear();
+}
+
+std::string StatementMetrics::normalise(std::string_view sql) {
+    std::string normalised;
+    normalised.reserve(sql.size());
+
+    // Write a placeholder for a literal, folding it into the previous one if it is part of a list
+    auto placeholder = [&normalised]() {
+        size_t end = normalised.size();
+        while (end != 0 && normalised[end - 1] == ' ') {
+            end--;
+        }
+        if (end != 0 && normalised[end - 1] == ',') {
+            size_t before = end - 1;
+            while (before != 0 && normalised[before - 1] == ' ') {
+                before--;
+            }
+            if (before != 0 && normalised[before - 1] == '?') {
+                normalised.resize(before);
+                return;
+            }
+        }
+        normalised.push_back('?');
+    };
+    auto identifierChar = [](char c) {
+        return std::isalnum((unsigned char) c) || c == '_' || c == '@' || c == '#' || c == '$';
+    };
+
+    size_t i = 0;
+    while (i < sql.size()) {
+        char c = sql[i];
+        if (std::isspace((unsigned char) c)) {
+            // Collapse whitespace into a single space, dropping it altogether at the ends
+            while (i < sql.size() && std::isspace((unsigned char) sql[i])) {
+                i++;
+            }
+            if (!normalised.empty() && i < sql.size()) {
+                normalised.push_back(' ');
+            }
+        } else if (c == '\'') {
+            // A string literal, in which a quote is escaped by doubling it
+            i++;
+            while (i < sql.size()) {
+                if (sql[i] == '\'') {
+                    if (i + 1 < sql.size() && sql[i + 1] == '\'') {
+                        i += 2;
+                        continue;
+                    }
+                    break;
+                }
+                i++;
+            }
+            i++;
+            placeholder();
+        } else if (std::isdigit((unsigned char) c) && (normalised.empty() || !identifierChar(normalised.back()))) {
+            // A number, rather than the digits in a name like table2
+            while (i < sql.size() && (std::isalnum((unsigned char) sql[i]) || sql[i] == '.')) {
+                i++;
+            }
+            placeholder();
+        } else if (c == '"' || c == '[' || c == '`') {
+            // A quoted name is kept as it is
+            char close = c == '[' ? ']' : c;
+            size_t end = sql.find(close, i + 1);
+            end = end == std::string_view::npos ? sql.size() : end + 1;
+            normalised.append(sql.substr(i, end - i));
+            i = end;
+        } else {
+            normalised.push_back(c);
+            i++;
+        }
+    }
+
+    return normalised;
+}
+
+void StatementMetrics::dumpLoop(std::chrono::milliseconds interval, ReportSink sink) {
+    std::unique_lock<std::mutex> lock(dumpLock);
+    while (!dumpStop.wait_for(lock, interval, [this]() { return stopping; })) {
+        // Report without holding the lock, so stopping isn't held up by a slow sink
+        lock.unlock();
+        try {
+            sink(report());
+        } catch (...) {
+            // A failing sink mustn't take the thread down with it; the next interval tries again
+        }
+        lock.lock();
+    }
+}
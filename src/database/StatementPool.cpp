@@ -0,0 +1,102 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include "../../include/database/StatementPool.h"
+
+using namespace sql;
+
+// StatementDefault
+// A statement attribute and the value a newly allocated handle has for it
+struct StatementDefault {
+    SQLINTEGER attribute;
+    SQLULEN value;
+};
+
+// The attributes put back to their defaults when a handle is given back: those the library sets for block fetches
+// and parameter arrays, and those which change how the next statement would run
+static const StatementDefault statementDefaults[] = {
+        {SQL_ATTR_QUERY_TIMEOUT, 0},
+        {SQL_ATTR_MAX_ROWS, 0},
+        {SQL_ATTR_CURSOR_TYPE, SQL_CURSOR_FORWARD_ONLY},
+        {SQL_ATTR_ROW_BIND_TYPE, SQL_BIND_BY_COLUMN},
+        {SQL_ATTR_ROW_ARRAY_SIZE, 1},
+        {SQL_ATTR_ROW_STATUS_PTR, 0},
+        {SQL_ATTR_ROWS_FETCHED_PTR, 0},
+        {SQL_ATTR_PARAM_BIND_TYPE, SQL_PARAM_BIND_BY_COLUMN},
+        {SQL_ATTR_PARAMSET_SIZE, 1},
+        {SQL_ATTR_PARAM_STATUS_PTR, 0},
+        {SQL_ATTR_PARAMS_PROCESSED_PTR, 0}
+};
+
+StatementPool::StatementPool(size_t capacity)
+        : capacity(capacity) {
+    // Room for every idle handle up front, so giving one back never allocates
+    idle.reserve(capacity);
+}
+
+SQLStatementHandle StatementPool::acquire(const SQLConnectionHandle &connection) {
+    {
+        std::lock_guard<std::mutex> guard(poolLock);
+        if (!idle.empty()) {
+            SQLStatementHandle handle = std::move(idle.back());
+            idle.pop_back();
+            return handle;
+        }
+    }
+
+    // Allocate outside the lock, so handles can still be given back while the driver works
+    SQLStatementHandle handle;
+    handle.allocate(connection);
+
+    std::lock_guard<std::mutex> guard(poolLock);
+    allocated++;
+    return handle;
+}
+
+void StatementPool::release(SQLStatementHandle &&handle) {
+    // Take the handle over, so it is freed on returning unless it is kept
+    SQLStatementHandle returned = std::move(handle);
+    if (returned == null_handle) {
+        return;
+    }
+
+    // Discard any rows left unread, along with any further result sets, then clear what the last statement bound
+    if (!SQL_SUCCEEDED(SQLFreeStmt(returned.get(), SQL_CLOSE)) ||
+        !SQL_SUCCEEDED(SQLFreeStmt(returned.get(), SQL_UNBIND)) ||
+        !SQL_SUCCEEDED(SQLFreeStmt(returned.get(), SQL_RESET_PARAMS))) {
+        return;
+    }
+
+    // Put back any attribute the last statement may have changed, so the next one runs as on a fresh handle.
+    // Only an exact success will do: with info, the driver may have substituted a different value
+    for (const StatementDefault &attribute : statementDefaults) {
+        if (SQLSetStmtAttr(returned.get(), attribute.attribute, (SQLPOINTER) attribute.value, 0) != SQL_SUCCESS) {
+            return;
+        }
+    }
+
+    std::lock_guard<std::mutex> guard(poolLock);
+    if (!closed && idle.size() < capacity) {
+        idle.push_back(std::move(returned));
+    }
+}
+
+void StatementPool::close() {
+    std::vector<SQLStatementHandle> freed;
+    {
+        std::lock_guard<std::mutex> guard(poolLock);
+        closed = true;
+        freed.swap(idle);
+    }
+}
+
+size_t StatementPool::idleCount() const {
+    std::lock_guard<std::mutex> guard(poolLock);
+    return idle.size();
+}
+
+size_t StatementPool::allocations() const {
+    std::lock_guard<std::mutex> guard(poolLock);
+    return allocated;
+}
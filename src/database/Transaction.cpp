@@ -0,0 +1,49 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include "../../include/database/Transaction.h"
+#include "../../include/database/SQLSession.h"
+
+using namespace sql;
+
+Transaction::Transaction(SQLSession &session)
+        : session(&session), __active(false) {
+    session.beginTransaction();
+    __active = true;
+}
+
+Transaction::Transaction(Transaction &&other) noexcept
+        : session(other.session), __active(other.__active) {
+    other.__active = false;
+}
+
+Transaction::~Transaction() {
+    if (__active) {
+        // A destructor mustn't throw, and if the rollback fails the connection is already in no state to use
+        try {
+            rollback();
+        } catch (...) {
+        }
+    }
+}
+
+void Transaction::commit() {
+    if (!__active) {
+        throw SQLException("Transaction has already ended.");
+    }
+    __active = false;
+    session->commit();
+}
+
+void Transaction::rollback() {
+    if (!__active) {
+        throw SQLException("Transaction has already ended.");
+    }
+    __active = false;
+    session->rollback();
+}
+
+bool Transaction::active() const {
+    return __active;
+}
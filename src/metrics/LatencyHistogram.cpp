@@ -0,0 +1,163 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include <limits>
+
+#include "../../include/metrics/LatencyHistogram.h"
+
+using namespace metrics;
+
+// The number of values counted exactly, below which buckets are one value wide
+#define LINEAR_BUCKETS (1u << LATENCY_HISTOGRAM_PRECISION_BITS)
+// The number of buckets each doubling of value is split into above the linear buckets
+#define OCTAVE_BUCKETS (1u << (LATENCY_HISTOGRAM_PRECISION_BITS - 1))
+
+// Get the index of the highest set bit of a non zero value
+static inline unsigned highestBit(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return 63u - (unsigned) __builtin_clzll(value);
+#else
+    unsigned bit = 0;
+    while (value >>= 1u) {
+        bit++;
+    }
+    return bit;
+#endif
+}
+
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+void LatencyHistogram::record(uint64_t value) {
+    buckets[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(value, std::memory_order_relaxed);
+
+    // The extremes rarely change, so only try to swap them when the value is past them
+    uint64_t current = smallest.load(std::memory_order_relaxed);
+    while (value < current && !smallest.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+    current = largest.load(std::memory_order_relaxed);
+    while (value > current && !largest.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t LatencyHistogram::count() const {
+    return total.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::percentile(double percent) const {
+    // Count the buckets as they are read, rather than trusting the total, which may have moved on since
+    uint64_t counts[BUCKET_COUNT];
+    uint64_t recorded = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+        counts[i] = buckets[i].load(std::memory_order_relaxed);
+        recorded += counts[i];
+    }
+    if (recorded == 0) {
+        return 0;
+    }
+
+    // The rank of the value wanted, counting from one, so the 0th percentile is the smallest value
+    double clamped = percent < 0 ? 0 : percent > 100 ? 100 : percent;
+    uint64_t rank = (uint64_t) ((clamped / 100.0) * (double) recorded + 0.5);
+    rank = rank == 0 ? 1 : rank;
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+        seen += counts[i];
+        if (seen >= rank) {
+            // No value can be beyond the largest recorded, which is exact where the bucket top is not. The last
+            // bucket also holds every value past the tracked range, so has no top of its own
+            uint64_t max = largest.load(std::memory_order_relaxed);
+            if (i == BUCKET_COUNT - 1) {
+                return max;
+            }
+            uint64_t top = bucketTop(i);
+            return top < max ? top : max;
+        }
+    }
+    return largest.load(std::memory_order_relaxed);
+}
+
+HistogramSummary LatencyHistogram::summary() const {
+    HistogramSummary summary;
+    summary.count = count();
+    if (summary.count == 0) {
+        return summary;
+    }
+
+    summary.min = smallest.load(std::memory_order_relaxed);
+    summary.max = largest.load(std::memory_order_relaxed);
+    summary.mean = (double) sum.load(std::memory_order_relaxed) / (double) summary.count;
+    summary.p50 = percentile(50);
+    summary.p90 = percentile(90);
+    summary.p99 = percentile(99);
+    summary.p999 = percentile(99.9);
+    return summary;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram &other) {
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+        uint64_t bucketCount = other.buckets[i].load(std::memory_order_relaxed);
+        if (bucketCount != 0) {
+            buckets[i].fetch_add(bucketCount, std::memory_order_relaxed);
+        }
+    }
+    uint64_t otherCount = other.total.load(std::memory_order_relaxed);
+    if (otherCount == 0) {
+        return;
+    }
+    total.fetch_add(otherCount, std::memory_order_relaxed);
+    sum.fetch_add(other.sum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+    uint64_t value = other.smallest.load(std::memory_order_relaxed);
+    uint64_t current = smallest.load(std::memory_order_relaxed);
+    while (value < current && !smallest.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+    value = other.largest.load(std::memory_order_relaxed);
+    current = largest.load(std::memory_order_relaxed);
+    while (value > current && !largest.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::reset() {
+    for (std::atomic<uint64_t> &bucket : buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    total.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+    smallest.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+    largest.store(0, std::memory_order_relaxed);
+}
+
+size_t LatencyHistogram::bucketOf(uint64_t value) {
+    if (value < LINEAR_BUCKETS) {
+        return (size_t) value;
+    }
+
+    // Values past the tracked range count as the largest tracked value
+    unsigned bit = highestBit(value);
+    if (bit >= LATENCY_HISTOGRAM_MAX_BITS) {
+        return BUCKET_COUNT - 1;
+    }
+
+    // Keep the top precision bits of the value, the first of which is always set
+    unsigned shift = bit - (LATENCY_HISTOGRAM_PRECISION_BITS - 1);
+    uint64_t mantissa = value >> shift;
+    return LINEAR_BUCKETS + (bit - LATENCY_HISTOGRAM_PRECISION_BITS) * OCTAVE_BUCKETS +
+           (size_t) (mantissa - OCTAVE_BUCKETS);
+}
+
+uint64_t LatencyHistogram::bucketTop(size_t bucket) {
+    if (bucket < LINEAR_BUCKETS) {
+        return bucket;
+    }
+
+    size_t octave = (bucket - LINEAR_BUCKETS) / OCTAVE_BUCKETS;
+    uint64_t mantissa = OCTAVE_BUCKETS + (bucket - LINEAR_BUCKETS) % OCTAVE_BUCKETS;
+    unsigned shift = (unsigned) octave + 1;
+    return ((mantissa + 1) << shift) - 1;
+}
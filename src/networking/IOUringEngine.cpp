@@ -0,0 +1,428 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include "../../include/networking/IOUringEngine.h"
+
+#ifdef CONTRACTS_IO_URING
+
+#include <cerrno>
+
+using namespace networking;
+
+IOUringEngine::IOUringEngine(unsigned entries, unsigned maxConnections, unsigned bufferCount, unsigned bufferSize)
+        : bufferMemory((size_t) bufferCount * bufferSize), bufferCount(bufferCount), bufferSize(bufferSize),
+          connections(maxConnections) {
+    // The kernel indexes the buffer ring with a mask, so it must be a power of two in size
+    if (bufferCount == 0 || (bufferCount & (bufferCount - 1)) != 0 || bufferCount > 32768) {
+        throw SocketException("io_uring buffer count must be a power of two no greater than 32768.");
+    }
+
+    // Create the ring. The liburing calls return a negated error code rather than setting errno, so copy it
+    // across for the exception message
+    io_uring_params params{};
+    int result = io_uring_queue_init_params(entries, &ring, &params);
+    if (result < 0) {
+        errno = -result;
+        throw SocketException("Failed to create io_uring.");
+    }
+
+    // Reserve the fixed file table for accepted connections. The kernel fills empty slots as it accepts
+    result = io_uring_register_files_sparse(&ring, maxConnections);
+    if (result < 0) {
+        io_uring_queue_exit(&ring);
+        errno = -result;
+        throw SocketException("Failed to register io_uring file table.");
+    }
+
+    // Register the receive buffer ring and hand every buffer to the kernel
+    bufferRing = io_uring_setup_buf_ring(&ring, bufferCount, BufferGroup, 0, &result);
+    if (!bufferRing) {
+        io_uring_queue_exit(&ring);
+        errno = -result;
+        throw SocketException("Failed to register io_uring buffer ring.");
+    }
+    for (unsigned i = 0; i < bufferCount; i++) {
+        io_uring_buf_ring_add(bufferRing, &bufferMemory[(size_t) i * bufferSize], bufferSize, i,
+                              io_uring_buf_ring_mask(bufferCount), (int) i);
+    }
+    io_uring_buf_ring_advance(bufferRing, (int) bufferCount);
+}
+
+IOUringEngine::~IOUringEngine() {
+    io_uring_free_buf_ring(&ring, bufferRing, bufferCount, BufferGroup);
+    io_uring_queue_exit(&ring);
+}
+
+bool IOUringEngine::supported() {
+    // Probe the kernel for each of the operations the engine submits
+    io_uring_probe *probe = io_uring_get_probe();
+    if (!probe) {
+        return false;
+    }
+
+    bool result = io_uring_opcode_supported(probe, IORING_OP_ACCEPT)
+                  && io_uring_opcode_supported(probe, IORING_OP_RECV)
+                  && io_uring_opcode_supported(probe, IORING_OP_SEND)
+                  && io_uring_opcode_supported(probe, IORING_OP_SHUTDOWN)
+                  && io_uring_opcode_supported(probe, IORING_OP_CLOSE)
+                  && io_uring_opcode_supported(probe, IORING_OP_FILES_UPDATE);
+
+    io_uring_free_probe(probe);
+    return result;
+}
+
+void IOUringEngine::onAccept(AcceptHandler handler) {
+    acceptHandler = std::move(handler);
+}
+
+void IOUringEngine::onMessage(MessageHandler handler) {
+    messageHandler = std::move(handler);
+}
+
+void IOUringEngine::onClose(CloseHandler handler) {
+    closeHandler = std::move(handler);
+}
+
+void IOUringEngine::setMaxMessageSize(size_t bytes) {
+    maxMessageSize = bytes;
+}
+
+void IOUringEngine::listen(const TCPSocket &listenSocket) {
+    listener = listenSocket;
+    armAccept();
+}
+
+void IOUringEngine::adopt(const TCPSocket &socket, AdoptHandler handler) {
+    if (!socket) {
+        throw SocketException("Cannot adopt a socket which is not open.");
+    }
+    // Anything the connection protocol left coalesced on the socket must go out before the ring takes over
+    if (!socket.flush()) {
+        TCPSocket(socket).close();
+        return;
+    }
+
+    unsigned id = nextAdoption++;
+    Adoption &adoption = adoptions[id];
+    adoption.socket = socket;
+    adoption.descriptor = *socket.sock;
+    adoption.handler = std::move(handler);
+
+    // Install the descriptor in whichever slot of the fixed file table is free. The kernel writes the slot it
+    // picked back over the descriptor, which therefore stays in place until the install completes
+    io_uring_sqe *sqe = getSubmission();
+    io_uring_prep_files_update(sqe, &adoption.descriptor, 1, IORING_FILE_INDEX_ALLOC);
+    io_uring_sqe_set_data64(sqe, packUserData(Operation::INSTALL, id));
+}
+
+void IOUringEngine::send(ConnectionID connection, MessageBase &&message) {
+    Connection &target = connections[connection];
+    if (!target.open || target.closing) {
+        return;
+    }
+
+    // Frame the message and queue it behind anything already waiting
+    target.outbound.push_back(message.message());
+    armSend(connection);
+}
+
+void IOUringEngine::close(ConnectionID connection) {
+    Connection &target = connections[connection];
+    if (!target.open || target.closing) {
+        return;
+    }
+    target.closing = true;
+
+    // Shut the connection down first so the armed receive completes. The close is submitted once the shutdown
+    // completes, whether or not it succeeded - linking the two would cancel the close whenever the shutdown
+    // failed (e.g. the peer had already gone), leaking the slot
+    io_uring_sqe *sqe = getSubmission();
+    io_uring_prep_shutdown(sqe, (int) connection, SHUT_RDWR);
+    sqe->flags |= IOSQE_FIXED_FILE;
+    io_uring_sqe_set_data64(sqe, packUserData(Operation::SHUTDOWN, connection));
+}
+
+size_t IOUringEngine::poll(unsigned minCompletions) {
+    // Submit everything queued since the last poll and wait for the completions in a single system call
+    int result = io_uring_submit_and_wait(&ring, minCompletions);
+    if (result < 0 && result != -EINTR) {
+        errno = -result;
+        throw SocketException("Failed to submit to io_uring.");
+    }
+
+    // Process every completion available, then release them all back to the kernel at once
+    unsigned head;
+    io_uring_cqe *cqe;
+    size_t processed = 0;
+    io_uring_for_each_cqe(&ring, head, cqe) {
+        complete(cqe);
+        processed++;
+    }
+    io_uring_cq_advance(&ring, (unsigned) processed);
+
+    return processed;
+}
+
+unsigned long long IOUringEngine::packUserData(Operation operation, ConnectionID connection) const {
+    // The operation takes the top byte, the slot's generation the bits below it and the slot the bottom half
+    unsigned long long generation = connection < connections.size() ? connections[connection].generation : 0;
+    generation &= (1ull << IO_URING_GENERATION_BITS) - 1;
+    return ((unsigned long long) operation << (32u + IO_URING_GENERATION_BITS)) | (generation << 32u) | connection;
+}
+
+void IOUringEngine::armClose(ConnectionID connection) {
+    io_uring_sqe *sqe = getSubmission();
+    io_uring_prep_close_direct(sqe, connection);
+    io_uring_sqe_set_data64(sqe, packUserData(Operation::CLOSE, connection));
+}
+
+io_uring_sqe *IOUringEngine::getSubmission() {
+    io_uring_sqe *sqe = io_uring_get_sqe(&ring);
+    if (!sqe) {
+        // The submission queue is full, so push it to the kernel to make room
+        io_uring_submit(&ring);
+        sqe = io_uring_get_sqe(&ring);
+        if (!sqe) {
+            throw SocketException("io_uring submission queue is full.");
+        }
+    }
+    return sqe;
+}
+
+void IOUringEngine::armAccept() {
+    // Accept straight into a free slot of the fixed file table, so the connection never needs a descriptor
+    io_uring_sqe *sqe = getSubmission();
+    io_uring_prep_multishot_accept_direct(sqe, *listener.sock, nullptr, nullptr, 0);
+    io_uring_sqe_set_data64(sqe, packUserData(Operation::ACCEPT, 0));
+}
+
+void IOUringEngine::armReceive(ConnectionID connection) {
+    // Receive into whichever buffer the kernel picks from the ring, repeatedly until the receive is cancelled
+    io_uring_sqe *sqe = getSubmission();
+    io_uring_prep_recv_multishot(sqe, (int) connection, nullptr, 0, 0);
+    sqe->flags |= IOSQE_FIXED_FILE | IOSQE_BUFFER_SELECT;
+    sqe->buf_group = BufferGroup;
+    io_uring_sqe_set_data64(sqe, packUserData(Operation::RECEIVE, connection));
+}
+
+void IOUringEngine::armSend(ConnectionID connection) {
+    Connection &target = connections[connection];
+    if (target.sending || target.closing || target.outbound.empty()) {
+        return;
+    }
+
+    // Send whatever remains of the front message. Its buffer stays in the queue until the send completes
+    const NetworkMessage &message = target.outbound.front();
+    io_uring_sqe *sqe = getSubmission();
+    io_uring_prep_send(sqe, (int) connection, message.cbegin() + target.sendOffset,
+                       message.bufferSize() - target.sendOffset, platform::SendFlags);
+    sqe->flags |= IOSQE_FIXED_FILE;
+    io_uring_sqe_set_data64(sqe, packUserData(Operation::SEND, connection));
+    target.sending = true;
+}
+
+void IOUringEngine::recycleBuffer(unsigned short bufferID) {
+    io_uring_buf_ring_add(bufferRing, &bufferMemory[(size_t) bufferID * bufferSize], bufferSize, bufferID,
+                          io_uring_buf_ring_mask(bufferCount), 0);
+    io_uring_buf_ring_advance(bufferRing, 1);
+}
+
+void IOUringEngine::complete(const io_uring_cqe *cqe) {
+    // Unpack the operation, connection and generation from the user data
+    unsigned long long data = cqe->user_data;
+    Operation operation = (Operation) (data >> (32u + IO_URING_GENERATION_BITS));
+    unsigned generation = (unsigned) ((data >> 32u) & ((1ull << IO_URING_GENERATION_BITS) - 1));
+    ConnectionID connection = (ConnectionID) (data & 0xFFFFFFFFu);
+
+    // A completion for an earlier connection in a slot which has since been reused must not touch the new
+    // connection. A receive still has to give its buffer back, but is otherwise ignored too. Accepts and installs
+    // are not for a slot
+    if (operation != Operation::ACCEPT && operation != Operation::INSTALL
+        && generation != (connections[connection].generation & ((1u << IO_URING_GENERATION_BITS) - 1))) {
+        if (operation == Operation::RECEIVE && (cqe->flags & IORING_CQE_F_BUFFER)) {
+            recycleBuffer(cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+        }
+        return;
+    }
+
+    switch (operation) {
+        case Operation::ACCEPT:
+            completeAccept(cqe);
+            break;
+        case Operation::RECEIVE:
+            completeReceive(connection, cqe);
+            break;
+        case Operation::SEND:
+            completeSend(connection, cqe);
+            break;
+        case Operation::SHUTDOWN:
+            // The shutdown has been issued (or failed because the connection was already gone), so the slot can
+            // now be closed
+            armClose(connection);
+            break;
+        case Operation::INSTALL:
+            completeInstall(connection, cqe);
+            break;
+        case Operation::CLOSE: {
+            // Reset the slot ready for the kernel to reuse it, moving it on a generation so anything still in flight
+            // for this connection is ignored, then report the close
+            Connection &target = connections[connection];
+            SocketMetrics::add(SocketCounter::SocketsClosed);
+            target.generation++;
+            target.open = false;
+            target.closing = false;
+            target.sending = false;
+            target.decoder = NetworkMessageDecoder(maxMessageSize);
+            target.outbound.clear();
+            target.sendOffset = 0;
+            if (closeHandler) {
+                closeHandler(connection);
+            }
+            break;
+        }
+    }
+}
+
+void IOUringEngine::completeAccept(const io_uring_cqe *cqe) {
+    // A successful accept gives the fixed file slot the connection was installed in
+    if (cqe->res >= 0 && (unsigned) cqe->res < connections.size()) {
+        ConnectionID connection = (ConnectionID) cqe->res;
+        SocketMetrics::add(SocketCounter::Accepts);
+        SocketMetrics::add(SocketCounter::SocketsOpened);
+        connections[connection].open = true;
+        connections[connection].decoder = NetworkMessageDecoder(maxMessageSize);
+        armReceive(connection);
+        if (acceptHandler) {
+            acceptHandler(connection);
+        }
+    }
+
+    // The kernel stops a multishot accept on error, so rearm it
+    if (!(cqe->flags & IORING_CQE_F_MORE)) {
+        armAccept();
+    }
+}
+
+void IOUringEngine::completeReceive(ConnectionID connection, const io_uring_cqe *cqe) {
+    Connection &target = connections[connection];
+
+    // Each completion of the multishot receive stands in for a call to recv
+    SocketMetrics::add(SocketCounter::ReceiveCalls);
+    if (cqe->res > 0) {
+        SocketMetrics::add(SocketCounter::BytesReceived, (uint64_t) cqe->res);
+    }
+
+    if (cqe->flags & IORING_CQE_F_BUFFER) {
+        unsigned short bufferID = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+
+        // Feed the received bytes through the decoder, handing off each message as it completes. A buffer may
+        // end part way through a message, or hold the end of one and the start of the next
+        const byte *received = &bufferMemory[(size_t) bufferID * bufferSize];
+        size_t remaining = cqe->res > 0 ? (size_t) cqe->res : 0;
+        while (remaining > 0 && target.open && !target.closing) {
+            size_t used = target.decoder.decodeStream(received, remaining);
+            received += used;
+            remaining -= used;
+
+            // A header giving a message larger than we accept is refused before anything is allocated for it,
+            // and the rest of the stream can't be framed, so the connection is dropped
+            if (target.decoder.invalid()) {
+                SocketMetrics::add(SocketCounter::OversizedCloses);
+                close(connection);
+                break;
+            }
+
+            if (target.decoder.streamComplete()) {
+                NetworkMessage message = target.decoder.create();
+                target.decoder = NetworkMessageDecoder(maxMessageSize);
+                if (messageHandler) {
+                    messageHandler(connection, std::move(message));
+                }
+            }
+        }
+
+        // The data has been copied out, so the kernel can have the buffer back
+        recycleBuffer(bufferID);
+    }
+
+    if (!target.open || target.closing) {
+        return;
+    }
+
+    if (cqe->res == -ENOBUFS) {
+        // Every buffer was in use. The buffers have been recycled by now, so simply start receiving again
+        armReceive(connection);
+    } else if (cqe->res <= 0) {
+        // The peer closed the connection or it failed
+        SocketMetrics::add(cqe->res == 0 ? SocketCounter::EofCloses : SocketCounter::ResetCloses);
+        close(connection);
+    } else if (!(cqe->flags & IORING_CQE_F_MORE)) {
+        // The kernel ended the multishot receive, so rearm it
+        armReceive(connection);
+    }
+}
+
+void IOUringEngine::completeSend(ConnectionID connection, const io_uring_cqe *cqe) {
+    Connection &target = connections[connection];
+    target.sending = false;
+
+    SocketMetrics::add(SocketCounter::SendCalls);
+    if (cqe->res < 0) {
+        SocketMetrics::add(SocketCounter::SendErrors);
+    } else {
+        SocketMetrics::add(SocketCounter::BytesSent, (uint64_t) cqe->res);
+        if (!target.outbound.empty()
+            && (size_t) cqe->res < target.outbound.front().bufferSize() - target.sendOffset) {
+            SocketMetrics::add(SocketCounter::PartialWrites);
+        }
+    }
+
+    if (!target.open || target.closing) {
+        return;
+    }
+    if (cqe->res < 0) {
+        close(connection);
+        return;
+    }
+
+    // Move past what was written, dropping the front message once all of it has gone, then send the next part
+    target.sendOffset += (size_t) cqe->res;
+    if (target.sendOffset >= target.outbound.front().bufferSize()) {
+        target.outbound.pop_front();
+        target.sendOffset = 0;
+    }
+    armSend(connection);
+}
+
+void IOUringEngine::completeInstall(unsigned adoption, const io_uring_cqe *cqe) {
+    auto it = adoptions.find(adoption);
+    if (it == adoptions.end()) {
+        return;
+    }
+    Adoption adopted = std::move(it->second);
+    adoptions.erase(it);
+
+    // The install gives the number of files updated, or fails if every slot in the table is taken
+    if (cqe->res < 1 || adopted.descriptor < 0 || (size_t) adopted.descriptor >= connections.size()) {
+        adopted.socket.close();
+        return;
+    }
+
+    // The ring holds its own reference to the connection now, so release our descriptor. Closing the socket
+    // normally would shut the connection down, so the descriptor is closed directly and invalidated for every
+    // copy of the socket. The connection stays counted as open until the engine closes it
+    platform::closeSocket(*adopted.socket.sock);
+    *adopted.socket.sock = INVALID_SOCK;
+
+    ConnectionID connection = (ConnectionID) adopted.descriptor;
+    Connection &target = connections[connection];
+    target.open = true;
+    target.decoder = NetworkMessageDecoder(maxMessageSize);
+    armReceive(connection);
+    if (adopted.handler) {
+        adopted.handler(connection);
+    }
+}
+
+#endif //CONTRACTS_IO_URING
@@ -2,6 +2,8 @@
 // Created by Matthew on 03/09/2020.
 //
 
+#include <algorithm>
+
 #include "../../include/networking/NetworkMessageV2.h"
 
 using namespace networking;
@@ -100,17 +102,24 @@ NetworkMessage NetworkMessageBuilder::create() {
     return std::move(NetworkMessage(std::move(networkMessageBuffer), messageSize));
 }
 
-NetworkMessageDecoder::NetworkMessageDecoder()
-        : buff(nullptr), decoderStep(0), messageSize(0), invalid(false) {
+NetworkMessageDecoder::NetworkMessageDecoder(size_t maxMessageSize)
+        : buff(nullptr), decoderStep(0), messageSize(0), maxMessageSize(maxMessageSize), __invalid(false) {
 
 }
 
-void NetworkMessageDecoder::decodeHeader(const std::array<byte, NetworkMessage::HeaderSize> &header) {
+bool NetworkMessageDecoder::decodeHeader(const std::array<byte, NetworkMessage::HeaderSize> &header) {
     std::copy(header.begin(), header.begin() + sizeof(unsigned), (byte *) &messageSize);
 
+    // Check the size the peer claims before allocating anything for it
+    if (messageSize > maxMessageSize) {
+        invalidate();
+        return false;
+    }
+
     buff = byte_buffer(NetworkMessage::calculateSendBufferSize(messageSize));
 
     std::copy(header.begin(), header.end(), buff.begin());
+    return true;
 }
 
 void NetworkMessageDecoder::decodeChunk(const std::array<byte, NetworkMessage::BufferChunkSize> &chunk) {
@@ -118,19 +127,60 @@ void NetworkMessageDecoder::decodeChunk(const std::array<byte, NetworkMessage::B
               buff.begin() + NetworkMessage::HeaderSize + NetworkMessage::BufferChunkSize * (decoderStep++));
 }
 
+size_t NetworkMessageDecoder::decodeStream(const byte *data, size_t size) {
+    size_t used = 0;
+
+    // Nothing more can be decoded once the header has been rejected
+    if (__invalid) {
+        return used;
+    }
+
+    // First collect the header, which may itself arrive split across spans
+    if (streamOffset < NetworkMessage::HeaderSize) {
+        size_t headerBytes = std::min(size, NetworkMessage::HeaderSize - streamOffset);
+        std::copy(data, data + headerBytes, streamHeader.begin() + streamOffset);
+        streamOffset += headerBytes;
+        used += headerBytes;
+
+        // Once the header is complete, decode it to size the message buffer
+        if (streamOffset < NetworkMessage::HeaderSize) {
+            return used;
+        }
+        if (!decodeHeader(streamHeader)) {
+            return used;
+        }
+    }
+
+    // Copy as much of the body as this span holds, up to the end of the message
+    size_t bodyBytes = std::min(size - used, buff.size() - streamOffset);
+    std::copy(data + used, data + used + bodyBytes, buff.begin() + streamOffset);
+    streamOffset += bodyBytes;
+    used += bodyBytes;
+
+    return used;
+}
+
+bool NetworkMessageDecoder::streamComplete() const {
+    return streamOffset >= NetworkMessage::HeaderSize && streamOffset == buff.size();
+}
+
 bool NetworkMessageDecoder::expectingData() const {
     return NetworkMessage::HeaderSize + NetworkMessage::BufferChunkSize * decoderStep < buff.size();
 }
 
 NetworkMessage NetworkMessageDecoder::create() {
-    if (invalid) {
+    if (__invalid) {
         return std::move(NetworkMessage(invalid_message));
     }
     return std::move(NetworkMessage(std::move(buff), messageSize));
 }
 
 void NetworkMessageDecoder::invalidate() {
-    invalid = true;
+    __invalid = true;
+}
+
+bool NetworkMessageDecoder::invalid() const {
+    return __invalid;
 }
 
 MessageBase::MessageBase()
@@ -197,6 +247,7 @@ RawMessage::RawMessage(RawMessage &&other) noexcept
 RawMessage::RawMessage(const NetworkMessage &message) {
     if (message.invalid()) {
         buffer = byte_buffer((size_t) 0);
+        __invalid = true;
         return;
     }
 
@@ -2,10 +2,482 @@
 // Created by Matthew.Sirman on 25/08/2020.
 //
 
+#include <algorithm>
+
+#if !defined(_WIN32) && defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 #include "../../include/networking/NetworkTranslator.h"
 
 using namespace networking;
 
-void NetworkTranslator::setConnectionProtocol(Protocol &&protocol) {
-    connectionProtocol = std::move(protocol);
+ServerConnection::ServerConnection(const TCPSocket &socket)
+        : __socket(socket) {
+
+}
+
+const TCPSocket &ServerConnection::socket() const {
+    return __socket;
+}
+
+Protocol &ServerConnection::protocol() {
+    return __protocol;
+}
+
+void ServerConnection::send(MessageBase &&message) {
+    if (__closed) {
+        return;
+    }
+
+    // This runs on the reactor thread, which is also the queue's writer, so we must never block waiting for
+    // room. Instead, write out as much as the socket takes and try again. A refused message is left untouched
+    if (!__socket.tryQueue(std::move(message))) {
+        flush();
+        if (!__socket.tryQueue(std::move(message))) {
+            // The client isn't reading its replies, so give up on it
+            close();
+        }
+    }
+}
+
+void ServerConnection::flush() {
+    // A failed write means the connection is gone, which should only end this connection, not the reactor
+    try {
+        __socket.flushQueue();
+    } catch (SocketException &) {
+        close();
+    }
+}
+
+void ServerConnection::close() {
+    __closed = true;
+}
+
+bool ServerConnection::closed() const {
+    return __closed;
+}
+
+NetworkTranslator::NetworkTranslator() = default;
+
+NetworkTranslator::~NetworkTranslator() {
+    // Make sure no threads outlive the translator
+    stop();
+}
+
+void NetworkTranslator::setConnectionProtocol(ProtocolBuilder builder) {
+    protocolBuilder = std::move(builder);
+}
+
+void NetworkTranslator::setMessageHandler(MessageHandler handler) {
+    messageHandler = std::move(handler);
+}
+
+void NetworkTranslator::setHandshakeTimeout(std::chrono::milliseconds timeout) {
+    handshakeTimeout = timeout;
+}
+
+void NetworkTranslator::setHandshakeThreads(unsigned count) {
+    handshakeThreadCount = count;
+}
+
+void NetworkTranslator::setMessageTimeout(std::chrono::milliseconds timeout) {
+    messageTimeout = timeout;
+}
+
+void NetworkTranslator::setIdleTimeout(std::chrono::milliseconds timeout) {
+    idleTimeout = timeout;
+}
+
+void NetworkTranslator::setMaxMessageSize(size_t bytes) {
+    maxMessageSize = bytes;
+}
+
+void NetworkTranslator::start(unsigned short port, const std::string &host, unsigned reactorCount) {
+    if (running()) {
+        return;
+    }
+
+    // Open the listening socket
+    listener = TCPSocket();
+    listener.create();
+    listener.bind(port, host);
+    listener.listen();
+
+    // Default to a reactor per hardware thread
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    if (reactorCount == 0) {
+        reactorCount = cores;
+    }
+
+    // Start each reactor, pinned to its own core
+    draining = false;
+    {
+        std::lock_guard<std::mutex> guard(reactorsLock);
+        for (unsigned i = 0; i < reactorCount; i++) {
+            reactors.push_back(std::make_unique<Reactor>());
+            Reactor &reactor = *reactors.back();
+            reactor.thread = std::thread(&NetworkTranslator::reactorLoop, this, std::ref(reactor));
+            pinThread(reactor.thread, i % cores);
+        }
+    }
+
+    // Start the handshake threads, which hand their connections to the reactors
+    nextReactor = 0;
+    handshaking = true;
+    unsigned handshakeCount = handshakeThreadCount == 0 ? reactorCount : handshakeThreadCount;
+    for (unsigned i = 0; i < handshakeCount; i++) {
+        handshakeThreads.emplace_back(&NetworkTranslator::handshakeLoop, this);
+    }
+
+    // Finally start accepting connections
+    accepting = true;
+    acceptThread = std::thread(&NetworkTranslator::acceptLoop, this);
+}
+
+void NetworkTranslator::stop(std::chrono::milliseconds drainTimeout) {
+    if (!running()) {
+        return;
+    }
+
+    // Stop accepting first, so no more connections can be handed to the reactors once they start draining
+    accepting = false;
+    acceptThread.join();
+    listener.close();
+
+    // Then stop the handshakes. Any in progress are bounded by the handshake timeout, and connections still
+    // waiting for one are simply closed
+    {
+        std::lock_guard<std::mutex> guard(handshakeLock);
+        handshaking = false;
+        handshakeQueue.clear();
+    }
+    handshakeReady.notify_all();
+    for (std::thread &thread : handshakeThreads) {
+        thread.join();
+    }
+    handshakeThreads.clear();
+
+    // Tell the reactors to drain, then wait for them all to finish
+    drainDeadline = std::chrono::steady_clock::now() + drainTimeout;
+    draining = true;
+    for (std::unique_ptr<Reactor> &reactor : reactors) {
+        reactor->thread.join();
+    }
+    {
+        std::lock_guard<std::mutex> guard(reactorsLock);
+        reactors.clear();
+    }
+    draining = false;
+}
+
+bool NetworkTranslator::running() const {
+    return accepting;
+}
+
+unsigned short NetworkTranslator::port() const {
+    return listener.localPort();
+}
+
+size_t NetworkTranslator::connectionCount() const {
+    std::lock_guard<std::mutex> guard(reactorsLock);
+    size_t total = 0;
+    for (const std::unique_ptr<Reactor> &reactor : reactors) {
+        total += reactor->connectionCount.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+void NetworkTranslator::acceptLoop() {
+    while (accepting) {
+        // Wait for a connection, waking up regularly to check whether the server is stopping
+        TCPSocketSet socketSet;
+        socketSet.setAcceptSocket(listener);
+        if (!TCPSocket::select(socketSet, REACTOR_POLL_INTERVAL) || !socketSet.acceptReady()) {
+            continue;
+        }
+
+        TCPSocket client;
+        try {
+            client = listener.accept();
+        } catch (SocketException &) {
+            // The client may have gone away before we accepted it, which is no reason to stop the server
+            continue;
+        }
+
+        // Hand the connection to the handshake threads, unless so many are already waiting that it would only
+        // time out in the queue
+        {
+            std::lock_guard<std::mutex> guard(handshakeLock);
+            if (handshakeQueue.size() >= HANDSHAKE_QUEUE_LIMIT) {
+                client.close();
+                continue;
+            }
+            handshakeQueue.push_back(std::move(client));
+        }
+        handshakeReady.notify_one();
+    }
+}
+
+void NetworkTranslator::handshakeLoop() {
+    while (true) {
+        TCPSocket socket;
+        {
+            std::unique_lock<std::mutex> lock(handshakeLock);
+            handshakeReady.wait(lock, [this]() { return !handshakeQueue.empty() || !handshaking; });
+            if (!handshaking) {
+                return;
+            }
+            socket = std::move(handshakeQueue.front());
+            handshakeQueue.pop_front();
+        }
+
+        std::unique_ptr<ServerConnection> connection = handshake(socket);
+        if (!connection) {
+            continue;
+        }
+
+        // Hand the connection to the next reactor in turn
+        Reactor &reactor = *reactors[nextReactor.fetch_add(1, std::memory_order_relaxed) % reactors.size()];
+        std::lock_guard<std::mutex> guard(reactor.inboxLock);
+        reactor.inbox.push_back(std::move(connection));
+    }
+}
+
+void NetworkTranslator::reactorLoop(Reactor &reactor) {
+    while (true) {
+        // Pick up any connections the handshake threads have handed us
+        std::vector<std::unique_ptr<ServerConnection>> incoming;
+        {
+            std::lock_guard<std::mutex> guard(reactor.inboxLock);
+            std::swap(incoming, reactor.inbox);
+        }
+        for (std::unique_ptr<ServerConnection> &connection : incoming) {
+            adopt(reactor, std::move(connection));
+        }
+
+        // While draining, close each connection as soon as its replies have been written, and close every
+        // connection once the deadline has passed
+        if (draining) {
+            bool expired = std::chrono::steady_clock::now() >= drainDeadline;
+            for (std::unique_ptr<ServerConnection> &connection : reactor.connections) {
+                if (expired || !connection->__socket.hasQueuedData()) {
+                    connection->close();
+                }
+            }
+            sweepClosed(reactor);
+            if (reactor.connections.empty()) {
+                return;
+            }
+        }
+
+        // Wait for the connections, but no longer than the next idle timer tick
+        std::chrono::microseconds timeout = REACTOR_POLL_INTERVAL;
+        std::optional<TimerWheel::Clock::duration> nextTick = reactor.timers.timeUntilNextTick();
+        if (nextTick.has_value()) {
+            timeout = std::min(timeout, std::chrono::duration_cast<std::chrono::microseconds>(nextTick.value()));
+        }
+
+        if (reactor.connections.empty()) {
+            // Select on no sockets isn't portable, so just sleep until there might be something to do
+            std::this_thread::sleep_for(timeout);
+        } else {
+            TCPSocketSet socketSet;
+            for (const std::unique_ptr<ServerConnection> &connection : reactor.connections) {
+                socketSet.addSocket(connection->__socket);
+            }
+
+            if (TCPSocket::select(socketSet, timeout)) {
+                for (std::unique_ptr<ServerConnection> &connection : reactor.connections) {
+                    if (socketSet.exceptReady(connection->__socket)) {
+                        connection->close();
+                        continue;
+                    }
+                    // Write out queued replies first, then serve any requests unless we are shutting down
+                    if (socketSet.writeReady(connection->__socket)) {
+                        connection->flush();
+                    }
+                    if (!draining && socketSet.readReady(connection->__socket)) {
+                        handleReadable(reactor, *connection);
+                    }
+                }
+            }
+        }
+
+        // Fire any idle timers which have expired, then drop everything which has been closed
+        reactor.timers.advance();
+        sweepClosed(reactor);
+    }
+}
+
+std::unique_ptr<ServerConnection> NetworkTranslator::handshake(const TCPSocket &socket) {
+    std::unique_ptr<ServerConnection> connection(new ServerConnection(socket));
+
+    // Build this connection's own instance of the connection protocol and run it. A client which doesn't
+    // complete it in time is dropped. This runs on a handshake thread, so a slow client only holds up that thread
+    try {
+        // Messages are coalesced by corking rather than by Nagle's algorithm, which would only hold back the last
+        // segment of each step waiting for an acknowledgement
+        connection->__socket.setNoDelay(true);
+        if (protocolBuilder) {
+            protocolBuilder(connection->__protocol, connection->__socket);
+            // Everything a handshake step sends leaves together when the step waits for the client's reply
+            CorkGuard cork(connection->__socket);
+            connection->__protocol.execute(handshakeTimeout);
+            if (!connection->__protocol.completed()) {
+                connection->__socket.close();
+                return nullptr;
+            }
+        }
+    } catch (std::exception &) {
+        // A failed handshake only costs the client its connection, never the handshake thread
+        connection->__socket.close();
+        return nullptr;
+    }
+
+    return connection;
+}
+
+void NetworkTranslator::adopt(Reactor &reactor, std::unique_ptr<ServerConnection> connection) {
+    // From now on the reactor multiplexes this socket with the rest, so it must never block it
+    try {
+        connection->__socket.setNonBlocking();
+    } catch (SocketException &) {
+        connection->__socket.close();
+        return;
+    }
+
+    connection->decoder = NetworkMessageDecoder(maxMessageSize);
+    resetIdleTimer(reactor, *connection);
+    reactor.connections.push_back(std::move(connection));
+    reactor.connectionCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void NetworkTranslator::handleReadable(Reactor &reactor, ServerConnection &connection) {
+    // Read whatever has arrived, a buffer at a time, and feed it through the connection's decoder. The rest of a
+    // message which is only partly here is picked up next time the connection is readable, so a slow client never
+    // holds up the reactor
+    for (size_t reads = 0; reads < REACTOR_READS_PER_WAKE && !connection.__closed; reads++) {
+        SocketCounter closeReason;
+        long received = connection.__socket.receiveAvailable(reactor.receiveBuffer.data(),
+                                                             reactor.receiveBuffer.size(), closeReason);
+        if (received == SOCKET_ERROR) {
+            // The client closed the connection or it failed
+            SocketMetrics::add(closeReason);
+            connection.close();
+            return;
+        }
+        if (received == 0) {
+            break;
+        }
+
+        const byte *next = reactor.receiveBuffer.data();
+        size_t remaining = (size_t) received;
+        while (remaining > 0 && !connection.__closed) {
+            // The first bytes of a message have arrived, so give the rest a bounded time to follow
+            if (!connection.messageTimer.has_value()) {
+                connection.messageTimer = reactor.timers.schedule(messageTimeout, [&connection]() {
+                    connection.messageTimer.reset();
+                    SocketMetrics::add(SocketCounter::TimeoutCloses);
+                    connection.close();
+                });
+            }
+
+            size_t used = connection.decoder.decodeStream(next, remaining);
+            next += used;
+            remaining -= used;
+
+            // A header giving a message larger than we accept is refused before anything is allocated for it,
+            // and the rest of the stream can't be framed, so the connection is dropped
+            if (connection.decoder.invalid()) {
+                SocketMetrics::add(SocketCounter::OversizedCloses);
+                connection.close();
+                return;
+            }
+
+            if (connection.decoder.streamComplete()) {
+                reactor.timers.cancel(connection.messageTimer.value());
+                connection.messageTimer.reset();
+                NetworkMessage message = connection.decoder.create();
+                connection.decoder = NetworkMessageDecoder(maxMessageSize);
+                dispatch(reactor, connection, std::move(message));
+            }
+        }
+
+        // A short read means the socket has been drained
+        if ((size_t) received < reactor.receiveBuffer.size()) {
+            break;
+        }
+    }
+
+    // Write whatever the handler queued straight away rather than waiting for the next select
+    if (!connection.__closed) {
+        connection.flush();
+    }
+}
+
+void NetworkTranslator::dispatch(Reactor &reactor, ServerConnection &connection, NetworkMessage &&message) {
+    resetIdleTimer(reactor, connection);
+
+    if (messageHandler) {
+        try {
+            messageHandler(connection, std::move(message));
+        } catch (std::exception &) {
+            // A request which fails to be handled only costs the client that sent it its connection
+            connection.close();
+        }
+    }
+}
+
+void NetworkTranslator::resetIdleTimer(Reactor &reactor, ServerConnection &connection) {
+    if (connection.idleTimer.has_value()) {
+        reactor.timers.cancel(connection.idleTimer.value());
+        connection.idleTimer.reset();
+    }
+    if (idleTimeout.count() != 0) {
+        connection.idleTimer = reactor.timers.schedule(idleTimeout, [&connection]() {
+            connection.idleTimer.reset();
+            connection.close();
+        });
+    }
+}
+
+void NetworkTranslator::sweepClosed(Reactor &reactor) {
+    // Partition the closed connections to the end, then close and remove them
+    auto firstClosed = std::partition(reactor.connections.begin(), reactor.connections.end(),
+                                      [](const std::unique_ptr<ServerConnection> &connection) {
+                                          return !connection->__closed;
+                                      });
+
+    for (auto it = firstClosed; it != reactor.connections.end(); it++) {
+        ServerConnection &connection = **it;
+        if (connection.idleTimer.has_value()) {
+            reactor.timers.cancel(connection.idleTimer.value());
+        }
+        if (connection.messageTimer.has_value()) {
+            reactor.timers.cancel(connection.messageTimer.value());
+        }
+        if (connection.__socket) {
+            connection.__socket.close();
+        }
+    }
+
+    reactor.connectionCount.fetch_sub(reactor.connections.end() - firstClosed, std::memory_order_relaxed);
+    reactor.connections.erase(firstClosed, reactor.connections.end());
+}
+
+void NetworkTranslator::pinThread(std::thread &thread, unsigned core) {
+#if defined(_WIN32)
+    SetThreadAffinityMask(thread.native_handle(), (DWORD_PTR) 1 << core);
+#elif defined(__linux__)
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(core, &cpus);
+    pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set_t), &cpus);
+#else
+    // Thread affinity isn't available on this platform
+    (void) thread;
+    (void) core;
+#endif
 }
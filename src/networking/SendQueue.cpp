@@ -0,0 +1,104 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include <thread>
+
+#include "../../include/networking/SendQueue.h"
+
+using namespace networking;
+
+SendQueue::SendQueue(size_t byteBudget)
+        : budget(byteBudget) {
+    // The queue always starts with a sentinel node so producers never have to deal with an empty list
+    tail = new Node();
+    head.store(tail, std::memory_order_relaxed);
+}
+
+SendQueue::~SendQueue() {
+    // Walk from the sentinel to the newest node, freeing every node on the way
+    while (tail) {
+        Node *next = tail->next.load(std::memory_order_acquire);
+        delete tail;
+        tail = next;
+    }
+}
+
+bool SendQueue::tryPush(NetworkMessage &&message) {
+    size_t messageBytes = message.bufferSize();
+
+    // Reserve space in the budget for this message
+    size_t current = bytes.load(std::memory_order_relaxed);
+    do {
+        if (current != 0 && current + messageBytes > budget.load(std::memory_order_relaxed)) {
+            return false;
+        }
+    } while (!bytes.compare_exchange_weak(current, current + messageBytes, std::memory_order_relaxed));
+
+    // Create the node for the message
+    Node *node = new Node();
+    node->message = std::move(message);
+
+    // Swap ourselves in as the newest node, then link the previous newest node to us. Until the link is made
+    // the writer simply sees the queue end at the previous node.
+    Node *previous = head.exchange(node, std::memory_order_acq_rel);
+    previous->next.store(node, std::memory_order_release);
+
+    return true;
+}
+
+void SendQueue::push(NetworkMessage &&message) {
+    // Back off until the writer has drained enough of the queue to fit the message
+    while (!tryPush(std::move(message))) {
+        std::this_thread::yield();
+    }
+}
+
+NetworkMessage *SendQueue::front() {
+    Node *next = tail->next.load(std::memory_order_acquire);
+    if (!next) {
+        return nullptr;
+    }
+    return &next->message;
+}
+
+void SendQueue::pop() {
+    Node *next = tail->next.load(std::memory_order_acquire);
+    if (!next) {
+        return;
+    }
+
+    // The front node becomes the new sentinel, so release its message buffer now rather than when it is freed
+    size_t messageBytes = next->message.bufferSize();
+    next->message = NetworkMessage();
+
+    delete tail;
+    tail = next;
+    __frontOffset = 0;
+
+    bytes.fetch_sub(messageBytes, std::memory_order_relaxed);
+}
+
+size_t SendQueue::frontOffset() const {
+    return __frontOffset;
+}
+
+void SendQueue::advanceFront(size_t written) {
+    __frontOffset += written;
+}
+
+size_t SendQueue::queuedBytes() const {
+    return bytes.load(std::memory_order_relaxed);
+}
+
+size_t SendQueue::byteBudget() const {
+    return budget.load(std::memory_order_relaxed);
+}
+
+void SendQueue::setByteBudget(size_t byteBudget) {
+    budget.store(byteBudget, std::memory_order_relaxed);
+}
+
+bool SendQueue::empty() const {
+    return !tail->next.load(std::memory_order_acquire);
+}
@@ -0,0 +1,69 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include "../../include/networking/SocketMetrics.h"
+#include "../../include/networking/TCPSocket.h"
+
+using namespace networking;
+
+// Declare the static values
+std::array<SocketMetrics::Shard, SOCKET_METRICS_SHARDS> SocketMetrics::shards;
+std::atomic<size_t> SocketMetrics::nextShard = 0;
+
+// The name of each counter, in order
+static constexpr const char *counterNames[] = {
+        "bytes sent", "send calls", "partial writes", "send errors", "bytes received", "receive calls",
+        "reset closes", "eof closes", "timeout closes", "oversized closes", "accepts", "sockets opened",
+        "sockets closed"
+};
+static_assert(sizeof(counterNames) / sizeof(counterNames[0]) == (size_t) SocketCounter::Count,
+              "Every socket counter needs a name.");
+
+uint64_t SocketMetricsSnapshot::operator[](SocketCounter counter) const {
+    return counters[(size_t) counter];
+}
+
+double SocketMetricsSnapshot::rate(SocketCounter counter, const SocketMetricsSnapshot &earlier) const {
+    double seconds = std::chrono::duration<double>(taken - earlier.taken).count();
+    if (seconds <= 0 || (*this)[counter] < earlier[counter]) {
+        return 0;
+    }
+    return (double) ((*this)[counter] - earlier[counter]) / seconds;
+}
+
+int64_t SocketMetricsSnapshot::openSockets() const {
+    return (int64_t) (*this)[SocketCounter::SocketsOpened] - (int64_t) (*this)[SocketCounter::SocketsClosed];
+}
+
+void SocketMetricsSnapshot::dump(std::ostream &out) const {
+    for (size_t counter = 0; counter < (size_t) SocketCounter::Count; counter++) {
+        out << counterNames[counter] << ": " << counters[counter] << '\n';
+    }
+    out << "open sockets: " << openSockets() << '\n';
+    out << "socket objects: " << socketObjects << '\n';
+}
+
+SocketMetricsSnapshot SocketMetrics::snapshot() {
+    SocketMetricsSnapshot snapshot{};
+    for (const Shard &shard : shards) {
+        for (size_t counter = 0; counter < (size_t) SocketCounter::Count; counter++) {
+            snapshot.counters[counter] += shard.counters[counter].load(std::memory_order_relaxed);
+        }
+    }
+    snapshot.socketObjects = TCPSocket::globalUsage();
+    snapshot.taken = std::chrono::steady_clock::now();
+    return snapshot;
+}
+
+void SocketMetrics::reset() {
+    for (Shard &shard : shards) {
+        for (size_t counter = 0; counter < (size_t) SocketCounter::Count; counter++) {
+            // The sockets opened and closed are kept, as the number open is the difference between them
+            if (counter == (size_t) SocketCounter::SocketsOpened || counter == (size_t) SocketCounter::SocketsClosed) {
+                continue;
+            }
+            shard.counters[counter].store(0, std::memory_order_relaxed);
+        }
+    }
+}
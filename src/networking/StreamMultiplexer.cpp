@@ -0,0 +1,505 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include <algorithm>
+
+#include "../../include/networking/StreamMultiplexer.h"
+
+using namespace networking;
+
+Stream::Stream(Link link, StreamID id)
+        : link(std::move(link)), __id(id) {
+
+}
+
+StreamID Stream::id() const {
+    return __id;
+}
+
+bool Stream::send(const byte *data, size_t size) {
+    // The other side would reset the stream part way through a message larger than it will reassemble
+    if (size > STREAM_MAX_MESSAGE_SIZE) {
+        return false;
+    }
+
+    size_t offset = 0;
+    // Send the message a frame at a time, so other streams' frames can be sent in between. An empty message
+    // still takes a single, empty frame to mark its end
+    do {
+        size_t frameSize;
+        {
+            // Wait until the other side has given us credit to send on this stream, then take what we need
+            std::unique_lock<std::mutex> lock(link->streamLock);
+            writable.wait(lock, [this]() {
+                return sendWindow > 0 || localClosed || __reset || !link->connected;
+            });
+            if (localClosed || __reset || !link->connected) {
+                return false;
+            }
+            frameSize = std::min({size - offset, sendWindow, (size_t) STREAM_MAX_FRAME_PAYLOAD});
+            sendWindow -= frameSize;
+        }
+
+        bool last = offset + frameSize == size;
+        link->sendFrame(__id, (byte) StreamMultiplexer::FrameType::DATA, last ? StreamMultiplexer::EndOfMessage : 0,
+                        data + offset, frameSize);
+        offset += frameSize;
+    } while (offset < size);
+
+    return true;
+}
+
+bool Stream::send(const byte_buffer &buffer) {
+    return send(buffer.cbegin(), buffer.size());
+}
+
+std::optional<byte_buffer> Stream::receive(const std::optional<Deadline> &deadline) {
+    std::unique_lock<std::mutex> lock(link->streamLock);
+
+    // Wait for a whole message, or for the stream to end
+    auto ready = [this]() {
+        return !this->ready.empty() || remoteClosed || __reset || !link->connected;
+    };
+    if (deadline.has_value()) {
+        if (!readable.wait_until(lock, deadline.value(), ready)) {
+            return std::nullopt;
+        }
+    } else {
+        readable.wait(lock, ready);
+    }
+    if (this->ready.empty()) {
+        return std::nullopt;
+    }
+
+    Message message = std::move(this->ready.front());
+    this->ready.pop_front();
+
+    // Now the message has been taken, the sender can have its credit back. If there is nothing else waiting,
+    // also return the credit for the message in progress, as the receiver can't take anything until that
+    // message completes and a message larger than the window would otherwise never arrive
+    size_t credit = message.uncredited;
+    if (this->ready.empty()) {
+        credit += partialUncredited;
+        partialUncredited = 0;
+    }
+    bool granting = credit != 0 && !__reset && !remoteClosed;
+    if (granting) {
+        receiveWindow += credit;
+    }
+    lock.unlock();
+
+    if (granting) {
+        link->grantCredit(__id, credit);
+    }
+    return std::move(message.data);
+}
+
+void Stream::close() {
+    {
+        std::lock_guard<std::mutex> guard(link->streamLock);
+        if (localClosed || __reset || !link->connected) {
+            return;
+        }
+        localClosed = true;
+        writable.notify_all();
+        link->retireIfFinished(*this);
+    }
+
+    // Tell the other side with an empty data frame marking the end of the stream
+    link->sendFrame(__id, (byte) StreamMultiplexer::FrameType::DATA, StreamMultiplexer::EndOfStream, nullptr, 0);
+}
+
+void Stream::reset() {
+    {
+        std::lock_guard<std::mutex> guard(link->streamLock);
+        if (__reset || !link->connected) {
+            return;
+        }
+        abandon();
+        link->retireIfFinished(*this);
+    }
+
+    link->sendFrame(__id, (byte) StreamMultiplexer::FrameType::RESET, 0, nullptr, 0);
+}
+
+void Stream::abandon() {
+    __reset = true;
+    ready.clear();
+    // Release the reassembly buffer's memory too, as a stream is often reset for growing it too far
+    std::vector<byte>().swap(partial);
+    partialUncredited = 0;
+    readable.notify_all();
+    writable.notify_all();
+}
+
+StreamLink::StreamLink(const TCPSocket &socket, AESKey key)
+        : socket(socket), key(key) {
+    // Flow control is per stream, so the socket's own queue must never hold back a frame. In particular the
+    // reader must be able to queue credit grants without waiting
+    this->socket.setSendQueueBudget(~(size_t) 0);
+}
+
+void StreamLink::sendFrame(StreamID id, byte type, byte flags, const byte *payload, size_t size) {
+    // Build the frame header followed by the payload
+    byte_buffer frame(StreamMultiplexer::FrameHeaderSize + size);
+    writeLittleEndian(frame.begin(), id, sizeof(StreamID));
+    frame.begin()[sizeof(StreamID)] = type;
+    frame.begin()[sizeof(StreamID) + 1] = flags;
+    frame.begin()[sizeof(StreamID) + 2] = 0;
+    frame.begin()[sizeof(StreamID) + 3] = 0;
+    if (size != 0) {
+        std::copy(payload, payload + size, frame.begin() + StreamMultiplexer::FrameHeaderSize);
+    }
+
+    // Encrypt and queue the frame as a single message, so it can't be split by another stream's frame, then
+    // wake the writer
+    socket.queue(AESMessage(std::move(frame), key));
+    {
+        std::lock_guard<std::mutex> guard(writeLock);
+        framesPending = true;
+    }
+    writeReady.notify_one();
+}
+
+void StreamLink::grantCredit(StreamID id, size_t credit) {
+    byte payload[sizeof(unsigned)];
+    writeLittleEndian(payload, std::min<size_t>(credit, ~0u), sizeof(unsigned));
+    sendFrame(id, (byte) StreamMultiplexer::FrameType::WINDOW_UPDATE, 0, payload, sizeof(unsigned));
+}
+
+void StreamLink::retireIfFinished(const Stream &stream) {
+    // No more frames can arrive for the stream, so stop tracking it. The stream object itself lives on for as
+    // long as its owner holds it, so any messages already received can still be taken
+    if ((stream.localClosed && stream.remoteClosed) || stream.__reset) {
+        streams.erase(stream.__id);
+    }
+}
+
+StreamMultiplexer::StreamMultiplexer(const TCPSocket &socket, AESKey key, Role role)
+        : link(std::make_shared<StreamLink>(socket, key)), closer(socket), role(role),
+          nextID(role == Role::CLIENT ? 1 : 2) {
+
+    // The reader and writer each use a copy of the socket on their own thread. The copies share one descriptor,
+    // so neither thread closes it - close shuts the connection down to wake them, and only closes the descriptor
+    // once both have finished
+    reader = std::thread(&StreamMultiplexer::readLoop, this, TCPSocket(socket));
+    writer = std::thread(&StreamMultiplexer::writeLoop, this, TCPSocket(socket));
+}
+
+StreamMultiplexer::~StreamMultiplexer() {
+    close();
+}
+
+std::shared_ptr<Stream> StreamMultiplexer::open() {
+    std::lock_guard<std::mutex> guard(link->streamLock);
+
+    // Take the next identifier with our parity
+    StreamID id = nextID;
+    nextID += 2;
+
+    std::shared_ptr<Stream> stream(new Stream(link, id));
+    link->streams.emplace(id, stream);
+
+    // Announce the stream while still holding the lock, so streams are announced in identifier order even when
+    // several threads open them at once. This lets the other side tell a new stream from a late frame for one
+    // which has already finished
+    link->sendFrame(id, (byte) FrameType::OPEN, 0, nullptr, 0);
+    return stream;
+}
+
+std::shared_ptr<Stream> StreamMultiplexer::accept(const std::optional<Deadline> &deadline) {
+    std::unique_lock<std::mutex> lock(link->streamLock);
+
+    auto ready = [this]() {
+        return !acceptQueue.empty() || !link->connected;
+    };
+    if (deadline.has_value()) {
+        if (!acceptable.wait_until(lock, deadline.value(), ready)) {
+            return nullptr;
+        }
+    } else {
+        acceptable.wait(lock, ready);
+    }
+    if (acceptQueue.empty()) {
+        return nullptr;
+    }
+
+    std::shared_ptr<Stream> stream = std::move(acceptQueue.front());
+    acceptQueue.pop_front();
+    return stream;
+}
+
+void StreamMultiplexer::close() {
+    // Only the first caller closes the connection. Any other waits here until it has finished
+    std::lock_guard<std::mutex> guard(closeLock);
+    if (!closer) {
+        return;
+    }
+
+    // Let the writer finish writing the frames already queued, so messages sent before the close still arrive.
+    // The wait is bounded, as a peer which has stopped reading would otherwise hold the close up forever
+    Deadline giveUp = Deadline::clock::now() + STREAM_CLOSE_DRAIN_TIMEOUT;
+    stopWriter(true);
+    bool drained;
+    {
+        std::unique_lock<std::mutex> lock(link->writeLock);
+        drained = link->writerStopped.wait_until(lock, giveUp, [this]() {
+            return link->writerFinished;
+        });
+    }
+
+    // Written only means handed to the socket. Closing a socket with frames still to read from it, such as credit
+    // the other side granted as our last messages arrived, resets the connection and throws away whatever the
+    // socket has not yet sent. So end our side of the connection instead, and let the reader carry on until the
+    // other side has read everything and closed its end too
+    if (drained) {
+        closer.shutdownSend();
+        std::unique_lock<std::mutex> lock(link->streamLock);
+        link->disconnected.wait_until(lock, giveUp, [this]() {
+            return !link->connected;
+        });
+    }
+
+    // Shutting the connection down wakes the reader, which ends every stream, and the writer if it is still
+    // blocked writing, without touching the descriptor they share
+    closer.shutdown();
+    reader.join();
+    writer.join();
+
+    // Neither thread can be using the socket any more, so it is now safe to close
+    if (closeReason.has_value()) {
+        SocketMetrics::add(closeReason.value());
+    }
+    closer.close();
+}
+
+bool StreamMultiplexer::connected() const {
+    std::lock_guard<std::mutex> guard(link->streamLock);
+    return link->connected;
+}
+
+void StreamMultiplexer::readLoop(TCPSocket connection) {
+    std::optional<SocketCounter> failure;
+    while (true) {
+        // Receive and decrypt the next frame. Anything we can't make sense of ends the connection, as we can no
+        // longer trust which stream the following frames belong to
+        SocketCounter receiveFailure;
+        NetworkMessage received = connection.receive(std::nullopt, receiveFailure);
+        if (received.invalid()) {
+            failure = receiveFailure;
+            break;
+        }
+        AESMessage frame(received, link->key);
+        if (frame.invalid()) {
+            break;
+        }
+        size_t frameSize = frame.end() - frame.begin();
+        if (frameSize < FrameHeaderSize) {
+            break;
+        }
+
+        // Decode the header
+        const byte *data = frame.begin();
+        StreamID id = (StreamID) readLittleEndian(data, sizeof(StreamID));
+        FrameType type = (FrameType) data[sizeof(StreamID)];
+        byte flags = data[sizeof(StreamID) + 1];
+        const byte *payload = data + FrameHeaderSize;
+        size_t payloadSize = frameSize - FrameHeaderSize;
+
+        switch (type) {
+            case FrameType::OPEN:
+                receiveOpen(id);
+                break;
+            case FrameType::DATA:
+                receiveData(id, flags, payload, payloadSize);
+                break;
+            case FrameType::WINDOW_UPDATE: {
+                if (payloadSize < sizeof(unsigned)) {
+                    break;
+                }
+                // Add the credit to the stream and wake any senders waiting for it
+                std::unique_lock<std::mutex> lock(link->streamLock);
+                auto it = link->streams.find(id);
+                if (it == link->streams.end()) {
+                    break;
+                }
+                std::shared_ptr<Stream> stream = it->second;
+                size_t credit = readLittleEndian(payload, sizeof(unsigned));
+                if (credit > STREAM_MAX_WINDOW - std::min<size_t>(stream->sendWindow, STREAM_MAX_WINDOW)) {
+                    resetViolating(lock, *stream);
+                    break;
+                }
+                stream->sendWindow += credit;
+                stream->writable.notify_all();
+                break;
+            }
+            case FrameType::RESET: {
+                // The other side abandoned the stream, so end it in both directions
+                std::lock_guard<std::mutex> guard(link->streamLock);
+                auto it = link->streams.find(id);
+                if (it != link->streams.end()) {
+                    it->second->abandon();
+                    link->streams.erase(it);
+                }
+                break;
+            }
+            default:
+                // Ignore frame types we don't know about, so the format can be extended
+                break;
+        }
+    }
+
+    // The connection has gone, so there is nothing left worth writing. Shutting it down shows the other side the
+    // end of the connection and wakes the writer if it is blocked writing, leaving the descriptor for close. Then
+    // end every stream and wake everything waiting on them. Clearing the table also drops the link's hold on the
+    // streams, which each hold the link
+    stopWriter(false);
+    connection.shutdown();
+    {
+        std::lock_guard<std::mutex> guard(link->streamLock);
+        closeReason = failure;
+        link->connected = false;
+        for (std::pair<const StreamID, std::shared_ptr<Stream>> &stream : link->streams) {
+            stream.second->readable.notify_all();
+            stream.second->writable.notify_all();
+        }
+        link->streams.clear();
+        acceptable.notify_all();
+        link->disconnected.notify_all();
+    }
+}
+
+void StreamMultiplexer::writeLoop(TCPSocket connection) {
+    while (true) {
+        bool last;
+        {
+            std::unique_lock<std::mutex> lock(link->writeLock);
+            link->writeReady.wait(lock, [this]() {
+                return link->framesPending || link->stopping;
+            });
+            // When draining, write out whatever is queued before stopping
+            if (link->stopping && !link->draining) {
+                break;
+            }
+            last = link->stopping;
+            link->framesPending = false;
+        }
+
+        // Write everything queued so far, waiting for room if the socket fills. A failed write means the
+        // connection is gone, which the reader will find out for itself
+        try {
+            bool failed = false;
+            while (!connection.flushQueue() && !failed) {
+                failed = !connection.waitWritable();
+            }
+            if (failed) {
+                break;
+            }
+        } catch (SocketException &) {
+            break;
+        }
+        if (last) {
+            break;
+        }
+    }
+
+    // Tell a closing multiplexer the writer has finished
+    {
+        std::lock_guard<std::mutex> guard(link->writeLock);
+        link->writerFinished = true;
+    }
+    link->writerStopped.notify_all();
+}
+
+void StreamMultiplexer::stopWriter(bool drain) {
+    {
+        std::lock_guard<std::mutex> guard(link->writeLock);
+        // A writer told to stop straight away can't be asked to drain afterwards
+        if (!link->stopping) {
+            link->draining = drain;
+        } else if (!drain) {
+            link->draining = false;
+        }
+        link->stopping = true;
+    }
+    link->writeReady.notify_one();
+}
+
+void StreamMultiplexer::receiveOpen(StreamID id) {
+    std::lock_guard<std::mutex> guard(link->streamLock);
+
+    // New streams must have the other side's parity, and as they are announced in order, a higher identifier
+    // than any the other side has opened before
+    bool remoteParity = (id % 2 == 1) == (role == Role::SERVER);
+    if (!remoteParity || id <= lastRemoteID) {
+        return;
+    }
+    lastRemoteID = id;
+
+    std::shared_ptr<Stream> stream(new Stream(link, id));
+    link->streams.emplace(id, stream);
+    acceptQueue.push_back(stream);
+    acceptable.notify_one();
+}
+
+void StreamMultiplexer::receiveData(StreamID id, byte flags, const byte *payload, size_t size) {
+    std::unique_lock<std::mutex> lock(link->streamLock);
+
+    // A frame for a stream we don't know is a late frame for a stream which has already been retired
+    auto it = link->streams.find(id);
+    if (it == link->streams.end()) {
+        return;
+    }
+    std::shared_ptr<Stream> stream = it->second;
+
+    if (stream->remoteClosed || stream->__reset) {
+        return;
+    }
+
+    // The sender may only send what it has been given credit for, and may not make a message larger than we
+    // are prepared to reassemble. A sender breaking either would otherwise grow our memory without bound
+    if (size > stream->receiveWindow || stream->partial.size() + size > STREAM_MAX_MESSAGE_SIZE) {
+        resetViolating(lock, *stream);
+        return;
+    }
+    stream->receiveWindow -= size;
+
+    // Add the frame to the message being reassembled
+    size_t credit = 0;
+    stream->partial.insert(stream->partial.end(), payload, payload + size);
+    if (flags & EndOfMessage) {
+        // The message is complete, so hand it to the receiver. The credit for it is returned once it is taken
+        byte_buffer message(stream->partial.size());
+        std::copy(stream->partial.begin(), stream->partial.end(), message.begin());
+        stream->ready.push_back({std::move(message), stream->partialUncredited + size});
+        stream->partial.clear();
+        stream->partialUncredited = 0;
+        stream->readable.notify_all();
+    } else if (stream->ready.empty()) {
+        // The receiver is waiting on this very message, so there is no point holding back the credit
+        credit = size;
+        stream->receiveWindow += credit;
+    } else {
+        stream->partialUncredited += size;
+    }
+
+    if (flags & EndOfStream) {
+        stream->remoteClosed = true;
+        stream->readable.notify_all();
+        link->retireIfFinished(*stream);
+    }
+
+    lock.unlock();
+    if (credit != 0) {
+        link->grantCredit(id, credit);
+    }
+}
+
+void StreamMultiplexer::resetViolating(std::unique_lock<std::mutex> &lock, Stream &stream) {
+    stream.abandon();
+    link->retireIfFinished(stream);
+    lock.unlock();
+
+    link->sendFrame(stream.__id, (byte) FrameType::RESET, 0, nullptr, 0);
+}
@@ -3,6 +3,7 @@
 //
 
 #include <array>
+#include <algorithm>
 
 #include "../../include/networking/TCPSocket.h"
 
@@ -10,7 +11,7 @@ using namespace networking;
 
 // Declare the static values
 std::atomic_int TCPSocket::__globalSockUsage = 0;
-WSADATA TCPSocket::__wsaData;
+thread_local TCPSocket::ThreadTraffic TCPSocket::__threadTraffic;
 
 size_t std::hash<networking::TCPSocket>::operator()(const TCPSocket &sock) const {
     // Return the has of the socket file descriptor as this identifies a unique socket
@@ -57,7 +58,7 @@ std::unordered_set<TCPSocket> TCPSocketSet::reads() const {
     // Loop over each socket
     for (const TCPSocket &sock : sockets) {
         // If the socket is set (by select) add it to the set sockets
-        if (FD_ISSET(*sock.sock, &readFds)) {
+        if (readyEvents(*sock.sock) & (POLLIN | POLLHUP)) {
             setSockets.insert(sock);
         }
     }
@@ -73,7 +74,7 @@ std::unordered_set<TCPSocket> TCPSocketSet::writes() const {
     // Loop over each socket
     for (const TCPSocket &sock : sockets) {
         // If the socket is set (by select) add it to the set sockets
-        if (FD_ISSET(*sock.sock, &writeFds)) {
+        if (readyEvents(*sock.sock) & (POLLOUT)) {
             setSockets.insert(sock);
         }
     }
@@ -89,7 +90,7 @@ std::unordered_set<TCPSocket> TCPSocketSet::excepts() const {
     // Loop over each socket
     for (const TCPSocket &sock : sockets) {
         // If the socket is set (by select) add it to the set sockets
-        if (FD_ISSET(*sock.sock, &exceptFds)) {
+        if (readyEvents(*sock.sock) & (POLLERR | POLLNVAL)) {
             setSockets.insert(sock);
         }
     }
@@ -102,33 +103,62 @@ bool TCPSocketSet::acceptReady() const {
     if (!acceptSocket.has_value()) {
         return false;
     }
-    return FD_ISSET(*acceptSocket->sock, &readFds);
+    return (readyEvents(*acceptSocket->sock) & POLLIN) != 0;
 }
 
-void TCPSocketSet::buildFDSets() {
-    FD_ZERO(&readFds);
-    FD_ZERO(&writeFds);
-    FD_ZERO(&exceptFds);
+bool TCPSocketSet::readReady(const TCPSocket &sock) const {
+    // A socket closed since the select can no longer be ready
+    return sock && (readyEvents(*sock.sock) & (POLLIN | POLLHUP)) != 0;
+}
+
+bool TCPSocketSet::writeReady(const TCPSocket &sock) const {
+    return sock && (readyEvents(*sock.sock) & (POLLOUT)) != 0;
+}
+
+bool TCPSocketSet::exceptReady(const TCPSocket &sock) const {
+    return sock && (readyEvents(*sock.sock) & (POLLERR | POLLNVAL)) != 0;
+}
+
+void TCPSocketSet::buildDescriptors() {
+    descriptors.clear();
+    descriptorIndex.clear();
+
+    // Add a descriptor watching a socket for the given events
+    auto watch = [this](SOCKET sock, short events) {
+        platform::PollDescriptor descriptor{};
+        descriptor.fd = sock;
+        descriptor.events = events;
+        descriptorIndex[sock] = descriptors.size();
+        descriptors.push_back(descriptor);
+    };
 
     if (acceptSocket.has_value()) {
-        FD_SET(*acceptSocket->sock, &readFds);
+        watch(*acceptSocket->sock, POLLIN);
     }
 
+    // Errors and hang ups are always reported, so each socket only asks for reads, and for writes when it has
+    // something queued
     for (const TCPSocket &sock : sockets) {
         if (sock) {
-            FD_SET(*sock.sock, &readFds);
-            FD_SET(*sock.sock, &writeFds);
-            FD_SET(*sock.sock, &exceptFds);
+            watch(*sock.sock, (short) (sock.hasQueuedData() ? POLLIN | POLLOUT : POLLIN));
         }
     }
 }
 
+short TCPSocketSet::readyEvents(SOCKET sock) const {
+    auto it = descriptorIndex.find(sock);
+    if (it == descriptorIndex.end()) {
+        return 0;
+    }
+    return descriptors[it->second].revents;
+}
+
 TCPSocket::TCPSocket()
         : sock(std::make_shared<SOCKET>(INVALID_SOCK)), __useCount(nullptr) {
-    // If the global usage counter is 0, this indicates that WSA is not currently initialise,
+    // If the global usage counter is 0, this indicates that the socket library is not currently initialised,
     // so start it up
     if (__globalSockUsage == 0) {
-        WSAStartup(MAKEWORD(2u, 2u), &__wsaData);
+        platform::startup();
     }
 
     // Increment the global socket usage
@@ -141,6 +171,10 @@ TCPSocket::TCPSocket(const TCPSocket &socket) noexcept {
     // Copy the pointer to the usage counter (we do not have to worry about the usage counter already having
     // a value as this is the constructor)
     this->__useCount = socket.__useCount;
+    // Share the send queue
+    this->sendQueue = socket.sendQueue;
+    // Share the cork state
+    this->corkState = socket.corkState;
     // If the usage counter is not null, increment it - we are making a copy of this object,
     // so there is now one extra reference to it
     if (this->__useCount) {
@@ -157,6 +191,10 @@ TCPSocket::TCPSocket(TCPSocket &&socket) noexcept {
     // Move the pointer to the usage counter (we do not have to worry about the usage counter already having
     // a value as this is the constructor)
     this->__useCount = std::move(socket.__useCount);
+    // Move the send queue
+    this->sendQueue = std::move(socket.sendQueue);
+    // Move the cork state
+    this->corkState = std::move(socket.corkState);
     // Note: we do not increment the usage counter here because this is a move - the original socket object is
     // being invalidated and so the total usages doesn't change
 
@@ -168,8 +206,9 @@ TCPSocket::TCPSocket(TCPSocket &&socket) noexcept {
 }
 
 TCPSocket::~TCPSocket() {
-    // If the socket isn't invalid (i.e. has been created, or copied or moved from another socket)
-    if (sock) {
+    // If the socket isn't invalid (i.e. has been created, or copied or moved from another socket). A socket which
+    // was default constructed and never created has no usage counter to drop
+    if (sock && __useCount) {
         // We decrement the use count as this object is losing its reference. If the use count is now 0,
         // we destroy the internal socket as there are no longer any references to it
         if (--(*__useCount) == 0) {
@@ -179,8 +218,8 @@ TCPSocket::~TCPSocket() {
     // We always decrement the global socket counter - this simply tracks the number of TCPSocket objects in
     // existence, and this is the destructor so one less will exist.
     if (!(--__globalSockUsage)) {
-        // If there are no more TCPSocket objects, we cleanup WSA.
-        WSACleanup();
+        // If there are no more TCPSocket objects, we cleanup the socket library.
+        platform::cleanup();
     }
 }
 
@@ -206,6 +245,10 @@ TCPSocket &TCPSocket::operator=(const TCPSocket &other) noexcept {
     this->sock = other.sock;
     // Copy across the usage counter
     this->__useCount = other.__useCount;
+    // Copy across the send queue
+    this->sendQueue = other.sendQueue;
+    // Copy across the cork state
+    this->corkState = other.corkState;
     // If the usage counter isn't null (i.e. we are copying an actual socket rather than a null socket) then
     // we increment the usage counter
     if (this->__useCount) {
@@ -235,6 +278,10 @@ TCPSocket &TCPSocket::operator=(TCPSocket &&other) noexcept {
     this->sock = std::move(other.sock);
     // Move across the usage counter
     this->__useCount = std::move(other.__useCount);
+    // Move across the send queue
+    this->sendQueue = std::move(other.sendQueue);
+    // Move across the cork state
+    this->corkState = std::move(other.corkState);
     // Note: we do not increment the usage counter here because this is a move - the other socket object is
     // being invalidated and so the total usages doesn't change
 
@@ -262,17 +309,22 @@ void TCPSocket::create() {
     if (*(sock = std::make_shared<SOCKET>(socket(AF_INET, SOCK_STREAM, 0))) == INVALID_SOCK) {
         throw SocketException("Failed to create socket");
     }
+    SocketMetrics::add(SocketCounter::SocketsOpened);
 
-    BOOL reuseAddr = TRUE;
+    int reuseAddr = 1;
     // Set the socket to reuse the address if necessary
-    if ((setsockopt(*sock, SOL_SOCKET, SO_REUSEADDR, (char *) &reuseAddr, sizeof(BOOL))) != 0) {
+    if ((setsockopt(*sock, SOL_SOCKET, SO_REUSEADDR, (const char *) &reuseAddr, sizeof(int))) != 0) {
         throw SocketException("Failed to set socket option reuse address");
     }
 
     __useCount.reset();
 
     // Initialise the usage counter to 1 - we now have a live socket object with a single reference
-    __useCount = std::make_shared<int>(1);
+    __useCount = std::make_shared<std::atomic_int>(1);
+
+    // Create the outbound queue and cork state for this connection
+    sendQueue = std::make_shared<SendQueue>();
+    corkState = std::make_shared<CorkState>();
 }
 
 void TCPSocket::bind(unsigned short port, const std::string &host) const {
@@ -295,11 +347,21 @@ void TCPSocket::bind(unsigned short port, const std::string &host) const {
     }
 
     // Call the socket interface's bind function to bind this socket object to the constructed address
-    if (::bind(*sock, (SOCKADDR *) &address, sizeof(address)) == SOCKET_ERROR) {
+    if (::bind(*sock, (sockaddr *) &address, sizeof(address)) == SOCKET_ERROR) {
         throw SocketException("Failed to bind socket");
     }
 }
 
+unsigned short TCPSocket::localPort() const {
+    // Ask the socket interface for the address this socket ended up bound to
+    sockaddr_in address{};
+    socklen_t addressSize = sizeof(sockaddr_in);
+    if (getsockname(*sock, (sockaddr *) &address, &addressSize) == SOCKET_ERROR) {
+        throw SocketException("Failed to get socket address");
+    }
+    return ntohs(address.sin_port);
+}
+
 void TCPSocket::connect(const std::string &host, unsigned short port) const {
     // Declare an address value to connect to
     sockaddr_in serverAddress{};
@@ -317,8 +379,7 @@ void TCPSocket::connect(const std::string &host, unsigned short port) const {
         // Declare hints for the type of host we are looking for
         addrinfo hints{};
 
-        // Initialise the hints and set the family type an protocol to what we are looking for
-        ZeroMemory(&hints, sizeof(addrinfo));
+        // Set the family type an protocol to what we are looking for
         hints.ai_family = AF_INET;
         hints.ai_socktype = SOCK_STREAM;
         hints.ai_protocol = IPPROTO_TCP;
@@ -330,30 +391,97 @@ void TCPSocket::connect(const std::string &host, unsigned short port) const {
 
         // Set the server address to the first hostname in the linked list
         serverAddress.sin_addr = ((sockaddr_in *) result->ai_addr)->sin_addr;
+
+        // Free the linked list of hosts now that we have the address we need
+        freeaddrinfo(result);
     }
 
     // Attempt to connect to whichever host address we ended up with by this point. We know the address is
     // valid, but not necessarily that we will be able to connect
-    if (::connect(*sock, (SOCKADDR *) &serverAddress, sizeof(sockaddr_in)) == SOCKET_ERROR) {
+    if (::connect(*sock, (sockaddr *) &serverAddress, sizeof(sockaddr_in)) == SOCKET_ERROR) {
         throw SocketException("Failed to connect to server");
     }
 }
 
 void TCPSocket::setNonBlocking() {
-    // Create a value to set the non blocking property to - 1 for true
-    unsigned long nonBlocking = 1;
-
     // Set the socket object's non blocking property to true
-    if (ioctlsocket(*sock, FIONBIO, &nonBlocking) == SOCKET_ERROR) {
+    if (!platform::setNonBlocking(*sock)) {
         throw SocketException("Failed to set socket to non-blocking mode");
     }
 }
 
+void TCPSocket::setNoDelay(bool noDelay) const {
+    int value = noDelay ? 1 : 0;
+    // Set the TCP no delay option to disable or enable Nagle's algorithm
+    if (setsockopt(*sock, IPPROTO_TCP, TCP_NODELAY, (const char *) &value, sizeof(int)) == SOCKET_ERROR) {
+        throw SocketException("Failed to set socket option no delay");
+    }
+}
+
+void TCPSocket::setKeepAlive(bool keepAlive) const {
+    int value = keepAlive ? 1 : 0;
+    // Set the keepalive option to enable or disable keepalive probes
+    if (setsockopt(*sock, SOL_SOCKET, SO_KEEPALIVE, (const char *) &value, sizeof(int)) == SOCKET_ERROR) {
+        throw SocketException("Failed to set socket option keepalive");
+    }
+}
+
+void TCPSocket::setSendBufferSize(int bytes) const {
+    // Set the size of the kernel send buffer
+    if (setsockopt(*sock, SOL_SOCKET, SO_SNDBUF, (const char *) &bytes, sizeof(int)) == SOCKET_ERROR) {
+        throw SocketException("Failed to set socket option send buffer size");
+    }
+}
+
+void TCPSocket::setReceiveBufferSize(int bytes) const {
+    // Set the size of the kernel receive buffer
+    if (setsockopt(*sock, SOL_SOCKET, SO_RCVBUF, (const char *) &bytes, sizeof(int)) == SOCKET_ERROR) {
+        throw SocketException("Failed to set socket option receive buffer size");
+    }
+}
+
+void TCPSocket::cork() const {
+    // Take another cork on the socket
+    corkState->depth++;
+}
+
+void TCPSocket::uncork() const {
+    // Release one cork, and if it was the last one, write whatever has been coalesced
+    if (corkState->depth > 0 && --corkState->depth == 0) {
+        flush();
+    }
+}
+
+bool TCPSocket::flush() const {
+    // If there is nothing coalesced, there is nothing to do
+    if (!corkState || corkState->buffer.empty()) {
+        return true;
+    }
+
+    // Write the coalesced messages in one go, then empty the buffer (keeping its capacity for the next step).
+    // Whatever the socket didn't take is dropped either way, as the connection has failed
+    bool written = sendAll(corkState->buffer.data(), corkState->buffer.size());
+    corkState->buffer.clear();
+    return written;
+}
+
 void TCPSocket::close() {
     // If the socket has been explicitly closed, destroy it
     destroy();
 }
 
+void TCPSocket::shutdownSend() const {
+    if (*this) {
+        platform::shutdownSend(*sock);
+    }
+}
+
+void TCPSocket::shutdown() const {
+    if (*this) {
+        platform::shutdownSocket(*sock);
+    }
+}
+
 void TCPSocket::listen() const {
     // Call the listen interface on this socket
     if (::listen(*sock, BACKLOG_QUEUE_SIZE) == SOCKET_ERROR) {
@@ -373,28 +501,140 @@ TCPSocket TCPSocket::accept() const {
     SOCKET clientSocket = INVALID_SOCK;
 
     // Accept the client socket
-    if ((clientSocket = ::accept(*sock, (SOCKADDR *) &clientAddress, &clientAddressSize)) == INVALID_SOCK) {
+    if ((clientSocket = ::accept(*sock, (sockaddr *) &clientAddress, &clientAddressSize)) == INVALID_SOCK) {
         throw SocketException("Failed to accept socket");
     }
 
+    SocketMetrics::add(SocketCounter::Accepts);
+    SocketMetrics::add(SocketCounter::SocketsOpened);
+
     // Set the socket object's file descriptor to the accepted socket
     acceptedSocket.sock = std::make_shared<SOCKET>(clientSocket);
     // This is a new socket, but is not created internally, so we explicitly initialise the usage counter
     // to 1
-    acceptedSocket.__useCount = std::make_shared<int>(1);
+    acceptedSocket.__useCount = std::make_shared<std::atomic_int>(1);
+    // Create the outbound queue and cork state for the new connection
+    acceptedSocket.sendQueue = std::make_shared<SendQueue>();
+    acceptedSocket.corkState = std::make_shared<CorkState>();
 
     // Return the accepted socket by moving it
     return std::move(acceptedSocket);
 }
 
-void TCPSocket::send(MessageBase &&message) const {
+bool TCPSocket::send(MessageBase &&message) const {
     // Create the network message to send
     NetworkMessage networkMessage = message.message();
+    __threadTraffic.sent += networkMessage.bufferSize();
+
+    // If the socket is corked, add the message to the coalesced buffer instead of writing it now
+    if (corkState && corkState->depth > 0) {
+        corkState->buffer.insert(corkState->buffer.end(), networkMessage.cbegin(), networkMessage.cend());
+        // Don't let the buffer grow indefinitely - once it is large enough to fill segments, write it
+        if (corkState->buffer.size() >= CORK_FLUSH_THRESHOLD) {
+            return flush();
+        }
+        return true;
+    }
+
     // Send the raw message data from the message object
-    ::send(*sock, (const char *) networkMessage.begin(), networkMessage.bufferSize(), 0);
+    return sendAll(networkMessage.cbegin(), networkMessage.bufferSize());
+}
+
+void TCPSocket::queue(MessageBase &&message) const {
+    // Frame the message on the producer's thread, then hand it to the queue
+    NetworkMessage networkMessage = message.message();
+    SendQueue &queue = requireSendQueue();
+    __threadTraffic.sent += networkMessage.bufferSize();
+    queue.push(std::move(networkMessage));
+}
+
+bool TCPSocket::tryQueue(MessageBase &&message) const {
+    // Check the budget before framing so we don't waste the work if the queue is full. The queue may still
+    // refuse the message if another producer fills it in between.
+    SendQueue &queue = requireSendQueue();
+    if (queue.queuedBytes() != 0 && queue.queuedBytes() >= queue.byteBudget()) {
+        return false;
+    }
+    NetworkMessage networkMessage = message.message();
+    size_t size = networkMessage.bufferSize();
+    if (!queue.tryPush(std::move(networkMessage))) {
+        return false;
+    }
+    __threadTraffic.sent += size;
+    return true;
+}
+
+bool TCPSocket::flushQueue() const {
+    SendQueue &queue = requireSendQueue();
+
+    // Loop over each message at the front of the queue
+    NetworkMessage *front;
+    while ((front = queue.front())) {
+        // Send whatever is left of the front message
+        size_t offset = queue.frontOffset();
+        int sent = (int) ::send(*sock, (const char *) front->cbegin() + offset, (int) (front->bufferSize() - offset),
+                                platform::SendFlags);
+        SocketMetrics::add(SocketCounter::SendCalls);
+        if (sent == SOCKET_ERROR) {
+            // If the socket can't take any more data right now, stop until it is writable again
+            if (platform::wouldBlock(platform::lastError())) {
+                return false;
+            }
+            SocketMetrics::add(SocketCounter::SendErrors);
+            throw SocketException("Failed to send queued message");
+        }
+        SocketMetrics::add(SocketCounter::BytesSent, sent);
+        if ((size_t) sent < front->bufferSize() - offset) {
+            SocketMetrics::add(SocketCounter::PartialWrites);
+        }
+
+        // Record the progress, and once the whole message has gone, remove it from the queue
+        queue.advanceFront(sent);
+        if (queue.frontOffset() == front->bufferSize()) {
+            queue.pop();
+        }
+    }
+
+    return true;
+}
+
+bool TCPSocket::hasQueuedData() const {
+    return sendQueue && !sendQueue->empty();
+}
+
+void TCPSocket::setSendQueueBudget(size_t bytes) const {
+    requireSendQueue().setByteBudget(bytes);
+}
+
+SendQueue &TCPSocket::requireSendQueue() const {
+    if (!sendQueue) {
+        throw SocketException("Socket has no send queue - it has not been created or has been closed");
+    }
+    return *sendQueue;
 }
 
 NetworkMessage TCPSocket::receive() {
+    // Receive with no deadline - this will wait for as long as it takes the remote to send a message
+    return receive(std::nullopt);
+}
+
+NetworkMessage TCPSocket::receive(const std::optional<Deadline> &deadline) {
+    // If the connection was reset or closed, or the deadline passed, we close the socket and return the invalid
+    // message
+    SocketCounter closeReason;
+    NetworkMessage message = receive(deadline, closeReason);
+    if (message.invalid()) {
+        SocketMetrics::add(closeReason);
+        close();
+    }
+    return message;
+}
+
+NetworkMessage TCPSocket::receive(const std::optional<Deadline> &deadline, SocketCounter &closeReason) {
+    // We are about to wait on the remote socket, so anything coalesced must go out now or the remote may
+    // never send what we are waiting for
+    flush();
+
     // Create an empty message object
     NetworkMessageDecoder decoder;
 
@@ -402,22 +642,19 @@ NetworkMessage TCPSocket::receive() {
     // initially, followed by the body
     std::array<byte, NetworkMessage::HeaderSize> header{};
 
-    // Receive the header data
-    size_t receiveSize;
-    if ((receiveSize = ::recv(*sock, (char *) header.data(), header.size(), 0)) == -1) {
-        if (WSAGetLastError() == WSAECONNRESET) {
-            decoder.invalidate();
-            close();
-            return decoder.create();
-        }
-    } else if (receiveSize == 0) {
+    // Receive the header data. If the connection was reset or closed, or the deadline passed, we return an
+    // invalid message
+    if (!receiveExact(header.data(), header.size(), deadline, closeReason)) {
         decoder.invalidate();
-        close();
         return decoder.create();
     }
 
-    // Pass the header data to the message so it can decode it
-    decoder.decodeHeader(header);
+    // Pass the header data to the message so it can decode it. A header claiming a message larger than we
+    // accept leaves the rest of the stream unreadable, so the connection must be closed
+    if (!decoder.decodeHeader(header)) {
+        closeReason = SocketCounter::OversizedCloses;
+        return decoder.create();
+    }
 
     // Declare an array for the message chunks
     std::array<byte, NetworkMessage::BufferChunkSize> chunk{};
@@ -425,12 +662,9 @@ NetworkMessage TCPSocket::receive() {
     // For as long as the message object is expecting data
     while (decoder.expectingData()) {
         // Receive the next fixed size chunk
-        if (::recv(*sock, (char *) chunk.data(), chunk.size(), 0) == -1) {
-            if (WSAGetLastError() == WSAECONNRESET) {
-                decoder.invalidate();
-                close();
-                return decoder.create();
-            }
+        if (!receiveExact(chunk.data(), chunk.size(), deadline, closeReason)) {
+            decoder.invalidate();
+            return decoder.create();
         }
         // Pass the chunk to the message so it can decode it
         decoder.decodeChunk(chunk);
@@ -440,13 +674,192 @@ NetworkMessage TCPSocket::receive() {
     return decoder.create();
 }
 
+long TCPSocket::receiveAvailable(byte *data, size_t size, SocketCounter &closeReason) const {
+    while (true) {
+        int receiveSize = (int) ::recv(*sock, (char *) data, (int) size, 0);
+        SocketMetrics::add(SocketCounter::ReceiveCalls);
+        if (receiveSize == SOCKET_ERROR) {
+            int error = platform::lastError();
+            // A signal arrived before anything was read, so just try again
+            if (platform::interrupted(error)) {
+                continue;
+            }
+            // Nothing to read yet is not an error for a non blocking socket
+            if (platform::wouldBlock(error)) {
+                return 0;
+            }
+            closeReason = SocketCounter::ResetCloses;
+            return SOCKET_ERROR;
+        }
+        if (receiveSize == 0) {
+            // The remote closed the connection
+            closeReason = SocketCounter::EofCloses;
+            return SOCKET_ERROR;
+        }
+
+        SocketMetrics::add(SocketCounter::BytesReceived, receiveSize);
+        __threadTraffic.received += receiveSize;
+        return receiveSize;
+    }
+}
+
+TCPSocket::ThreadTraffic TCPSocket::threadTraffic() {
+    return __threadTraffic;
+}
+
+int TCPSocket::globalUsage() {
+    return __globalSockUsage.load();
+}
+
 void TCPSocket::select(TCPSocketSet &socketSet) {
-    // Build the file descriptor sets
-    socketSet.buildFDSets();
-    // Call the select interface with the socket sets defined in the passed in object
-    if (::select(0, &socketSet.readFds, &socketSet.writeFds, &socketSet.exceptFds, nullptr) == SOCKET_ERROR) {
+    // Build the poll descriptors
+    socketSet.buildDescriptors();
+    // Wait with no timeout for any socket in the set to become ready, waiting again if a signal interrupts us
+    while (platform::poll(socketSet.descriptors.data(), socketSet.descriptors.size(), -1) == SOCKET_ERROR) {
+        if (!platform::interrupted(platform::lastError())) {
+            throw SocketException("Failed to select ready socket file descriptors");
+        }
+    }
+}
+
+bool TCPSocket::select(TCPSocketSet &socketSet, std::chrono::microseconds timeout) {
+    // Build the poll descriptors
+    socketSet.buildDescriptors();
+
+    // Poll takes a timeout in milliseconds, so round up rather than spinning on a sub millisecond timeout
+    int timeoutMillis = (int) std::chrono::ceil<std::chrono::milliseconds>(timeout).count();
+
+    // Call the poll interface, which returns the number of ready sockets or zero on timeout. An interrupted
+    // wait is treated as a timeout, as callers already loop around select
+    int ready = platform::poll(socketSet.descriptors.data(), socketSet.descriptors.size(), timeoutMillis);
+    if (ready == SOCKET_ERROR) {
+        if (platform::interrupted(platform::lastError())) {
+            return false;
+        }
         throw SocketException("Failed to select ready socket file descriptors");
     }
+    return ready > 0;
+}
+
+bool TCPSocket::receiveExact(byte *data, size_t size, const std::optional<Deadline> &deadline,
+                             SocketCounter &closeReason) {
+    size_t received = 0;
+    // Keep receiving until the buffer is full - the remote may deliver the data across several reads
+    while (received < size) {
+        // If there is a deadline, wait until there is data to read before calling recv, so we never block
+        // beyond the deadline
+        if (deadline.has_value() && !waitReadable(deadline.value())) {
+            closeReason = SocketCounter::TimeoutCloses;
+            return false;
+        }
+
+        int receiveSize = (int) ::recv(*sock, (char *) data + received, (int) (size - received), 0);
+        SocketMetrics::add(SocketCounter::ReceiveCalls);
+        if (receiveSize == SOCKET_ERROR) {
+            int error = platform::lastError();
+            // A signal arrived before anything was read, so just try again
+            if (platform::interrupted(error)) {
+                continue;
+            }
+            // A non blocking socket with nothing to read yet just waits for data to arrive
+            if (platform::wouldBlock(error)) {
+                if (!deadline.has_value() && !waitReadable(std::nullopt)) {
+                    closeReason = SocketCounter::ResetCloses;
+                    return false;
+                }
+                continue;
+            }
+            // Any other error (e.g. the connection being reset) ends the receive
+            closeReason = SocketCounter::ResetCloses;
+            return false;
+        }
+        if (receiveSize == 0) {
+            // The remote closed the connection
+            closeReason = SocketCounter::EofCloses;
+            return false;
+        }
+
+        SocketMetrics::add(SocketCounter::BytesReceived, receiveSize);
+        received += receiveSize;
+        __threadTraffic.received += receiveSize;
+    }
+
+    return true;
+}
+
+bool TCPSocket::waitReadable(const std::optional<Deadline> &deadline) const {
+    platform::PollDescriptor descriptor{};
+    descriptor.fd = *sock;
+    descriptor.events = POLLIN;
+
+    while (true) {
+        // Convert the deadline into a timeout relative to now, rounding up so we never wake just before it. A
+        // deadline in the past is a zero timeout, so we still pick up data which has already arrived
+        int timeout = -1;
+        if (deadline.has_value()) {
+            Deadline::duration remaining = std::max(deadline.value() - Deadline::clock::now(),
+                                                    Deadline::duration::zero());
+            timeout = (int) std::chrono::ceil<std::chrono::milliseconds>(remaining).count();
+        }
+
+        // Wait for the socket to become readable. A return of 0 means the timeout expired. An error or hang up
+        // also counts as readable, so the following receive picks it up
+        int ready = platform::poll(&descriptor, 1, timeout);
+        if (ready != SOCKET_ERROR) {
+            return ready > 0 && (descriptor.revents & POLLNVAL) == 0;
+        }
+        // A signal interrupting the wait just means waiting again for whatever time is left
+        if (!platform::interrupted(platform::lastError())) {
+            return false;
+        }
+    }
+}
+
+bool TCPSocket::sendAll(const byte *data, size_t size) const {
+    size_t written = 0;
+    // Keep sending until the whole buffer has been accepted by the socket
+    while (written < size) {
+        int sent = (int) ::send(*sock, (const char *) data + written, (int) (size - written), platform::SendFlags);
+        SocketMetrics::add(SocketCounter::SendCalls);
+        if (sent == SOCKET_ERROR) {
+            int error = platform::lastError();
+            // A signal arrived before anything was written, so just try again
+            if (platform::interrupted(error)) {
+                continue;
+            }
+            // A non blocking socket with a full send buffer carries on once the remote has read some of it
+            if (platform::wouldBlock(error) && waitWritable()) {
+                continue;
+            }
+            // Anything else means the connection has failed, so the rest of the buffer can never be sent
+            SocketMetrics::add(SocketCounter::SendErrors);
+            return false;
+        }
+        SocketMetrics::add(SocketCounter::BytesSent, sent);
+        if ((size_t) sent < size - written) {
+            SocketMetrics::add(SocketCounter::PartialWrites);
+        }
+        written += sent;
+    }
+
+    return true;
+}
+
+bool TCPSocket::waitWritable() const {
+    platform::PollDescriptor descriptor{};
+    descriptor.fd = *sock;
+    descriptor.events = POLLOUT;
+
+    while (true) {
+        int ready = platform::poll(&descriptor, 1, -1);
+        if (ready != SOCKET_ERROR) {
+            // An error or hang up also wakes the poll, and is reported by the next send
+            return ready > 0 && (descriptor.revents & POLLNVAL) == 0;
+        }
+        if (!platform::interrupted(platform::lastError())) {
+            return false;
+        }
+    }
 }
 
 void TCPSocket::invalidate() {
@@ -454,6 +867,9 @@ void TCPSocket::invalidate() {
     sock = nullptr;
     // Set the usage counter to be a null pointer
     __useCount = nullptr;
+    // Drop the references to the send queue and cork state
+    sendQueue = nullptr;
+    corkState = nullptr;
 }
 
 void TCPSocket::destroy() {
@@ -463,58 +879,44 @@ void TCPSocket::destroy() {
     if (sock) {
         if (*sock != INVALID_SOCK) {
             // Shut it down and close it
-            shutdown(*sock, SD_BOTH);
-            closesocket(*sock);
+            platform::shutdownSocket(*sock);
+            platform::closeSocket(*sock);
             *sock = INVALID_SOCK;
-            // Invalidate the socket object (in case the object still exists, to notify that the actual socket
-            // is closed)
-            invalidate();
+            SocketMetrics::add(SocketCounter::SocketsClosed);
         }
+        // Invalidate the socket object (in case the object still exists, to notify that the actual socket
+        // is closed). This applies even if another copy closed the socket first, as we have dropped our
+        // use count either way
+        invalidate();
+    }
+}
+
+CorkGuard::CorkGuard(const TCPSocket &socket)
+        : socket(socket) {
+    // Cork the socket for the lifetime of the guard
+    this->socket.cork();
+}
+
+CorkGuard::~CorkGuard() {
+    // Release the cork if the socket is still alive
+    if (socket) {
+        socket.uncork();
     }
 }
 
 SocketException::SocketException(const std::string &message)
-        : std::exception(formatMessage(message).c_str()) {
+        : message(formatMessage(message)) {
 
 }
 
+const char *SocketException::what() const noexcept {
+    return message.c_str();
+}
+
 std::string SocketException::formatMessage(const std::string &userMessage) {
-    // Declare buffers for the error message and the return display buffer
-    LPVOID messageBuffer;
-    LPVOID displayBuffer;
     // Get the error code
-    DWORD code = WSAGetLastError();
-
-    // Format the message into the message buffer string
-    FormatMessageA(
-            FORMAT_MESSAGE_ALLOCATE_BUFFER |
-            FORMAT_MESSAGE_FROM_SYSTEM |
-            FORMAT_MESSAGE_IGNORE_INSERTS,
-            nullptr, code,
-            MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT),
-            (LPSTR) &messageBuffer,
-            0, nullptr
-    );
-
-    // Create the buffer for the display message
-    displayBuffer = (LPVOID) LocalAlloc(
-            LMEM_ZEROINIT,
-            (lstrlen((LPCTSTR) messageBuffer) + userMessage.size() + 40) * sizeof(TCHAR)
-    );
-    // Print the passed in message, the error message and the error code into the buffer
-    StringCchPrintf((LPTSTR) displayBuffer,
-                    LocalSize(displayBuffer) / sizeof(TCHAR),
-                    TEXT("%s (%d): %s"),
-                    (LPTSTR) userMessage.c_str(), code, messageBuffer
-    );
-
-    // Convert the raw string back into a C++ string
-    std::string message((const char *) displayBuffer, lstrlen((LPCTSTR) displayBuffer));
-
-    // Free the two local buffers
-    LocalFree(messageBuffer);
-    LocalFree(displayBuffer);
-
-    // Return the actual complete error message string
-    return message;
-}
\ No newline at end of file
+    int code = platform::lastError();
+
+    // Combine the passed in message, the error code and the platform's description of the error
+    return userMessage + " (" + std::to_string(code) + "): " + platform::errorString(code);
+}
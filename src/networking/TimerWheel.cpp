@@ -0,0 +1,97 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include <algorithm>
+
+#include "../../include/networking/TimerWheel.h"
+
+using namespace networking;
+
+TimerWheel::TimerWheel(std::chrono::milliseconds tick, size_t slotCount)
+        : tick(tick), slots(slotCount), currentTime(Clock::now()) {
+
+}
+
+TimerWheel::TimerID TimerWheel::schedule(Clock::time_point deadline, std::function<void()> callback) {
+    // Work out how many ticks away the deadline is, rounding up so the timer never fires early. A deadline
+    // which has already passed fires on the next tick
+    Clock::duration delay = deadline - currentTime;
+    size_t ticks = 1;
+    if (delay > Clock::duration::zero()) {
+        ticks = std::max<size_t>(1, (delay + tick - Clock::duration(1)) / tick);
+    }
+
+    // Place the timer in the slot the wheel will be on after that many ticks, with however many whole turns
+    // of the wheel it must wait through first
+    size_t slot = (currentSlot + ticks) % slots.size();
+    size_t rounds = (ticks - 1) / slots.size();
+
+    TimerID id = nextID++;
+    slots[slot].push_back({id, rounds, std::move(callback)});
+    locations.emplace(id, TimerLocation{slot, std::prev(slots[slot].end())});
+
+    return id;
+}
+
+TimerWheel::TimerID TimerWheel::schedule(Clock::duration delay, std::function<void()> callback) {
+    return schedule(Clock::now() + delay, std::move(callback));
+}
+
+bool TimerWheel::cancel(TimerID id) {
+    // Look up where the timer is, and if it still exists, remove it from its slot
+    auto it = locations.find(id);
+    if (it == locations.end()) {
+        return false;
+    }
+
+    slots[it->second.slot].erase(it->second.timer);
+    locations.erase(it);
+    return true;
+}
+
+size_t TimerWheel::advance(Clock::time_point now) {
+    size_t fired = 0;
+
+    // Step through each whole tick which has passed
+    while (currentTime + tick <= now) {
+        currentTime += tick;
+        currentSlot = (currentSlot + 1) % slots.size();
+
+        // Collect the expired timers from this slot before calling any of them, as the callbacks may modify
+        // the wheel. Timers due on a later turn just count down a round
+        Slot expired;
+        Slot &slot = slots[currentSlot];
+        for (Slot::iterator timer = slot.begin(); timer != slot.end();) {
+            if (timer->rounds == 0) {
+                locations.erase(timer->id);
+                Slot::iterator next = std::next(timer);
+                expired.splice(expired.end(), slot, timer);
+                timer = next;
+            } else {
+                timer->rounds--;
+                timer++;
+            }
+        }
+
+        // Fire each of the expired timers
+        for (Timer &timer : expired) {
+            timer.callback();
+            fired++;
+        }
+    }
+
+    return fired;
+}
+
+std::optional<TimerWheel::Clock::duration> TimerWheel::timeUntilNextTick(Clock::time_point now) const {
+    // If nothing is scheduled, there is no need to wake up for the wheel
+    if (locations.empty()) {
+        return std::nullopt;
+    }
+    return std::max(currentTime + tick - now, Clock::duration::zero());
+}
+
+size_t TimerWheel::size() const {
+    return locations.size();
+}
@@ -0,0 +1,71 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include <algorithm>
+
+#if defined(__SSSE3__) || defined(__AVX__)
+#include <immintrin.h>
+#define BYTE_ORDER_SIMD_SWAP
+#endif
+
+#include "../../include/networking/byteOrder.h"
+
+using namespace networking;
+
+#ifdef BYTE_ORDER_SIMD_SWAP
+// Swap every element in as many whole 16 byte blocks as there are in the buffer using a single byte shuffle
+// per block. Returns the number of bytes which were swapped, so the caller can finish the tail.
+static size_t simdByteSwap(byte *data, size_t bytes, size_t elementSize) {
+    // Build the shuffle mask, which reverses the bytes within each element in the block
+    alignas(16) char mask[16];
+    for (size_t i = 0; i < 16; i++) {
+        mask[i] = (char) ((i / elementSize) * elementSize + (elementSize - 1 - i % elementSize));
+    }
+    const __m128i shuffle = _mm_load_si128((const __m128i *) mask);
+
+    size_t offset = 0;
+    for (; offset + 16 <= bytes; offset += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i *) (data + offset));
+        _mm_storeu_si128((__m128i *) (data + offset), _mm_shuffle_epi8(block, shuffle));
+    }
+
+    return offset;
+}
+#endif
+
+void networking::byteSwapElements(byte *data, size_t count, size_t elementSize) {
+    // Single byte elements have no byte order
+    if (elementSize <= 1) {
+        return;
+    }
+
+    size_t bytes = count * elementSize;
+    size_t offset = 0;
+
+#ifdef BYTE_ORDER_SIMD_SWAP
+    // Only the power of two sizes tile a 16 byte block exactly
+    if (elementSize == 2 || elementSize == 4 || elementSize == 8) {
+        offset = simdByteSwap(data, bytes, elementSize);
+    }
+#endif
+
+    // Scalar reversal of whatever is left over
+    for (; offset < bytes; offset += elementSize) {
+        std::reverse(data + offset, data + offset + elementSize);
+    }
+}
+
+void networking::writeLittleEndian(byte *dst, unsigned long long value, size_t width) {
+    for (size_t i = 0; i < width; i++) {
+        dst[i] = (byte) (value >> (8 * i));
+    }
+}
+
+unsigned long long networking::readLittleEndian(const byte *src, size_t width) {
+    unsigned long long value = 0;
+    for (size_t i = 0; i < width; i++) {
+        value |= (unsigned long long) src[i] << (8 * i);
+    }
+    return value;
+}
@@ -0,0 +1,72 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#include <cstring>
+
+#include "../../../include/networking/platform/socketPlatform.h"
+
+using namespace networking;
+
+// Overloads to read the result of either variant of strerror_r. The XSI version returns an error code and
+// writes into the buffer, while the GNU version returns the message (which may or may not be the buffer)
+static std::string strerrorResult(int, const char *buffer) {
+    return buffer;
+}
+
+static std::string strerrorResult(const char *message, const char *) {
+    return message;
+}
+
+void platform::startup() {
+    // There is no socket library to start on POSIX systems
+}
+
+void platform::cleanup() {
+
+}
+
+int platform::shutdownSocket(SOCKET sock) {
+    return shutdown(sock, SHUT_RDWR);
+}
+
+int platform::shutdownSend(SOCKET sock) {
+    return shutdown(sock, SHUT_WR);
+}
+
+int platform::closeSocket(SOCKET sock) {
+    return close(sock);
+}
+
+bool platform::setNonBlocking(SOCKET sock) {
+    // Read the current file status flags, then set them again with the non blocking flag added
+    int flags = fcntl(sock, F_GETFL, 0);
+    if (flags == -1) {
+        return false;
+    }
+    return fcntl(sock, F_SETFL, flags | O_NONBLOCK) != -1;
+}
+
+int platform::lastError() {
+    return errno;
+}
+
+bool platform::wouldBlock(int error) {
+    return error == EWOULDBLOCK || error == EAGAIN;
+}
+
+bool platform::interrupted(int error) {
+    return error == EINTR;
+}
+
+int platform::poll(PollDescriptor *descriptors, size_t count, int timeoutMillis) {
+    return ::poll(descriptors, (nfds_t) count, timeoutMillis);
+}
+
+std::string platform::errorString(int error) {
+    char buffer[256] = {};
+    return strerrorResult(strerror_r(error, buffer, sizeof(buffer)), buffer);
+}
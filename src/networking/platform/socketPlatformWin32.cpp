@@ -0,0 +1,80 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include "../../../include/networking/platform/socketPlatform.h"
+
+using namespace networking;
+
+// WSA state for the process
+static WSADATA wsaData;
+
+void platform::startup() {
+    WSAStartup(MAKEWORD(2u, 2u), &wsaData);
+}
+
+void platform::cleanup() {
+    WSACleanup();
+}
+
+int platform::shutdownSocket(SOCKET sock) {
+    return shutdown(sock, SD_BOTH);
+}
+
+int platform::shutdownSend(SOCKET sock) {
+    return shutdown(sock, SD_SEND);
+}
+
+int platform::closeSocket(SOCKET sock) {
+    return closesocket(sock);
+}
+
+bool platform::setNonBlocking(SOCKET sock) {
+    // Create a value to set the non blocking property to - 1 for true
+    unsigned long nonBlocking = 1;
+    // Set the socket object's non blocking property to true
+    return ioctlsocket(sock, FIONBIO, &nonBlocking) != SOCKET_ERROR;
+}
+
+int platform::lastError() {
+    return WSAGetLastError();
+}
+
+bool platform::wouldBlock(int error) {
+    return error == WSAEWOULDBLOCK;
+}
+
+bool platform::interrupted(int error) {
+    return error == WSAEINTR;
+}
+
+int platform::poll(PollDescriptor *descriptors, size_t count, int timeoutMillis) {
+    return WSAPoll(descriptors, (ULONG) count, timeoutMillis);
+}
+
+std::string platform::errorString(int error) {
+    // Declare a buffer for the error message
+    LPSTR messageBuffer = nullptr;
+
+    // Format the message into the message buffer string
+    DWORD length = FormatMessageA(
+            FORMAT_MESSAGE_ALLOCATE_BUFFER |
+            FORMAT_MESSAGE_FROM_SYSTEM |
+            FORMAT_MESSAGE_IGNORE_INSERTS,
+            nullptr, error,
+            MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT),
+            (LPSTR) &messageBuffer,
+            0, nullptr
+    );
+
+    // Convert the raw string into a C++ string, dropping the trailing line break the system adds
+    std::string message(messageBuffer ? messageBuffer : "", length);
+    while (!message.empty() && (message.back() == '\n' || message.back() == '\r')) {
+        message.pop_back();
+    }
+
+    // Free the system allocated buffer
+    LocalFree(messageBuffer);
+
+    return message;
+}
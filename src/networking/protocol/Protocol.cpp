@@ -31,51 +31,14 @@ Protocol &Protocol::operator=(Protocol &&other) noexcept {
     return *this;
 }
 
-void Protocol::execute() {
-    __completed = false;
-
-    // Initialise the current layer to 0
-    size_t currentLayer = 0;
-
-    // Loop over every linker function
-    for (const LinkElement &link : links) {
-        // Get the layer of the current linker function - this is the index of the "from" side of the feed
-        size_t layerID = link.first;
-        // Get the actual linker function
-        std::function < void() > linker = link.second;
-
-        // If the layer of this link is greater than the current layer, this means that we have executed all of
-        // the linker functions up to layerID. Therefore, we need to activate each layer up to
-        // layerID. The goal is to activate each layer once and only once, in order, and only after it has been
-        // fed all of its inputs. As there is no cyclic feeding, we know that if we have no more links which come
-        // from a layer earlier than layerID, then each layer is ready for activation.
-        if (layerID >= currentLayer) {
-            // Activate each layer from the current layer up to layerID (exclusive)
-            for (size_t l = currentLayer; l <= layerID; l++) {
-                layers[l]->activate();
-                if (layers[l]->protocolTerminated()) {
-                    return;
-                }
-            }
-            // Update the current layer to layer ID + 1
-            currentLayer = layerID + 1;
-        }
-
-        // Call the linker function
-        linker();
-    }
-
-    // We can see that every layer up to (but not including) currentLayer has been activated from above. Therefore,
-    // we still need to activate the rest of the layers, so for each layer from currentLayer to the end of the layers
-    // list, we activate it.
-    for (size_t l = currentLayer; l < layers.size(); l++) {
-        layers[l]->activate();
-        if (layers[l]->protocolTerminated()) {
-            return;
-        }
-    }
+void Protocol::execute(std::chrono::milliseconds timeout) {
+    NullProtocolInstrumentation instrumentation;
+    execute(timeout, instrumentation);
+}
 
-    __completed = true;
+void Protocol::execute() {
+    NullProtocolInstrumentation instrumentation;
+    executeLayers(instrumentation);
 }
 
 void Protocol::clearData() {
@@ -85,6 +48,21 @@ void Protocol::clearData() {
     }
 }
 
+void Protocol::setLayerDeadlines(const std::optional<std::chrono::steady_clock::time_point> &deadline) {
+    for (std::unique_ptr<internal::ProtocolLayer> &layer : layers) {
+        layer->setDeadline(deadline);
+    }
+}
+
+Protocol::DeadlineGuard::DeadlineGuard(Protocol &protocol, std::chrono::steady_clock::time_point deadline)
+        : protocol(protocol) {
+    protocol.setLayerDeadlines(deadline);
+}
+
+Protocol::DeadlineGuard::~DeadlineGuard() {
+    protocol.setLayerDeadlines(std::nullopt);
+}
+
 bool Protocol::completed() const {
     return __completed;
 }
@@ -0,0 +1,156 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include <algorithm>
+#include <iomanip>
+#include <typeinfo>
+
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#include <cstdlib>
+#endif
+
+#include "../../../include/networking/protocol/ProtocolMetrics.h"
+
+using namespace networking;
+
+// Get the readable name of a layer's type
+static std::string layerTypeName(const internal::ProtocolLayer &layer) {
+    const char *name = typeid(layer).name();
+#if defined(__GNUG__)
+    // GCC and Clang give mangled names, so demangle them
+    int status = 0;
+    char *demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+    if (status == 0 && demangled) {
+        std::string readable(demangled);
+        std::free(demangled);
+        return readable;
+    }
+#endif
+    return name;
+}
+
+LayerStats::LayerStats(std::string layer)
+        : layer(std::move(layer)) {
+
+}
+
+void ProtocolMetrics::layerActivated(const internal::ProtocolLayer &layer, std::chrono::steady_clock::duration duration,
+                                     unsigned long long bytesSent, unsigned long long bytesReceived) {
+    LayerStats &stats = layerStats(layer);
+    stats.activations.fetch_add(1, std::memory_order_relaxed);
+    stats.bytesSent.fetch_add(bytesSent, std::memory_order_relaxed);
+    stats.bytesReceived.fetch_add(bytesReceived, std::memory_order_relaxed);
+    stats.activate.record(duration);
+}
+
+void ProtocolMetrics::layerTerminated(const internal::ProtocolLayer &layer, TerminationReason reason) {
+    layerStats(layer).terminations[(size_t) reason].fetch_add(1, std::memory_order_relaxed);
+}
+
+void ProtocolMetrics::executionFinished(bool executionCompleted, std::chrono::steady_clock::duration duration) {
+    (executionCompleted ? completed : terminated).fetch_add(1, std::memory_order_relaxed);
+    executions.record(duration);
+}
+
+ProtocolReport ProtocolMetrics::report() const {
+    ProtocolReport report{};
+    report.completed = completed.load(std::memory_order_relaxed);
+    report.terminated = terminated.load(std::memory_order_relaxed);
+    report.executions = executions.summary();
+
+    {
+        std::lock_guard<std::mutex> guard(layerLock);
+        report.layers.reserve(layers.size());
+        for (const std::pair<const std::type_index, std::unique_ptr<LayerStats>> &entry : layers) {
+            const LayerStats &stats = *entry.second;
+            LayerReport &layer = report.layers.emplace_back();
+            layer.layer = stats.layer;
+            layer.activations = stats.activations.load(std::memory_order_relaxed);
+            layer.bytesSent = stats.bytesSent.load(std::memory_order_relaxed);
+            layer.bytesReceived = stats.bytesReceived.load(std::memory_order_relaxed);
+            for (size_t reason = 0; reason < TerminationReasonCount; reason++) {
+                layer.terminations[reason] = stats.terminations[reason].load(std::memory_order_relaxed);
+            }
+            layer.activate = stats.activate.summary();
+        }
+    }
+
+    std::sort(report.layers.begin(), report.layers.end(), [](const LayerReport &a, const LayerReport &b) {
+        return a.activate.mean * (double) a.activate.count > b.activate.mean * (double) b.activate.count;
+    });
+    return report;
+}
+
+void ProtocolMetrics::dump(std::ostream &out) const {
+    ProtocolReport protocolReport = report();
+
+    out << "executions: " << protocolReport.completed << " completed, " << protocolReport.terminated
+        << " terminated, p50 " << std::fixed << std::setprecision(3) << (double) protocolReport.executions.p50 / 1e6
+        << " ms, p99 " << (double) protocolReport.executions.p99 / 1e6 << " ms\n";
+    out << "activations       sent   received    p50 ms    p99 ms    max ms  layer (terminations)\n";
+    for (const LayerReport &layer : protocolReport.layers) {
+        out << std::setw(11) << layer.activations << ' ' << std::setw(10) << layer.bytesSent << ' '
+            << std::setw(10) << layer.bytesReceived << ' ' << std::setprecision(3)
+            << std::setw(9) << (double) layer.activate.p50 / 1e6 << ' '
+            << std::setw(9) << (double) layer.activate.p99 / 1e6 << ' '
+            << std::setw(9) << (double) layer.activate.max / 1e6 << "  " << layer.layer;
+
+        // List only the reasons the layer has actually stopped protocols for
+        bool first = true;
+        for (size_t reason = (size_t) TerminationReason::Unspecified; reason < TerminationReasonCount; reason++) {
+            if (layer.terminations[reason] != 0) {
+                out << (first ? " (" : ", ") << reasonName((TerminationReason) reason) << ' '
+                    << layer.terminations[reason];
+                first = false;
+            }
+        }
+        out << (first ? "\n" : ")\n");
+    }
+}
+
+void ProtocolMetrics::reset() {
+    // The layers are kept, as executions in progress may hold references to them, and only their counts cleared
+    std::lock_guard<std::mutex> guard(layerLock);
+    for (std::pair<const std::type_index, std::unique_ptr<LayerStats>> &entry : layers) {
+        LayerStats &stats = *entry.second;
+        stats.activations.store(0, std::memory_order_relaxed);
+        stats.bytesSent.store(0, std::memory_order_relaxed);
+        stats.bytesReceived.store(0, std::memory_order_relaxed);
+        for (std::atomic<uint64_t> &count : stats.terminations) {
+            count.store(0, std::memory_order_relaxed);
+        }
+        stats.activate.reset();
+    }
+    completed.store(0, std::memory_order_relaxed);
+    terminated.store(0, std::memory_order_relaxed);
+    executions.reset();
+}
+
+const char *ProtocolMetrics::reasonName(TerminationReason reason) {
+    switch (reason) {
+        case TerminationReason::None:
+            return "none";
+        case TerminationReason::Unspecified:
+            return "unspecified";
+        case TerminationReason::ConnectionLost:
+            return "connection lost";
+        case TerminationReason::DeadlineExpired:
+            return "deadline expired";
+        case TerminationReason::MalformedMessage:
+            return "malformed message";
+    }
+    return "unknown";
+}
+
+LayerStats &ProtocolMetrics::layerStats(const internal::ProtocolLayer &layer) {
+    std::type_index type(typeid(layer));
+
+    std::lock_guard<std::mutex> guard(layerLock);
+    std::unordered_map<std::type_index, std::unique_ptr<LayerStats>>::iterator found = layers.find(type);
+    if (found != layers.end()) {
+        return *found->second;
+    }
+    return *layers.emplace(type, std::make_unique<LayerStats>(layerTypeName(layer))).first->second;
+}
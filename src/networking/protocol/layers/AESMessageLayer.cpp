@@ -24,9 +24,14 @@ void AESMessageLayer::activate() {
             break;
         }
         case RECEIVER: {
-            AESMessage aesMessage(socket.get().receive(), key.get());
+            NetworkMessage received = socket.get().receive(receiveDeadline());
+            if (received.invalid()) {
+                markReceiveFailure();
+                return;
+            }
+            AESMessage aesMessage(received, key.get());
             if (aesMessage.invalid()) {
-                markProtocolTermination();
+                markProtocolTermination(TerminationReason::MalformedMessage);
                 return;
             }
             message.get() = shared_byte_buffer(aesMessage.size());
@@ -30,9 +30,9 @@ void KeyExchange::activate() {
         }
         case RECEIVER: {
             // Receive a message from the socket
-            RawMessage keyMessage(socket.get().receive());
+            RawMessage keyMessage(socket.get().receive(receiveDeadline()));
             if (keyMessage.invalid()) {
-                markProtocolTermination();
+                markReceiveFailure();
                 return;
             }
             // Copy from the message data into the internal key value
@@ -26,9 +26,15 @@ void RSAMessageLayer::activate() {
         }
         case RECEIVER: {
             // Receive a message from the socket
-            RSAMessage rsaMessage(socket.get().receive(), { publicKey.get(), privateKey.get() });
+            NetworkMessage received = socket.get().receive(receiveDeadline());
+            if (received.invalid()) {
+                markReceiveFailure();
+                return;
+            }
+            // Decrypt it, which fails if it isn't the size of an encrypted value
+            RSAMessage rsaMessage(received, { publicKey.get(), privateKey.get() });
             if (rsaMessage.invalid()) {
-                markProtocolTermination();
+                markProtocolTermination(TerminationReason::MalformedMessage);
                 return;
             }
             // Copy from the message data into the internal value
@@ -0,0 +1,211 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "../include/networking/protocol/Protocol.h"
+#include "loopback.h"
+
+using namespace networking;
+using namespace tests;
+
+// Input and output slots for the test protocols. Inputs and outputs belong to no layer, so their layer type is a
+// placeholder
+using SocketInput = internal::Connector<0, std::nullptr_t, TCPSocket>;
+template<typename T>
+using ValuesInput = internal::Connector<1, std::nullptr_t, std::vector<T>>;
+template<typename T>
+using ValuesOutput = internal::Connector<0, std::nullptr_t, std::vector<T>>;
+
+// Send an array on the socket with a single array exchange
+template<typename T>
+static bool sendArray(const TCPSocket &socket, const std::vector<T> &values) {
+    Protocol protocol;
+    LayerReference<ArrayExchange<T>> exchange = protocol.addLayer<ArrayExchange<T>>(Sender);
+    protocol.link<SocketInput, typename ArrayExchange<T>::Socket>(Protocol::Inputs, exchange);
+    protocol.link<ValuesInput<T>, typename ArrayExchange<T>::Values>(Protocol::Inputs, exchange);
+    protocol.feed<SocketInput>(socket);
+    protocol.feed<ValuesInput<T>>(values);
+    protocol.execute();
+    return protocol.completed();
+}
+
+// Receive an array from the socket with a single array exchange. Returns std::nullopt if the exchange terminated
+template<typename T>
+static std::optional<std::vector<T>> receiveArray(const TCPSocket &socket) {
+    Protocol protocol;
+    LayerReference<ArrayExchange<T>> exchange = protocol.addLayer<ArrayExchange<T>>(Receiver);
+    protocol.link<SocketInput, typename ArrayExchange<T>::Socket>(Protocol::Inputs, exchange);
+    protocol.link<typename ArrayExchange<T>::Values, ValuesOutput<T>>(exchange, Protocol::Outputs);
+    protocol.feed<SocketInput>(socket);
+    protocol.execute(std::chrono::seconds(10));
+    if (!protocol.completed()) {
+        return std::nullopt;
+    }
+    return protocol.read<ValuesOutput<T>>();
+}
+
+// Build a frame by hand, with the given header fields and element bytes
+static byte_buffer frame(unsigned count, unsigned short elementSize, ByteOrder order, const std::vector<byte> &body) {
+    byte_buffer buffer(ArrayExchange<int>::HeaderSize + body.size());
+    for (size_t i = 0; i < sizeof(unsigned); i++) {
+        buffer.begin()[i] = (byte) (count >> (8 * i));
+    }
+    buffer.begin()[4] = (byte) elementSize;
+    buffer.begin()[5] = (byte) (elementSize >> 8u);
+    buffer.begin()[6] = (byte) order;
+    buffer.begin()[7] = 0;
+    std::copy(body.begin(), body.end(), buffer.begin() + ArrayExchange<int>::HeaderSize);
+    return buffer;
+}
+
+// Get the bytes of each value in the byte order other than the host's, as a peer of that order would send them
+template<typename T>
+static std::vector<byte> foreignBytes(const std::vector<T> &values) {
+    std::vector<byte> bytes(values.size() * sizeof(T));
+    std::memcpy(bytes.data(), values.data(), bytes.size());
+    for (size_t i = 0; i < values.size(); i++) {
+        std::reverse(bytes.begin() + i * sizeof(T), bytes.begin() + (i + 1) * sizeof(T));
+    }
+    return bytes;
+}
+
+// The byte order other than the host's
+static ByteOrder foreignByteOrder() {
+    return hostByteOrder() == ByteOrder::LITTLE ? ByteOrder::BIG : ByteOrder::LITTLE;
+}
+
+TEST(ArrayExchange, FrameIsHeaderThenNativeElements) {
+    LoopbackPair pair = connectLoopback();
+    std::vector<int> values = {1, -2, 300000};
+    ASSERT_TRUE(sendArray(pair.client, values));
+
+    RawMessage message(pair.server.receive(std::chrono::steady_clock::now() + std::chrono::seconds(10)));
+    ASSERT_FALSE(message.invalid());
+    ASSERT_EQ(message.size(), ArrayExchange<int>::HeaderSize + values.size() * sizeof(int));
+
+    // The count and element size are little endian whatever the host, followed by the host's byte order
+    const byte *data = message.begin();
+    EXPECT_EQ(data[0], 3);
+    EXPECT_EQ(data[1] | data[2] | data[3], 0);
+    EXPECT_EQ(data[4], sizeof(int));
+    EXPECT_EQ(data[5], 0);
+    EXPECT_EQ(data[6], (byte) hostByteOrder());
+    EXPECT_EQ(data[7], 0);
+    EXPECT_EQ(std::memcmp(data + ArrayExchange<int>::HeaderSize, values.data(), values.size() * sizeof(int)), 0);
+}
+
+TEST(ArrayExchange, RoundTripsEmptyAndLargeArrays) {
+    LoopbackPair pair = connectLoopback();
+
+    std::vector<double> empty;
+    ASSERT_TRUE(sendArray(pair.client, empty));
+    std::optional<std::vector<double>> receivedEmpty = receiveArray<double>(pair.server);
+    ASSERT_TRUE(receivedEmpty.has_value());
+    EXPECT_TRUE(receivedEmpty->empty());
+
+    // Large enough to span many message chunks
+    std::vector<long long> large(50000);
+    for (size_t i = 0; i < large.size(); i++) {
+        large[i] = (long long) (i * i) - 12345;
+    }
+    std::thread sender([&]() { sendArray(pair.client, large); });
+    std::optional<std::vector<long long>> receivedLarge = receiveArray<long long>(pair.server);
+    sender.join();
+    ASSERT_TRUE(receivedLarge.has_value());
+    EXPECT_EQ(receivedLarge.value(), large);
+}
+
+TEST(ArrayExchange, ElementsInTheOtherByteOrderAreSwapped) {
+    LoopbackPair pair = connectLoopback();
+    std::vector<unsigned short> shorts = {0x0102, 0xA0B0, 7};
+    std::vector<unsigned> ints = {0x01020304u, 0xDEADBEEFu};
+    std::vector<double> doubles = {1.5, -0.25, 1e300};
+
+    ASSERT_TRUE(pair.client.send(RawMessage(frame(3, sizeof(unsigned short), foreignByteOrder(),
+                                                  foreignBytes(shorts)))));
+    ASSERT_TRUE(pair.client.send(RawMessage(frame(2, sizeof(unsigned), foreignByteOrder(), foreignBytes(ints)))));
+    ASSERT_TRUE(pair.client.send(RawMessage(frame(3, sizeof(double), foreignByteOrder(), foreignBytes(doubles)))));
+
+    EXPECT_EQ(receiveArray<unsigned short>(pair.server), shorts);
+    EXPECT_EQ(receiveArray<unsigned>(pair.server), ints);
+    EXPECT_EQ(receiveArray<double>(pair.server), doubles);
+}
+
+TEST(ArrayExchange, RejectsMalformedFrames) {
+    // Each frame ends its exchange, so each gets a connection of its own
+    struct Pod {
+        int a;
+        short b;
+    };
+    std::vector<std::pair<const char *, byte_buffer>> frames;
+    frames.emplace_back("wrong element size", frame(1, 8, hostByteOrder(), std::vector<byte>(8)));
+    frames.emplace_back("count larger than body", frame(3, 4, hostByteOrder(), std::vector<byte>(8)));
+    frames.emplace_back("short header", byte_buffer(ArrayExchange<int>::HeaderSize - 1));
+    for (std::pair<const char *, byte_buffer> &bad : frames) {
+        LoopbackPair pair = connectLoopback();
+        ASSERT_TRUE(pair.client.send(RawMessage(std::move(bad.second))));
+        EXPECT_FALSE(receiveArray<int>(pair.server).has_value()) << bad.first;
+    }
+
+    // A struct's fields can't be swapped without knowing its layout
+    LoopbackPair pair = connectLoopback();
+    ASSERT_TRUE(pair.client.send(RawMessage(frame(1, sizeof(Pod), foreignByteOrder(),
+                                                  std::vector<byte>(sizeof(Pod))))));
+    EXPECT_FALSE(receiveArray<Pod>(pair.server).has_value());
+}
+
+TEST(ByteOrder, SwapMatchesReversingEachElement) {
+    // Every element size, including the 2, 4 and 8 byte sizes with a vectorised path, at counts which leave every
+    // possible tail after the whole 16 byte blocks, starting from an unaligned address
+    for (size_t elementSize = 1; elementSize <= 16; elementSize++) {
+        for (size_t count = 0; count <= 40; count++) {
+            std::vector<byte> storage(count * elementSize + 1);
+            for (size_t i = 0; i < storage.size(); i++) {
+                storage[i] = (byte) (i * 7 + 3);
+            }
+            std::vector<byte> expected(storage.begin() + 1, storage.end());
+            for (size_t i = 0; i < count; i++) {
+                std::reverse(expected.begin() + i * elementSize, expected.begin() + (i + 1) * elementSize);
+            }
+
+            byteSwapElements(storage.data() + 1, count, elementSize);
+            EXPECT_TRUE(std::equal(expected.begin(), expected.end(), storage.begin() + 1))
+                                << "Element size " << elementSize << ", count " << count;
+            EXPECT_EQ(storage[0], 3) << "Wrote before the elements";
+        }
+    }
+}
+
+TEST(ByteOrder, SwapTwiceRestoresValues) {
+    std::vector<unsigned long long> values(37);
+    for (size_t i = 0; i < values.size(); i++) {
+        values[i] = 0x0102030405060708ull * (i + 1);
+    }
+    std::vector<unsigned long long> swapped = values;
+    byteSwapElements((byte *) swapped.data(), swapped.size(), sizeof(unsigned long long));
+    EXPECT_EQ(swapped[0], 0x0807060504030201ull);
+    byteSwapElements((byte *) swapped.data(), swapped.size(), sizeof(unsigned long long));
+    EXPECT_EQ(swapped, values);
+}
+
+TEST(ByteOrder, LittleEndianFieldsRoundTrip) {
+    byte buffer[8] = {};
+    writeLittleEndian(buffer, 0x0A0B0C0Du, sizeof(unsigned));
+    EXPECT_EQ(buffer[0], 0x0D);
+    EXPECT_EQ(buffer[3], 0x0A);
+    EXPECT_EQ(buffer[4], 0);
+    EXPECT_EQ(readLittleEndian(buffer, sizeof(unsigned)), 0x0A0B0C0Du);
+
+    // Only the low width bytes are written or read
+    writeLittleEndian(buffer, 0x0102030405060708ull, 2);
+    EXPECT_EQ(buffer[2], 0x0B);
+    EXPECT_EQ(readLittleEndian(buffer, 2), 0x0708u);
+    writeLittleEndian(buffer, ~0ull, sizeof(buffer));
+    EXPECT_EQ(readLittleEndian(buffer, sizeof(buffer)), ~0ull);
+}
@@ -0,0 +1,266 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include <gtest/gtest.h>
+
+#include "../include/database/SQLSession.h"
+#include "../include/database/ColumnCompute.h"
+#include "fakeDriver.h"
+
+using namespace sql;
+using namespace tests;
+
+// Row counts which leave every kind of tail: within the first word, a whole number of words, and part words whose
+// length leaves each remainder after the four value blocks of the dense kernel
+static const std::vector<size_t> tailRowCounts = {1, 3, 63, 64, 65, 128, 130, 229, 255};
+
+// ColumnComputeTest
+// A session connected to the fake driver, with tables of generated rows read into memory
+class ColumnComputeTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        FakeDriver::instance().reset();
+        session.connect("fake", "user", "password");
+    }
+
+    // Read a table of the given rows. Each row has an integer Count, a floating point Amount and a string Key,
+    // with the rows for which the null function returns true holding nulls in all three
+    template<typename NullFunction>
+    MaterializedResult numbers(size_t rows, NullFunction isNull) {
+        FakeResult table;
+        table.columns = {
+                {"Count", SQL_INTEGER, 10, true},
+                {"Amount", SQL_DOUBLE, 15, true},
+                {"Key", SQL_VARCHAR, 10, true}
+        };
+        for (size_t row = 0; row < rows; row++) {
+            if (isNull(row)) {
+                table.rows.push_back({std::nullopt, std::nullopt, std::nullopt});
+            } else {
+                // Values which go negative and back, so neither the minimum nor the maximum is at either end
+                long long count = (long long) ((row * 37) % 101) - 50;
+                table.rows.push_back({std::to_string(count), std::to_string(count * 2) + ".5",
+                                      "k" + std::to_string(row % 5)});
+            }
+        }
+        FakeDriver::instance().script("FROM Numbers", table);
+        return MaterializedResult(session.executeQuery("SELECT Count, Amount, Key FROM Numbers"));
+    }
+
+    MaterializedResult numbers(size_t rows) {
+        return numbers(rows, [](size_t) { return false; });
+    }
+
+    // Aggregate a column one row at a time, as a reference for the kernels
+    template<typename T>
+    static ColumnSummary<T> reference(const MaterializedResult &result, size_t column, const RowMask *mask) {
+        ColumnSummary<T> summary;
+        for (size_t row = 0; row < result.rowCount(); row++) {
+            if (!result.isNull(row, column) && (mask == nullptr || mask->test(row))) {
+                summary.add(result.get<T>(row, column).value());
+            }
+        }
+        return summary;
+    }
+
+    // Check a summary matches the reference
+    template<typename T>
+    static void expectSummary(const ColumnSummary<T> &actual, const ColumnSummary<T> &expected,
+                              const std::string &label) {
+        EXPECT_EQ(actual.count, expected.count) << label;
+        EXPECT_EQ(actual.sum, expected.sum) << label;
+        if (expected.count != 0) {
+            EXPECT_EQ(actual.min, expected.min) << label;
+            EXPECT_EQ(actual.max, expected.max) << label;
+        }
+    }
+
+    SQLSession session;
+};
+
+TEST_F(ColumnComputeTest, DenseAndScalarSummariesAgree) {
+    for (size_t rows : tailRowCounts) {
+        MaterializedResult result = numbers(rows);
+        std::string label = std::to_string(rows) + " rows";
+
+        // With nothing left out every word takes the dense kernel
+        expectSummary(summarise<int>(result, 0), reference<int>(result, 0, nullptr), label);
+        expectSummary(summarise<double>(result, 1), reference<double>(result, 1, nullptr), label);
+
+        // A mask clearing one row of every word sends each through the row at a time path instead
+        RowMask sparse(rows, true);
+        for (size_t row = 0; row < rows; row += 64) {
+            sparse.set(row, false);
+        }
+        expectSummary(summarise<int>(result, 0, &sparse), reference<int>(result, 0, &sparse), label + " masked");
+        expectSummary(summarise<double>(result, 1, &sparse), reference<double>(result, 1, &sparse),
+                      label + " masked");
+
+        // A full mask is the same as none
+        RowMask full(rows, true);
+        expectSummary(summarise<int>(result, 0, &full), reference<int>(result, 0, nullptr), label + " full");
+    }
+}
+
+TEST_F(ColumnComputeTest, SummariesLeaveOutNulls) {
+    for (size_t rows : tailRowCounts) {
+        // Nulls in some words but not others, so both paths are taken in the same column
+        MaterializedResult result = numbers(rows, [](size_t row) { return row % 128 == 70 || row == 2; });
+        std::string label = std::to_string(rows) + " rows";
+        expectSummary(summarise<int>(result, 0), reference<int>(result, 0, nullptr), label);
+        expectSummary(summarise<double>(result, 1), reference<double>(result, 1, nullptr), label);
+    }
+
+    // A column with nothing but nulls counts nothing
+    MaterializedResult empty = numbers(10, [](size_t) { return true; });
+    ColumnSummary<int> summary = summarise<int>(empty, 0);
+    EXPECT_EQ(summary.count, 0u);
+    EXPECT_EQ(summary.sum, 0);
+    EXPECT_EQ(summary.mean(), 0.0);
+}
+
+TEST_F(ColumnComputeTest, SummaryNeedsAMaskOverEveryRow) {
+    MaterializedResult result = numbers(10);
+    RowMask wrong(11, true);
+    EXPECT_THROW(summarise<int>(result, 0, &wrong), SQLException);
+    EXPECT_THROW(GroupIndex(result, {2}, &wrong), SQLException);
+    EXPECT_THROW(summarise<long long>(result, 0), SQLException);
+}
+
+TEST(RowMask, BitsPastTheLastRowStayClear) {
+    for (size_t rows : tailRowCounts) {
+        RowMask all(rows, true);
+        EXPECT_EQ(all.count(), rows);
+        EXPECT_EQ(all.words().size(), (rows + 63) / 64);
+
+        // Inverting an empty mask sets only the rows it covers
+        RowMask none(rows);
+        EXPECT_EQ(none.count(), 0u);
+        EXPECT_EQ((~none).count(), rows);
+        EXPECT_EQ((~all).count(), 0u);
+        if (rows % 64 != 0) {
+            EXPECT_EQ(all.words().back() >> (rows % 64), 0u) << rows << " rows";
+        }
+    }
+}
+
+TEST(RowMask, SetTestAndCombine) {
+    RowMask evens(130), low(130);
+    for (size_t row = 0; row < 130; row++) {
+        evens.set(row, row % 2 == 0);
+        low.set(row, row < 5);
+    }
+    EXPECT_TRUE(evens.test(128));
+    EXPECT_FALSE(evens.test(129));
+
+    EXPECT_EQ((evens & low).selectedRows(), (std::vector<uint32_t>{0, 2, 4}));
+    EXPECT_EQ((evens | low).count(), 65u + 2u);
+    EXPECT_EQ((~evens & low).selectedRows(), (std::vector<uint32_t>{1, 3}));
+
+    low.set(3, false);
+    EXPECT_EQ(low.selectedRows(), (std::vector<uint32_t>{0, 1, 2, 4}));
+
+    EXPECT_THROW(evens &= RowMask(129), SQLException);
+    EXPECT_THROW(evens |= RowMask(131), SQLException);
+}
+
+TEST_F(ColumnComputeTest, ComparisonsNeverMatchNulls) {
+    MaterializedResult result = numbers(130, [](size_t row) { return row % 3 == 0; });
+    RowMask present = RowMask::nonNull(result, 0);
+    EXPECT_EQ(present.count(), 130u - 44u);
+
+    for (Comparison comparison : {Comparison::EQUAL, Comparison::NOT_EQUAL, Comparison::LESS,
+                                  Comparison::LESS_EQUAL, Comparison::GREATER, Comparison::GREATER_EQUAL}) {
+        RowMask matched = compareColumn<int>(result, 0, comparison, 0);
+        for (size_t row = 0; row < result.rowCount(); row++) {
+            bool expected = false;
+            if (!result.isNull(row, 0)) {
+                int value = result.get<int>(row, 0).value();
+                expected = (comparison == Comparison::EQUAL && value == 0) ||
+                           (comparison == Comparison::NOT_EQUAL && value != 0) ||
+                           (comparison == Comparison::LESS && value < 0) ||
+                           (comparison == Comparison::LESS_EQUAL && value <= 0) ||
+                           (comparison == Comparison::GREATER && value > 0) ||
+                           (comparison == Comparison::GREATER_EQUAL && value >= 0);
+            }
+            ASSERT_EQ(matched.test(row), expected) << "Row " << row << ", comparison " << (int) comparison;
+        }
+        // Nulls are stored as zero, but must not match as one
+        EXPECT_EQ((matched & ~present).count(), 0u);
+    }
+
+    RowMask keyed = compareColumn(result, 2, Comparison::EQUAL, "k1");
+    EXPECT_EQ(keyed.count(), (compareColumn(result, 2, Comparison::LESS, "k2") &
+                              compareColumn(result, 2, Comparison::GREATER_EQUAL, "k1")).count());
+    for (uint32_t row : keyed.selectedRows()) {
+        EXPECT_EQ(result.get<std::string>(row, 2).value(), "k1");
+    }
+    EXPECT_EQ((compareColumn(result, 2, Comparison::NOT_EQUAL, "k1") & ~present).count(), 0u);
+}
+
+TEST_F(ColumnComputeTest, GroupsKeepNullsTogetherAndApartFromZero) {
+    FakeResult table;
+    table.columns = {
+            {"Region", SQL_VARCHAR, 10, true},
+            {"Code", SQL_INTEGER, 10, true},
+            {"Total", SQL_INTEGER, 10, true}
+    };
+    table.rows = {
+            {"north", "0", "1"},
+            {std::nullopt, std::nullopt, "2"},
+            {"north", std::nullopt, "4"},
+            {"south", "0", "8"},
+            {std::nullopt, std::nullopt, std::nullopt},
+            {"north", "0", "16"},
+            {"", "0", "32"}
+    };
+    FakeDriver::instance().script("FROM Sales", table);
+    MaterializedResult result(session.executeQuery("SELECT Region, Code, Total FROM Sales"));
+
+    // Groups are numbered by their first row. A null code is its own key, not a code of zero, and an empty string
+    // is not a null one
+    GroupIndex index(result, {0, 1});
+    ASSERT_EQ(index.groupCount(), 5u);
+    EXPECT_EQ(index.rowGroups(), (std::vector<uint32_t>{0, 1, 2, 3, 1, 0, 4}));
+    EXPECT_EQ(index.groupSizes(), (std::vector<size_t>{2, 2, 1, 1, 1}));
+    EXPECT_EQ(index.firstRow(2), 2u);
+
+    // Nulls in the summed column are left out of their group's aggregates
+    std::vector<ColumnSummary<int>> totals = index.summarise<int>(2);
+    EXPECT_EQ(totals[0].sum, 17);
+    EXPECT_EQ(totals[1].count, 1u);
+    EXPECT_EQ(totals[1].sum, 2);
+    EXPECT_EQ(totals[4].max, 32);
+
+    // Rows outside the mask are in no group
+    RowMask mask = compareColumn<int>(result, 2, Comparison::GREATER, 3);
+    GroupIndex masked(result, {0}, &mask);
+    EXPECT_EQ(masked.groupCount(), 3u);
+    EXPECT_EQ(masked.rowGroups()[0], GroupIndex::NO_GROUP);
+    EXPECT_EQ(masked.rowGroups()[4], GroupIndex::NO_GROUP);
+    EXPECT_EQ(masked.rowGroups()[2], masked.rowGroups()[5]);
+}
+
+TEST_F(ColumnComputeTest, ManyGroupsMatchAReferenceGrouping) {
+    // Enough groups that the open addressing table has to probe past collisions
+    MaterializedResult result = numbers(2000, [](size_t row) { return row % 97 == 0; });
+    GroupIndex index(result, {0, 2});
+
+    std::vector<std::pair<std::optional<int>, std::optional<std::string>>> keys;
+    for (size_t row = 0; row < result.rowCount(); row++) {
+        Value<int> count = result.get<int>(row, 0);
+        Value<std::string> key = result.get<std::string>(row, 2);
+        std::pair<std::optional<int>, std::optional<std::string>> rowKey(
+                count.hasValue() ? std::optional<int>(count.value()) : std::nullopt,
+                key.hasValue() ? std::optional<std::string>(key.value()) : std::nullopt);
+
+        size_t group = std::find(keys.begin(), keys.end(), rowKey) - keys.begin();
+        if (group == keys.size()) {
+            keys.push_back(rowKey);
+        }
+        ASSERT_EQ(index.rowGroups()[row], group) << "Row " << row;
+    }
+    EXPECT_EQ(index.groupCount(), keys.size());
+    EXPECT_GT(keys.size(), 100u);
+}
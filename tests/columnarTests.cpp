@@ -0,0 +1,155 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include <gtest/gtest.h>
+
+#include "../include/database/SQLSession.h"
+#include "../include/database/ColumnarBlock.h"
+#include "fakeDriver.h"
+
+using namespace sql;
+using namespace tests;
+
+// ColumnarTest
+// A session connected to the fake driver
+class ColumnarTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        FakeDriver::instance().reset();
+        session.connect("fake", "user", "password");
+    }
+
+    // Run a query and encode every row of its result into one block
+    byte_buffer encode(const std::string &sql) {
+        QueryResult result = session.executeQuery(sql);
+        ColumnarBlockEncoder encoder;
+        encoder.beginBlock(result);
+        while (result.fetchNextRow()) {
+            encoder.addRow(result);
+        }
+        return encoder.finishBlock();
+    }
+
+    SQLSession session;
+};
+
+TEST_F(ColumnarTest, RoundTripsEveryColumnType) {
+    FakeResult result;
+    result.columns = {
+            {"Flag", SQL_BIT, 1, true},
+            {"Small", SQL_SMALLINT, 5, false},
+            {"Count", SQL_INTEGER, 10, true},
+            {"Big", SQL_BIGINT, 19, false},
+            {"Ratio", SQL_DOUBLE, 15, true},
+            {"Day", SQL_TYPE_DATE, 10, true},
+            {"Name", SQL_VARCHAR, 10000, true}
+    };
+    std::string longName(3 * COLUMNAR_STRING_CHUNK + 5, 'x');
+    result.rows = {
+            {"1", "-3", "42", "9000000000", "0.5", "2026-10-18", "first"},
+            {std::nullopt, "7", std::nullopt, "-1", std::nullopt, std::nullopt, std::nullopt},
+            {"0", "0", "-42", "0", "-2.25", "1999-01-31", longName},
+            {"1", "1", "1", "1", "1", "2000-02-29", ""}
+    };
+    FakeDriver::instance().script("FROM Everything", result);
+
+    byte_buffer block = encode("SELECT * FROM Everything");
+    ColumnarBlockReader reader(block);
+
+    ASSERT_EQ(reader.rowCount(), 4u);
+    ASSERT_EQ(reader.columnCount(), 7u);
+    EXPECT_EQ(reader.columnName(6), "Name");
+    EXPECT_EQ(reader.columnType(0), ColumnType::BOOL);
+    EXPECT_EQ(reader.columnType(5), ColumnType::DATE);
+
+    EXPECT_EQ(reader.values<short>(1)[0], -3);
+    EXPECT_EQ(reader.values<int>(2)[2], -42);
+    EXPECT_EQ(reader.values<long long>(3)[0], 9000000000LL);
+    EXPECT_EQ(reader.values<double>(4)[2], -2.25);
+    EXPECT_EQ(reader.get<std::string>(6, 0).value(), "first");
+    EXPECT_EQ(reader.get<std::string>(6, 2).value(), longName);
+    EXPECT_EQ(reader.get<std::string>(6, 3).value(), "");
+
+    ColumnarDate date = reader.values<ColumnarDate>(5)[0];
+    EXPECT_EQ(date.year, 2026);
+    EXPECT_EQ(date.month, 10);
+    EXPECT_EQ(date.day, 18);
+
+    // Nulls in nullable columns are marked, and other values on the same row are unaffected
+    for (size_t column : {(size_t) 0, (size_t) 2, (size_t) 4, (size_t) 5, (size_t) 6}) {
+        EXPECT_TRUE(reader.isNull(column, 1));
+        EXPECT_FALSE(reader.isNull(column, 0));
+    }
+    EXPECT_FALSE(reader.isNull(1, 1));
+    EXPECT_EQ(reader.values<short>(1)[1], 7);
+}
+
+TEST_F(ColumnarTest, TinyIntKeepsValuesAboveSignedRange) {
+    // Some databases' TINYINT is unsigned, so values past 127 must survive
+    FakeResult result;
+    result.columns = {{"Level", SQL_TINYINT, 3, false}};
+    result.rows = {{"0"}, {"127"}, {"200"}, {"255"}};
+    FakeDriver::instance().script("FROM Levels", result);
+
+    byte_buffer block = encode("SELECT Level FROM Levels");
+    ColumnarBlockReader reader(block);
+
+    ASSERT_EQ(reader.rowCount(), 4u);
+    EXPECT_EQ(reader.values<short>(0)[2], 200);
+    EXPECT_EQ(reader.values<short>(0)[3], 255);
+}
+
+TEST_F(ColumnarTest, DecimalsAreReadAsDoubles) {
+    // Prices are decimals, read as doubles so they can be computed on. Within 15 significant digits nothing is lost
+    FakeResult result;
+    result.columns = {{"Price", SQL_DECIMAL, 12, false}, {"Rate", SQL_NUMERIC, 15, true}};
+    result.rows = {{"1234567890.12", "0.125"}, {"-0.01", std::nullopt}};
+    FakeDriver::instance().script("FROM Prices", result);
+
+    byte_buffer block = encode("SELECT Price, Rate FROM Prices");
+    ColumnarBlockReader reader(block);
+
+    ASSERT_EQ(reader.columnType(0), ColumnType::FLOAT64);
+    EXPECT_EQ(reader.values<double>(0)[0], 1234567890.12);
+    EXPECT_EQ(reader.values<double>(0)[1], -0.01);
+    EXPECT_EQ(reader.values<double>(1)[0], 0.125);
+    EXPECT_TRUE(reader.isNull(1, 1));
+}
+
+TEST(ColumnarBlockReader, RejectsColumnCountLargerThanBlock) {
+    // A header alone, claiming far more columns than the block has room for
+    byte_buffer block(16);
+    std::fill(block.begin(), block.end(), 0);
+    block.begin()[0] = COLUMNAR_BLOCK_VERSION;
+    block.begin()[1] = (byte) networking::hostByteOrder();
+    uint32_t columnCount = 0x7fffffff;
+    memcpy(block.begin() + 4, &columnCount, sizeof(uint32_t));
+
+    EXPECT_THROW(ColumnarBlockReader reader(block), SQLException);
+}
+
+TEST(ColumnarBlockReader, RejectsTruncatedBlock) {
+    // Cutting a valid block short anywhere past the header must be caught rather than read past the end
+    FakeDriver::instance().reset();
+    FakeResult result;
+    result.columns = {{"Name", SQL_VARCHAR, 10, true}, {"Count", SQL_INTEGER, 10, true}};
+    result.rows = {{"a", "1"}, {"bb", "2"}, {std::nullopt, "3"}};
+    FakeDriver::instance().script("FROM Short", result);
+
+    SQLSession session;
+    session.connect("fake", "user", "password");
+    QueryResult query = session.executeQuery("SELECT * FROM Short");
+    ColumnarBlockEncoder encoder;
+    encoder.beginBlock(query);
+    while (query.fetchNextRow()) {
+        encoder.addRow(query);
+    }
+    byte_buffer block = encoder.finishBlock();
+
+    for (size_t size = 16; size < block.size(); size += 8) {
+        byte_buffer truncated(size);
+        std::copy(block.begin(), block.begin() + size, truncated.begin());
+        EXPECT_THROW(ColumnarBlockReader reader(truncated), SQLException) << "Truncated to " << size;
+    }
+}
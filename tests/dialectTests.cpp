@@ -0,0 +1,193 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include <limits>
+
+#include <gtest/gtest.h>
+
+#include "../include/database/SQLDialect.h"
+#include "../include/database/SQLException.h"
+
+using namespace sql;
+
+// A query for the first page of orders after skipping some
+static SelectQuery pagedOrders(std::optional<size_t> offset, std::optional<size_t> limit) {
+    SelectQuery query;
+    query.rootTable = "Orders";
+    query.selections = {"Id"};
+    query.orderByConditions.emplace_back("Id", OrderDirection::ASC);
+    query.offset = offset;
+    query.limit = limit;
+    return query;
+}
+
+TEST(SQLDialect, RecognisesDriversByName) {
+    EXPECT_EQ(SQLDialect::forDBMS("Microsoft SQL Server").name(), "SQL Server");
+    EXPECT_EQ(SQLDialect::forDBMS("Oracle").name(), "Oracle");
+    EXPECT_EQ(SQLDialect::forDBMS("SQLite").name(), "SQLite");
+    EXPECT_EQ(SQLDialect::forDBMS("PostgreSQL").name(), "PostgreSQL");
+}
+
+TEST(SQLDialect, UnknownDatabaseGetsStandardPaging) {
+    const SQLDialect &dialect = SQLDialect::forDBMS("Firebird");
+    EXPECT_EQ(dialect.name(), "Standard SQL");
+
+    EXPECT_EQ(dialect.render(pagedOrders(std::nullopt, 10)), "SELECT Id\nFROM Orders\nORDER BY Id ASC\n"
+                                                             "FETCH FIRST 10 ROWS ONLY\n");
+    EXPECT_EQ(dialect.render(pagedOrders(20, 10)), "SELECT Id\nFROM Orders\nORDER BY Id ASC\n"
+                                                   "OFFSET 20 ROWS FETCH FIRST 10 ROWS ONLY\n");
+    EXPECT_EQ(dialect.render(pagedOrders(20, std::nullopt)), "SELECT Id\nFROM Orders\nORDER BY Id ASC\n"
+                                                             "OFFSET 20 ROWS\n");
+}
+
+TEST(SQLDialect, OracleOffsetNearTheLimitOfSize) {
+    // The offset and limit are written as given, rather than added together where they could wrap
+    size_t largest = std::numeric_limits<size_t>::max();
+    std::string sql = SQLDialect::oracle().render(pagedOrders(largest - 1, 10));
+    EXPECT_NE(sql.find("OFFSET " + std::to_string(largest - 1) + " ROWS FETCH NEXT 10 ROWS ONLY"),
+              std::string::npos) << sql;
+}
+
+// A query for the orders after a key, newest first and then by id
+static SelectQuery ordersAfter(std::vector<QueryParameter> key) {
+    SelectQuery query;
+    query.rootTable = "Orders";
+    query.selections = {"Id", "Placed"};
+    query.whereConditions = {"Status = 'open'"};
+    query.orderByConditions.emplace_back("Placed", OrderDirection::DESC);
+    query.orderByConditions.emplace_back("Id", OrderDirection::ASC);
+    query.afterKey = std::move(key);
+    return query;
+}
+
+TEST(SQLDialect, KeysetConditionFollowsEachKeysDirection) {
+    // Past the key is less than it on the descending column, and greater on the ascending one
+    EXPECT_EQ(SQLDialect::standard().render(ordersAfter({"2026-10-18", 41})),
+              "SELECT Id, Placed\nFROM Orders\n"
+              "WHERE Status = 'open' AND ((Placed < ?) OR (Placed = ? AND Id > ?))\n"
+              "ORDER BY Placed DESC, Id ASC\n");
+
+    // Each term repeats the key values before it, so the parameters are bound in the order they appear
+    std::vector<QueryParameter> parameters = SQLDialect::parameters(ordersAfter({"2026-10-18", 41}));
+    ASSERT_EQ(parameters.size(), 3u);
+    EXPECT_EQ(parameters[0].key(), QueryParameter("2026-10-18").key());
+    EXPECT_EQ(parameters[1].key(), QueryParameter("2026-10-18").key());
+    EXPECT_EQ(parameters[2].key(), QueryParameter(41).key());
+}
+
+TEST(SQLDialect, KeysetConditionOnThreeColumnsWithoutOtherConditions) {
+    SelectQuery query;
+    query.rootTable = "Lines";
+    query.selections = {"*"};
+    query.orderByConditions.emplace_back("Region", OrderDirection::ASC);
+    query.orderByConditions.emplace_back("Total", OrderDirection::DESC);
+    query.orderByConditions.emplace_back("Id", OrderDirection::ASC);
+    query.afterKey = {"North", 12.5, 7};
+    query.limit = 50;
+
+    EXPECT_EQ(SQLDialect::postgreSQL().render(query),
+              "SELECT *\nFROM Lines\n"
+              "WHERE ((Region > ?) OR (Region = ? AND Total < ?) OR (Region = ? AND Total = ? AND Id > ?))\n"
+              "ORDER BY Region ASC, Total DESC, Id ASC\n"
+              "LIMIT 50\n");
+    EXPECT_EQ(SQLDialect::parameters(query).size(), 6u);
+}
+
+TEST(SQLDialect, KeysetNeedsAValueForEachOrderColumn) {
+    EXPECT_THROW(SQLDialect::standard().render(ordersAfter({"2026-10-18"})), SQLException);
+    EXPECT_THROW(SQLDialect::sqlServer().render(ordersAfter({"2026-10-18", 41, 3})), SQLException);
+
+    // Including when there is no order at all to page through
+    SelectQuery unordered = pagedOrders(std::nullopt, 10);
+    unordered.orderByConditions.clear();
+    unordered.afterKey = {1};
+    EXPECT_THROW(SQLDialect::oracle().render(unordered), SQLException);
+}
+
+TEST(SQLDialect, SQLServerLimitsWithTopAndPagesWithOffsetFetch) {
+    const SQLDialect &dialect = SQLDialect::sqlServer();
+
+    // A limit alone is a TOP, which needs no order
+    EXPECT_EQ(dialect.render(pagedOrders(std::nullopt, 10)), "SELECT TOP 10 Id\nFROM Orders\nORDER BY Id ASC\n");
+
+    // With an offset, the limit moves to the FETCH after it, and TOP goes
+    EXPECT_EQ(dialect.render(pagedOrders(20, 10)), "SELECT Id\nFROM Orders\nORDER BY Id ASC\n"
+                                                   "OFFSET 20 ROWS FETCH NEXT 10 ROWS ONLY\n");
+    EXPECT_EQ(dialect.render(pagedOrders(20, std::nullopt)), "SELECT Id\nFROM Orders\nORDER BY Id ASC\n"
+                                                             "OFFSET 20 ROWS\n");
+
+    // OFFSET is only allowed after an ORDER BY, so a query without one is given an order by a constant
+    SelectQuery unordered = pagedOrders(20, 10);
+    unordered.orderByConditions.clear();
+    EXPECT_EQ(dialect.render(unordered), "SELECT Id\nFROM Orders\nORDER BY (SELECT NULL)\n"
+                                         "OFFSET 20 ROWS FETCH NEXT 10 ROWS ONLY\n");
+
+    EXPECT_EQ(dialect.quoteIdentifier("dbo.Odd]Name"), "[dbo].[Odd]]Name]");
+}
+
+TEST(SQLDialect, OracleWrapsALimitAroundTheOrderedRows) {
+    const SQLDialect &dialect = SQLDialect::oracle();
+
+    // ROWNUM is counted before ORDER BY is applied, so it must be taken from the ordered rows of a wrapped query
+    EXPECT_EQ(dialect.render(pagedOrders(std::nullopt, 10)), "SELECT * FROM (\n"
+                                                             "SELECT Id\nFROM Orders\nORDER BY Id ASC\n"
+                                                             ")\nWHERE ROWNUM <= 10\n");
+
+    // An offset is paged by the query itself, without the wrapping query
+    EXPECT_EQ(dialect.render(pagedOrders(20, 10)), "SELECT Id\nFROM Orders\nORDER BY Id ASC\n"
+                                                   "OFFSET 20 ROWS FETCH NEXT 10 ROWS ONLY\n");
+    EXPECT_EQ(dialect.render(pagedOrders(std::nullopt, std::nullopt)), "SELECT Id\nFROM Orders\nORDER BY Id ASC\n");
+}
+
+TEST(SQLDialect, OracleJoinsInTheWhereClause) {
+    SelectQuery query = pagedOrders(std::nullopt, std::nullopt);
+    query.rootTableAlias = "o";
+    query.joins.emplace_back("Customers", "c", "o.CustomerId", "c.Id", JoinType::LEFT);
+    query.whereConditions = {"o.Total > 10"};
+
+    EXPECT_EQ(SQLDialect::oracle().render(query), "SELECT Id\nFROM Orders o, Customers c\n"
+                                                  "WHERE o.CustomerId=c.Id(+) AND\no.Total > 10\n"
+                                                  "ORDER BY Id ASC\n");
+    EXPECT_EQ(SQLDialect::standard().render(query), "SELECT Id\nFROM Orders o\n"
+                                                    "LEFT JOIN Customers c ON o.CustomerId=c.Id\n"
+                                                    "WHERE o.Total > 10\nORDER BY Id ASC\n");
+}
+
+TEST(SQLDialect, SQLiteGivesAnOffsetOnlyAfterALimit) {
+    const SQLDialect &dialect = SQLDialect::sqlite();
+    EXPECT_EQ(dialect.render(pagedOrders(std::nullopt, 10)), "SELECT Id\nFROM Orders\nORDER BY Id ASC\nLIMIT 10\n");
+    EXPECT_EQ(dialect.render(pagedOrders(20, 10)), "SELECT Id\nFROM Orders\nORDER BY Id ASC\n"
+                                                   "LIMIT 10 OFFSET 20\n");
+    EXPECT_EQ(dialect.render(pagedOrders(20, std::nullopt)), "SELECT Id\nFROM Orders\nORDER BY Id ASC\n"
+                                                             "LIMIT -1 OFFSET 20\n");
+    EXPECT_EQ(dialect.render(pagedOrders(std::nullopt, std::nullopt)), "SELECT Id\nFROM Orders\nORDER BY Id ASC\n");
+}
+
+TEST(SQLDialect, PostgreSQLLimitsAndOffsetsSeparately) {
+    const SQLDialect &dialect = SQLDialect::postgreSQL();
+    EXPECT_EQ(dialect.render(pagedOrders(std::nullopt, 10)), "SELECT Id\nFROM Orders\nORDER BY Id ASC\nLIMIT 10\n");
+    EXPECT_EQ(dialect.render(pagedOrders(20, 10)), "SELECT Id\nFROM Orders\nORDER BY Id ASC\n"
+                                                   "LIMIT 10\nOFFSET 20\n");
+    EXPECT_EQ(dialect.render(pagedOrders(20, std::nullopt)), "SELECT Id\nFROM Orders\nORDER BY Id ASC\nOFFSET 20\n");
+    EXPECT_EQ(dialect.quoteIdentifier("public.Odd\"Name"), "\"public\".\"Odd\"\"Name\"");
+}
+
+TEST(SQLDialect, GroupByComesBeforeOrderBy) {
+    SelectQuery query;
+    query.rootTable = "Orders";
+    query.selections = {"CustomerId", "COUNT(*)"};
+    query.whereConditions = {"Total > 10"};
+    query.groupByConditions = {"CustomerId"};
+    query.orderByConditions.emplace_back("COUNT(*)", OrderDirection::DESC);
+    query.limit = 5;
+
+    std::string expectedBody = "SELECT CustomerId, COUNT(*)\nFROM Orders\nWHERE Total > 10\n"
+                               "GROUP BY CustomerId\nORDER BY COUNT(*) DESC\n";
+    EXPECT_EQ(SQLDialect::standard().render(query), expectedBody + "FETCH FIRST 5 ROWS ONLY\n");
+    EXPECT_EQ(SQLDialect::postgreSQL().render(query), expectedBody + "LIMIT 5\n");
+    EXPECT_EQ(SQLDialect::sqlServer().render(query), "SELECT TOP 5 CustomerId, COUNT(*)\nFROM Orders\n"
+                                                     "WHERE Total > 10\nGROUP BY CustomerId\n"
+                                                     "ORDER BY COUNT(*) DESC\n");
+    EXPECT_EQ(SQLDialect::oracle().render(query), "SELECT * FROM (\n" + expectedBody + ")\nWHERE ROWNUM <= 5\n");
+}
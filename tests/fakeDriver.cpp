@@ -0,0 +1,721 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include <limits>
+#include <cstring>
+#include <algorithm>
+
+#include "fakeDriver.h"
+
+using namespace tests;
+
+namespace tests {
+
+    // FakeHandle
+    // The state common to every handle the fake driver gives out
+    struct FakeHandle {
+        SQLSMALLINT type;
+        // The diagnostic for the last call which failed on the handle
+        std::string state, message;
+    };
+
+    // FakeConnection
+    struct FakeConnection : FakeHandle {
+        bool open = false;
+        bool dead = false;
+    };
+
+    // FakeParameter
+    // A value bound to a statement's parameter
+    struct FakeParameter {
+        SQLSMALLINT cType;
+        SQLPOINTER value;
+        SQLLEN *indicator;
+    };
+
+    // FakeBinding
+    // An array bound to a column of a statement's result, one element per row of a block
+    struct FakeBinding {
+        SQLSMALLINT cType;
+        SQLPOINTER values;
+        SQLLEN width;
+        SQLLEN *indicators;
+    };
+
+    // FakeStatement
+    struct FakeStatement : FakeHandle {
+        // The result of the statement last executed, if it is still open
+        std::optional<FakeResult> result;
+        // The current row, counting from 1, or 0 before the first fetch
+        size_t row = 0;
+        // How much of each value on the current row has been read, and whether it has been read to the end
+        std::vector<size_t> readOffsets;
+        std::vector<bool> readDone;
+        // The statement prepared on the handle
+        std::string prepared;
+        // The parameters bound, by number counting from 0
+        std::vector<FakeParameter> parameters;
+        // The parameter set attributes for bulk executes
+        SQLULEN paramsetSize = 1;
+        SQLUSMALLINT *paramStatus = nullptr;
+        SQLULEN *paramsProcessed = nullptr;
+        // The rows affected by the last execute
+        SQLLEN rowCount = -1;
+        // The arrays bound to columns, by number counting from 0
+        std::vector<std::optional<FakeBinding>> bindings;
+        // The row array attributes for block fetches
+        SQLULEN rowArraySize = 1;
+        SQLUSMALLINT *rowStatus = nullptr;
+        SQLULEN *rowsFetched = nullptr;
+    };
+
+}
+
+// Record a diagnostic on a handle and return an error
+static SQLRETURN failWith(FakeHandle *handle, const std::string &state, const std::string &message) {
+    handle->state = state;
+    handle->message = message;
+    return SQL_ERROR;
+}
+
+// Write a string into a caller's buffer, truncating it to fit with its terminator
+static void copyString(const std::string &value, SQLCHAR *buffer, size_t bufferLength) {
+    if (buffer == nullptr || bufferLength == 0) {
+        return;
+    }
+    size_t length = std::min(value.size(), bufferLength - 1);
+    memcpy(buffer, value.data(), length);
+    buffer[length] = 0;
+}
+
+// Convert a value's character form to an integer C type, failing as a driver does if it won't fit
+template<typename T>
+static SQLRETURN convertInteger(FakeStatement *statement, const std::string &value, SQLPOINTER target,
+                                SQLLEN *length) {
+    long long converted;
+    try {
+        size_t used;
+        converted = std::stoll(value, &used);
+        if (used != value.size()) {
+            return failWith(statement, "22018", "Invalid character value for cast specification");
+        }
+    } catch (std::exception &) {
+        return failWith(statement, "22018", "Invalid character value for cast specification");
+    }
+    if (converted < (long long) std::numeric_limits<T>::min() ||
+        (converted > 0 && (unsigned long long) converted > (unsigned long long) std::numeric_limits<T>::max())) {
+        return failWith(statement, "22003", "Numeric value out of range");
+    }
+    T result = (T) converted;
+    memcpy(target, &result, sizeof(T));
+    *length = sizeof(T);
+    return SQL_SUCCESS;
+}
+
+// Convert a value's character form to a floating point C type
+template<typename T>
+static SQLRETURN convertFloating(FakeStatement *statement, const std::string &value, SQLPOINTER target,
+                                 SQLLEN *length) {
+    T result;
+    try {
+        result = (T) std::stod(value);
+    } catch (std::exception &) {
+        return failWith(statement, "22018", "Invalid character value for cast specification");
+    }
+    memcpy(target, &result, sizeof(T));
+    *length = sizeof(T);
+    return SQL_SUCCESS;
+}
+
+// Get the character form of a bound parameter's value
+static std::string parameterText(const FakeParameter &parameter) {
+    if (parameter.indicator != nullptr && *parameter.indicator == SQL_NULL_DATA) {
+        return "NULL";
+    }
+    switch (parameter.cType) {
+        case SQL_C_CHAR:
+            return std::string((const char *) parameter.value, *parameter.indicator);
+        case SQL_C_SSHORT:
+            return std::to_string(*(const short *) parameter.value);
+        case SQL_C_SLONG:
+            return std::to_string(*(const int *) parameter.value);
+        case SQL_C_SBIGINT:
+            return std::to_string(*(const long long *) parameter.value);
+        case SQL_C_DOUBLE:
+            return std::to_string(*(const double *) parameter.value);
+        default:
+            return "?";
+    }
+}
+
+FakeDriver &FakeDriver::instance() {
+    static FakeDriver driver;
+    return driver;
+}
+
+FakeDriver::FakeDriver() {
+    reset();
+}
+
+void FakeDriver::reset() {
+    std::lock_guard<std::recursive_mutex> guard(lock);
+    scripts.clear();
+    failures.clear();
+    failingBulkRows.clear();
+    bulkRowsExecuted = 0;
+    executed.clear();
+    bound.clear();
+    ended.clear();
+    connected = 0;
+    dbmsName = "Microsoft SQL Server";
+    transactionEndsFail = false;
+}
+
+void FakeDriver::script(const std::string &fragment, FakeResult result) {
+    std::lock_guard<std::recursive_mutex> guard(lock);
+    scripts.emplace_back(fragment, std::move(result));
+}
+
+void FakeDriver::fail(const std::string &fragment) {
+    std::lock_guard<std::recursive_mutex> guard(lock);
+    failures.push_back(fragment);
+}
+
+void FakeDriver::failBulkRows(std::vector<size_t> rows) {
+    std::lock_guard<std::recursive_mutex> guard(lock);
+    failingBulkRows = std::move(rows);
+}
+
+void FakeDriver::failTransactionEnds() {
+    std::lock_guard<std::recursive_mutex> guard(lock);
+    transactionEndsFail = true;
+}
+
+void FakeDriver::setDBMSName(const std::string &name) {
+    std::lock_guard<std::recursive_mutex> guard(lock);
+    dbmsName = name;
+}
+
+void FakeDriver::killConnections() {
+    std::lock_guard<std::recursive_mutex> guard(lock);
+    for (FakeConnection *connection : openConnections) {
+        connection->dead = true;
+    }
+}
+
+std::vector<std::string> FakeDriver::statements() const {
+    std::lock_guard<std::recursive_mutex> guard(lock);
+    return executed;
+}
+
+std::vector<std::string> FakeDriver::parameters() const {
+    std::lock_guard<std::recursive_mutex> guard(lock);
+    return bound;
+}
+
+std::vector<std::string> FakeDriver::transactionEnds() const {
+    std::lock_guard<std::recursive_mutex> guard(lock);
+    return ended;
+}
+
+size_t FakeDriver::connections() const {
+    std::lock_guard<std::recursive_mutex> guard(lock);
+    return connected;
+}
+
+size_t FakeDriver::openStatements() const {
+    std::lock_guard<std::recursive_mutex> guard(lock);
+    return statementHandles;
+}
+
+std::optional<FakeResult> FakeDriver::resultFor(const std::string &statement) {
+    for (const std::string &failure : failures) {
+        if (statement.find(failure) != std::string::npos) {
+            return std::nullopt;
+        }
+    }
+    for (auto it = scripts.rbegin(); it != scripts.rend(); it++) {
+        if (statement.find(it->first) != std::string::npos) {
+            return it->second;
+        }
+    }
+    // Anything unscripted succeeds without returning any rows
+    return FakeResult();
+}
+
+void FakeDriver::recordStatement(const std::string &statement) {
+    executed.push_back(statement);
+}
+
+void FakeDriver::recordParameters(std::vector<std::string> values) {
+    bound = std::move(values);
+}
+
+void FakeDriver::recordTransactionEnd(bool commit) {
+    ended.emplace_back(commit ? "COMMIT" : "ROLLBACK");
+}
+
+void FakeDriver::recordConnection(FakeConnection *connection, bool open) {
+    if (open) {
+        openConnections.push_back(connection);
+        connected++;
+    } else {
+        openConnections.erase(std::remove(openConnections.begin(), openConnections.end(), connection),
+                              openConnections.end());
+    }
+}
+
+void FakeDriver::recordStatementHandle(bool open) {
+    if (open) {
+        statementHandles++;
+    } else {
+        statementHandles--;
+    }
+}
+
+bool FakeDriver::nextBulkRowFails() {
+    size_t row = bulkRowsExecuted++;
+    return std::find(failingBulkRows.begin(), failingBulkRows.end(), row) != failingBulkRows.end();
+}
+
+// The ODBC entry points. Declaring them inside extern "C" means any which doesn't match the driver manager's
+// header fails to compile, rather than quietly becoming an overload the library never calls
+
+extern "C" {
+
+SQLRETURN SQL_API SQLAllocHandle(SQLSMALLINT handleType, SQLHANDLE, SQLHANDLE *outputHandle) {
+    std::lock_guard<std::recursive_mutex> guard(FakeDriver::instance().lock);
+    FakeHandle *handle;
+    switch (handleType) {
+        case SQL_HANDLE_DBC:
+            handle = new FakeConnection();
+            break;
+        case SQL_HANDLE_STMT:
+            handle = new FakeStatement();
+            FakeDriver::instance().recordStatementHandle(true);
+            break;
+        default:
+            handle = new FakeHandle();
+            break;
+    }
+    handle->type = handleType;
+    *outputHandle = handle;
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLFreeHandle(SQLSMALLINT handleType, SQLHANDLE handle) {
+    std::lock_guard<std::recursive_mutex> guard(FakeDriver::instance().lock);
+    switch (handleType) {
+        case SQL_HANDLE_DBC:
+            FakeDriver::instance().recordConnection((FakeConnection *) handle, false);
+            delete (FakeConnection *) handle;
+            break;
+        case SQL_HANDLE_STMT:
+            FakeDriver::instance().recordStatementHandle(false);
+            delete (FakeStatement *) handle;
+            break;
+        default:
+            delete (FakeHandle *) handle;
+            break;
+    }
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLSetEnvAttr(SQLHENV, SQLINTEGER, SQLPOINTER, SQLINTEGER) {
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLDriverConnect(SQLHDBC connectionHandle, SQLHWND, SQLCHAR *, SQLSMALLINT, SQLCHAR *,
+                                   SQLSMALLINT, SQLSMALLINT *, SQLUSMALLINT) {
+    std::lock_guard<std::recursive_mutex> guard(FakeDriver::instance().lock);
+    auto *connection = (FakeConnection *) connectionHandle;
+    connection->open = true;
+    connection->dead = false;
+    FakeDriver::instance().recordConnection(connection, true);
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLDisconnect(SQLHDBC connectionHandle) {
+    std::lock_guard<std::recursive_mutex> guard(FakeDriver::instance().lock);
+    auto *connection = (FakeConnection *) connectionHandle;
+    connection->open = false;
+    FakeDriver::instance().recordConnection(connection, false);
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLGetInfo(SQLHDBC, SQLUSMALLINT infoType, SQLPOINTER value, SQLSMALLINT bufferLength,
+                             SQLSMALLINT *length) {
+    std::lock_guard<std::recursive_mutex> guard(FakeDriver::instance().lock);
+    if (infoType != SQL_DBMS_NAME) {
+        return SQL_ERROR;
+    }
+    const std::string &name = FakeDriver::instance().dbmsName;
+    copyString(name, (SQLCHAR *) value, bufferLength);
+    *length = (SQLSMALLINT) name.size();
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLSetConnectAttr(SQLHDBC connectionHandle, SQLINTEGER attribute, SQLPOINTER value, SQLINTEGER) {
+    std::lock_guard<std::recursive_mutex> guard(FakeDriver::instance().lock);
+    if (attribute == SQL_ATTR_AUTOCOMMIT && (SQLULEN) value == SQL_AUTOCOMMIT_ON &&
+        FakeDriver::instance().transactionEndsFail) {
+        return failWith((FakeConnection *) connectionHandle, "HY000", "Autocommit could not be restored");
+    }
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLGetConnectAttr(SQLHDBC connectionHandle, SQLINTEGER attribute, SQLPOINTER value,
+                                    SQLINTEGER, SQLINTEGER *) {
+    std::lock_guard<std::recursive_mutex> guard(FakeDriver::instance().lock);
+    auto *connection = (FakeConnection *) connectionHandle;
+    if (attribute != SQL_ATTR_CONNECTION_DEAD) {
+        return failWith(connection, "HY092", "Invalid attribute");
+    }
+    *(SQLUINTEGER *) value = connection->dead || !connection->open ? SQL_CD_TRUE : SQL_CD_FALSE;
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLEndTran(SQLSMALLINT, SQLHANDLE handle, SQLSMALLINT completionType) {
+    std::lock_guard<std::recursive_mutex> guard(FakeDriver::instance().lock);
+    FakeDriver::instance().recordTransactionEnd(completionType == SQL_COMMIT);
+    if (FakeDriver::instance().transactionEndsFail) {
+        return failWith((FakeConnection *) handle, "08S01", "Communication link failure");
+    }
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLSetStmtAttr(SQLHSTMT statementHandle, SQLINTEGER attribute, SQLPOINTER value, SQLINTEGER) {
+    std::lock_guard<std::recursive_mutex> guard(FakeDriver::instance().lock);
+    auto *statement = (FakeStatement *) statementHandle;
+    switch (attribute) {
+        case SQL_ATTR_PARAMSET_SIZE:
+            statement->paramsetSize = (SQLULEN) value;
+            break;
+        case SQL_ATTR_PARAM_STATUS_PTR:
+            statement->paramStatus = (SQLUSMALLINT *) value;
+            break;
+        case SQL_ATTR_PARAMS_PROCESSED_PTR:
+            statement->paramsProcessed = (SQLULEN *) value;
+            break;
+        case SQL_ATTR_ROW_ARRAY_SIZE:
+            statement->rowArraySize = (SQLULEN) value;
+            break;
+        case SQL_ATTR_ROW_STATUS_PTR:
+            statement->rowStatus = (SQLUSMALLINT *) value;
+            break;
+        case SQL_ATTR_ROWS_FETCHED_PTR:
+            statement->rowsFetched = (SQLULEN *) value;
+            break;
+        default:
+            break;
+    }
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLExecDirect(SQLHSTMT statementHandle, SQLCHAR *text, SQLINTEGER textLength) {
+    std::lock_guard<std::recursive_mutex> guard(FakeDriver::instance().lock);
+    auto *statement = (FakeStatement *) statementHandle;
+    std::string sql = textLength == SQL_NTS ? std::string((const char *) text)
+                                            : std::string((const char *) text, textLength);
+    FakeDriver::instance().recordStatement(sql);
+    std::vector<std::string> values;
+    for (const FakeParameter &parameter : statement->parameters) {
+        values.push_back(parameterText(parameter));
+    }
+    FakeDriver::instance().recordParameters(std::move(values));
+
+    statement->result = FakeDriver::instance().resultFor(sql);
+    statement->row = 0;
+    if (!statement->result.has_value()) {
+        return failWith(statement, "42000", "Statement failed: " + sql);
+    }
+    statement->rowCount = (SQLLEN) statement->result->rows.size();
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLPrepare(SQLHSTMT statementHandle, SQLCHAR *text, SQLINTEGER textLength) {
+    std::lock_guard<std::recursive_mutex> guard(FakeDriver::instance().lock);
+    auto *statement = (FakeStatement *) statementHandle;
+    statement->prepared = textLength == SQL_NTS ? std::string((const char *) text)
+                                                : std::string((const char *) text, textLength);
+    FakeDriver::instance().recordStatement(statement->prepared);
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLBindParameter(SQLHSTMT statementHandle, SQLUSMALLINT number, SQLSMALLINT, SQLSMALLINT cType,
+                                   SQLSMALLINT, SQLULEN, SQLSMALLINT, SQLPOINTER value, SQLLEN,
+                                   SQLLEN *indicator) {
+    std::lock_guard<std::recursive_mutex> guard(FakeDriver::instance().lock);
+    auto *statement = (FakeStatement *) statementHandle;
+    if (number == 0) {
+        return failWith(statement, "07009", "Invalid descriptor index");
+    }
+    if (statement->parameters.size() < number) {
+        statement->parameters.resize(number);
+    }
+    statement->parameters[number - 1] = {cType, value, indicator};
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLExecute(SQLHSTMT statementHandle) {
+    std::lock_guard<std::recursive_mutex> guard(FakeDriver::instance().lock);
+    auto *statement = (FakeStatement *) statementHandle;
+    if (!FakeDriver::instance().resultFor(statement->prepared).has_value()) {
+        return failWith(statement, "42000", "Statement failed: " + statement->prepared);
+    }
+
+    // Run every parameter set, failing the rows the test asked for
+    bool failed = false;
+    statement->rowCount = 0;
+    for (SQLULEN row = 0; row < statement->paramsetSize; row++) {
+        bool rowFails = FakeDriver::instance().nextBulkRowFails();
+        if (statement->paramStatus != nullptr) {
+            statement->paramStatus[row] = rowFails ? SQL_PARAM_ERROR : SQL_PARAM_SUCCESS;
+        }
+        failed |= rowFails;
+        statement->rowCount += rowFails ? 0 : 1;
+    }
+    if (statement->paramsProcessed != nullptr) {
+        *statement->paramsProcessed = statement->paramsetSize;
+    }
+    return failed ? failWith(statement, "23000", "Row rejected") : SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLRowCount(SQLHSTMT statementHandle, SQLLEN *rowCount) {
+    std::lock_guard<std::recursive_mutex> guard(FakeDriver::instance().lock);
+    *rowCount = ((FakeStatement *) statementHandle)->rowCount;
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLNumResultCols(SQLHSTMT statementHandle, SQLSMALLINT *count) {
+    std::lock_guard<std::recursive_mutex> guard(FakeDriver::instance().lock);
+    auto *statement = (FakeStatement *) statementHandle;
+    *count = statement->result.has_value() ? (SQLSMALLINT) statement->result->columns.size() : 0;
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLDescribeCol(SQLHSTMT statementHandle, SQLUSMALLINT column, SQLCHAR *name,
+                                 SQLSMALLINT bufferLength, SQLSMALLINT *nameLength, SQLSMALLINT *sqlType,
+                                 SQLULEN *size, SQLSMALLINT *decimalDigits, SQLSMALLINT *nullable) {
+    std::lock_guard<std::recursive_mutex> guard(FakeDriver::instance().lock);
+    auto *statement = (FakeStatement *) statementHandle;
+    if (!statement->result.has_value() || column == 0 || column > statement->result->columns.size()) {
+        return failWith(statement, "07009", "Invalid descriptor index");
+    }
+    const FakeColumn &description = statement->result->columns[column - 1];
+    copyString(description.name, name, bufferLength);
+    *nameLength = (SQLSMALLINT) description.name.size();
+    *sqlType = description.sqlType;
+    *size = description.size;
+    *decimalDigits = 0;
+    *nullable = description.nullable ? SQL_NULLABLE : SQL_NO_NULLS;
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLBindCol(SQLHSTMT statementHandle, SQLUSMALLINT column, SQLSMALLINT targetType,
+                             SQLPOINTER target, SQLLEN bufferLength, SQLLEN *indicators) {
+    std::lock_guard<std::recursive_mutex> guard(FakeDriver::instance().lock);
+    auto *statement = (FakeStatement *) statementHandle;
+    if (column == 0) {
+        return failWith(statement, "07009", "Invalid descriptor index");
+    }
+    if (statement->bindings.size() < column) {
+        statement->bindings.resize(column);
+    }
+    // A null target unbinds the column
+    if (target == nullptr) {
+        statement->bindings[column - 1].reset();
+    } else {
+        statement->bindings[column - 1] = FakeBinding{targetType, target, bufferLength, indicators};
+    }
+    return SQL_SUCCESS;
+}
+
+// Fetch the next block of rows into the bound arrays, converting each value as SQLGetData would
+static SQLRETURN fetchBlock(FakeStatement *statement) {
+    size_t available = statement->result->rows.size() - std::min(statement->row, statement->result->rows.size());
+    size_t count = std::min<size_t>(statement->rowArraySize, available);
+    if (statement->rowsFetched != nullptr) {
+        *statement->rowsFetched = count;
+    }
+    if (count == 0) {
+        statement->row = statement->result->rows.size() + 1;
+        return SQL_NO_DATA;
+    }
+
+    bool failed = false, truncated = false;
+    for (size_t i = 0; i < count; i++) {
+        statement->row++;
+        statement->readOffsets.assign(statement->result->columns.size(), 0);
+        statement->readDone.assign(statement->result->columns.size(), false);
+
+        SQLUSMALLINT status = SQL_ROW_SUCCESS;
+        for (size_t column = 0; column < statement->bindings.size(); column++) {
+            if (!statement->bindings[column].has_value()) {
+                continue;
+            }
+            const FakeBinding &binding = statement->bindings[column].value();
+            SQLRETURN ret = SQLGetData(statement, column + 1, binding.cType,
+                                       (SQLCHAR *) binding.values + i * binding.width, binding.width,
+                                       binding.indicators + i);
+            if (ret == SQL_ERROR) {
+                status = SQL_ROW_ERROR;
+            } else if (ret == SQL_SUCCESS_WITH_INFO && status == SQL_ROW_SUCCESS) {
+                status = SQL_ROW_SUCCESS_WITH_INFO;
+            }
+        }
+        if (statement->rowStatus != nullptr) {
+            statement->rowStatus[i] = status;
+        }
+        failed |= status == SQL_ROW_ERROR;
+        truncated |= status == SQL_ROW_SUCCESS_WITH_INFO;
+    }
+    for (size_t i = count; i < statement->rowArraySize && statement->rowStatus != nullptr; i++) {
+        statement->rowStatus[i] = SQL_ROW_NOROW;
+    }
+    return failed || truncated ? SQL_SUCCESS_WITH_INFO : SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLFetch(SQLHSTMT statementHandle) {
+    std::lock_guard<std::recursive_mutex> guard(FakeDriver::instance().lock);
+    auto *statement = (FakeStatement *) statementHandle;
+    if (!statement->result.has_value() || statement->result->columns.empty()) {
+        return failWith(statement, "24000", "Invalid cursor state");
+    }
+    bool bound = std::any_of(statement->bindings.begin(), statement->bindings.end(),
+                             [](const std::optional<FakeBinding> &binding) { return binding.has_value(); });
+    if (bound || statement->rowArraySize != 1) {
+        return fetchBlock(statement);
+    }
+    if (statement->row >= statement->result->rows.size()) {
+        statement->row = statement->result->rows.size() + 1;
+        return SQL_NO_DATA;
+    }
+    statement->row++;
+    statement->readOffsets.assign(statement->result->columns.size(), 0);
+    statement->readDone.assign(statement->result->columns.size(), false);
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLGetData(SQLHSTMT statementHandle, SQLUSMALLINT column, SQLSMALLINT targetType,
+                             SQLPOINTER target, SQLLEN bufferLength, SQLLEN *length) {
+    std::lock_guard<std::recursive_mutex> guard(FakeDriver::instance().lock);
+    auto *statement = (FakeStatement *) statementHandle;
+    if (!statement->result.has_value() || statement->row == 0 || statement->row > statement->result->rows.size()) {
+        return failWith(statement, "24000", "Invalid cursor state");
+    }
+    const std::vector<std::optional<std::string>> &row = statement->result->rows[statement->row - 1];
+    if (column == 0 || column > row.size()) {
+        return failWith(statement, "07009", "Invalid descriptor index");
+    }
+
+    // Each value can only be read once, apart from a string read in pieces
+    size_t index = column - 1;
+    if (statement->readDone[index]) {
+        return SQL_NO_DATA;
+    }
+    const std::optional<std::string> &value = row[index];
+    if (!value.has_value()) {
+        statement->readDone[index] = true;
+        *length = SQL_NULL_DATA;
+        return SQL_SUCCESS;
+    }
+
+    switch (targetType) {
+        case SQL_C_CHAR: {
+            // Return as much as fits with a terminator, reporting the length of everything left
+            size_t offset = statement->readOffsets[index];
+            size_t remaining = value->size() - offset;
+            *length = (SQLLEN) remaining;
+            if (bufferLength <= 0) {
+                return SQL_SUCCESS_WITH_INFO;
+            }
+            size_t piece = std::min(remaining, (size_t) bufferLength - 1);
+            memcpy(target, value->data() + offset, piece);
+            ((SQLCHAR *) target)[piece] = 0;
+            if (piece < remaining) {
+                statement->readOffsets[index] += piece;
+                return SQL_SUCCESS_WITH_INFO;
+            }
+            statement->readDone[index] = true;
+            return SQL_SUCCESS;
+        }
+        case SQL_C_BIT:
+            statement->readDone[index] = true;
+            return convertInteger<unsigned char>(statement, *value, target, length);
+        case SQL_C_STINYINT:
+            statement->readDone[index] = true;
+            return convertInteger<signed char>(statement, *value, target, length);
+        case SQL_C_UTINYINT:
+            statement->readDone[index] = true;
+            return convertInteger<unsigned char>(statement, *value, target, length);
+        case SQL_C_SSHORT:
+        case SQL_SMALLINT:
+            statement->readDone[index] = true;
+            return convertInteger<short>(statement, *value, target, length);
+        case SQL_C_SLONG:
+        case SQL_INTEGER:
+            statement->readDone[index] = true;
+            return convertInteger<int>(statement, *value, target, length);
+        case SQL_C_SBIGINT:
+            statement->readDone[index] = true;
+            return convertInteger<long long>(statement, *value, target, length);
+        case SQL_C_FLOAT:
+            statement->readDone[index] = true;
+            return convertFloating<float>(statement, *value, target, length);
+        case SQL_C_DOUBLE:
+            statement->readDone[index] = true;
+            return convertFloating<double>(statement, *value, target, length);
+        case SQL_C_TYPE_DATE: {
+            statement->readDone[index] = true;
+            SQL_DATE_STRUCT date{};
+            int year, month, day;
+            if (sscanf(value->c_str(), "%d-%d-%d", &year, &month, &day) != 3) {
+                return failWith(statement, "22018", "Invalid character value for cast specification");
+            }
+            date.year = (SQLSMALLINT) year;
+            date.month = (SQLUSMALLINT) month;
+            date.day = (SQLUSMALLINT) day;
+            memcpy(target, &date, sizeof(SQL_DATE_STRUCT));
+            *length = sizeof(SQL_DATE_STRUCT);
+            return SQL_SUCCESS;
+        }
+        default:
+            return failWith(statement, "HY003", "Program type out of range");
+    }
+}
+
+SQLRETURN SQL_API SQLFreeStmt(SQLHSTMT statementHandle, SQLUSMALLINT option) {
+    std::lock_guard<std::recursive_mutex> guard(FakeDriver::instance().lock);
+    auto *statement = (FakeStatement *) statementHandle;
+    if (option == SQL_CLOSE) {
+        statement->result.reset();
+        statement->row = 0;
+    } else if (option == SQL_RESET_PARAMS) {
+        statement->parameters.clear();
+    } else if (option == SQL_UNBIND) {
+        statement->bindings.clear();
+    }
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLGetDiagRec(SQLSMALLINT, SQLHANDLE handle, SQLSMALLINT record, SQLCHAR *state,
+                                SQLINTEGER *nativeError, SQLCHAR *message, SQLSMALLINT bufferLength,
+                                SQLSMALLINT *messageLength) {
+    std::lock_guard<std::recursive_mutex> guard(FakeDriver::instance().lock);
+    auto *fakeHandle = (FakeHandle *) handle;
+    // Callers read the buffers whatever is returned, so always leave them holding something
+    copyString(record == 1 ? fakeHandle->state : "", state, 6);
+    copyString(record == 1 ? fakeHandle->message : "", message, bufferLength);
+    if (nativeError != nullptr) {
+        *nativeError = 0;
+    }
+    if (messageLength != nullptr) {
+        *messageLength = (SQLSMALLINT) std::min<size_t>(record == 1 ? fakeHandle->message.size() : 0,
+                                                        bufferLength > 0 ? bufferLength - 1 : 0);
+    }
+    return record == 1 && !fakeHandle->state.empty() ? SQL_SUCCESS : SQL_NO_DATA;
+}
+
+}
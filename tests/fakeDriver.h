@@ -0,0 +1,134 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#ifndef CONTRACTS_INTERNAL_FAKEDRIVER_H
+#define CONTRACTS_INTERNAL_FAKEDRIVER_H
+
+#include <mutex>
+#include <string>
+#include <vector>
+#include <optional>
+
+#include "../include/database/SQLSafeHandle.h"
+
+namespace tests {
+
+    struct FakeConnection;
+
+    // FakeColumn
+    // A column of a scripted result, as the fake driver describes it
+    struct FakeColumn {
+        std::string name;
+        SQLSMALLINT sqlType;
+        SQLULEN size;
+        bool nullable;
+    };
+
+    // FakeResult
+    // The result the fake driver gives a scripted statement. Values are given in their character form, or as
+    // std::nullopt for null, and converted to whatever C type they are read as, as a real driver would
+    struct FakeResult {
+        std::vector<FakeColumn> columns;
+        std::vector<std::vector<std::optional<std::string>>> rows;
+    };
+
+    // FakeDriver
+    // Stands in for the ODBC driver in tests. The test executable defines the ODBC entry points the library
+    // calls, which take the place of the driver manager's, so sessions can be tested without a database.
+    // Statements are answered with the results a test scripts, by matching a fragment of their text, and the
+    // statements and transactions run are recorded for the test to check. Every call is made under one lock, so
+    // the driver may be used from several threads.
+    class FakeDriver {
+    public:
+        // Get the driver
+        static FakeDriver &instance();
+
+        // Forget every scripted result and failure and everything recorded, ready for the next test
+        void reset();
+
+        // Answer statements containing the fragment with the given result. The latest matching script wins
+        void script(const std::string &fragment, FakeResult result);
+
+        // Fail statements containing the fragment
+        void fail(const std::string &fragment);
+
+        // Fail the rows of bulk inserts with the given indices, counting every row executed since the reset
+        void failBulkRows(std::vector<size_t> rows);
+
+        // Fail every transaction end, and every return to autocommit, as a driver does once the connection drops
+        // part way through a transaction. Each reports a diagnostic of its own, so a test can tell which was raised
+        void failTransactionEnds();
+
+        // Set the name the driver reports for the DBMS
+        void setDBMSName(const std::string &name);
+
+        // Make every connection open now report itself dead, as a driver does once the server has gone.
+        // Connections made afterwards are alive
+        void killConnections();
+
+        // Get the text of every statement executed or prepared since the reset, in order
+        [[nodiscard]] std::vector<std::string> statements() const;
+
+        // Get the values bound to the parameters of the last statement executed directly, in their character form
+        [[nodiscard]] std::vector<std::string> parameters() const;
+
+        // Get every transaction ended since the reset, in order, as "COMMIT" or "ROLLBACK"
+        [[nodiscard]] std::vector<std::string> transactionEnds() const;
+
+        // Get the number of connections made since the reset
+        [[nodiscard]] size_t connections() const;
+
+        // Get the number of statement handles allocated and not yet freed. This is a live count, so isn't reset
+        [[nodiscard]] size_t openStatements() const;
+
+        // The lock every ODBC call is made under
+        mutable std::recursive_mutex lock;
+
+        // The state below is guarded by the lock, and used by the ODBC entry points
+
+        // Find the result for a statement, or std::nullopt if it should fail
+        std::optional<FakeResult> resultFor(const std::string &statement);
+
+        // Record a statement as executed
+        void recordStatement(const std::string &statement);
+
+        // Record the values bound to a statement executed directly
+        void recordParameters(std::vector<std::string> values);
+
+        // Record a transaction end
+        void recordTransactionEnd(bool commit);
+
+        // Record a connection being opened or closed
+        void recordConnection(FakeConnection *connection, bool open);
+
+        // Record a statement handle being allocated or freed
+        void recordStatementHandle(bool open);
+
+        // Returns true if the next bulk row executed should fail, and counts it
+        bool nextBulkRowFails();
+
+        // The name reported for the DBMS
+        std::string dbmsName;
+        // Whether transaction ends and returns to autocommit fail
+        bool transactionEndsFail = false;
+
+    private:
+        // Private constructor
+        FakeDriver();
+
+        std::vector<std::pair<std::string, FakeResult>> scripts;
+        std::vector<std::string> failures;
+        std::vector<size_t> failingBulkRows;
+        size_t bulkRowsExecuted = 0;
+        std::vector<std::string> executed;
+        std::vector<std::string> bound;
+        std::vector<std::string> ended;
+        std::vector<FakeConnection *> openConnections;
+        size_t connected = 0;
+        size_t statementHandles = 0;
+    };
+
+}
+
+#endif //CONTRACTS_INTERNAL_FAKEDRIVER_H
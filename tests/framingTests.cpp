@@ -0,0 +1,154 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include <thread>
+#include <algorithm>
+
+#include <gtest/gtest.h>
+
+#include "../include/networking/TCPSocket.h"
+#include "loopback.h"
+
+using namespace networking;
+using namespace tests;
+
+// Check a received message holds exactly the given payload
+static void expectPayload(const NetworkMessage &message, const byte_buffer &payload) {
+    ASSERT_FALSE(message.invalid());
+    ASSERT_EQ((size_t) (message.messageEnd() - message.messageBegin()), payload.size());
+    EXPECT_TRUE(std::equal(message.messageBegin(), message.messageEnd(), payload.cbegin()));
+}
+
+TEST(Framing, StreamDecodeAcrossSplitSpans) {
+    // Frame a message a few chunks long, then feed it back in awkwardly sized spans, including one which splits
+    // the header
+    byte_buffer payload = makePayload(3 * NetworkMessage::BufferChunkSize + 5);
+    NetworkMessage framed = RawMessage(payload.copy()).message();
+
+    NetworkMessageDecoder decoder;
+    const byte *next = framed.cbegin();
+    size_t span = 1;
+    while (!decoder.streamComplete()) {
+        size_t size = std::min<size_t>(span, framed.cend() - next);
+        ASSERT_GT(size, 0u);
+        next += decoder.decodeStream(next, size);
+        span = span * 3 + 1;
+    }
+
+    EXPECT_EQ(next, framed.cend());
+    expectPayload(decoder.create(), payload);
+}
+
+TEST(Framing, StreamDecodeStopsAtMessageEnd) {
+    // Two messages back to back in one span are decoded one at a time
+    byte_buffer first = makePayload(10), second = makePayload(NetworkMessage::BufferChunkSize);
+    NetworkMessage firstFramed = RawMessage(first.copy()).message();
+    NetworkMessage secondFramed = RawMessage(second.copy()).message();
+
+    std::vector<byte> stream(firstFramed.cbegin(), firstFramed.cend());
+    stream.insert(stream.end(), secondFramed.cbegin(), secondFramed.cend());
+
+    NetworkMessageDecoder firstDecoder;
+    size_t used = firstDecoder.decodeStream(stream.data(), stream.size());
+    ASSERT_TRUE(firstDecoder.streamComplete());
+    EXPECT_EQ(used, firstFramed.bufferSize());
+    expectPayload(firstDecoder.create(), first);
+
+    NetworkMessageDecoder secondDecoder;
+    used += secondDecoder.decodeStream(stream.data() + used, stream.size() - used);
+    ASSERT_TRUE(secondDecoder.streamComplete());
+    EXPECT_EQ(used, stream.size());
+    expectPayload(secondDecoder.create(), second);
+}
+
+TEST(Framing, StreamDecodeRejectsOversizedHeader) {
+    // A message of exactly the limit is accepted, but one byte more is refused as soon as the header is complete
+    NetworkMessage atLimit = RawMessage(makePayload(200)).message();
+    NetworkMessageDecoder accepting(200);
+    EXPECT_EQ(accepting.decodeStream(atLimit.cbegin(), atLimit.bufferSize()), atLimit.bufferSize());
+    EXPECT_TRUE(accepting.streamComplete());
+
+    NetworkMessage overLimit = RawMessage(makePayload(201)).message();
+    NetworkMessageDecoder refusing(200);
+    EXPECT_EQ(refusing.decodeStream(overLimit.cbegin(), 2), 2u);
+    EXPECT_FALSE(refusing.invalid());
+    EXPECT_EQ(refusing.decodeStream(overLimit.cbegin() + 2, overLimit.bufferSize() - 2),
+              NetworkMessage::HeaderSize - 2);
+    EXPECT_TRUE(refusing.invalid());
+    EXPECT_FALSE(refusing.streamComplete());
+
+    // Nothing more is taken once the header has been refused
+    EXPECT_EQ(refusing.decodeStream(overLimit.cbegin(), overLimit.bufferSize()), 0u);
+    EXPECT_TRUE(refusing.create().invalid());
+}
+
+TEST(Framing, SocketRoundTrip) {
+    LoopbackPair pair = connectLoopback();
+
+    for (size_t size : {(size_t) 0, (size_t) 1, NetworkMessage::BufferChunkSize, (size_t) 100000}) {
+        byte_buffer payload = makePayload(size);
+        ASSERT_TRUE(pair.client.send(RawMessage(payload.copy())));
+        expectPayload(pair.server.receive(std::chrono::steady_clock::now() + std::chrono::seconds(5)), payload);
+    }
+}
+
+TEST(Framing, CorkedMessagesArriveInOrder) {
+    LoopbackPair pair = connectLoopback();
+
+    // Enough corked messages to pass the flush threshold part way through
+    std::vector<byte_buffer> payloads;
+    {
+        CorkGuard cork(pair.client);
+        for (size_t i = 0; i < 40; i++) {
+            payloads.push_back(makePayload(i * 100));
+            ASSERT_TRUE(pair.client.send(RawMessage(payloads.back().copy())));
+        }
+    }
+
+    for (const byte_buffer &payload : payloads) {
+        expectPayload(pair.server.receive(std::chrono::steady_clock::now() + std::chrono::seconds(5)), payload);
+    }
+}
+
+TEST(Framing, NonBlockingSendWaitsForRoom) {
+    LoopbackPair pair = connectLoopback();
+
+    // A small send buffer and a large message guarantee the socket fills up and would block part way through
+    pair.client.setSendBufferSize(4096);
+    pair.client.setNonBlocking();
+    byte_buffer payload = makePayload(2 * 1024 * 1024);
+
+    bool sent = false;
+    std::thread sender([&]() {
+        sent = pair.client.send(RawMessage(payload.copy()));
+    });
+
+    NetworkMessage received = pair.server.receive(std::chrono::steady_clock::now() + std::chrono::seconds(30));
+    sender.join();
+
+    EXPECT_TRUE(sent);
+    expectPayload(received, payload);
+}
+
+TEST(Framing, SendToClosedConnectionFails) {
+    LoopbackPair pair = connectLoopback();
+    pair.server.close();
+
+    // The first write may still be accepted before the reset comes back, but the connection has failed well
+    // before a few megabytes have gone
+    bool sent = true;
+    for (int i = 0; i < 64 && sent; i++) {
+        sent = pair.client.send(RawMessage(makePayload(64 * 1024)));
+    }
+    EXPECT_FALSE(sent);
+}
+
+TEST(Framing, ReceiveTimesOut) {
+    LoopbackPair pair = connectLoopback();
+
+    // Nothing is sent, so the receive gives up at the deadline and closes the socket
+    NetworkMessage received = pair.server.receive(std::chrono::steady_clock::now() + std::chrono::milliseconds(50));
+    EXPECT_TRUE(received.invalid());
+    EXPECT_FALSE(pair.server);
+}
@@ -0,0 +1,215 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include <vector>
+#include <thread>
+#include <algorithm>
+
+#include <gtest/gtest.h>
+
+#include "../include/networking/IOUringEngine.h"
+#include "../include/networking/protocol/Protocol.h"
+#include "loopback.h"
+
+using namespace networking;
+using namespace tests;
+
+// Input and output slots for the handshake protocol run before a socket is adopted
+using HandshakeSocket = internal::Connector<0, std::nullptr_t, TCPSocket>;
+using HandshakeValues = internal::Connector<1, std::nullptr_t, std::vector<int>>;
+using HandshakeResult = internal::Connector<0, std::nullptr_t, std::vector<int>>;
+
+// Most polls a test makes waiting for an event before giving up, and the pause between them
+#define IO_URING_TEST_MAX_POLLS 1000
+#define IO_URING_TEST_POLL_INTERVAL std::chrono::milliseconds(1)
+
+// IOUringEngineTest
+// An engine accepting on a loopback listener, recording every event it reports
+class IOUringEngineTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        if (!IOUringEngine::supported()) {
+            GTEST_SKIP() << "io_uring is not supported by this kernel";
+        }
+
+        engine = std::make_unique<IOUringEngine>(64, 16, 16, 4096);
+        engine->onAccept([this](IOUringEngine::ConnectionID connection) {
+            accepted.push_back(connection);
+        });
+        engine->onMessage([this](IOUringEngine::ConnectionID connection, NetworkMessage &&message) {
+            received.emplace_back(connection, std::vector<byte>(message.messageBegin(), message.messageEnd()));
+        });
+        engine->onClose([this](IOUringEngine::ConnectionID connection) {
+            closed.push_back(connection);
+        });
+
+        listener.create();
+        listener.bind(0, "127.0.0.1");
+        listener.listen();
+        engine->listen(listener);
+    }
+
+    // Connect a new client to the engine
+    TCPSocket connect() {
+        TCPSocket client;
+        client.create();
+        client.connect("127.0.0.1", listener.localPort());
+        return client;
+    }
+
+    // Poll the engine until the condition holds. Returns false if it never does
+    template<typename _Condition>
+    bool pollUntil(_Condition condition) {
+        for (size_t i = 0; i < IO_URING_TEST_MAX_POLLS && !condition(); i++) {
+            if (engine->poll(0) == 0) {
+                std::this_thread::sleep_for(IO_URING_TEST_POLL_INTERVAL);
+            }
+        }
+        return condition();
+    }
+
+    std::unique_ptr<IOUringEngine> engine;
+    TCPSocket listener;
+
+    std::vector<IOUringEngine::ConnectionID> accepted;
+    std::vector<std::pair<IOUringEngine::ConnectionID, std::vector<byte>>> received;
+    std::vector<IOUringEngine::ConnectionID> closed;
+};
+
+TEST_F(IOUringEngineTest, EchoesFramedMessages) {
+    TCPSocket client = connect();
+    ASSERT_TRUE(pollUntil([this]() { return accepted.size() == 1; }));
+
+    // A message spanning several receive buffers is reassembled before it is handed over
+    byte_buffer payload = makePayload(3 * 4096 + 17);
+    ASSERT_TRUE(client.send(RawMessage(payload.copy())));
+    ASSERT_TRUE(pollUntil([this]() { return received.size() == 1; }));
+    EXPECT_EQ(received[0].first, accepted[0]);
+    ASSERT_EQ(received[0].second.size(), payload.size());
+    EXPECT_TRUE(std::equal(received[0].second.begin(), received[0].second.end(), payload.cbegin()));
+
+    engine->send(accepted[0], RawMessage(payload.copy()));
+    engine->poll(0);
+    NetworkMessage reply = client.receive(std::chrono::steady_clock::now() + std::chrono::seconds(5));
+    ASSERT_FALSE(reply.invalid());
+    EXPECT_TRUE(std::equal(reply.messageBegin(), reply.messageEnd(), payload.cbegin()));
+}
+
+TEST_F(IOUringEngineTest, CloseCompletesAfterPeerHasGone) {
+    TCPSocket client = connect();
+    ASSERT_TRUE(pollUntil([this]() { return accepted.size() == 1; }));
+
+    // The peer closing first makes the engine's shutdown fail, which must not stop the close
+    client.close();
+    ASSERT_TRUE(pollUntil([this]() { return closed.size() == 1; }));
+    EXPECT_EQ(closed[0], accepted[0]);
+}
+
+TEST_F(IOUringEngineTest, ReusedSlotIgnoresEarlierConnection) {
+    // Open and close connections until a slot is reused, checking each new connection only sees its own data
+    for (int i = 0; i < 4; i++) {
+        TCPSocket client = connect();
+        ASSERT_TRUE(pollUntil([this, i]() { return accepted.size() == (size_t) i + 1; }));
+        IOUringEngine::ConnectionID connection = accepted.back();
+
+        byte_buffer payload = makePayload(10 + i);
+        ASSERT_TRUE(client.send(RawMessage(payload.copy())));
+        ASSERT_TRUE(pollUntil([this, i]() { return received.size() == (size_t) i + 1; }));
+        EXPECT_EQ(received.back().first, connection);
+        EXPECT_EQ(received.back().second.size(), payload.size());
+
+        engine->close(connection);
+        ASSERT_TRUE(pollUntil([this, i]() { return closed.size() == (size_t) i + 1; }));
+        EXPECT_EQ(closed.back(), connection);
+    }
+
+    // Every connection was closed exactly once
+    EXPECT_EQ(closed.size(), accepted.size());
+}
+
+TEST_F(IOUringEngineTest, AdoptedSocketIsServedAfterItsProtocol) {
+    // Accept a connection outside the engine and run a connection protocol over it, as a server with a key
+    // exchange would, then hand it over
+    TCPSocket handshakeListener;
+    handshakeListener.create();
+    handshakeListener.bind(0, "127.0.0.1");
+    handshakeListener.listen();
+    TCPSocket client;
+    client.create();
+    client.connect("127.0.0.1", handshakeListener.localPort());
+    TCPSocket server = handshakeListener.accept();
+
+    std::vector<int> greeting = {1, 2, 3};
+    std::thread clientSide([&]() {
+        Protocol protocol;
+        LayerReference<ArrayExchange<int>> exchange = protocol.addLayer<ArrayExchange<int>>(Sender);
+        protocol.link<HandshakeSocket, ArrayExchange<int>::Socket>(Protocol::Inputs, exchange);
+        protocol.link<HandshakeValues, ArrayExchange<int>::Values>(Protocol::Inputs, exchange);
+        protocol.feed<HandshakeSocket>(client);
+        protocol.feed<HandshakeValues>(greeting);
+        protocol.execute();
+    });
+    Protocol protocol;
+    LayerReference<ArrayExchange<int>> exchange = protocol.addLayer<ArrayExchange<int>>(Receiver);
+    protocol.link<HandshakeSocket, ArrayExchange<int>::Socket>(Protocol::Inputs, exchange);
+    protocol.link<ArrayExchange<int>::Values, HandshakeResult>(exchange, Protocol::Outputs);
+    protocol.feed<HandshakeSocket>(server);
+    protocol.execute(std::chrono::seconds(5));
+    clientSide.join();
+    ASSERT_TRUE(protocol.completed());
+    EXPECT_EQ(protocol.read<HandshakeResult>(), greeting);
+
+    std::optional<IOUringEngine::ConnectionID> adopted;
+    engine->adopt(server, [&adopted](IOUringEngine::ConnectionID connection) { adopted = connection; });
+    ASSERT_TRUE(pollUntil([&adopted]() { return adopted.has_value(); }));
+    EXPECT_FALSE(server);
+
+    // From here the connection's messages arrive as completions
+    byte_buffer payload = makePayload(5000);
+    ASSERT_TRUE(client.send(RawMessage(payload.copy())));
+    ASSERT_TRUE(pollUntil([this]() { return received.size() == 1; }));
+    EXPECT_EQ(received[0].first, adopted.value());
+    EXPECT_TRUE(std::equal(received[0].second.begin(), received[0].second.end(), payload.cbegin()));
+
+    engine->send(adopted.value(), RawMessage(payload.copy()));
+    engine->poll(0);
+    NetworkMessage reply = client.receive(std::chrono::steady_clock::now() + std::chrono::seconds(5));
+    ASSERT_FALSE(reply.invalid());
+    EXPECT_TRUE(std::equal(reply.messageBegin(), reply.messageEnd(), payload.cbegin()));
+}
+
+TEST_F(IOUringEngineTest, OversizedMessageClosesConnection) {
+    engine->setMaxMessageSize(1000);
+    TCPSocket client = connect();
+    ASSERT_TRUE(pollUntil([this]() { return accepted.size() == 1; }));
+
+    SocketMetricsSnapshot before = SocketMetrics::snapshot();
+    ASSERT_TRUE(client.send(RawMessage(makePayload(1001))));
+    ASSERT_TRUE(pollUntil([this]() { return closed.size() == 1; }));
+    EXPECT_TRUE(received.empty());
+    EXPECT_EQ(SocketMetrics::snapshot()[SocketCounter::OversizedCloses] - before[SocketCounter::OversizedCloses], 1u);
+}
+
+TEST_F(IOUringEngineTest, TrafficIsCounted) {
+    TCPSocket client = connect();
+    ASSERT_TRUE(pollUntil([this]() { return accepted.size() == 1; }));
+
+    SocketMetricsSnapshot before = SocketMetrics::snapshot();
+    NetworkMessage framed = RawMessage(makePayload(300)).message();
+    ASSERT_TRUE(client.send(RawMessage(makePayload(300))));
+    ASSERT_TRUE(pollUntil([this]() { return received.size() == 1; }));
+    engine->send(accepted[0], RawMessage(makePayload(300)));
+    engine->poll(0);
+    ASSERT_FALSE(client.receive(std::chrono::steady_clock::now() + std::chrono::seconds(5)).invalid());
+
+    // Both the client's socket and the engine count into the same counters, so each direction is counted twice.
+    // The engine only counts its send once the completion arrives
+    ASSERT_TRUE(pollUntil([&]() {
+        return SocketMetrics::snapshot()[SocketCounter::BytesSent] - before[SocketCounter::BytesSent]
+               >= 2 * framed.bufferSize();
+    }));
+    SocketMetricsSnapshot after = SocketMetrics::snapshot();
+    EXPECT_EQ(after[SocketCounter::BytesReceived] - before[SocketCounter::BytesReceived], 2 * framed.bufferSize());
+    EXPECT_EQ(after[SocketCounter::BytesSent] - before[SocketCounter::BytesSent], 2 * framed.bufferSize());
+}
@@ -0,0 +1,29 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include "loopback.h"
+
+using namespace networking;
+
+tests::LoopbackPair tests::connectLoopback() {
+    TCPSocket listener;
+    listener.create();
+    listener.bind(0, "127.0.0.1");
+    listener.listen();
+
+    // The connection completes in the backlog, so the accept doesn't need its own thread
+    LoopbackPair pair;
+    pair.client.create();
+    pair.client.connect("127.0.0.1", listener.localPort());
+    pair.server = listener.accept();
+    return pair;
+}
+
+byte_buffer tests::makePayload(size_t size) {
+    byte_buffer payload(size);
+    for (size_t i = 0; i < size; i++) {
+        payload.begin()[i] = (byte) (i * 31 + 7);
+    }
+    return payload;
+}
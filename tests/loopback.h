@@ -0,0 +1,27 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#ifndef CONTRACTS_INTERNAL_LOOPBACK_H
+#define CONTRACTS_INTERNAL_LOOPBACK_H
+
+#include "../include/networking/TCPSocket.h"
+
+namespace tests {
+
+    // LoopbackPair
+    // Both ends of a TCP connection over the loopback interface
+    struct LoopbackPair {
+        networking::TCPSocket client;
+        networking::TCPSocket server;
+    };
+
+    // Open a connection to a listener on a port picked by the system
+    LoopbackPair connectLoopback();
+
+    // Make a buffer of the given size filled with a repeating pattern
+    byte_buffer makePayload(size_t size);
+
+}
+
+#endif //CONTRACTS_INTERNAL_LOOPBACK_H
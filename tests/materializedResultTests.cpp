@@ -0,0 +1,182 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include <gtest/gtest.h>
+
+#include "../include/database/SQLSession.h"
+#include "fakeDriver.h"
+
+using namespace sql;
+using namespace tests;
+
+// MaterializedResultTest
+// A session connected to the fake driver, with a small table of fruit holding some nulls
+class MaterializedResultTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        FakeDriver::instance().reset();
+        session.connect("fake", "user", "password");
+
+        FakeResult fruit;
+        fruit.columns = {
+                {"Id", SQL_INTEGER, 10, false},
+                {"Name", SQL_VARCHAR, 20, true},
+                {"Total", SQL_DOUBLE, 15, true},
+                {"Picked", SQL_TYPE_DATE, 10, false}
+        };
+        fruit.rows = {
+                {"1", "pear", "2.5", "2026-01-02"},
+                {"2", std::nullopt, "1", "2025-12-31"},
+                {"3", "apple", std::nullopt, "2026-01-02"},
+                {"4", "fig", "1", "2024-05-05"}
+        };
+        FakeDriver::instance().script("FROM Fruit", fruit);
+    }
+
+    // Read the whole fruit table
+    MaterializedResult fruit() {
+        return MaterializedResult(session.executeQuery("SELECT * FROM Fruit"));
+    }
+
+    // Get the ids of a result's rows in order
+    static std::vector<int> ids(const MaterializedResult &result) {
+        std::vector<int> values;
+        for (MaterializedRow row : result) {
+            values.push_back(row.get<int>(0).value());
+        }
+        return values;
+    }
+
+    SQLSession session;
+};
+
+TEST_F(MaterializedResultTest, RowsCanBeReadInAnyOrder) {
+    MaterializedResult result = fruit();
+    ASSERT_EQ(result.rowCount(), 4u);
+    ASSERT_EQ(result.columnCount(), 4u);
+    EXPECT_EQ(result.columnType(2), ColumnType::FLOAT64);
+    EXPECT_EQ(result.columnIndex("Total"), 2u);
+    EXPECT_THROW((void) result.columnIndex("Colour"), SQLException);
+
+    // Backwards, then straight to a row in the middle
+    EXPECT_EQ(result[3].get<std::string>(1).value(), "fig");
+    EXPECT_EQ(result[0].get<double>(2).value(), 2.5);
+    EXPECT_EQ(result.get<std::string>(2, 1).value(), "apple");
+    EXPECT_TRUE(result.isNull(1, 1));
+    EXPECT_FALSE(result[1].get<std::string>(1).hasValue());
+    EXPECT_TRUE(result[2].isNull(2));
+    EXPECT_EQ(result[2].index(), 2u);
+
+    // Reading a column as another type is refused rather than reinterpreting its bytes
+    EXPECT_THROW((void) result.get<int>(0, 1), SQLException);
+
+    // Fixed width columns are arrays, with nulls only in a nullable column's bitmap
+    const int *idValues = result.values<int>(0);
+    EXPECT_EQ(std::vector<int>(idValues, idValues + 4), (std::vector<int>{1, 2, 3, 4}));
+    EXPECT_EQ(result.nulls(0), nullptr);
+    ASSERT_NE(result.nulls(2), nullptr);
+    EXPECT_EQ(result.nulls(2)[0], 0x04);
+
+    // The result can be read again, and as many times as needed, with the statement long gone
+    EXPECT_EQ(ids(result), (std::vector<int>{1, 2, 3, 4}));
+    EXPECT_EQ(ids(result), (std::vector<int>{1, 2, 3, 4}));
+}
+
+TEST_F(MaterializedResultTest, IteratorsAreRandomAccess) {
+    MaterializedResult result = fruit();
+    MaterializedRowIterator begin = result.begin(), end = result.end();
+
+    EXPECT_EQ(end - begin, 4);
+    EXPECT_EQ(begin[3].get<int>(0).value(), 4);
+    EXPECT_EQ((*(end - 1)).get<int>(0).value(), 4);
+    EXPECT_EQ((*(begin + 2)).get<int>(0).value(), 3);
+    EXPECT_TRUE(begin < end);
+
+    MaterializedRowIterator it = begin;
+    it += 3;
+    it--;
+    EXPECT_EQ((*it).index(), 2u);
+    it -= 2;
+    EXPECT_EQ(it, begin);
+    EXPECT_EQ(++it - begin, 1);
+    EXPECT_NE(it, end);
+}
+
+TEST_F(MaterializedResultTest, SortIsStableWithNullsFirst) {
+    MaterializedResult result = fruit();
+
+    // The rows tied on 1 keep the order they were in
+    result.sort(2);
+    EXPECT_EQ(ids(result), (std::vector<int>{3, 2, 4, 1}));
+    result.sort(2, OrderDirection::DESC);
+    EXPECT_EQ(ids(result), (std::vector<int>{1, 2, 4, 3}));
+
+    // Strings, with the values moving with their rows
+    result.sort(1);
+    EXPECT_EQ(ids(result), (std::vector<int>{2, 3, 4, 1}));
+    EXPECT_TRUE(result.isNull(0, 1));
+    EXPECT_EQ(result.get<std::string>(1, 1).value(), "apple");
+    EXPECT_EQ(result.get<std::string>(3, 1).value(), "pear");
+    EXPECT_TRUE(result.isNull(1, 2));
+
+    // Sorting by the less significant column first sorts by both
+    result.sort(0, OrderDirection::DESC);
+    result.sort(3);
+    EXPECT_EQ(ids(result), (std::vector<int>{4, 2, 3, 1}));
+}
+
+TEST_F(MaterializedResultTest, FilterAndSelectKeepTheChosenRows) {
+    MaterializedResult result = fruit();
+
+    result.filter([](const MaterializedRow &row) {
+        return row.isNull(2) || row.get<double>(2).value() < 2;
+    });
+    EXPECT_EQ(ids(result), (std::vector<int>{2, 3, 4}));
+    EXPECT_TRUE(result.isNull(0, 1));
+    EXPECT_TRUE(result.isNull(1, 2));
+    EXPECT_EQ(result.get<std::string>(2, 1).value(), "fig");
+
+    // Rows may be repeated
+    result.selectRows({2, 1, 1});
+    EXPECT_EQ(ids(result), (std::vector<int>{4, 3, 3}));
+    EXPECT_EQ(result.get<std::string>(1, 1).value(), "apple");
+    EXPECT_EQ(result.get<std::string>(2, 1).value(), "apple");
+    EXPECT_EQ(result.nulls(2)[0], 0x06);
+
+    // A row past the end is refused, leaving the result as it was
+    EXPECT_THROW(result.selectRows({0, 3}), SQLException);
+    EXPECT_EQ(result.rowCount(), 3u);
+
+    result.filter([](const MaterializedRow &) { return false; });
+    EXPECT_EQ(result.rowCount(), 0u);
+    EXPECT_EQ(result.begin(), result.end());
+}
+
+TEST_F(MaterializedResultTest, QueryResultEndIsReachedWhenTheRowsRunOut) {
+    // The driver doesn't say how many rows there are, so the end is only known once a fetch finds no more
+    QueryResult result = session.executeQuery("SELECT * FROM Fruit");
+    QueryResultRowIterator end = result.end();
+    QueryResultRowIterator it = result.begin();
+    EXPECT_NE(it, end);
+
+    std::vector<int> seen;
+    for (; it != end; ++it) {
+        seen.push_back((*it)[0].get<int>().value());
+    }
+    EXPECT_EQ(seen, (std::vector<int>{1, 2, 3, 4}));
+    EXPECT_EQ(it, result.end());
+    EXPECT_EQ(result.end(), end);
+
+    // An empty result ends straight away
+    FakeResult empty;
+    empty.columns = {{"Id", SQL_INTEGER, 10, false}};
+    FakeDriver::instance().script("FROM Empty", empty);
+    QueryResult none = session.executeQuery("SELECT Id FROM Empty");
+    size_t rows = 0;
+    for (const Row &row : none) {
+        (void) row;
+        rows++;
+    }
+    EXPECT_EQ(rows, 0u);
+}
@@ -0,0 +1,250 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+#include <gtest/gtest.h>
+
+#include "../include/networking/StreamMultiplexer.h"
+#include "loopback.h"
+
+using namespace networking;
+using namespace tests;
+
+// How long a test waits for a message which should arrive promptly
+#define MULTIPLEXER_TEST_TIMEOUT std::chrono::seconds(10)
+
+// Frame types and flags as they appear on the wire
+#define MULTIPLEXER_TEST_OPEN 0
+#define MULTIPLEXER_TEST_DATA 1
+#define MULTIPLEXER_TEST_WINDOW_UPDATE 2
+#define MULTIPLEXER_TEST_RESET 3
+#define MULTIPLEXER_TEST_END_OF_MESSAGE 0x1
+
+// Deadline for a message which should arrive promptly
+static Deadline soon() {
+    return std::chrono::steady_clock::now() + MULTIPLEXER_TEST_TIMEOUT;
+}
+
+// Check a received message holds exactly the given payload
+static void expectMessage(const std::optional<byte_buffer> &message, const byte_buffer &payload) {
+    ASSERT_TRUE(message.has_value());
+    ASSERT_EQ(message->size(), payload.size());
+    EXPECT_TRUE(std::equal(message->cbegin(), message->cend(), payload.cbegin()));
+}
+
+// Send a frame by hand, with every payload byte set to fill, so a test can break the rules a multiplexer keeps to
+static bool sendRawFrame(const TCPSocket &socket, const AESKey &key, StreamID id, byte type, byte flags,
+                         size_t payloadSize, byte fill = 0) {
+    byte_buffer frame(sizeof(StreamID) + 4 + payloadSize);
+    std::fill(frame.begin(), frame.end(), fill);
+    for (size_t i = 0; i < sizeof(StreamID); i++) {
+        frame.begin()[i] = (byte) (id >> (8 * i));
+    }
+    frame.begin()[sizeof(StreamID)] = type;
+    frame.begin()[sizeof(StreamID) + 1] = flags;
+    return socket.send(AESMessage(std::move(frame), key));
+}
+
+// Read frames sent back by hand until the given stream is reset. Returns false if the connection ends first
+static bool awaitReset(TCPSocket &socket, const AESKey &key, StreamID id) {
+    while (true) {
+        AESMessage frame(socket.receive(soon()), key);
+        if (frame.invalid()) {
+            return false;
+        }
+        const byte *data = frame.begin();
+        StreamID frameID = 0;
+        for (size_t i = 0; i < sizeof(StreamID); i++) {
+            frameID |= (StreamID) data[i] << (8 * i);
+        }
+        if (frameID == id && data[sizeof(StreamID)] == MULTIPLEXER_TEST_RESET) {
+            return true;
+        }
+    }
+}
+
+// MultiplexerTest
+// A client and server multiplexer over a loopback connection
+class MultiplexerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        pair = connectLoopback();
+        client = std::make_unique<StreamMultiplexer>(pair.client, key, StreamMultiplexer::Role::CLIENT);
+        server = std::make_unique<StreamMultiplexer>(pair.server, key, StreamMultiplexer::Role::SERVER);
+    }
+
+    LoopbackPair pair;
+    AESKey key{};
+    std::unique_ptr<StreamMultiplexer> client, server;
+};
+
+TEST_F(MultiplexerTest, ReassemblesMessagesLargerThanTheWindow) {
+    std::shared_ptr<Stream> sending = client->open();
+    std::shared_ptr<Stream> receiving = server->accept(soon());
+    ASSERT_NE(receiving, nullptr);
+
+    // The first message fits in a frame, the second spans several frames, and the third needs credit granted
+    // back part way through
+    std::vector<byte_buffer> payloads;
+    payloads.push_back(makePayload(10));
+    payloads.push_back(makePayload(STREAM_MAX_FRAME_PAYLOAD * 3 + 1));
+    payloads.push_back(makePayload(STREAM_INITIAL_WINDOW * 4 + 7));
+
+    std::thread sender([&]() {
+        for (const byte_buffer &payload : payloads) {
+            EXPECT_TRUE(sending->send(payload));
+        }
+    });
+    for (const byte_buffer &payload : payloads) {
+        expectMessage(receiving->receive(soon()), payload);
+    }
+    sender.join();
+}
+
+TEST_F(MultiplexerTest, StreamsInterleaveIndependently) {
+    // Open several streams, then have the server answer them in reverse order, so each stream's reply must
+    // find its own way back
+    std::vector<std::shared_ptr<Stream>> opened, accepted;
+    for (int i = 0; i < 4; i++) {
+        opened.push_back(client->open());
+        accepted.push_back(server->accept(soon()));
+        ASSERT_NE(accepted.back(), nullptr);
+        EXPECT_EQ(accepted.back()->id(), opened.back()->id());
+    }
+
+    std::vector<byte_buffer> payloads;
+    for (size_t i = 0; i < opened.size(); i++) {
+        payloads.push_back(makePayload(STREAM_MAX_FRAME_PAYLOAD * (i + 1) + i));
+    }
+    std::vector<std::thread> senders;
+    for (size_t i = opened.size(); i-- > 0;) {
+        senders.emplace_back([&, i]() {
+            EXPECT_TRUE(accepted[i]->send(payloads[i]));
+        });
+    }
+    for (size_t i = 0; i < opened.size(); i++) {
+        expectMessage(opened[i]->receive(soon()), payloads[i]);
+    }
+    for (std::thread &sender : senders) {
+        sender.join();
+    }
+}
+
+TEST_F(MultiplexerTest, StreamOutlivesMultiplexer) {
+    std::shared_ptr<Stream> stream = client->open();
+    ASSERT_NE(server->accept(soon()), nullptr);
+
+    // Once the multiplexer has gone the stream acts as if the connection was lost, rather than touching it
+    client.reset();
+    EXPECT_FALSE(stream->send(makePayload(10)));
+    EXPECT_FALSE(stream->receive(soon()).has_value());
+    stream->close();
+    stream->reset();
+}
+
+TEST_F(MultiplexerTest, CloseWritesQueuedFramesFirst) {
+    std::shared_ptr<Stream> sending = client->open();
+    std::vector<byte_buffer> payloads;
+    for (size_t i = 0; i < 8; i++) {
+        payloads.push_back(makePayload(STREAM_MAX_FRAME_PAYLOAD + i));
+        ASSERT_TRUE(sending->send(payloads.back()));
+    }
+
+    // Everything was only queued when the connection closes, but still arrives
+    client->close();
+    std::shared_ptr<Stream> receiving = server->accept(soon());
+    ASSERT_NE(receiving, nullptr);
+    for (const byte_buffer &payload : payloads) {
+        expectMessage(receiving->receive(soon()), payload);
+    }
+}
+
+// MultiplexerRawPeerTest
+// A server multiplexer whose peer writes frames by hand
+class MultiplexerRawPeerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        pair = connectLoopback();
+        server = std::make_unique<StreamMultiplexer>(pair.server, key, StreamMultiplexer::Role::SERVER);
+
+        ASSERT_TRUE(sendRawFrame(pair.client, key, 1, MULTIPLEXER_TEST_OPEN, 0, 0));
+        stream = server->accept(soon());
+        ASSERT_NE(stream, nullptr);
+    }
+
+    void TearDown() override {
+        // Close the peer first, as a multiplexer does once the other side ends the connection, so the server's
+        // close doesn't wait out its drain timeout
+        pair.client.close();
+    }
+
+    LoopbackPair pair;
+    AESKey key{};
+    std::unique_ptr<StreamMultiplexer> server;
+    std::shared_ptr<Stream> stream;
+};
+
+TEST_F(MultiplexerRawPeerTest, FrameBeyondCreditResetsStream) {
+    ASSERT_TRUE(sendRawFrame(pair.client, key, 1, MULTIPLEXER_TEST_DATA, MULTIPLEXER_TEST_END_OF_MESSAGE,
+                             STREAM_INITIAL_WINDOW + 1));
+
+    EXPECT_TRUE(awaitReset(pair.client, key, 1));
+    EXPECT_FALSE(stream->receive(soon()).has_value());
+    EXPECT_TRUE(server->connected());
+}
+
+TEST_F(MultiplexerRawPeerTest, OversizedMessageResetsStream) {
+    // Every frame is within the credit, which the waiting receiver hands straight back, but the message as a
+    // whole grows past what the receiver will reassemble
+    std::thread sender([this]() {
+        for (size_t sent = 0; sent <= STREAM_MAX_MESSAGE_SIZE; sent += STREAM_INITIAL_WINDOW) {
+            if (!sendRawFrame(pair.client, key, 1, MULTIPLEXER_TEST_DATA, 0, STREAM_INITIAL_WINDOW)) {
+                break;
+            }
+        }
+    });
+    std::optional<byte_buffer> message = stream->receive(soon());
+    bool reset = awaitReset(pair.client, key, 1);
+    sender.join();
+
+    EXPECT_FALSE(message.has_value());
+    EXPECT_TRUE(reset);
+}
+
+TEST_F(MultiplexerTest, ConcurrentClosesCloseOnce) {
+    std::shared_ptr<Stream> stream = client->open();
+    ASSERT_NE(server->accept(soon()), nullptr);
+
+    // Every caller returns once the connection is closed, and only one of them closes it
+    SocketMetricsSnapshot before = SocketMetrics::snapshot();
+    std::vector<std::thread> closers;
+    for (int i = 0; i < 4; i++) {
+        closers.emplace_back([this]() { client->close(); });
+    }
+    for (std::thread &closer : closers) {
+        closer.join();
+    }
+    EXPECT_FALSE(client->connected());
+    EXPECT_FALSE(stream->send(makePayload(10)));
+
+    // The server saw the end of the connection, so closing it doesn't wait out the drain timeout
+    Deadline closeStarted = std::chrono::steady_clock::now();
+    server->close();
+    EXPECT_LT(std::chrono::steady_clock::now() - closeStarted, STREAM_CLOSE_DRAIN_TIMEOUT);
+    EXPECT_EQ(SocketMetrics::snapshot()[SocketCounter::SocketsClosed] - before[SocketCounter::SocketsClosed], 2u);
+}
+
+TEST_F(MultiplexerRawPeerTest, CreditPastTheWindowLimitResetsStream) {
+    // 0x01010101 bytes of credit is generous but allowed, while a further 0xFFFFFFFF would take the window past
+    // its limit
+    ASSERT_TRUE(sendRawFrame(pair.client, key, 1, MULTIPLEXER_TEST_WINDOW_UPDATE, 0, sizeof(unsigned), 0x01));
+    ASSERT_TRUE(sendRawFrame(pair.client, key, 1, MULTIPLEXER_TEST_WINDOW_UPDATE, 0, sizeof(unsigned), 0xFF));
+
+    EXPECT_TRUE(awaitReset(pair.client, key, 1));
+    EXPECT_FALSE(stream->send(makePayload(10)));
+    EXPECT_TRUE(server->connected());
+}
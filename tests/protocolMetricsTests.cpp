@@ -0,0 +1,210 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include <sstream>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "../include/networking/protocol/Protocol.h"
+#include "../include/networking/protocol/ProtocolMetrics.h"
+#include "loopback.h"
+
+using namespace networking;
+using namespace tests;
+using namespace std::chrono_literals;
+
+// Input and output slots for the test protocols, which exchange an array of ints followed by an array of doubles,
+// each with a layer of its own
+using SocketInput = internal::Connector<0, std::nullptr_t, TCPSocket>;
+using IntsInput = internal::Connector<1, std::nullptr_t, std::vector<int>>;
+using DoublesInput = internal::Connector<2, std::nullptr_t, std::vector<double>>;
+using IntsOutput = internal::Connector<0, std::nullptr_t, std::vector<int>>;
+using DoublesOutput = internal::Connector<1, std::nullptr_t, std::vector<double>>;
+
+// Send both arrays on the socket, measuring the execution
+static bool sendArrays(const TCPSocket &socket, const std::vector<int> &ints, const std::vector<double> &doubles,
+                       ProtocolMetrics &metrics) {
+    Protocol protocol;
+    LayerReference<ArrayExchange<int>> intExchange = protocol.addLayer<ArrayExchange<int>>(Sender);
+    LayerReference<ArrayExchange<double>> doubleExchange = protocol.addLayer<ArrayExchange<double>>(Sender);
+    protocol.link<SocketInput, ArrayExchange<int>::Socket>(Protocol::Inputs, intExchange);
+    protocol.link<SocketInput, ArrayExchange<double>::Socket>(Protocol::Inputs, doubleExchange);
+    protocol.link<IntsInput, ArrayExchange<int>::Values>(Protocol::Inputs, intExchange);
+    protocol.link<DoublesInput, ArrayExchange<double>::Values>(Protocol::Inputs, doubleExchange);
+    protocol.feed<SocketInput>(socket);
+    protocol.feed<IntsInput>(ints);
+    protocol.feed<DoublesInput>(doubles);
+    protocol.execute(metrics);
+    return protocol.completed();
+}
+
+// Send just the ints on the socket, as a peer which stops part way through would
+static void sendInts(const TCPSocket &socket, const std::vector<int> &ints) {
+    Protocol protocol;
+    LayerReference<ArrayExchange<int>> exchange = protocol.addLayer<ArrayExchange<int>>(Sender);
+    protocol.link<SocketInput, ArrayExchange<int>::Socket>(Protocol::Inputs, exchange);
+    protocol.link<IntsInput, ArrayExchange<int>::Values>(Protocol::Inputs, exchange);
+    protocol.feed<SocketInput>(socket);
+    protocol.feed<IntsInput>(ints);
+    protocol.execute();
+}
+
+// Receive both arrays from the socket within the timeout, measuring the execution
+static bool receiveArrays(const TCPSocket &socket, std::chrono::milliseconds timeout, ProtocolMetrics &metrics) {
+    Protocol protocol;
+    LayerReference<ArrayExchange<int>> intExchange = protocol.addLayer<ArrayExchange<int>>(Receiver);
+    LayerReference<ArrayExchange<double>> doubleExchange = protocol.addLayer<ArrayExchange<double>>(Receiver);
+    protocol.link<SocketInput, ArrayExchange<int>::Socket>(Protocol::Inputs, intExchange);
+    protocol.link<SocketInput, ArrayExchange<double>::Socket>(Protocol::Inputs, doubleExchange);
+    protocol.link<ArrayExchange<int>::Values, IntsOutput>(intExchange, Protocol::Outputs);
+    protocol.link<ArrayExchange<double>::Values, DoublesOutput>(doubleExchange, Protocol::Outputs);
+    protocol.feed<SocketInput>(socket);
+    protocol.execute(timeout, metrics);
+    return protocol.completed();
+}
+
+// Find the report of a layer type, or nullptr if the layer was never activated
+static const LayerReport *findLayer(const ProtocolReport &report, const std::string &layer) {
+    for (const LayerReport &entry : report.layers) {
+        if (entry.layer == layer) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+// Get the total of every termination a layer has made
+static uint64_t totalTerminations(const LayerReport &layer) {
+    uint64_t total = 0;
+    for (uint64_t count : layer.terminations) {
+        total += count;
+    }
+    return total;
+}
+
+// Get the bytes a framed message carrying an array of the given number of elements takes on the wire
+template<typename T>
+static uint64_t frameBytes(size_t count) {
+    return NetworkMessage::HeaderSize +
+           paddedSize(ArrayExchange<T>::HeaderSize + count * sizeof(T), NetworkMessage::BufferChunkSize);
+}
+
+static const std::string IntLayer = "networking::ArrayExchange<int>";
+static const std::string DoubleLayer = "networking::ArrayExchange<double>";
+
+TEST(ProtocolMetrics, CompletedExchangeMeasuresEachLayer) {
+    LoopbackPair pair = connectLoopback();
+    ProtocolMetrics senderMetrics, receiverMetrics;
+
+    // The sender holds back, so the receiver's first layer spends that long waiting for its message
+    std::thread sender([&]() {
+        std::this_thread::sleep_for(30ms);
+        EXPECT_TRUE(sendArrays(pair.client, {1, 2, 3}, std::vector<double>(40, 0.5), senderMetrics));
+    });
+    EXPECT_TRUE(receiveArrays(pair.server, 10s, receiverMetrics));
+    sender.join();
+
+    ProtocolReport sent = senderMetrics.report();
+    EXPECT_EQ(sent.completed, 1u);
+    EXPECT_EQ(sent.terminated, 0u);
+    EXPECT_EQ(sent.executions.count, 1u);
+    ASSERT_EQ(sent.layers.size(), 2u);
+    const LayerReport *sentInts = findLayer(sent, IntLayer);
+    const LayerReport *sentDoubles = findLayer(sent, DoubleLayer);
+    ASSERT_NE(sentInts, nullptr);
+    ASSERT_NE(sentDoubles, nullptr);
+
+    // Each layer sent its own frame and nothing else. The doubles span several message chunks
+    EXPECT_EQ(sentInts->activations, 1u);
+    EXPECT_EQ(sentInts->bytesSent, frameBytes<int>(3));
+    EXPECT_EQ(sentInts->bytesReceived, 0u);
+    EXPECT_EQ(sentDoubles->bytesSent, frameBytes<double>(40));
+    EXPECT_GT(sentDoubles->bytesSent, sentInts->bytesSent + NetworkMessage::BufferChunkSize);
+    EXPECT_EQ(totalTerminations(*sentInts) + totalTerminations(*sentDoubles), 0u);
+
+    // The receiving layers took in exactly what the sending ones sent
+    ProtocolReport received = receiverMetrics.report();
+    EXPECT_EQ(received.completed, 1u);
+    const LayerReport *receivedInts = findLayer(received, IntLayer);
+    const LayerReport *receivedDoubles = findLayer(received, DoubleLayer);
+    ASSERT_NE(receivedInts, nullptr);
+    ASSERT_NE(receivedDoubles, nullptr);
+    EXPECT_EQ(receivedInts->bytesReceived, sentInts->bytesSent);
+    EXPECT_EQ(receivedDoubles->bytesReceived, sentDoubles->bytesSent);
+    EXPECT_EQ(receivedInts->bytesSent, 0u);
+
+    // The wait is the first layer's, and the execution took at least as long as its layers
+    EXPECT_EQ(receivedInts->activate.count, 1u);
+    EXPECT_GE(receivedInts->activate.max, (uint64_t) std::chrono::nanoseconds(30ms).count());
+    EXPECT_GE(received.executions.max, receivedInts->activate.max);
+    EXPECT_EQ(received.layers.front().layer, IntLayer);
+}
+
+TEST(ProtocolMetrics, TerminatingLayerRecordsItsReason) {
+    ProtocolMetrics metrics;
+
+    // Nothing is sent, so the first layer waits out the deadline and the second never runs
+    LoopbackPair silent = connectLoopback();
+    EXPECT_FALSE(receiveArrays(silent.server, 50ms, metrics));
+    ProtocolReport report = metrics.report();
+    EXPECT_EQ(report.completed, 0u);
+    EXPECT_EQ(report.terminated, 1u);
+    const LayerReport *ints = findLayer(report, IntLayer);
+    ASSERT_NE(ints, nullptr);
+    EXPECT_EQ(ints->activations, 1u);
+    EXPECT_EQ(ints->terminations[(size_t) TerminationReason::DeadlineExpired], 1u);
+    EXPECT_EQ(totalTerminations(*ints), 1u);
+    EXPECT_EQ(findLayer(report, DoubleLayer), nullptr);
+
+    // The ints arrive, then the connection closes before the doubles
+    LoopbackPair closed = connectLoopback();
+    sendInts(closed.client, {4});
+    closed.client.close();
+    EXPECT_FALSE(receiveArrays(closed.server, 10s, metrics));
+
+    // The ints arrive, then a frame too short to hold a header
+    LoopbackPair malformed = connectLoopback();
+    sendInts(malformed.client, {5});
+    ASSERT_TRUE(malformed.client.send(RawMessage(byte_buffer(ArrayExchange<double>::HeaderSize - 1))));
+    EXPECT_FALSE(receiveArrays(malformed.server, 10s, metrics));
+
+    report = metrics.report();
+    EXPECT_EQ(report.completed, 0u);
+    EXPECT_EQ(report.terminated, 3u);
+    EXPECT_EQ(report.executions.count, 3u);
+    ints = findLayer(report, IntLayer);
+    const LayerReport *doubles = findLayer(report, DoubleLayer);
+    ASSERT_NE(doubles, nullptr);
+    EXPECT_EQ(ints->activations, 3u);
+    EXPECT_EQ(totalTerminations(*ints), 1u);
+    EXPECT_EQ(doubles->activations, 2u);
+    EXPECT_EQ(doubles->terminations[(size_t) TerminationReason::ConnectionLost], 1u);
+    EXPECT_EQ(doubles->terminations[(size_t) TerminationReason::MalformedMessage], 1u);
+    EXPECT_EQ(totalTerminations(*doubles), 2u);
+
+    // The table names only the reasons each layer stopped for
+    std::ostringstream table;
+    metrics.dump(table);
+    EXPECT_NE(table.str().find("0 completed, 3 terminated"), std::string::npos) << table.str();
+    EXPECT_NE(table.str().find(IntLayer + " (deadline expired 1)"), std::string::npos) << table.str();
+    EXPECT_NE(table.str().find(DoubleLayer + " (connection lost 1, malformed message 1)"), std::string::npos)
+                        << table.str();
+}
+
+TEST(ProtocolMetrics, ResetClearsEveryCount) {
+    ProtocolMetrics metrics;
+    LoopbackPair pair = connectLoopback();
+    EXPECT_FALSE(receiveArrays(pair.server, 10ms, metrics));
+    metrics.reset();
+
+    ProtocolReport report = metrics.report();
+    EXPECT_EQ(report.terminated, 0u);
+    EXPECT_EQ(report.executions.count, 0u);
+    const LayerReport *ints = findLayer(report, IntLayer);
+    ASSERT_NE(ints, nullptr);
+    EXPECT_EQ(ints->activations, 0u);
+    EXPECT_EQ(ints->activate.count, 0u);
+    EXPECT_EQ(totalTerminations(*ints), 0u);
+}
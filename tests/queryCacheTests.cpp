@@ -0,0 +1,74 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include <gtest/gtest.h>
+
+#include "../include/database/SQLSession.h"
+#include "fakeDriver.h"
+
+using namespace sql;
+using namespace tests;
+
+// How long cached results are kept in the tests, which is longer than any test takes
+#define QUERY_CACHE_TEST_TIME_TO_LIVE std::chrono::minutes(10)
+
+TEST(QueryCacheWrittenTables, FindsTheTableWrittenTo) {
+    using Tables = std::optional<std::vector<std::string>>;
+    EXPECT_EQ(QueryCache::writtenTables("SELECT Id FROM Orders"), Tables(std::vector<std::string>()));
+    EXPECT_EQ(QueryCache::writtenTables("INSERT INTO Orders (Id) VALUES (1)"), Tables({"Orders"}));
+    EXPECT_EQ(QueryCache::writtenTables("UPDATE Orders SET Total = 0"), Tables({"Orders"}));
+    EXPECT_EQ(QueryCache::writtenTables("DELETE FROM Orders WHERE Id = 1"), Tables({"Orders"}));
+    EXPECT_EQ(QueryCache::writtenTables("SELECT Id, Total INTO OrderCopy FROM Orders"), Tables({"OrderCopy"}));
+}
+
+TEST(QueryCacheWrittenTables, WritesThroughAnAliasCouldWriteAnything) {
+    EXPECT_EQ(QueryCache::writtenTables("UPDATE a SET Total = 0 FROM Orders a WHERE a.Id = 1"), std::nullopt);
+    EXPECT_EQ(QueryCache::writtenTables("DELETE t FROM Orders t JOIN Customers c ON t.Customer = c.Id"),
+              std::nullopt);
+}
+
+// QueryCacheTest
+// A session connected to the fake driver, caching its results
+class QueryCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        FakeDriver::instance().reset();
+        session.connect("fake", "user", "password");
+        session.setQueryCache(cache);
+
+        FakeResult orders;
+        orders.columns = {{"Id", SQL_INTEGER, 10, false}};
+        orders.rows = {{"1"}, {"2"}};
+        FakeDriver::instance().script("FROM Orders", orders);
+    }
+
+    // Read the orders through the cache
+    void readOrders() {
+        session.executeCachedQuery("SELECT Id FROM Orders", {"Orders"}, QUERY_CACHE_TEST_TIME_TO_LIVE);
+    }
+
+    std::shared_ptr<QueryCache> cache = std::make_shared<QueryCache>();
+    SQLSession session;
+};
+
+TEST_F(QueryCacheTest, WriteToTheTableInvalidates) {
+    readOrders();
+    ASSERT_EQ(cache->size(), 1u);
+
+    // A write to another table leaves the result, but one to the table read drops it
+    session.execute("UPDATE Customers SET Name = 'x'");
+    EXPECT_EQ(cache->size(), 1u);
+    session.execute("INSERT INTO Orders (Id) VALUES (3)");
+    EXPECT_EQ(cache->size(), 0u);
+}
+
+TEST_F(QueryCacheTest, UpdateThroughAnAliasInvalidates) {
+    readOrders();
+    session.execute("UPDATE a SET Total = 0 FROM Orders a WHERE a.Id = 1");
+    EXPECT_EQ(cache->size(), 0u);
+
+    readOrders();
+    session.execute("DELETE t FROM Orders t WHERE t.Id = 2");
+    EXPECT_EQ(cache->size(), 0u);
+}
@@ -0,0 +1,290 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include <future>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#endif
+
+#include <gtest/gtest.h>
+
+#include "../include/networking/NetworkTranslator.h"
+#include "loopback.h"
+
+using namespace networking;
+using namespace tests;
+
+// How long a test waits for a reply which should arrive promptly
+#define REACTOR_TEST_REPLY_TIMEOUT std::chrono::seconds(5)
+
+// RawClient
+// A client connection made with the platform socket calls directly, so a test can write part of a framed message
+class RawClient {
+public:
+    explicit RawClient(unsigned short port) {
+        platform::startup();
+        sock = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+        connected = ::connect(sock, (sockaddr *) &address, sizeof(address)) != SOCKET_ERROR;
+    }
+
+    RawClient(const RawClient &other) = delete;
+
+    ~RawClient() {
+        platform::closeSocket(sock);
+        platform::cleanup();
+    }
+
+    RawClient &operator=(const RawClient &other) = delete;
+
+    // Write a range of bytes of a framed message
+    void send(const NetworkMessage &framed, size_t begin, size_t end) const {
+        const byte *data = framed.cbegin() + begin;
+        while (begin < end) {
+            int sent = (int) ::send(sock, (const char *) data, (int) (end - begin), platform::SendFlags);
+            ASSERT_NE(sent, SOCKET_ERROR);
+            data += sent;
+            begin += sent;
+        }
+    }
+
+    // Read exactly size bytes, waiting at most the timeout. Returns fewer if the connection closes first
+    std::vector<byte> receive(size_t size, std::chrono::milliseconds timeout) const {
+        std::vector<byte> data;
+        Deadline deadline = std::chrono::steady_clock::now() + timeout;
+        std::vector<byte> buffer(size);
+        while (data.size() < size && std::chrono::steady_clock::now() < deadline) {
+            platform::PollDescriptor descriptor{};
+            descriptor.fd = sock;
+            descriptor.events = POLLIN;
+            if (platform::poll(&descriptor, 1, 10) <= 0) {
+                continue;
+            }
+            int received = (int) ::recv(sock, (char *) buffer.data(), (int) (size - data.size()), 0);
+            if (received <= 0) {
+                break;
+            }
+            data.insert(data.end(), buffer.begin(), buffer.begin() + received);
+        }
+        return data;
+    }
+
+    bool connected;
+
+private:
+    SOCKET sock;
+};
+
+// ReactorTest
+// A server echoing every message it receives back to its sender
+class ReactorTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        server.setMessageTimeout(std::chrono::milliseconds(200));
+        server.setMessageHandler([](ServerConnection &connection, NetworkMessage &&message) {
+            connection.send(RawMessage(message));
+        });
+    }
+
+    void TearDown() override {
+        server.stop(std::chrono::milliseconds(100));
+    }
+
+    // Connect a client socket to the server
+    TCPSocket connect() {
+        TCPSocket client;
+        client.create();
+        client.connect("127.0.0.1", server.port());
+        return client;
+    }
+
+    NetworkTranslator server;
+};
+
+// Check a reply holds exactly the given payload
+static void expectReply(TCPSocket &client, const byte_buffer &payload) {
+    NetworkMessage reply = client.receive(std::chrono::steady_clock::now() + REACTOR_TEST_REPLY_TIMEOUT);
+    ASSERT_FALSE(reply.invalid());
+    ASSERT_EQ((size_t) (reply.messageEnd() - reply.messageBegin()), payload.size());
+    EXPECT_TRUE(std::equal(reply.messageBegin(), reply.messageEnd(), payload.cbegin()));
+}
+
+TEST_F(ReactorTest, EchoesMessages) {
+    server.start(0, "127.0.0.1", 2);
+    TCPSocket client = connect();
+
+    for (size_t size : {(size_t) 1, (size_t) 5000, (size_t) 300000}) {
+        byte_buffer payload = makePayload(size);
+        ASSERT_TRUE(client.send(RawMessage(payload.copy())));
+        expectReply(client, payload);
+    }
+}
+
+TEST_F(ReactorTest, SeveralMessagesInOneWrite) {
+    server.start(0, "127.0.0.1", 1);
+    TCPSocket client = connect();
+
+    // Corking sends every message in a single write, so the reactor decodes them all from one read
+    std::vector<byte_buffer> payloads;
+    {
+        CorkGuard cork(client);
+        for (size_t i = 0; i < 10; i++) {
+            payloads.push_back(makePayload(i * 7 + 1));
+            client.send(RawMessage(payloads.back().copy()));
+        }
+    }
+    for (const byte_buffer &payload : payloads) {
+        expectReply(client, payload);
+    }
+}
+
+TEST_F(ReactorTest, PartialMessageDoesNotBlockOtherConnections) {
+    server.start(0, "127.0.0.1", 1);
+
+    // The first client sends only part of its message, which must not hold up the second on the same reactor
+    byte_buffer slowPayload = makePayload(1000);
+    NetworkMessage slowFramed = RawMessage(slowPayload.copy()).message();
+    RawClient slow(server.port());
+    ASSERT_TRUE(slow.connected);
+    slow.send(slowFramed, 0, 10);
+
+    TCPSocket fast = connect();
+    byte_buffer fastPayload = makePayload(50);
+    ASSERT_TRUE(fast.send(RawMessage(fastPayload.copy())));
+    expectReply(fast, fastPayload);
+
+    // The rest of the slow message, well inside the message timeout, completes it
+    slow.send(slowFramed, 10, slowFramed.bufferSize());
+    std::vector<byte> reply = slow.receive(slowFramed.bufferSize(), REACTOR_TEST_REPLY_TIMEOUT);
+    ASSERT_EQ(reply.size(), slowFramed.bufferSize());
+    EXPECT_TRUE(std::equal(reply.begin(), reply.end(), slowFramed.cbegin()));
+}
+
+TEST_F(ReactorTest, IncompleteMessageTimesOut) {
+    server.start(0, "127.0.0.1", 1);
+
+    RawClient slow(server.port());
+    ASSERT_TRUE(slow.connected);
+    NetworkMessage framed = RawMessage(makePayload(1000)).message();
+    slow.send(framed, 0, 10);
+
+    // The server closes the connection once the message timeout passes, which the client sees as the end
+    std::vector<byte> reply = slow.receive(1, REACTOR_TEST_REPLY_TIMEOUT);
+    EXPECT_TRUE(reply.empty());
+}
+
+TEST_F(ReactorTest, SlowHandshakeDoesNotBlockReactor) {
+    // The first connection's handshake never finishes until the test lets it. Every connection is served by the
+    // one reactor, but the handshakes run on two threads
+    struct Release {
+        std::promise<void> promise;
+
+        // Let the handshake go however the test ends, or stopping the server would wait for it forever
+        ~Release() {
+            promise.set_value();
+        }
+    } release;
+    std::shared_future<void> released = release.promise.get_future().share();
+    // The handshake threads may outlive this scope until the server stops, so share what they use
+    std::shared_ptr<std::atomic_int> handshakes = std::make_shared<std::atomic_int>(0);
+    server.setConnectionProtocol([released, handshakes](Protocol &, const TCPSocket &) {
+        if ((*handshakes)++ == 0) {
+            released.wait();
+        }
+    });
+    server.setHandshakeThreads(2);
+    server.start(0, "127.0.0.1", 1);
+
+    TCPSocket stuck = connect();
+    while (*handshakes == 0) {
+        std::this_thread::yield();
+    }
+
+    TCPSocket client = connect();
+    byte_buffer payload = makePayload(100);
+    ASSERT_TRUE(client.send(RawMessage(payload.copy())));
+    expectReply(client, payload);
+}
+
+TEST_F(ReactorTest, HighDescriptorsAreServed) {
+    // Push the connection's descriptor past where an fd_set could hold it, where the platform allows
+#if !defined(_WIN32)
+    rlimit limit{};
+    getrlimit(RLIMIT_NOFILE, &limit);
+    if (limit.rlim_cur < 2048 && limit.rlim_max >= 2048) {
+        limit.rlim_cur = 2048;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+#endif
+    std::vector<TCPSocket> filler;
+    try {
+        for (int i = 0; i < 1100; i++) {
+            filler.emplace_back();
+            filler.back().create();
+        }
+    } catch (SocketException &) {
+        GTEST_SKIP() << "Not enough descriptors available to pass FD_SETSIZE";
+    }
+
+    server.start(0, "127.0.0.1", 1);
+    TCPSocket client = connect();
+    byte_buffer payload = makePayload(100);
+    ASSERT_TRUE(client.send(RawMessage(payload.copy())));
+    expectReply(client, payload);
+}
+
+TEST_F(ReactorTest, OversizedMessageClosesConnection) {
+    server.setMaxMessageSize(1000);
+    server.start(0, "127.0.0.1", 1);
+
+    // A message of exactly the limit is still served
+    TCPSocket client = connect();
+    byte_buffer payload = makePayload(1000);
+    ASSERT_TRUE(client.send(RawMessage(payload.copy())));
+    expectReply(client, payload);
+
+    // A header claiming the largest possible message closes the connection as soon as it arrives, without the
+    // reactor trying to allocate for it or waiting for the body
+    SocketMetricsSnapshot before = SocketMetrics::snapshot();
+    NetworkMessage framed = RawMessage(makePayload(10)).message();
+    std::fill(framed.begin(), framed.begin() + NetworkMessage::HeaderSize, 0xFF);
+    RawClient oversized(server.port());
+    ASSERT_TRUE(oversized.connected);
+    oversized.send(framed, 0, NetworkMessage::HeaderSize);
+    EXPECT_TRUE(oversized.receive(1, REACTOR_TEST_REPLY_TIMEOUT).empty());
+    EXPECT_EQ(SocketMetrics::snapshot()[SocketCounter::OversizedCloses] - before[SocketCounter::OversizedCloses], 1u);
+
+    // The other connection is unaffected
+    ASSERT_TRUE(client.send(RawMessage(payload.copy())));
+    expectReply(client, payload);
+}
+
+TEST_F(ReactorTest, ConnectionCountIsReadableWhileStopping) {
+    server.start(0, "127.0.0.1", 2);
+    TCPSocket first = connect(), second = connect();
+    Deadline giveUp = std::chrono::steady_clock::now() + REACTOR_TEST_REPLY_TIMEOUT;
+    while (server.connectionCount() < 2 && std::chrono::steady_clock::now() < giveUp) {
+        std::this_thread::yield();
+    }
+    EXPECT_EQ(server.connectionCount(), 2u);
+
+    // A monitoring thread reads the count throughout the shutdown, while the reactors are torn down
+    std::atomic_bool stopped{false};
+    std::thread monitor([&]() {
+        while (!stopped) {
+            EXPECT_LE(server.connectionCount(), 2u);
+        }
+    });
+    server.stop(std::chrono::milliseconds(100));
+    stopped = true;
+    monitor.join();
+    EXPECT_EQ(server.connectionCount(), 0u);
+}
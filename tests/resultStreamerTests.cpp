@@ -0,0 +1,202 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include <atomic>
+#include <thread>
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+
+#include "../include/database/SQLSession.h"
+#include "../include/database/ResultStreamer.h"
+#include "fakeDriver.h"
+
+using namespace sql;
+using namespace tests;
+
+// Block encoder which writes each row's number as one byte, and fails on a given row if asked to
+class NumberEncoder : public BlockEncoder {
+public:
+    explicit NumberEncoder(size_t failingRow = 0)
+            : failingRow(failingRow) {
+
+    }
+
+    void beginBlock(const QueryResult &) override {
+        block.clear();
+    }
+
+    void addRow(const QueryResult &result) override {
+        if (++rows == failingRow) {
+            throw std::runtime_error("Encoding failed");
+        }
+        block.push_back((byte) std::stoi(result.row[0].get<std::string>().value()));
+    }
+
+    [[nodiscard]] size_t blockSize() const override {
+        return block.size();
+    }
+
+    byte_buffer finishBlock() override {
+        byte_buffer buffer(block.size());
+        std::copy(block.begin(), block.end(), buffer.begin());
+        return buffer;
+    }
+
+private:
+    size_t failingRow;
+    size_t rows = 0;
+    std::vector<byte> block;
+};
+
+// ResultStreamerTest
+// A session connected to the fake driver, with a table of numbered rows
+class ResultStreamerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        FakeDriver::instance().reset();
+        session.connect("fake", "user", "password");
+    }
+
+    // Script the numbers table with the given number of rows, numbered from 1
+    static void scriptNumbers(size_t count) {
+        FakeResult numbers;
+        numbers.columns = {{"Number", SQL_VARCHAR, 10, false}};
+        for (size_t i = 1; i <= count; i++) {
+            numbers.rows.push_back({std::to_string(i)});
+        }
+        FakeDriver::instance().script("FROM Numbers", numbers);
+    }
+
+    // Get the bytes of a block
+    static std::vector<byte> bytesOf(byte_buffer &block) {
+        return std::vector<byte>(block.begin(), block.end());
+    }
+
+    SQLSession session;
+};
+
+TEST_F(ResultStreamerTest, BlocksEndWithAnEmptyTerminator) {
+    scriptNumbers(5);
+    QueryResult result = session.executeQuery("SELECT Number FROM Numbers");
+    NumberEncoder encoder;
+    ResultStreamer streamer(result, encoder, 2);
+
+    std::vector<std::vector<byte>> blocks;
+    ASSERT_TRUE(streamer.stream([&blocks](byte_buffer &&block) {
+        blocks.push_back(bytesOf(block));
+        return true;
+    }));
+
+    // Full blocks, the part filled last block, then the empty block marking the end
+    std::vector<std::vector<byte>> expected = {{1, 2}, {3, 4}, {5}, {}};
+    EXPECT_EQ(blocks, expected);
+    EXPECT_EQ(streamer.rowsFetched(), 5u);
+}
+
+TEST_F(ResultStreamerTest, EmptyResultSendsOnlyTheTerminator) {
+    scriptNumbers(0);
+    QueryResult result = session.executeQuery("SELECT Number FROM Numbers");
+    NumberEncoder encoder;
+    ResultStreamer streamer(result, encoder);
+
+    std::vector<size_t> sizes;
+    ASSERT_TRUE(streamer.stream([&sizes](byte_buffer &&block) {
+        sizes.push_back(block.size());
+        return true;
+    }));
+    EXPECT_EQ(sizes, std::vector<size_t>({0}));
+    EXPECT_EQ(streamer.rowsFetched(), 0u);
+}
+
+TEST_F(ResultStreamerTest, BlockBytesLimitFinishesBlocksEarly) {
+    scriptNumbers(7);
+    QueryResult result = session.executeQuery("SELECT Number FROM Numbers");
+    NumberEncoder encoder;
+    ResultStreamer streamer(result, encoder, 100, 3);
+
+    std::vector<size_t> sizes;
+    ASSERT_TRUE(streamer.stream([&sizes](byte_buffer &&block) {
+        sizes.push_back(block.size());
+        return true;
+    }));
+    EXPECT_EQ(sizes, std::vector<size_t>({3, 3, 1, 0}));
+}
+
+TEST_F(ResultStreamerTest, FetchingWaitsWhileTheSinkIsBehind) {
+    scriptNumbers(20);
+    QueryResult result = session.executeQuery("SELECT Number FROM Numbers");
+    NumberEncoder encoder;
+    // One row to a block and room for two blocks between fetching and sending
+    ResultStreamer streamer(result, encoder, 1, RESULT_STREAM_BLOCK_BYTES, 2);
+
+    std::atomic_bool release{false};
+    size_t blocks = 0;
+    std::thread sender([&]() {
+        EXPECT_TRUE(streamer.stream([&](byte_buffer &&) {
+            while (!release.load()) {
+                std::this_thread::yield();
+            }
+            blocks++;
+            return true;
+        }));
+    });
+
+    // With the first block held by the sink, two queued and one waiting for room, fetching must stop at four
+    std::chrono::steady_clock::time_point giveUp = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (streamer.rowsFetched() < 4 && std::chrono::steady_clock::now() < giveUp) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(streamer.rowsFetched(), 4u);
+
+    release = true;
+    sender.join();
+    EXPECT_EQ(streamer.rowsFetched(), 20u);
+    EXPECT_EQ(blocks, 21u);
+}
+
+TEST_F(ResultStreamerTest, RefusedBlockStopsFetching) {
+    scriptNumbers(100);
+    QueryResult result = session.executeQuery("SELECT Number FROM Numbers");
+    NumberEncoder encoder;
+    ResultStreamer streamer(result, encoder, 1, RESULT_STREAM_BLOCK_BYTES, 2);
+
+    size_t offered = 0;
+    EXPECT_FALSE(streamer.stream([&offered](byte_buffer &&) {
+        return ++offered < 2;
+    }));
+
+    // No more blocks are offered once one is refused, and fetching stopped well short of the end
+    EXPECT_EQ(offered, 2u);
+    EXPECT_LE(streamer.rowsFetched(), 5u);
+}
+
+TEST_F(ResultStreamerTest, FetchErrorIsRethrownBySend) {
+    scriptNumbers(10);
+    QueryResult result = session.executeQuery("SELECT Number FROM Numbers");
+    NumberEncoder encoder(6);
+    ResultStreamer streamer(result, encoder, 2);
+
+    // The blocks finished before the error are still sent, but never the terminator
+    std::vector<std::vector<byte>> blocks;
+    EXPECT_THROW(streamer.stream([&blocks](byte_buffer &&block) {
+        blocks.push_back(bytesOf(block));
+        return true;
+    }), std::runtime_error);
+    std::vector<std::vector<byte>> expected = {{1, 2}, {3, 4}};
+    EXPECT_EQ(blocks, expected);
+}
+
+TEST_F(ResultStreamerTest, SinkErrorIsRethrownBySend) {
+    scriptNumbers(100);
+    QueryResult result = session.executeQuery("SELECT Number FROM Numbers");
+    NumberEncoder encoder;
+    ResultStreamer streamer(result, encoder, 1, RESULT_STREAM_BLOCK_BYTES, 2);
+
+    EXPECT_THROW(streamer.stream([](byte_buffer &&) -> bool {
+        throw std::runtime_error("Send failed");
+    }), std::runtime_error);
+    EXPECT_LE(streamer.rowsFetched(), 4u);
+}
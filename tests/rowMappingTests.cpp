@@ -0,0 +1,156 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include <gtest/gtest.h>
+
+#include "../include/database/SQLSession.h"
+#include "../include/database/RowMapping.h"
+#include "fakeDriver.h"
+
+using namespace sql;
+using namespace tests;
+
+// A trade as mapped from a row. The note may be null, but the rest may not
+struct Trade {
+    int id = 0;
+    std::string symbol;
+    double price = 0;
+    Value<std::string> note;
+    ColumnarDate settled{};
+};
+
+using TradeMapping = RowMapping<Trade, Field<0, &Trade::id>, Field<1, &Trade::symbol>, Field<2, &Trade::price>,
+        Field<3, &Trade::note>, Field<4, &Trade::settled>>;
+
+// RowMappingTest
+// A session connected to the fake driver
+class RowMappingTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        FakeDriver::instance().reset();
+        session.connect("fake", "user", "password");
+    }
+
+    // Script the trades table with the given rows of id, symbol, price, note and settlement date
+    static void scriptTrades(std::vector<std::vector<std::optional<std::string>>> rows, SQLULEN symbolSize = 8) {
+        FakeResult trades;
+        trades.columns = {
+                {"Id", SQL_INTEGER, 10, false},
+                {"Symbol", SQL_VARCHAR, symbolSize, false},
+                {"Price", SQL_DOUBLE, 15, false},
+                {"Note", SQL_VARCHAR, 20, true},
+                {"Settled", SQL_TYPE_DATE, 10, false}
+        };
+        trades.rows = std::move(rows);
+        FakeDriver::instance().script("FROM Trades", trades);
+    }
+
+    SQLSession session;
+};
+
+TEST_F(RowMappingTest, MapsEveryFieldAcrossSeveralBlocks) {
+    // Each row takes about 200 bytes of bound buffers, so every block is of the largest size and the rows span three
+    size_t rowCount = 2 * ROW_MAPPING_MAX_BLOCK_ROWS + 37;
+    std::vector<std::vector<std::optional<std::string>>> rows;
+    for (size_t i = 0; i < rowCount; i++) {
+        rows.push_back({std::to_string(i), "S" + std::to_string(i % 100), std::to_string(i) + ".25",
+                        i % 3 == 0 ? std::nullopt : std::optional<std::string>("note " + std::to_string(i)),
+                        "2026-10-" + std::to_string(1 + i % 28)});
+    }
+    scriptTrades(rows);
+
+    QueryResult result = session.executeQuery("SELECT * FROM Trades");
+    std::vector<Trade> trades = TradeMapping::fetchAll(result);
+
+    ASSERT_EQ(trades.size(), rowCount);
+    for (size_t i = 0; i < rowCount; i += 7) {
+        EXPECT_EQ(trades[i].id, (int) i);
+        EXPECT_EQ(trades[i].symbol, "S" + std::to_string(i % 100));
+        EXPECT_DOUBLE_EQ(trades[i].price, i + 0.25);
+        EXPECT_EQ(trades[i].note.hasValue(), i % 3 != 0) << "Row " << i;
+        if (i % 3 != 0) {
+            EXPECT_EQ(trades[i].note.value(), "note " + std::to_string(i));
+        }
+        EXPECT_EQ(trades[i].settled.year, 2026);
+        EXPECT_EQ(trades[i].settled.month, 10);
+        EXPECT_EQ(trades[i].settled.day, 1 + i % 28);
+    }
+    // The last row, in the part filled final block, is kept too
+    EXPECT_EQ(trades.back().id, (int) rowCount - 1);
+}
+
+TEST_F(RowMappingTest, NullInAPlainFieldIsRefused) {
+    scriptTrades({
+            {"1", "AAA", "1.5", std::nullopt, "2026-10-18"},
+            {"2", "BBB", std::nullopt, "late", "2026-10-18"}
+    });
+    QueryResult result = session.executeQuery("SELECT * FROM Trades");
+
+    // The note is a Value, so may be null, but the price can't hold one
+    EXPECT_THROW(TradeMapping::fetchAll(result), SQLException);
+}
+
+TEST_F(RowMappingTest, StringTooLongForItsBufferIsRefused) {
+    // The column claims to be short, so the value overflows the buffer sized for it
+    scriptTrades({{"1", std::string(200, 'x'), "1.5", std::nullopt, "2026-10-18"}}, 10);
+    QueryResult result = session.executeQuery("SELECT * FROM Trades");
+    EXPECT_THROW(TradeMapping::fetchAll(result), SQLException);
+
+    // A value which just fits is read whole
+    scriptTrades({{"1", std::string(64, 'y'), "1.5", std::nullopt, "2026-10-18"}}, 10);
+    QueryResult fits = session.executeQuery("SELECT * FROM Trades");
+    std::vector<Trade> trades = TradeMapping::fetchAll(fits);
+    ASSERT_EQ(trades.size(), 1u);
+    EXPECT_EQ(trades[0].symbol, std::string(64, 'y'));
+}
+
+TEST_F(RowMappingTest, MappingAColumnPastTheResultIsRefused) {
+    FakeResult narrow;
+    narrow.columns = {{"Id", SQL_INTEGER, 10, false}};
+    narrow.rows = {{"1"}};
+    FakeDriver::instance().script("FROM Narrow", narrow);
+    QueryResult result = session.executeQuery("SELECT Id FROM Narrow");
+    EXPECT_THROW(TradeMapping::fetchAll(result), SQLException);
+}
+
+TEST_F(RowMappingTest, ResultReadsRowByRowAfterTheCursorIsGone) {
+    scriptTrades({
+            {"1", "AAA", "1.5", std::nullopt, "2026-10-18"},
+            {"2", "BBB", "2.5", std::nullopt, "2026-10-18"},
+            {"3", "CCC", "3.5", "last", "2026-10-18"}
+    });
+    QueryResult result = session.executeQuery("SELECT * FROM Trades");
+
+    {
+        // Fetch just the first two rows as a block
+        BlockCursor cursor(result, 2);
+        std::vector<SQLINTEGER> ids(2);
+        std::vector<SQLLEN> indicators(2);
+        cursor.bind(0, SQL_C_SLONG, ids.data(), sizeof(SQLINTEGER), indicators.data());
+        ASSERT_EQ(cursor.fetch(), 2u);
+        EXPECT_EQ(ids, (std::vector<SQLINTEGER>{1, 2}));
+    }
+
+    // With the columns unbound and single row fetches back, the rest is read as normal
+    ASSERT_TRUE(result.fetchNextRow());
+    EXPECT_EQ(result.row[0].get<int>().value(), 3);
+    EXPECT_EQ(result.row[3].get<std::string>().value(), "last");
+    EXPECT_FALSE(result.fetchNextRow());
+}
+
+TEST_F(RowMappingTest, FetchAllReadsOnlyTheRowsLeft) {
+    scriptTrades({
+            {"1", "AAA", "1.5", std::nullopt, "2026-10-18"},
+            {"2", "BBB", "2.5", std::nullopt, "2026-10-18"}
+    });
+    QueryResult result = session.executeQuery("SELECT * FROM Trades");
+    ASSERT_TRUE(result.fetchNextRow());
+
+    std::vector<Trade> trades = TradeMapping::fetchAll(result);
+    ASSERT_EQ(trades.size(), 1u);
+    EXPECT_EQ(trades[0].id, 2);
+
+    // Once exhausted, there is nothing more to map
+    EXPECT_TRUE(TradeMapping::fetchAll(result).empty());
+}
@@ -0,0 +1,163 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "../include/networking/SendQueue.h"
+#include "../include/networking/TCPSocket.h"
+
+using namespace networking;
+
+// Make a framed message whose first two payload bytes identify it
+static NetworkMessage taggedMessage(byte producer, byte sequence, size_t size = 2) {
+    byte_buffer buffer(size);
+    buffer.begin()[0] = producer;
+    buffer.begin()[1] = sequence;
+    return RawMessage(std::move(buffer)).message();
+}
+
+TEST(SendQueue, PopsInPushOrderAndTracksBytes) {
+    SendQueue queue;
+    EXPECT_TRUE(queue.empty());
+    EXPECT_EQ(queue.front(), nullptr);
+
+    size_t total = 0;
+    for (byte i = 0; i < 5; i++) {
+        NetworkMessage message = taggedMessage(0, i);
+        total += message.bufferSize();
+        ASSERT_TRUE(queue.tryPush(std::move(message)));
+    }
+    EXPECT_FALSE(queue.empty());
+    EXPECT_EQ(queue.queuedBytes(), total);
+
+    for (byte i = 0; i < 5; i++) {
+        NetworkMessage *front = queue.front();
+        ASSERT_NE(front, nullptr);
+        EXPECT_EQ(front->messageBegin()[1], i);
+        total -= front->bufferSize();
+        queue.pop();
+        EXPECT_EQ(queue.queuedBytes(), total);
+    }
+    EXPECT_TRUE(queue.empty());
+    EXPECT_EQ(queue.front(), nullptr);
+}
+
+TEST(SendQueue, WriteProgressIsKeptForTheFrontMessage) {
+    SendQueue queue;
+    ASSERT_TRUE(queue.tryPush(taggedMessage(0, 0)));
+    ASSERT_TRUE(queue.tryPush(taggedMessage(0, 1)));
+
+    EXPECT_EQ(queue.frontOffset(), 0u);
+    queue.advanceFront(3);
+    queue.advanceFront(4);
+    EXPECT_EQ(queue.frontOffset(), 7u);
+    EXPECT_EQ(queue.front()->messageBegin()[1], 0);
+
+    // Popping the front message starts the next one from its beginning
+    queue.pop();
+    EXPECT_EQ(queue.frontOffset(), 0u);
+    EXPECT_EQ(queue.front()->messageBegin()[1], 1);
+}
+
+TEST(SendQueue, RefusesMessagesOnceOverBudget) {
+    size_t messageBytes = taggedMessage(0, 0).bufferSize();
+    SendQueue queue(2 * messageBytes);
+
+    EXPECT_TRUE(queue.tryPush(taggedMessage(0, 0)));
+    EXPECT_TRUE(queue.tryPush(taggedMessage(0, 1)));
+    NetworkMessage refused = taggedMessage(0, 2);
+    EXPECT_FALSE(queue.tryPush(std::move(refused)));
+    EXPECT_EQ(queue.queuedBytes(), 2 * messageBytes);
+
+    // A refused message is left untouched so it may be pushed again once there is room
+    EXPECT_FALSE(refused.invalid());
+    queue.pop();
+    EXPECT_TRUE(queue.tryPush(std::move(refused)));
+
+    // Raising the budget lets more in
+    EXPECT_FALSE(queue.tryPush(taggedMessage(0, 3)));
+    queue.setByteBudget(4 * messageBytes);
+    EXPECT_EQ(queue.byteBudget(), 4 * messageBytes);
+    EXPECT_TRUE(queue.tryPush(taggedMessage(0, 3)));
+}
+
+TEST(SendQueue, EmptyQueueAcceptsMessageLargerThanBudget) {
+    SendQueue queue(16);
+    EXPECT_TRUE(queue.tryPush(taggedMessage(0, 0, 1000)));
+    EXPECT_FALSE(queue.tryPush(taggedMessage(0, 1)));
+}
+
+TEST(SendQueue, PushWaitsForTheWriterToMakeRoom) {
+    size_t messageBytes = taggedMessage(0, 0).bufferSize();
+    SendQueue queue(messageBytes);
+    ASSERT_TRUE(queue.tryPush(taggedMessage(0, 0)));
+
+    std::atomic_bool pushed{false};
+    std::thread producer([&]() {
+        queue.push(taggedMessage(0, 1));
+        pushed = true;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(pushed.load());
+    queue.pop();
+    producer.join();
+
+    EXPECT_TRUE(pushed.load());
+    ASSERT_NE(queue.front(), nullptr);
+    EXPECT_EQ(queue.front()->messageBegin()[1], 1);
+}
+
+TEST(SendQueue, ConcurrentProducersKeepTheirOwnOrder) {
+    constexpr byte producers = 4;
+    constexpr byte messagesEach = 200;
+
+    // A small budget, so producers are regularly held back while the writer drains
+    SendQueue queue(4 * taggedMessage(0, 0).bufferSize());
+    std::vector<std::thread> threads;
+    for (byte producer = 0; producer < producers; producer++) {
+        threads.emplace_back([&queue, producer]() {
+            for (byte i = 0; i < messagesEach; i++) {
+                queue.push(taggedMessage(producer, i));
+            }
+        });
+    }
+
+    // Single writer: every message arrives exactly once, and each producer's messages in the order pushed
+    std::vector<int> next(producers, 0);
+    size_t received = 0;
+    while (received < (size_t) producers * messagesEach) {
+        NetworkMessage *front = queue.front();
+        if (front == nullptr) {
+            std::this_thread::yield();
+            continue;
+        }
+        byte producer = front->messageBegin()[0];
+        ASSERT_LT(producer, producers);
+        EXPECT_EQ(front->messageBegin()[1], next[producer]);
+        next[producer]++;
+        queue.pop();
+        received++;
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_TRUE(queue.empty());
+    EXPECT_EQ(queue.queuedBytes(), 0u);
+    for (int count : next) {
+        EXPECT_EQ(count, messagesEach);
+    }
+}
+
+TEST(SendQueue, SocketWithoutQueueThrows) {
+    TCPSocket socket;
+    EXPECT_THROW(socket.queue(RawMessage(byte_buffer(1))), SocketException);
+    EXPECT_THROW((void) socket.tryQueue(RawMessage(byte_buffer(1))), SocketException);
+    EXPECT_THROW(socket.flushQueue(), SocketException);
+    EXPECT_THROW(socket.setSendQueueBudget(10), SocketException);
+    EXPECT_FALSE(socket.hasQueuedData());
+}
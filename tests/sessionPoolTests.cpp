@@ -0,0 +1,41 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include <gtest/gtest.h>
+
+#include "../include/database/SessionPool.h"
+#include "fakeDriver.h"
+
+using namespace sql;
+using namespace tests;
+
+// SessionPoolTest
+// A pool of sessions connected to the fake driver
+class SessionPoolTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        FakeDriver::instance().reset();
+    }
+
+    SessionPool pool{"fake", "user", "password", 2};
+};
+
+TEST_F(SessionPoolTest, ReusesLiveSessions) {
+    pool.execute("UPDATE Orders SET Total = 0");
+    pool.execute("UPDATE Orders SET Total = 1");
+
+    EXPECT_EQ(FakeDriver::instance().connections(), 1u);
+    EXPECT_EQ(pool.size(), 1u);
+}
+
+TEST_F(SessionPoolTest, ReplacesSessionsWhoseConnectionWasLost) {
+    pool.execute("UPDATE Orders SET Total = 0");
+    FakeDriver::instance().killConnections();
+
+    // The idle session's connection has gone, so it is reconnected before the statement runs on it
+    SessionLease lease = pool.acquire();
+    EXPECT_TRUE(lease->connectionAlive());
+    EXPECT_EQ(FakeDriver::instance().connections(), 2u);
+    EXPECT_EQ(pool.size(), 1u);
+}
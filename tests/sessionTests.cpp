@@ -0,0 +1,286 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include <atomic>
+#include <thread>
+#include <algorithm>
+
+#include <gtest/gtest.h>
+
+#include "../include/database/SQLSession.h"
+#include "fakeDriver.h"
+
+using namespace sql;
+using namespace tests;
+
+// SessionTest
+// A session connected to the fake driver
+class SessionTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        FakeDriver::instance().reset();
+        session.connect("fake", "user", "password");
+    }
+
+    // Script a single integer column result for statements containing the fragment
+    static void scriptNumbers(const std::string &fragment, const std::vector<std::string> &values) {
+        FakeResult result;
+        result.columns = {{"Number", SQL_INTEGER, 10, false}};
+        for (const std::string &value : values) {
+            result.rows.push_back({value});
+        }
+        FakeDriver::instance().script(fragment, result);
+    }
+
+    SQLSession session;
+};
+
+TEST_F(SessionTest, AsyncQueryIsReadBeforeTheNextStatement) {
+    scriptNumbers("FROM First", {"1", "2", "3"});
+    scriptNumbers("FROM Second", {"4"});
+
+    // The second query is queued behind the first, so runs while the first's result is still unread
+    std::future<MaterializedResult> first = session.executeQueryAsync("SELECT Number FROM First");
+    std::future<MaterializedResult> second = session.executeQueryAsync("SELECT Number FROM Second");
+
+    MaterializedResult firstResult = first.get();
+    MaterializedResult secondResult = second.get();
+    ASSERT_EQ(firstResult.rowCount(), 3u);
+    EXPECT_EQ(firstResult.get<int>(2, 0).value(), 3);
+    ASSERT_EQ(secondResult.rowCount(), 1u);
+    EXPECT_EQ(secondResult.get<int>(0, 0).value(), 4);
+}
+
+TEST_F(SessionTest, AsyncQueryErrorIsCarriedByTheFuture) {
+    FakeDriver::instance().fail("FROM Missing");
+
+    std::future<MaterializedResult> result = session.executeQueryAsync("SELECT Number FROM Missing");
+    EXPECT_THROW(result.get(), SQLException);
+}
+
+TEST_F(SessionTest, ThrowingCallbackDoesNotStopTheWorker) {
+    scriptNumbers("FROM Numbers", {"1"});
+
+    session.executeQueryAsync("SELECT Number FROM Numbers", [](std::future<MaterializedResult> &&) {
+        throw std::runtime_error("callback failed");
+    });
+
+    // The worker drops the callback's error and carries on with the next query
+    std::future<MaterializedResult> next = session.executeQueryAsync("SELECT Number FROM Numbers");
+    ASSERT_EQ(next.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    EXPECT_EQ(next.get().rowCount(), 1u);
+}
+
+TEST_F(SessionTest, CallbackErrorsGoToTheErrorHandler) {
+    scriptNumbers("FROM Numbers", {"1"});
+
+    std::vector<std::string> errors;
+    session.setCallbackErrorHandler([&errors](std::exception_ptr error) {
+        try {
+            std::rethrow_exception(error);
+        } catch (std::runtime_error &e) {
+            errors.emplace_back(e.what());
+        }
+        throw std::logic_error("handler failed");
+    });
+    session.executeQueryAsync("SELECT Number FROM Numbers", [](std::future<MaterializedResult> &&) {
+        throw std::runtime_error("first callback failed");
+    });
+    session.executeQueryAsync("SELECT Number FROM Numbers", [](std::future<MaterializedResult> &&) {
+        throw std::runtime_error("second callback failed");
+    });
+
+    // Even the handler throwing doesn't stop the worker
+    std::future<MaterializedResult> next = session.executeQueryAsync("SELECT Number FROM Numbers");
+    ASSERT_EQ(next.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    EXPECT_EQ(errors, std::vector<std::string>({"first callback failed", "second callback failed"}));
+}
+
+// Build a batch of orders with the given number of rows
+static BulkInsert orders(int rows) {
+    BulkInsert batch("Orders", {"Id", "Name"});
+    for (int i = 0; i < rows; i++) {
+        batch.addRow(i, "order " + std::to_string(i));
+    }
+    return batch;
+}
+
+TEST_F(SessionTest, BulkInsertCommitsWhenEveryRowIsAccepted) {
+    BulkInsertResult result = session.bulkInsert(orders(4));
+
+    EXPECT_TRUE(result.committed);
+    EXPECT_EQ(result.rowsInserted, 4u);
+    EXPECT_EQ(result.rowStatus, std::vector<BulkRowStatus>(4, BulkRowStatus::INSERTED));
+    EXPECT_EQ(FakeDriver::instance().transactionEnds(), std::vector<std::string>{"COMMIT"});
+
+    // Names are quoted for the dialect
+    std::vector<std::string> statements = FakeDriver::instance().statements();
+    EXPECT_NE(std::find(statements.begin(), statements.end(), "INSERT INTO [Orders] ([Id], [Name]) VALUES (?, ?)"),
+              statements.end());
+}
+
+TEST_F(SessionTest, RolledBackBulkInsertReportsNothingKept) {
+    FakeDriver::instance().failBulkRows({2});
+
+    BulkInsertResult result = session.bulkInsert(orders(4));
+
+    // The rows either side of the failure were accepted, but undone with it
+    EXPECT_FALSE(result.committed);
+    EXPECT_EQ(result.rowsInserted, 0u);
+    EXPECT_EQ(result.rowStatus, (std::vector<BulkRowStatus>{BulkRowStatus::ROLLED_BACK, BulkRowStatus::ROLLED_BACK,
+                                                             BulkRowStatus::FAILED, BulkRowStatus::ROLLED_BACK}));
+    EXPECT_EQ(FakeDriver::instance().transactionEnds(), std::vector<std::string>{"ROLLBACK"});
+}
+
+TEST_F(SessionTest, BulkInsertInCallersTransactionRollsBackToSavepoint) {
+    session.beginTransaction();
+    FakeDriver::instance().failBulkRows({1});
+
+    BulkInsertResult result = session.bulkInsert(orders(3));
+
+    EXPECT_FALSE(result.committed);
+    EXPECT_EQ(result.rowsInserted, 0u);
+    EXPECT_EQ(result.rowStatus[0], BulkRowStatus::ROLLED_BACK);
+
+    // Only the batch is undone, leaving the caller's transaction open for them to end
+    std::vector<std::string> statements = FakeDriver::instance().statements();
+    ASSERT_GE(statements.size(), 3u);
+    EXPECT_EQ(statements.front(), "SAVE TRANSACTION [bulk_insert__]");
+    EXPECT_EQ(statements.back(), "ROLLBACK TRANSACTION [bulk_insert__]");
+    EXPECT_TRUE(FakeDriver::instance().transactionEnds().empty());
+    EXPECT_TRUE(session.inTransaction());
+    session.rollback();
+}
+
+TEST_F(SessionTest, BulkInsertRacingTransactionsOnAnotherThread) {
+    // Another thread begins and ends transactions while batches are inserted. Each batch either runs in a
+    // transaction of its own or joins the other thread's behind a savepoint, but is never caught between the two
+    std::atomic_bool inserting{true};
+    std::thread other([&]() {
+        while (inserting.load()) {
+            try {
+                session.beginTransaction();
+            } catch (SQLException &) {
+                // A batch's own transaction can't be running here, as it only exists while the lock is held
+                ADD_FAILURE() << "Transaction already in progress";
+                return;
+            }
+            std::this_thread::yield();
+            session.commit();
+        }
+    });
+
+    for (int i = 0; i < 200; i++) {
+        BulkInsertResult result;
+        EXPECT_NO_THROW(result = session.bulkInsert(orders(2)));
+        EXPECT_TRUE(result.committed);
+    }
+    inserting = false;
+    other.join();
+    EXPECT_FALSE(session.inTransaction());
+}
+
+TEST_F(SessionTest, KeysetValuesAreBoundAsParameters) {
+    session.table("Orders").select("Id", "Name").orderBy(OrderDirection::ASC, "Placed", "Id")
+            .after("2026-10-18", 41).limit(10).execute();
+
+    // Each use of a key value is a placeholder, bound in the order they appear
+    std::string statement = FakeDriver::instance().statements().back();
+    EXPECT_NE(statement.find("(Placed > ?) OR (Placed = ? AND Id > ?)"), std::string::npos) << statement;
+    EXPECT_EQ(statement.find("41"), std::string::npos) << statement;
+    EXPECT_EQ(FakeDriver::instance().parameters(), (std::vector<std::string>{"2026-10-18", "2026-10-18", "41"}));
+}
+
+TEST_F(SessionTest, KeysetMixesOrderDirections) {
+    session.table("Orders").select("Id").orderBy(OrderDirection::DESC, "Placed").orderBy(OrderDirection::ASC, "Id")
+            .after("2026-10-18", 41).execute();
+
+    std::string statement = FakeDriver::instance().statements().back();
+    EXPECT_NE(statement.find("WHERE ((Placed < ?) OR (Placed = ? AND Id > ?))"), std::string::npos) << statement;
+    EXPECT_NE(statement.find("ORDER BY Placed DESC, Id ASC"), std::string::npos) << statement;
+
+    // A key short of the order by columns is refused before anything is sent to the database
+    size_t executed = FakeDriver::instance().statements().size();
+    EXPECT_THROW(session.table("Orders").select("Id").orderBy(OrderDirection::DESC, "Placed", "Id").after(41)
+                         .execute(), SQLException);
+    EXPECT_EQ(FakeDriver::instance().statements().size(), executed);
+}
+
+TEST_F(SessionTest, OracleOffsetAddsNoColumns) {
+    session.table("Orders").select("Id", "Name").orderBy(OrderDirection::ASC, "Id").offset(20).limit(10)
+            .executeOracle();
+
+    std::string statement = FakeDriver::instance().statements().back();
+    EXPECT_EQ(statement.find("rownum__"), std::string::npos) << statement;
+    EXPECT_NE(statement.find("OFFSET 20 ROWS FETCH NEXT 10 ROWS ONLY"), std::string::npos) << statement;
+}
+
+TEST_F(SessionTest, TransactionGuardRollsBackUnlessCommitted) {
+    {
+        Transaction transaction = session.transaction();
+        EXPECT_TRUE(transaction.active());
+        EXPECT_TRUE(session.inTransaction());
+    }
+    EXPECT_FALSE(session.inTransaction());
+    EXPECT_EQ(FakeDriver::instance().transactionEnds(), std::vector<std::string>{"ROLLBACK"});
+
+    // Nor is a committed transaction rolled back as well on leaving scope
+    {
+        Transaction transaction = session.transaction();
+        transaction.commit();
+        EXPECT_FALSE(transaction.active());
+    }
+    EXPECT_EQ(FakeDriver::instance().transactionEnds(), (std::vector<std::string>{"ROLLBACK", "COMMIT"}));
+}
+
+TEST_F(SessionTest, TransactionGuardEndsOnlyOnce) {
+    Transaction transaction = session.transaction();
+    transaction.commit();
+
+    EXPECT_THROW(transaction.commit(), SQLException);
+    EXPECT_THROW(transaction.rollback(), SQLException);
+    EXPECT_EQ(FakeDriver::instance().transactionEnds(), std::vector<std::string>{"COMMIT"});
+
+    // The session is free for the next transaction
+    EXPECT_FALSE(session.inTransaction());
+    session.transaction().commit();
+    EXPECT_EQ(FakeDriver::instance().transactionEnds(), (std::vector<std::string>{"COMMIT", "COMMIT"}));
+}
+
+TEST_F(SessionTest, MovedTransactionGuardHandsOverTheTransaction) {
+    std::optional<Transaction> outer;
+    {
+        Transaction inner = session.transaction();
+        outer.emplace(std::move(inner));
+        EXPECT_FALSE(inner.active());
+        EXPECT_THROW(inner.commit(), SQLException);
+    }
+
+    // The moved from guard leaving scope doesn't end the transaction the new one controls
+    EXPECT_TRUE(outer->active());
+    EXPECT_TRUE(session.inTransaction());
+    EXPECT_TRUE(FakeDriver::instance().transactionEnds().empty());
+
+    outer->commit();
+    outer.reset();
+    EXPECT_EQ(FakeDriver::instance().transactionEnds(), std::vector<std::string>{"COMMIT"});
+}
+
+TEST_F(SessionTest, FailedCommitIsReportedAheadOfAutocommit) {
+    FakeDriver::instance().failTransactionEnds();
+    Transaction transaction = session.transaction();
+
+    try {
+        transaction.commit();
+        ADD_FAILURE() << "Commit should have failed";
+    } catch (SQLException &e) {
+        EXPECT_EQ(e.state(), "08S01");
+        EXPECT_EQ(e.error(), "Communication link failure");
+    }
+
+    // Whatever the outcome, the transaction is over, and the guard won't try to roll it back
+    EXPECT_FALSE(transaction.active());
+    EXPECT_FALSE(session.inTransaction());
+    EXPECT_EQ(FakeDriver::instance().transactionEnds(), std::vector<std::string>{"COMMIT"});
+}
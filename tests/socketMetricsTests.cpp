@@ -0,0 +1,56 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "../include/networking/SocketMetrics.h"
+#include "loopback.h"
+
+using namespace networking;
+using namespace tests;
+
+// Get how much a counter has gone up by between two snapshots
+static uint64_t increase(const SocketMetricsSnapshot &before, const SocketMetricsSnapshot &after,
+                         SocketCounter counter) {
+    return after[counter] - before[counter];
+}
+
+TEST(SocketMetrics, TimedOutReceiveCountsOneClose) {
+    LoopbackPair pair = connectLoopback();
+
+    SocketMetricsSnapshot before = SocketMetrics::snapshot();
+    NetworkMessage message = pair.server.receive(std::chrono::steady_clock::now() + std::chrono::milliseconds(50));
+    SocketMetricsSnapshot after = SocketMetrics::snapshot();
+
+    EXPECT_TRUE(message.invalid());
+    EXPECT_EQ(increase(before, after, SocketCounter::TimeoutCloses), 1u);
+    EXPECT_EQ(increase(before, after, SocketCounter::EofCloses), 0u);
+    EXPECT_EQ(increase(before, after, SocketCounter::ResetCloses), 0u);
+    EXPECT_EQ(increase(before, after, SocketCounter::SocketsClosed), 1u);
+}
+
+TEST(SocketMetrics, ClosedPeerCountsOneEofClose) {
+    LoopbackPair pair = connectLoopback();
+    pair.client.close();
+
+    SocketMetricsSnapshot before = SocketMetrics::snapshot();
+    NetworkMessage message = pair.server.receive(std::chrono::steady_clock::now() + std::chrono::seconds(10));
+    SocketMetricsSnapshot after = SocketMetrics::snapshot();
+
+    EXPECT_TRUE(message.invalid());
+    EXPECT_EQ(increase(before, after, SocketCounter::EofCloses), 1u);
+    EXPECT_EQ(increase(before, after, SocketCounter::TimeoutCloses), 0u);
+}
+
+TEST(SocketMetrics, RateAfterResetIsZero) {
+    SocketMetrics::add(SocketCounter::Accepts, 5);
+    SocketMetricsSnapshot before = SocketMetrics::snapshot();
+    SocketMetrics::reset();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    SocketMetricsSnapshot after = SocketMetrics::snapshot();
+
+    EXPECT_EQ(after.rate(SocketCounter::Accepts, before), 0.0);
+}
@@ -0,0 +1,131 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include <limits>
+
+#include <gtest/gtest.h>
+
+#include "../include/database/SQLSession.h"
+#include "../include/metrics/LatencyHistogram.h"
+#include "fakeDriver.h"
+
+using namespace sql;
+using namespace metrics;
+using namespace tests;
+
+TEST(LatencyHistogram, SmallValuesAreCountedExactly) {
+    LatencyHistogram histogram;
+    for (uint64_t value = 0; value < (1u << LATENCY_HISTOGRAM_PRECISION_BITS); value++) {
+        histogram.record(value);
+    }
+
+    EXPECT_EQ(histogram.count(), 64u);
+    EXPECT_EQ(histogram.percentile(0), 0u);
+    EXPECT_EQ(histogram.percentile(50), 31u);
+    EXPECT_EQ(histogram.percentile(100), 63u);
+}
+
+TEST(LatencyHistogram, LargeValuesAreKeptToRelativePrecision) {
+    // Alongside a much larger value, so a value's bucket is not capped by the largest recorded
+    uint64_t limit = 1ull << 40u;
+    for (uint64_t value = 64; value < limit; value = value * 3 / 2 + 1) {
+        LatencyHistogram histogram;
+        histogram.record(value);
+        histogram.record(limit);
+
+        uint64_t counted = histogram.percentile(0);
+        EXPECT_GE(counted, value);
+        EXPECT_LE(counted - value, value >> (LATENCY_HISTOGRAM_PRECISION_BITS - 1)) << "Value " << value;
+    }
+}
+
+TEST(LatencyHistogram, NeighbouringValuesShareBuckets) {
+    // 1000 and 1001 fall in the same bucket, one sixteen values wide, whose top is 1007
+    LatencyHistogram histogram;
+    histogram.record(1000);
+    histogram.record(1001);
+    histogram.record(2000);
+
+    EXPECT_EQ(histogram.percentile(50), 1007u);
+    EXPECT_EQ(histogram.percentile(100), 2000u);
+
+    HistogramSummary summary = histogram.summary();
+    EXPECT_EQ(summary.count, 3u);
+    EXPECT_EQ(summary.min, 1000u);
+    EXPECT_EQ(summary.max, 2000u);
+    EXPECT_DOUBLE_EQ(summary.mean, 4001.0 / 3.0);
+}
+
+TEST(LatencyHistogram, ValuesPastTheRangeReportTheLargestRecorded) {
+    LatencyHistogram histogram;
+    histogram.record(std::numeric_limits<uint64_t>::max());
+    histogram.record(1ull << LATENCY_HISTOGRAM_MAX_BITS);
+
+    EXPECT_EQ(histogram.percentile(0), std::numeric_limits<uint64_t>::max());
+    EXPECT_EQ(histogram.count(), 2u);
+}
+
+TEST(LatencyHistogram, MergeAndReset) {
+    LatencyHistogram first, second;
+    first.record(5);
+    second.record(10);
+    second.record(20);
+
+    first.merge(second);
+    EXPECT_EQ(first.count(), 3u);
+    EXPECT_EQ(first.summary().min, 5u);
+    EXPECT_EQ(first.summary().max, 20u);
+
+    first.reset();
+    EXPECT_EQ(first.count(), 0u);
+    EXPECT_EQ(first.percentile(50), 0u);
+}
+
+TEST(StatementMetrics, RowsAndBytesAreCountedAsTheyAreFetched) {
+    FakeDriver::instance().reset();
+    FakeResult scripted;
+    scripted.columns = {{"Name", SQL_VARCHAR, 20, false}};
+    scripted.rows = {{"first"}, {"second"}, {"third"}};
+    FakeDriver::instance().script("FROM Names", scripted);
+
+    std::shared_ptr<StatementMetrics> statementMetrics = std::make_shared<StatementMetrics>();
+    SQLSession session;
+    session.connect("fake", "user", "password");
+    session.setStatementMetrics(statementMetrics);
+
+    // The result is still open, part read, when the report is taken
+    QueryResult result = session.executeQuery("SELECT Name FROM Names");
+    ASSERT_TRUE(result.fetchNextRow());
+    EXPECT_EQ(result.row[0].get<std::string>().value(), "first");
+    ASSERT_TRUE(result.fetchNextRow());
+
+    std::vector<StatementReport> report = statementMetrics->report();
+    ASSERT_EQ(report.size(), 1u);
+    EXPECT_EQ(report[0].executions, 1u);
+    EXPECT_EQ(report[0].rows, 2u);
+    EXPECT_EQ(report[0].bytes, 5u);
+}
+
+TEST(StatementMetrics, DumpEveryReplacesTheRunningReport) {
+    StatementMetrics statementMetrics;
+    std::atomic<int> reports{0};
+
+    // Each call stops the thread the last one started, rather than assigning over it while it runs
+    for (int i = 0; i < 3; i++) {
+        statementMetrics.dumpEvery(std::chrono::milliseconds(1), [&reports](const std::vector<StatementReport> &) {
+            reports++;
+        });
+    }
+    // Wait for a report, but not forever if the thread never runs
+    std::chrono::steady_clock::time_point giveUp = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (reports.load() == 0 && std::chrono::steady_clock::now() < giveUp) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    statementMetrics.stopDumping();
+
+    int stopped = reports.load();
+    EXPECT_GT(stopped, 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_EQ(reports.load(), stopped);
+}
@@ -0,0 +1,155 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include <gtest/gtest.h>
+
+#include "../include/database/SQLSession.h"
+#include "../include/database/StatementPool.h"
+#include "fakeDriver.h"
+
+using namespace sql;
+using namespace tests;
+
+// StatementPoolTest
+// A connection to the fake driver with a result scripted for it, for pools to allocate statements on
+class StatementPoolTest : public testing::Test {
+protected:
+    void SetUp() override {
+        FakeDriver::instance().reset();
+        FakeResult numbers;
+        numbers.columns = {{"Value", SQL_INTEGER, 10, false}};
+        numbers.rows = {{"1"}, {"2"}, {"3"}};
+        FakeDriver::instance().script("FROM Numbers", numbers);
+
+        environment.allocate();
+        connection.allocate(environment);
+    }
+
+    SQLEnvironmentHandle environment;
+    SQLConnectionHandle connection;
+};
+
+// Run the query for the scripted numbers on a handle
+static void executeNumbers(const SQLStatementHandle &statement) {
+    ASSERT_EQ(SQLExecDirect(statement.get(), (SQLCHAR *) "SELECT Value FROM Numbers", SQL_NTS), SQL_SUCCESS);
+}
+
+TEST_F(StatementPoolTest, ReleasedHandleIsReused) {
+    StatementPool pool;
+    SQLStatementHandle first = pool.acquire(connection);
+    SQLHANDLE handle = first.get();
+    pool.release(std::move(first));
+    EXPECT_EQ(pool.idleCount(), 1u);
+
+    SQLStatementHandle second = pool.acquire(connection);
+    EXPECT_EQ(second.get(), handle);
+    EXPECT_EQ(pool.idleCount(), 0u);
+    EXPECT_EQ(pool.allocations(), 1u);
+}
+
+TEST_F(StatementPoolTest, ReleaseResetsTheHandle) {
+    StatementPool pool;
+    SQLStatementHandle statement = pool.acquire(connection);
+
+    // Leave the handle part way through a result, with a column bound for block fetches and a parameter bound
+    executeNumbers(statement);
+    ASSERT_EQ(SQLFetch(statement.get()), SQL_SUCCESS);
+    int values[2];
+    SQLLEN indicators[2];
+    ASSERT_EQ(SQLBindCol(statement.get(), 1, SQL_C_SLONG, values, sizeof(int), indicators), SQL_SUCCESS);
+    ASSERT_EQ(SQLSetStmtAttr(statement.get(), SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER) 2, 0), SQL_SUCCESS);
+    int parameter = 7;
+    SQLLEN parameterLength = sizeof(int);
+    ASSERT_EQ(SQLBindParameter(statement.get(), 1, SQL_PARAM_INPUT, SQL_C_SLONG, SQL_INTEGER, 0, 0, &parameter, 0,
+                               &parameterLength), SQL_SUCCESS);
+    pool.release(std::move(statement));
+
+    // The reused handle runs as a fresh one: no parameters are sent, and rows are fetched singly from the start
+    // into nothing bound, to be read with SQLGetData
+    SQLStatementHandle reused = pool.acquire(connection);
+    ASSERT_EQ(pool.allocations(), 1u);
+    executeNumbers(reused);
+    EXPECT_TRUE(FakeDriver::instance().parameters().empty());
+
+    values[0] = values[1] = 0;
+    ASSERT_EQ(SQLFetch(reused.get()), SQL_SUCCESS);
+    EXPECT_EQ(values[0], 0);
+    int value = 0;
+    SQLLEN length;
+    ASSERT_EQ(SQLGetData(reused.get(), 1, SQL_C_SLONG, &value, sizeof(int), &length), SQL_SUCCESS);
+    EXPECT_EQ(value, 1);
+    ASSERT_EQ(SQLFetch(reused.get()), SQL_SUCCESS);
+    ASSERT_EQ(SQLGetData(reused.get(), 1, SQL_C_SLONG, &value, sizeof(int), &length), SQL_SUCCESS);
+    EXPECT_EQ(value, 2);
+}
+
+TEST_F(StatementPoolTest, HandlesPastTheCapacityAreFreed) {
+    size_t open = FakeDriver::instance().openStatements();
+    StatementPool pool(2);
+    std::vector<SQLStatementHandle> handles;
+    for (int i = 0; i < 3; i++) {
+        handles.push_back(pool.acquire(connection));
+    }
+    EXPECT_EQ(FakeDriver::instance().openStatements(), open + 3);
+
+    for (SQLStatementHandle &handle : handles) {
+        pool.release(std::move(handle));
+    }
+    EXPECT_EQ(pool.idleCount(), 2u);
+    EXPECT_EQ(FakeDriver::instance().openStatements(), open + 2);
+}
+
+TEST_F(StatementPoolTest, CloseFreesIdleAndLaterReleasedHandles) {
+    size_t open = FakeDriver::instance().openStatements();
+    StatementPool pool;
+    SQLStatementHandle kept = pool.acquire(connection);
+    pool.release(pool.acquire(connection));
+    pool.release(pool.acquire(connection));
+    EXPECT_EQ(pool.idleCount(), 1u);
+    EXPECT_EQ(FakeDriver::instance().openStatements(), open + 2);
+
+    pool.close();
+    EXPECT_EQ(pool.idleCount(), 0u);
+    EXPECT_EQ(FakeDriver::instance().openStatements(), open + 1);
+
+    // A result still open when the connection closes gives its handle back afterwards, which must not be kept
+    pool.release(std::move(kept));
+    EXPECT_EQ(pool.idleCount(), 0u);
+    EXPECT_EQ(FakeDriver::instance().openStatements(), open);
+}
+
+TEST_F(StatementPoolTest, BackToBackStatementsShareOneHandle) {
+    std::shared_ptr<StatementMetrics> statementMetrics = std::make_shared<StatementMetrics>();
+    SQLSession session;
+    session.connect("fake", "user", "password");
+    session.setStatementMetrics(statementMetrics);
+    size_t open = FakeDriver::instance().openStatements();
+
+    for (int i = 0; i < 3; i++) {
+        session.execute("SELECT Value FROM Numbers");
+        QueryResult result = session.executeQuery("SELECT Value FROM Numbers");
+        ASSERT_TRUE(result.fetchNextRow());
+    }
+    EXPECT_EQ(FakeDriver::instance().openStatements(), open + 1);
+
+    // Only the first statement allocated
+    std::vector<StatementReport> report = statementMetrics->report();
+    ASSERT_EQ(report.size(), 1u);
+    EXPECT_EQ(report[0].executions, 6u);
+    EXPECT_EQ(report[0].handleAllocations, 1u);
+
+    // Results open at once each need their own handle, and both are kept for later
+    {
+        QueryResult first = session.executeQuery("SELECT Value FROM Numbers");
+        QueryResult second = session.executeQuery("SELECT Value FROM Numbers");
+        ASSERT_TRUE(first.fetchNextRow());
+        ASSERT_TRUE(second.fetchNextRow());
+        EXPECT_EQ(FakeDriver::instance().openStatements(), open + 2);
+    }
+    EXPECT_EQ(FakeDriver::instance().openStatements(), open + 2);
+
+    // Closing the connection frees them
+    session.closeConnection();
+    EXPECT_EQ(FakeDriver::instance().openStatements(), open);
+}
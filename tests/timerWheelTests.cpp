@@ -0,0 +1,127 @@
+//
+// Created by Matthew.Sirman on 18/10/2026.
+//
+
+#include <gtest/gtest.h>
+
+#include "../include/networking/TimerWheel.h"
+
+using namespace networking;
+using namespace std::chrono_literals;
+
+using Clock = TimerWheel::Clock;
+
+TEST(TimerWheel, FiresOnceTheDeadlineHasPassedAndNeverEarly) {
+    TimerWheel wheel(10ms, 16);
+    Clock::time_point start = Clock::now();
+    int fired = 0;
+    wheel.schedule(start + 50ms, [&fired]() { fired++; });
+    EXPECT_EQ(wheel.size(), 1u);
+
+    EXPECT_EQ(wheel.advance(start + 50ms - 1ns), 0u);
+    EXPECT_EQ(fired, 0);
+
+    // Timers fire at tick granularity, so by one tick past the deadline it must have gone
+    EXPECT_EQ(wheel.advance(start + 60ms), 1u);
+    EXPECT_EQ(fired, 1);
+    EXPECT_EQ(wheel.size(), 0u);
+
+    // And only once
+    EXPECT_EQ(wheel.advance(start + 500ms), 0u);
+    EXPECT_EQ(fired, 1);
+}
+
+TEST(TimerWheel, PassedDeadlineFiresOnTheNextTick) {
+    TimerWheel wheel(10ms, 16);
+    Clock::time_point start = Clock::now();
+    bool fired = false;
+    wheel.schedule(start - 1s, [&fired]() { fired = true; });
+
+    wheel.advance(start + 10ms);
+    EXPECT_TRUE(fired);
+}
+
+TEST(TimerWheel, CancelledTimerNeverFires) {
+    TimerWheel wheel(1ms, 16);
+    Clock::time_point start = Clock::now();
+    bool cancelledFired = false, keptFired = false;
+    TimerWheel::TimerID cancelled = wheel.schedule(start + 5ms, [&]() { cancelledFired = true; });
+    TimerWheel::TimerID kept = wheel.schedule(start + 5ms, [&]() { keptFired = true; });
+
+    EXPECT_TRUE(wheel.cancel(cancelled));
+    EXPECT_FALSE(wheel.cancel(cancelled));
+    EXPECT_EQ(wheel.size(), 1u);
+
+    EXPECT_EQ(wheel.advance(start + 10ms), 1u);
+    EXPECT_FALSE(cancelledFired);
+    EXPECT_TRUE(keptFired);
+
+    // A timer which has fired can no longer be cancelled
+    EXPECT_FALSE(wheel.cancel(kept));
+}
+
+TEST(TimerWheel, DeadlinesBeyondOneTurnWaitForTheirRound) {
+    // Eight slots of one millisecond, so a deadline 20ms away shares its slot with ones 4ms and 12ms away
+    TimerWheel wheel(1ms, 8);
+    Clock::time_point start = Clock::now();
+    std::vector<int> order;
+    wheel.schedule(start + 20ms, [&order]() { order.push_back(20); });
+    wheel.schedule(start + 12ms, [&order]() { order.push_back(12); });
+    wheel.schedule(start + 4ms, [&order]() { order.push_back(4); });
+
+    wheel.advance(start + 5ms);
+    EXPECT_EQ(order, std::vector<int>({4}));
+    wheel.advance(start + 13ms);
+    EXPECT_EQ(order, std::vector<int>({4, 12}));
+    EXPECT_EQ(wheel.size(), 1u);
+
+    // A whole number of turns later still, the last is not yet due
+    EXPECT_EQ(wheel.advance(start + 20ms - 1ns), 0u);
+    wheel.advance(start + 21ms);
+    EXPECT_EQ(order, std::vector<int>({4, 12, 20}));
+}
+
+TEST(TimerWheel, CallbackMayRescheduleItself) {
+    TimerWheel wheel(1ms, 8);
+    Clock::time_point start = Clock::now();
+    Clock::time_point deadline = start + 5ms;
+    int fired = 0;
+    std::function<void()> periodic = [&]() {
+        fired++;
+        deadline += 5ms;
+        wheel.schedule(deadline, periodic);
+    };
+    wheel.schedule(deadline, periodic);
+
+    // Timers scheduled by callbacks fire within the same advance if their deadline is passed too
+    EXPECT_EQ(wheel.advance(start + 51ms), 10u);
+    EXPECT_EQ(fired, 10);
+    EXPECT_EQ(wheel.size(), 1u);
+}
+
+TEST(TimerWheel, CallbackMayCancelALaterTimer) {
+    TimerWheel wheel(1ms, 8);
+    Clock::time_point start = Clock::now();
+    bool laterFired = false;
+    TimerWheel::TimerID later = wheel.schedule(start + 10ms, [&]() { laterFired = true; });
+    wheel.schedule(start + 2ms, [&]() { EXPECT_TRUE(wheel.cancel(later)); });
+
+    EXPECT_EQ(wheel.advance(start + 20ms), 1u);
+    EXPECT_FALSE(laterFired);
+    EXPECT_EQ(wheel.size(), 0u);
+}
+
+TEST(TimerWheel, TimeUntilNextTick) {
+    TimerWheel wheel(10ms, 16);
+    Clock::time_point start = Clock::now();
+    EXPECT_FALSE(wheel.timeUntilNextTick(start).has_value());
+
+    wheel.schedule(start + 100ms, []() {});
+    std::optional<Clock::duration> wait = wheel.timeUntilNextTick(start);
+    ASSERT_TRUE(wait.has_value());
+    EXPECT_GT(*wait, Clock::duration::zero());
+    EXPECT_LE(*wait, 10ms);
+
+    // Once a tick is overdue, the loop should not wait at all
+    EXPECT_EQ(wheel.timeUntilNextTick(start + 1s), Clock::duration::zero());
+}